@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""@package integration_test.
+
+Measures how the memory usage of the client scales with the number of mostly idle
+connections it holds open, with and without --low-memory-connections.
+"""
+
+import logging
+import os
+import pytest
+from test.integration.integration_test_fixtures import http_test_server_fixture
+from test.integration import asserts
+
+# Relative slack allowed when comparing the per connection growth of two executions, as the resident
+# set size also moves with allocator and page cache behavior.
+_PER_CONNECTION_TOLERANCE = 0.1
+
+
+def _measure_memory_per_connection(fixture, connections, low_memory):
+  args = [
+      fixture.getTestServerRootUri(), "--rps", "10", "--duration", "5", "--connections",
+      str(connections), "--max-active-requests", "1", "--prefetch-connections",
+      "--report-memory-usage"
+  ]
+  if low_memory:
+    args.append("--low-memory-connections")
+  parsed_json, _ = fixture.runNighthawkClient(args)
+  counters = fixture.getNighthawkCounterMapFromJson(parsed_json)
+  asserts.assertCounterEqual(counters, "upstream_cx_http1_total", connections)
+  asserts.assertCounterGreaterEqual(counters, "memory.rss_growth_bytes", 1)
+  return (counters["memory.rss_growth_bytes"],
+          counters["memory.rss_growth_bytes_per_connection_upper_bound"])
+
+
+@pytest.mark.parametrize('server_config',
+                         ["nighthawk/test/integration/configurations/nighthawk_http_origin.yaml"])
+def test_http_h1_idle_connection_memory(http_test_server_fixture):  # noqa
+  rows = ["connections low_memory rss_growth_bytes bytes_per_connection_upper_bound"]
+  per_connection_by_mode = {}
+  for connections in [100, 1000, 5000]:
+    for low_memory in [False, True]:
+      growth, per_connection = _measure_memory_per_connection(http_test_server_fixture,
+                                                              connections, low_memory)
+      per_connection_by_mode[(connections, low_memory)] = per_connection
+      rows.append("%d %s %d %d" % (connections, low_memory, growth, per_connection))
+  table = "\n".join(rows)
+  logging.info(table)
+  with open(os.path.join(http_test_server_fixture.test_server.tmpdir, "idle_connection_memory.txt"),
+            "w") as f:
+    f.write(table)
+  # With enough connections for the per connection growth to dominate the noise, low memory
+  # connections must not take more than the default ones.
+  for connections in [1000, 5000]:
+    default_per_connection = per_connection_by_mode[(connections, False)]
+    low_memory_per_connection = per_connection_by_mode[(connections, True)]
+    assert low_memory_per_connection <= default_per_connection * (
+        1 + _PER_CONNECTION_TOLERANCE), table
@@ -3,6 +3,7 @@
 #include <functional>
 #include <memory>
 
+#include "envoy/common/time.h"
 #include "envoy/http/header_map.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/store.h"
@@ -11,6 +12,8 @@
 #include "nighthawk/common/statistic.h"
 #include "nighthawk/common/uri.h"
 
+#include "api/client/output.pb.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -43,11 +46,14 @@ public:
    *
    * @param caller_completion_callback The callback the client must call back upon completion of a
    * successfully started request.
+   * @param intended_start The time the request was due to start, which is recorded as its intended
+   * start in the request event log.
    *
    * @return true if the request could be started, otherwise the request could not be started, for
    * example due to resource limits
    */
-  virtual bool tryStartRequest(CompletionCallback caller_completion_callback) PURE;
+  virtual bool tryStartRequest(CompletionCallback caller_completion_callback,
+                               Envoy::MonotonicTime intended_start) PURE;
 
   /**
    * @return const Envoy::Stats::Scope& the statistics scope associated the benchmark client.
@@ -60,6 +66,12 @@ public:
    * @return bool indicating if latency measurement is enabled.
    */
   virtual bool shouldMeasureLatencies() const PURE;
+
+  /**
+   * @return std::vector<nighthawk::client::SlowRequest> the slowest successful requests, slowest
+   * first. Empty unless capturing them was configured.
+   */
+  virtual std::vector<nighthawk::client::SlowRequest> slowestRequests() const PURE;
 };
 
 using BenchmarkClientPtr = std::unique_ptr<BenchmarkClient>;
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <array>
+#include <map>
 #include <memory>
+#include <string>
 
 #include "envoy/common/pure.h"
 #include "envoy/stats/store.h"
 
 #include "nighthawk/client/benchmark_client.h"
+#include "nighthawk/client/worker_counters.h"
 #include "nighthawk/common/phase.h"
 #include "nighthawk/common/statistic.h"
 #include "nighthawk/common/worker.h"
@@ -13,6 +17,12 @@
 namespace Nighthawk {
 namespace Client {
 
+/**
+ * The live counters of the typed counter block of a worker, indexed by WorkerCounter.
+ */
+using WorkerCounterBlock =
+    std::array<Envoy::Stats::Counter*, static_cast<size_t>(WorkerCounter::Count)>;
+
 /**
  * Interface for a threaded benchmark client worker.
  */
@@ -25,10 +35,43 @@ public:
   virtual StatisticPtrMap statistics() const PURE;
 
   /**
-   * @return const std::map<std::string, uint64_t>& The worker-specific counter values.
-   * Gets filled when the worker has completed its task, empty before that.
+   * @return const WorkerCounterValues& The worker-specific counter values, indexed by
+   * WorkerCounter. Gets filled when the worker has completed its task, zeroed before that.
+   */
+  virtual const WorkerCounterValues& counterValues() const PURE;
+
+  /**
+   * @return const WorkerCounterBlock& the counters of the worker's own stats scope that
+   * counterValues() gets snapshotted from. Their values also include those of the clusters bound to
+   * the source addresses of the worker.
+   */
+  virtual const WorkerCounterBlock& counterBlock() const PURE;
+
+  /**
+   * @return std::vector<nighthawk::client::SlowRequest> the slowest successful requests of the
+   * worker, slowest first. Must be called after the worker has completed its task.
+   */
+  virtual std::vector<nighthawk::client::SlowRequest> slowestRequests() const PURE;
+
+  /**
+   * @return const std::map<std::string, uint64_t>& the perf events counted over the main phase of
+   * the worker, keyed by counter name. Empty unless perf event counting was requested and is
+   * supported. Gets filled when the worker has completed its task.
+   */
+  virtual const std::map<std::string, uint64_t>& perfCounterValues() const PURE;
+
+  /**
+   * @return uint64_t an estimate of the memory held by the request source of the worker, in bytes.
+   * Zero when the allocator linked into the client doesn't report its statistics.
+   */
+  virtual uint64_t requestSourceMemoryBytes() const PURE;
+
+  /**
+   * @return uint64_t the number of upstream connections the worker held open when it completed its
+   * task, including those bound to source addresses. Gets filled when the worker has completed its
+   * task.
    */
-  virtual const std::map<std::string, uint64_t>& threadLocalCounterValues() PURE;
+  virtual uint64_t openConnections() const PURE;
 
   /**
    * @return const Phase& associated to this worker.
@@ -57,6 +57,23 @@ public:
   tlsContext() const PURE;
   virtual const absl::optional<envoy::config::core::v3::BindConfig>&
   upstreamBindConfig() const PURE;
+  virtual std::vector<std::string> sourceAddresses() const PURE;
+  virtual bool lowMemoryConnections() const PURE;
+  virtual bool reportMemoryUsage() const PURE;
+  virtual bool socketTimestamping() const PURE;
+  virtual bool tscClock() const PURE;
+  virtual bool calibrateOverhead() const PURE;
+  virtual bool overheadAdjustedPercentiles() const PURE;
+  virtual std::string requestEventLog() const PURE;
+  virtual uint32_t requestEventLogCapacity() const PURE;
+  virtual uint32_t slowestRequests() const PURE;
+  virtual std::vector<std::string> slowestRequestsHeaders() const PURE;
+  virtual bool perfCounters() const PURE;
+  virtual std::string cpuProfile() const PURE;
+  virtual std::string heapProfile() const PURE;
+  virtual std::chrono::nanoseconds profileDelay() const PURE;
+  virtual std::chrono::nanoseconds profileDuration() const PURE;
+  virtual std::chrono::nanoseconds memorySampleInterval() const PURE;
   virtual const absl::optional<envoy::config::core::v3::TransportSocket>&
   transportSocket() const PURE;
   virtual uint32_t maxPendingRequests() const PURE;
@@ -79,6 +96,10 @@ public:
   virtual TerminationPredicateMap failurePredicates() const PURE;
   virtual bool openLoop() const PURE;
   virtual std::chrono::nanoseconds jitterUniform() const PURE;
+  virtual std::chrono::nanoseconds requestTimeout() const PURE;
+  virtual double hedgeDelayPercentile() const PURE;
+  virtual uint32_t maxRetries() const PURE;
+  virtual double retryBudgetPercent() const PURE;
   virtual std::string nighthawkService() const PURE;
   virtual std::vector<nighthawk::client::MultiTarget::Endpoint> multiTargetEndpoints() const PURE;
   virtual std::string multiTargetPath() const PURE;
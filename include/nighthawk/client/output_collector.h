@@ -32,6 +32,27 @@ public:
                          const std::map<std::string, uint64_t>& counters,
                          const std::chrono::nanoseconds execution_duration,
                          const absl::optional<Envoy::SystemTime>& first_acquisition_time) PURE;
+  /**
+   * Sets the slowest requests section of the output.
+   *
+   * @param slowest_requests the slowest requests across all workers, slowest first.
+   */
+  virtual void
+  setSlowestRequests(const std::vector<nighthawk::client::SlowRequest>& slowest_requests) PURE;
+  /**
+   * Sets the profiles section of the output.
+   *
+   * @param profiles the profiles written while the workers executed their main phase.
+   */
+  virtual void setProfiles(const std::vector<nighthawk::client::Profile>& profiles) PURE;
+  /**
+   * Sets the memory samples section of the output.
+   *
+   * @param memory_samples the samples of the memory usage of the process, in the order they were
+   * taken.
+   */
+  virtual void
+  setMemorySamples(const std::vector<nighthawk::client::MemorySample>& memory_samples) PURE;
   /**
    * Directly sets the output value.
    *
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Gets told when the workers start and complete their main phase, for example to profile or sample
+ * the process while the workers generate load. Shared by all workers, so implementations must be
+ * thread safe.
+ */
+class PhaseObserver {
+public:
+  virtual ~PhaseObserver() = default;
+
+  /**
+   * Called by each worker on its own thread, right before it starts its main phase.
+   */
+  virtual void onPhaseStarted() PURE;
+
+  /**
+   * Called by each worker on its own thread, right after it completed its main phase.
+   */
+  virtual void onPhaseCompleted() PURE;
+};
+
+} // namespace Client
+} // namespace Nighthawk
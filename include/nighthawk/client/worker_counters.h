@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+namespace Client {
+
+// Counters each client worker tracks in a typed block. The first argument is the enum identifier,
+// the second one the name of the counter relative to the worker's stats scope. That name is also
+// used to report the counter in the output.
+#define ALL_WORKER_COUNTERS(COUNTER)                                                               \
+  COUNTER(GracefulStopRequested, "graceful_stop_requested")                                        \
+  COUNTER(BenchmarkStreamResets, "benchmark.stream_resets")                                        \
+  COUNTER(BenchmarkRequestTimeouts, "benchmark.request_timeouts")                                  \
+  COUNTER(BenchmarkHttp1xx, "benchmark.http_1xx")                                                  \
+  COUNTER(BenchmarkHttp2xx, "benchmark.http_2xx")                                                  \
+  COUNTER(BenchmarkHttp3xx, "benchmark.http_3xx")                                                  \
+  COUNTER(BenchmarkHttp4xx, "benchmark.http_4xx")                                                  \
+  COUNTER(BenchmarkHttp5xx, "benchmark.http_5xx")                                                  \
+  COUNTER(BenchmarkHttpXxx, "benchmark.http_xxx")                                                  \
+  COUNTER(BenchmarkPoolOverflow, "benchmark.pool_overflow")                                        \
+  COUNTER(BenchmarkPoolConnectionFailure, "benchmark.pool_connection_failure")                     \
+  COUNTER(BenchmarkAttemptedRequests, "benchmark.attempted_requests")                              \
+  COUNTER(BenchmarkHedgedAttempts, "benchmark.hedged_attempts")                                    \
+  COUNTER(BenchmarkHedgedRequests, "benchmark.hedged_requests")                                    \
+  COUNTER(BenchmarkHedgeWins, "benchmark.hedge_wins")                                              \
+  COUNTER(BenchmarkRetriedAttempts, "benchmark.retried_attempts")                                  \
+  COUNTER(BenchmarkRetriedRequests, "benchmark.retried_requests")                                  \
+  COUNTER(BenchmarkRetryBudgetExhausted, "benchmark.retry_budget_exhausted")                       \
+  COUNTER(BenchmarkCancelledAttempts, "benchmark.cancelled_attempts")                              \
+  COUNTER(SequencerFailedTerminations, "sequencer.failed_terminations")                            \
+  COUNTER(UpstreamCxTotal, "upstream_cx_total")                                                    \
+  COUNTER(UpstreamCxHttp1Total, "upstream_cx_http1_total")                                         \
+  COUNTER(UpstreamCxHttp2Total, "upstream_cx_http2_total")                                         \
+  COUNTER(UpstreamCxHttp3Total, "upstream_cx_http3_total")                                         \
+  COUNTER(UpstreamCxConnectFail, "upstream_cx_connect_fail")                                       \
+  COUNTER(UpstreamCxConnectTimeout, "upstream_cx_connect_timeout")                                 \
+  COUNTER(UpstreamCxCloseNotify, "upstream_cx_close_notify")                                       \
+  COUNTER(UpstreamCxDestroy, "upstream_cx_destroy")                                                \
+  COUNTER(UpstreamCxDestroyLocal, "upstream_cx_destroy_local")                                     \
+  COUNTER(UpstreamCxDestroyRemote, "upstream_cx_destroy_remote")                                   \
+  COUNTER(UpstreamCxDestroyWithActiveRq, "upstream_cx_destroy_with_active_rq")                     \
+  COUNTER(UpstreamCxDestroyLocalWithActiveRq, "upstream_cx_destroy_local_with_active_rq")          \
+  COUNTER(UpstreamCxDestroyRemoteWithActiveRq, "upstream_cx_destroy_remote_with_active_rq")        \
+  COUNTER(UpstreamCxIdleTimeout, "upstream_cx_idle_timeout")                                       \
+  COUNTER(UpstreamCxMaxRequests, "upstream_cx_max_requests")                                       \
+  COUNTER(UpstreamCxOverflow, "upstream_cx_overflow")                                              \
+  COUNTER(UpstreamCxPoolOverflow, "upstream_cx_pool_overflow")                                     \
+  COUNTER(UpstreamCxProtocolError, "upstream_cx_protocol_error")                                   \
+  COUNTER(UpstreamCxRxBytesTotal, "upstream_cx_rx_bytes_total")                                    \
+  COUNTER(UpstreamCxTxBytesTotal, "upstream_cx_tx_bytes_total")                                    \
+  COUNTER(UpstreamRqTotal, "upstream_rq_total")                                                    \
+  COUNTER(UpstreamRqCompleted, "upstream_rq_completed")                                            \
+  COUNTER(UpstreamRqCancelled, "upstream_rq_cancelled")                                            \
+  COUNTER(UpstreamRqPendingTotal, "upstream_rq_pending_total")                                     \
+  COUNTER(UpstreamRqPendingOverflow, "upstream_rq_pending_overflow")                               \
+  COUNTER(UpstreamRqPendingFailureEject, "upstream_rq_pending_failure_eject")                      \
+  COUNTER(UpstreamRqRxReset, "upstream_rq_rx_reset")                                               \
+  COUNTER(UpstreamRqTxReset, "upstream_rq_tx_reset")                                               \
+  COUNTER(UpstreamRqTimeout, "upstream_rq_timeout")                                                \
+  COUNTER(UpstreamFlowControlPausedReadingTotal, "upstream_flow_control_paused_reading_total")     \
+  COUNTER(UpstreamFlowControlResumedReadingTotal, "upstream_flow_control_resumed_reading_total")   \
+  COUNTER(UpstreamFlowControlBackedUpTotal, "upstream_flow_control_backed_up_total")               \
+  COUNTER(UpstreamFlowControlDrainedTotal, "upstream_flow_control_drained_total")
+
+#define GENERATE_WORKER_COUNTER_ENUM(IDENTIFIER, NAME) IDENTIFIER,
+#define GENERATE_WORKER_COUNTER_NAME(IDENTIFIER, NAME) NAME,
+
+/**
+ * Index of a counter in a worker's typed counter block.
+ */
+enum class WorkerCounter : size_t { ALL_WORKER_COUNTERS(GENERATE_WORKER_COUNTER_ENUM) Count };
+
+/**
+ * Snapshot of the counter values of a single worker (or a merge of those), indexed by
+ * WorkerCounter.
+ */
+using WorkerCounterValues = std::array<uint64_t, static_cast<size_t>(WorkerCounter::Count)>;
+
+/**
+ * @param index the index of the counter in WorkerCounterValues.
+ * @return absl::string_view the name of the counter, relative to the worker's stats scope.
+ */
+inline absl::string_view workerCounterName(size_t index) {
+  static constexpr absl::string_view names[] = {ALL_WORKER_COUNTERS(GENERATE_WORKER_COUNTER_NAME)};
+  return names[index];
+}
+
+/**
+ * Adds the values of a worker counter block to an accumulated counter block, by index.
+ * @param accumulated the counter block that gets the values added.
+ * @param values the counter block that should be added.
+ */
+inline void mergeWorkerCounterValues(WorkerCounterValues& accumulated,
+                                     const WorkerCounterValues& values) {
+  for (size_t i = 0; i < accumulated.size(); i++) {
+    accumulated[i] += values[i];
+  }
+}
+
+/**
+ * Converts a counter block to named counters. Only intended to be called when producing output.
+ * @param values the counter block to convert.
+ * @return std::map<std::string, uint64_t> the non-zero counter values, keyed by name.
+ */
+inline std::map<std::string, uint64_t> workerCounterValuesToMap(const WorkerCounterValues& values) {
+  std::map<std::string, uint64_t> counters;
+  for (size_t i = 0; i < values.size(); i++) {
+    if (values[i] > 0) {
+      counters[std::string(workerCounterName(i))] = values[i];
+    }
+  }
+  return counters;
+}
+
+} // namespace Client
+} // namespace Nighthawk
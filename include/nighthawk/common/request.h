@@ -8,6 +8,33 @@ namespace Nighthawk {
 
 using HeaderMapPtr = std::shared_ptr<const Envoy::Http::RequestHeaderMap>;
 
+/**
+ * Gets notified about the outcome of a request. Allows request sources to derive later requests
+ * from the responses to earlier ones.
+ */
+class ResponseObserver {
+public:
+  virtual ~ResponseObserver() = default;
+
+  /**
+   * @return uint32_t the maximum number of leading response body bytes that should be retained and
+   * passed to onResponse().
+   */
+  virtual uint32_t maxResponseBodyBytes() const PURE;
+
+  /**
+   * Called once when the request completes or fails. Will be called on the worker thread that
+   * issued the request.
+   * @param success true iff a complete response was received.
+   * @param headers the response headers, or nullptr if none were received.
+   * @param body the leading response body bytes, up to maxResponseBodyBytes().
+   */
+  virtual void onResponse(bool success, const Envoy::Http::ResponseHeaderMap* headers,
+                          absl::string_view body) PURE;
+};
+
+using ResponseObserverSharedPtr = std::shared_ptr<ResponseObserver>;
+
 /**
  * Defines the specifics of requests to be send by the load generator, as well as
  * may hold request-level expectations.
@@ -20,6 +47,18 @@ public:
    * @return HeaderMapPtr shared pointer to a request header specification.
    */
   virtual HeaderMapPtr header() const PURE;
+
+  /**
+   * @return uint32_t the class this request belongs to, as assigned by the request source. Indexes
+   * into the names returned by RequestSource::requestClassNames().
+   */
+  virtual uint32_t requestClass() const PURE;
+
+  /**
+   * @return ResponseObserverSharedPtr observer that should be notified of the response to this
+   * request, or nullptr if the request source doesn't need to know about it.
+   */
+  virtual ResponseObserverSharedPtr responseObserver() const PURE;
   // TODO(oschaaf): expectations
 };
 
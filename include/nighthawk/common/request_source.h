@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
@@ -10,6 +13,15 @@ namespace Nighthawk {
 
 using RequestGenerator = std::function<RequestPtr()>;
 
+/**
+ * The number of requests of a request class a request source yielded, and the share of all
+ * requests it aims to yield of the class.
+ */
+struct RequestClassMix {
+  uint64_t yielded;
+  double target_share;
+};
+
 /**
  * Represents a request source which yields request-specifiers.
  */
@@ -29,6 +41,20 @@ public:
    * has been done and just before the worker gets destroyed.
    */
   virtual void destroyOnThread() PURE;
+
+  /**
+   * @return std::vector<std::string> the names of the request classes yielded requests may be
+   * tagged with, indexed by Request::requestClass(). When empty, requests are not classified and
+   * no per-class statistics will be tracked for them.
+   */
+  virtual std::vector<std::string> requestClassNames() const { return {}; }
+
+  /**
+   * @return std::vector<RequestClassMix> the achieved and the targeted mix of the request classes,
+   * indexed like requestClassNames(). Empty when the request source doesn't aim for a particular
+   * mix.
+   */
+  virtual std::vector<RequestClassMix> requestClassMix() const { return {}; }
 };
 
 using RequestSourcePtr = std::unique_ptr<RequestSource>;
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "envoy/common/pure.h"
+#include "envoy/common/time.h"
 
 #include "nighthawk/common/operation_callback.h"
 #include "nighthawk/common/rate_limiter.h"
@@ -12,7 +13,12 @@
 
 namespace Nighthawk {
 
-using SequencerTarget = std::function<bool(OperationCallback)>;
+/**
+ * The target a sequencer calls to start an operation. It gets the callback to call when the
+ * operation completes, and the time the operation was due to start, which is earlier than now when
+ * the target had refused to start it before. Returns false when it can't start the operation now.
+ */
+using SequencerTarget = std::function<bool(OperationCallback, Envoy::MonotonicTime)>;
 
 /**
  * Abstract Sequencer interface.
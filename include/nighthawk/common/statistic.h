@@ -133,6 +133,11 @@ public:
    * instance this was called for will now represent what the stream contained.
    */
   virtual absl::Status deserializeNative(std::istream& input_stream) PURE;
+
+  /**
+   * @return uint64_t an estimate of the memory held by this Statistic instance, in bytes.
+   */
+  virtual uint64_t memoryUsageBytes() const PURE;
 };
 
 } // namespace Nighthawk
\ No newline at end of file
@@ -20,7 +20,9 @@ public:
 };
 
 /**
- * Abstract Uri interface.
+ * Abstract Uri interface. Besides the usual host based uris, unix domain socket uris are supported
+ * as unix:///path/to/socket[:/request/path], or unix://@name[:/request/path] for abstract sockets.
+ * Those have "localhost" as their host, no port, and resolve to a pipe address.
  */
 class Uri {
 public:
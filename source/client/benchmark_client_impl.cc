@@ -19,6 +19,12 @@ using namespace std::chrono_literals;
 
 namespace Nighthawk {
 namespace Client {
+namespace {
+
+// Hedge delays beyond this are capped, see RequestAttemptConfig::hedge_delay_percentile.
+constexpr std::chrono::milliseconds kMaxHedgeDelay = 1s;
+
+} // namespace
 
 BenchmarkClientStatistic::BenchmarkClientStatistic(BenchmarkClientStatistic&& statistic) noexcept
     : connect_statistic(std::move(statistic.connect_statistic)),
@@ -31,7 +37,13 @@ BenchmarkClientStatistic::BenchmarkClientStatistic(BenchmarkClientStatistic&& st
       latency_4xx_statistic(std::move(statistic.latency_4xx_statistic)),
       latency_5xx_statistic(std::move(statistic.latency_5xx_statistic)),
       latency_xxx_statistic(std::move(statistic.latency_xxx_statistic)),
-      origin_latency_statistic(std::move(statistic.origin_latency_statistic)) {}
+      origin_latency_statistic(std::move(statistic.origin_latency_statistic)),
+      request_class_statistics(std::move(statistic.request_class_statistics)),
+      request_timeout_statistic(std::move(statistic.request_timeout_statistic)),
+      first_attempt_statistic(std::move(statistic.first_attempt_statistic)),
+      final_response_statistic(std::move(statistic.final_response_statistic)),
+      wire_latency_statistic(std::move(statistic.wire_latency_statistic)),
+      client_overhead_statistic(std::move(statistic.client_overhead_statistic)) {}
 
 BenchmarkClientStatistic::BenchmarkClientStatistic(
     StatisticPtr&& connect_stat, StatisticPtr&& response_stat,
@@ -105,21 +117,79 @@ BenchmarkClientHttpImpl::BenchmarkClientHttpImpl(
   statistic_.latency_5xx_statistic->setId("benchmark_http_client.latency_5xx");
   statistic_.latency_xxx_statistic->setId("benchmark_http_client.latency_xxx");
   statistic_.origin_latency_statistic->setId("benchmark_http_client.origin_latency_statistic");
+  if (statistic_.request_timeout_statistic != nullptr) {
+    statistic_.request_timeout_statistic->setId("benchmark_http_client.request_to_timeout");
+  }
+  if (statistic_.first_attempt_statistic != nullptr) {
+    statistic_.first_attempt_statistic->setId("benchmark_http_client.first_attempt_to_response");
+  }
+  if (statistic_.final_response_statistic != nullptr) {
+    statistic_.final_response_statistic->setId("benchmark_http_client.request_to_final_response");
+  }
+  if (statistic_.wire_latency_statistic != nullptr) {
+    statistic_.wire_latency_statistic->setId("benchmark_http_client.wire_latency");
+  }
+  if (statistic_.client_overhead_statistic != nullptr) {
+    statistic_.client_overhead_statistic->setId("benchmark_http_client.client_overhead");
+  }
+}
+
+void BenchmarkClientHttpImpl::setRequestTimeout(std::chrono::nanoseconds request_timeout) {
+  request_timeout_wheel_ =
+      request_timeout.count() > 0
+          ? std::make_unique<TimingWheel>(dispatcher_, api_.timeSource(), request_timeout)
+          : nullptr;
+}
+
+void BenchmarkClientHttpImpl::setRequestAttemptConfig(const RequestAttemptConfig& config) {
+  attempt_config_ = config;
+  if (attempt_config_.hedge_delay_percentile > 0) {
+    // Hedge delays are tracked with a millisecond resolution, and capped at a second. Requests
+    // slower than that are better served by a request timeout and retries.
+    hedge_wheel_ = std::make_unique<TimingWheel>(dispatcher_, api_.timeSource(), kMaxHedgeDelay,
+                                                 kMaxHedgeDelay / 1ms);
+    hedge_latency_window_ = std::make_unique<HdrStatistic>();
+  } else {
+    hedge_wheel_ = nullptr;
+    hedge_latency_window_ = nullptr;
+  }
+  hedge_delay_ = 0ns;
 }
 
 void BenchmarkClientHttpImpl::terminate() {
-  absl::optional<Envoy::Upstream::HttpPoolData> pool_data = pool();
-  if (pool_data.has_value() && pool_data.value().hasActiveConnections()) {
+  const uint64_t attempted_requests = benchmark_client_counters_.attempted_requests_.value();
+  if (attempted_requests > 0) {
+    ENVOY_LOG(info, "Extra load caused by hedging: {:.2f}%, by retries: {:.2f}%.",
+              100.0 * benchmark_client_counters_.hedged_attempts_.value() / attempted_requests,
+              100.0 * benchmark_client_counters_.retried_attempts_.value() / attempted_requests);
+  }
+  // When connections are spread over source addresses, each of those has its own pool to drain.
+  std::vector<Envoy::Upstream::HttpPoolData> active_pools;
+  const std::vector<std::string> cluster_names =
+      source_address_clusters_.empty() ? std::vector<std::string>{cluster_name_}
+                                       : source_address_clusters_;
+  for (const std::string& cluster_name : cluster_names) {
+    absl::optional<Envoy::Upstream::HttpPoolData> pool_data = pool(cluster_name);
+    if (pool_data.has_value() && pool_data.value().hasActiveConnections()) {
+      active_pools.push_back(pool_data.value());
+    }
+  }
+  if (!active_pools.empty()) {
     // We don't report what happens after this call in the output, but latencies may still be
     // reported via callbacks. This may happen after a long time (60s), which HdrHistogram can't
     // track the way we configure it today, as that exceeds the max that it can record.
     // No harm is done, but it does result in log lines warning about it. Avoid that, by
     // disabling latency measurement here.
     setShouldMeasureLatencies(false);
-    pool_data.value().addIdleCallback([this]() -> void {
-      drain_timer_->disableTimer();
-      dispatcher_.exit();
-    });
+    pools_to_drain_ = active_pools.size();
+    for (Envoy::Upstream::HttpPoolData& pool_data : active_pools) {
+      pool_data.addIdleCallback([this]() -> void {
+        if (--pools_to_drain_ == 0) {
+          drain_timer_->disableTimer();
+          dispatcher_.exit();
+        }
+      });
+    }
     // Set up a timer with a callback which caps the time we wait for the pool to drain.
     drain_timer_ = dispatcher_.createTimer([this]() -> void {
       ENVOY_LOG(info, "Wait for the connection pool drain timed out, proceeding to hard shutdown.");
@@ -145,10 +215,76 @@ StatisticPtrMap BenchmarkClientHttpImpl::statistics() const {
   statistics[statistic_.latency_5xx_statistic->id()] = statistic_.latency_5xx_statistic.get();
   statistics[statistic_.latency_xxx_statistic->id()] = statistic_.latency_xxx_statistic.get();
   statistics[statistic_.origin_latency_statistic->id()] = statistic_.origin_latency_statistic.get();
+  for (const RequestClassStatisticPtr& request_class_statistic :
+       statistic_.request_class_statistics) {
+    statistics[request_class_statistic->response_statistic->id()] =
+        request_class_statistic->response_statistic.get();
+    statistics[request_class_statistic->response_body_size_statistic->id()] =
+        request_class_statistic->response_body_size_statistic.get();
+  }
+  if (statistic_.request_timeout_statistic != nullptr) {
+    statistics[statistic_.request_timeout_statistic->id()] =
+        statistic_.request_timeout_statistic.get();
+  }
+  if (statistic_.first_attempt_statistic != nullptr) {
+    statistics[statistic_.first_attempt_statistic->id()] = statistic_.first_attempt_statistic.get();
+  }
+  if (statistic_.final_response_statistic != nullptr) {
+    statistics[statistic_.final_response_statistic->id()] =
+        statistic_.final_response_statistic.get();
+  }
+  if (statistic_.wire_latency_statistic != nullptr) {
+    statistics[statistic_.wire_latency_statistic->id()] = statistic_.wire_latency_statistic.get();
+    statistics[statistic_.client_overhead_statistic->id()] =
+        statistic_.client_overhead_statistic.get();
+  }
   return statistics;
 };
 
-bool BenchmarkClientHttpImpl::tryStartRequest(CompletionCallback caller_completion_callback) {
+std::vector<nighthawk::client::SlowRequest> BenchmarkClientHttpImpl::slowestRequests() const {
+  if (slowest_request_tracker_ == nullptr) {
+    return {};
+  }
+  return slowest_request_tracker_->slowestRequests();
+}
+
+// A request that may be sent in multiple attempts. Kept alive by the completion callbacks of its
+// attempts, and scheduled in the hedge wheel until its hedge delay expires.
+class BenchmarkClientHttpImpl::AttemptedRequest
+    : public TimingWheelEntry,
+      public std::enable_shared_from_this<BenchmarkClientHttpImpl::AttemptedRequest> {
+public:
+  struct Attempt {
+    // Set while the attempt is outstanding.
+    StreamDecoder* stream_decoder;
+    Envoy::MonotonicTime start;
+  };
+
+  AttemptedRequest(BenchmarkClientHttpImpl& client, RequestPtr request, uint64_t content_length,
+                   CompletionCallback caller_completion_callback,
+                   Envoy::MonotonicTime intended_start, Envoy::MonotonicTime start)
+      : client(client), request(std::move(request)), content_length(content_length),
+        caller_completion_callback(std::move(caller_completion_callback)),
+        intended_start(intended_start), start(start) {}
+
+  // TimingWheelEntry
+  void onExpired() override { client.onHedgeDelayExpired(shared_from_this()); }
+
+  BenchmarkClientHttpImpl& client;
+  const RequestPtr request;
+  const uint64_t content_length;
+  CompletionCallback caller_completion_callback;
+  const Envoy::MonotonicTime intended_start;
+  const Envoy::MonotonicTime start;
+  std::vector<Attempt> attempts;
+  uint32_t outstanding_attempts{};
+  uint32_t retries{};
+  absl::optional<size_t> hedge_attempt;
+  bool done{};
+};
+
+bool BenchmarkClientHttpImpl::tryStartRequest(CompletionCallback caller_completion_callback,
+                                              Envoy::MonotonicTime intended_start) {
   absl::optional<Envoy::Upstream::HttpPoolData> pool_data = pool();
   if (!pool_data.has_value()) {
     return false;
@@ -185,17 +321,181 @@ bool BenchmarkClientHttpImpl::tryStartRequest(CompletionCallback caller_completi
     }
   }
 
+  if (attempt_config_.enabled() && request->responseObserver() == nullptr) {
+    benchmark_client_counters_.attempted_requests_.inc();
+    auto attempted_request = std::make_shared<AttemptedRequest>(
+        *this, std::move(request), content_length, std::move(caller_completion_callback),
+        intended_start, api_.timeSource().monotonicTime());
+    // Arm the hedge delay first, as the first attempt may fail right away.
+    if (hedge_wheel_ != nullptr && hedge_delay_ > 0ns) {
+      hedge_wheel_->schedule(*attempted_request, hedge_delay_);
+    }
+    startAttempt(attempted_request, pool_data.value());
+    return true;
+  }
+
+  StreamDecoder* stream_decoder = createStreamDecoder(
+      *request, content_length, std::move(caller_completion_callback), intended_start);
+  stream_decoder->setResponseObserver(request->responseObserver());
+  startStream(pool_data.value(), *stream_decoder);
+  return true;
+}
+
+StreamDecoder*
+BenchmarkClientHttpImpl::createStreamDecoder(const Request& request, uint64_t content_length,
+                                             CompletionCallback completion_callback,
+                                             Envoy::MonotonicTime intended_start) {
   auto stream_decoder = new StreamDecoder(
-      dispatcher_, api_.timeSource(), *this, std::move(caller_completion_callback),
+      dispatcher_, api_.timeSource(), *this, std::move(completion_callback),
       *statistic_.connect_statistic, *statistic_.response_statistic,
       *statistic_.response_header_size_statistic, *statistic_.response_body_size_statistic,
-      *statistic_.origin_latency_statistic, request->header(), shouldMeasureLatencies(),
+      *statistic_.origin_latency_statistic, request.header(), shouldMeasureLatencies(),
       content_length, generator_, http_tracer_, latency_response_header_name_);
+  const uint32_t request_class = request.requestClass();
+  if (request_class < statistic_.request_class_statistics.size()) {
+    stream_decoder->setRequestClassStatistic(
+        statistic_.request_class_statistics[request_class].get());
+  }
+  if (statistic_.wire_latency_statistic != nullptr) {
+    stream_decoder->setWireLatencyStatistics(statistic_.wire_latency_statistic.get(),
+                                             statistic_.client_overhead_statistic.get());
+  }
+  if (request_event_log_ != nullptr) {
+    stream_decoder->setRequestEventLog(request_event_log_.get(),
+                                       request_event_log_->nextRequestId(), request_class,
+                                       intended_start);
+  }
+  stream_decoder->setSlowestRequestTracker(slowest_request_tracker_.get());
+  return stream_decoder;
+}
+
+void BenchmarkClientHttpImpl::startStream(Envoy::Upstream::HttpPoolData& pool_data,
+                                          StreamDecoder& stream_decoder) {
+  if (request_timeout_wheel_ != nullptr) {
+    request_timeout_wheel_->schedule(stream_decoder);
+  }
   requests_initiated_++;
-  pool_data.value().newStream(*stream_decoder, *stream_decoder,
-                              {/*can_send_early_data_=*/false,
-                               /*can_use_http3_=*/true});
-  return true;
+  next_source_address_cluster_++;
+  // The returned handle stays valid until the pool either fails the request, or hands it a stream.
+  stream_decoder.setPoolRequest(pool_data.newStream(stream_decoder, stream_decoder,
+                                                    {/*can_send_early_data_=*/false,
+                                                     /*can_use_http3_=*/true}));
+}
+
+void BenchmarkClientHttpImpl::startAttempt(const AttemptedRequestSharedPtr& attempted_request,
+                                           Envoy::Upstream::HttpPoolData& pool_data) {
+  const size_t attempt = attempted_request->attempts.size();
+  // Retries and hedges are due when they get started.
+  StreamDecoder* stream_decoder = createStreamDecoder(
+      *attempted_request->request, attempted_request->content_length,
+      [this, attempted_request, attempt](bool complete, bool success) {
+        onAttemptComplete(attempted_request, attempt, complete, success);
+      },
+      attempt == 0 ? attempted_request->intended_start : api_.timeSource().monotonicTime());
+  attempted_request->attempts.push_back({stream_decoder, api_.timeSource().monotonicTime()});
+  attempted_request->outstanding_attempts++;
+  startStream(pool_data, *stream_decoder);
+}
+
+void BenchmarkClientHttpImpl::onAttemptComplete(const AttemptedRequestSharedPtr& attempted_request,
+                                                size_t attempt, bool complete, bool success) {
+  AttemptedRequest& request = *attempted_request;
+  request.attempts[attempt].stream_decoder = nullptr;
+  request.outstanding_attempts--;
+  if (request.done) {
+    // Another attempt won, and this one got cancelled.
+    return;
+  }
+  if (success) {
+    const Envoy::MonotonicTime now = api_.timeSource().monotonicTime();
+    const AttemptedRequest::Attempt& first_attempt = request.attempts[0];
+    if (attempt == 0 && measure_latencies_ && statistic_.first_attempt_statistic != nullptr) {
+      statistic_.first_attempt_statistic->addValue((now - first_attempt.start).count());
+    }
+    // When a later attempt wins while the first one is still outstanding, the time elapsed so far
+    // is a lower bound for the latency of the first attempt. As that exceeds the hedge delay, it
+    // still suffices to estimate the percentiles below it.
+    if (hedge_latency_window_ != nullptr &&
+        (attempt == 0 || first_attempt.stream_decoder != nullptr)) {
+      trackHedgeDelay(now - first_attempt.start);
+    }
+    if (request.hedge_attempt == attempt) {
+      benchmark_client_counters_.hedge_wins_.inc();
+    }
+    if (measure_latencies_ && statistic_.final_response_statistic != nullptr) {
+      statistic_.final_response_statistic->addValue((now - request.start).count());
+    }
+    finishAttemptedRequest(request, complete, true);
+    return;
+  }
+  if (request.outstanding_attempts > 0) {
+    // Another attempt may still succeed.
+    return;
+  }
+  if (request.retries < attempt_config_.max_retries) {
+    if (!retryBudgetAllowsRetry()) {
+      benchmark_client_counters_.retry_budget_exhausted_.inc();
+    } else {
+      absl::optional<Envoy::Upstream::HttpPoolData> pool_data = pool();
+      if (pool_data.has_value()) {
+        if (request.retries++ == 0) {
+          benchmark_client_counters_.retried_requests_.inc();
+        }
+        benchmark_client_counters_.retried_attempts_.inc();
+        startAttempt(attempted_request, pool_data.value());
+        return;
+      }
+    }
+  }
+  finishAttemptedRequest(request, complete, false);
+}
+
+void BenchmarkClientHttpImpl::onHedgeDelayExpired(
+    const AttemptedRequestSharedPtr& attempted_request) {
+  absl::optional<Envoy::Upstream::HttpPoolData> pool_data = pool();
+  if (attempted_request->done || !pool_data.has_value()) {
+    return;
+  }
+  attempted_request->hedge_attempt = attempted_request->attempts.size();
+  benchmark_client_counters_.hedged_attempts_.inc();
+  benchmark_client_counters_.hedged_requests_.inc();
+  startAttempt(attempted_request, pool_data.value());
+}
+
+void BenchmarkClientHttpImpl::finishAttemptedRequest(AttemptedRequest& attempted_request,
+                                                     bool complete, bool success) {
+  attempted_request.done = true;
+  attempted_request.unschedule();
+  // Cancelling completes the attempts synchronously, which clears them from the list.
+  for (size_t i = 0; i < attempted_request.attempts.size(); i++) {
+    if (attempted_request.attempts[i].stream_decoder != nullptr) {
+      attempted_request.attempts[i].stream_decoder->cancel();
+    }
+  }
+  attempted_request.caller_completion_callback(complete, success);
+}
+
+bool BenchmarkClientHttpImpl::retryBudgetAllowsRetry() const {
+  return (benchmark_client_counters_.retried_attempts_.value() + 1) * 100.0 <=
+         attempt_config_.retry_budget_percent *
+             benchmark_client_counters_.attempted_requests_.value();
+}
+
+void BenchmarkClientHttpImpl::trackHedgeDelay(std::chrono::nanoseconds first_attempt_latency) {
+  // The hedge delay follows the latency distribution, by recomputing it from fixed size windows.
+  // Until the first window filled, the delay stays zero and no hedge attempts are issued.
+  static constexpr uint64_t kHedgeDelayWindowSize = 1000;
+  hedge_latency_window_->addValue(first_attempt_latency.count());
+  if (hedge_latency_window_->count() >= kHedgeDelayWindowSize) {
+    hedge_delay_ = std::chrono::nanoseconds(
+        hedge_latency_window_->percentile(attempt_config_.hedge_delay_percentile));
+    hedge_latency_window_->reset();
+    if (hedge_delay_ > kMaxHedgeDelay) {
+      ENVOY_LOG_EVERY_POW_2(warn, "Capping the hedge delay of {}ns to {}ns.", hedge_delay_.count(),
+                            std::chrono::nanoseconds(kMaxHedgeDelay).count());
+      hedge_delay_ = kMaxHedgeDelay;
+    }
+  }
 }
 
 void BenchmarkClientHttpImpl::onComplete(bool success,
@@ -239,6 +539,20 @@ void BenchmarkClientHttpImpl::onPoolFailure(Envoy::Http::ConnectionPool::PoolFai
   }
 }
 
+void BenchmarkClientHttpImpl::onRequestTimeout(const uint64_t time_to_timeout_ns) {
+  // Abandoning the request frees up its slot, just like a completion would.
+  requests_completed_++;
+  benchmark_client_counters_.request_timeouts_.inc();
+  if (statistic_.request_timeout_statistic != nullptr && measure_latencies_) {
+    statistic_.request_timeout_statistic->addValue(time_to_timeout_ns);
+  }
+}
+
+void BenchmarkClientHttpImpl::onRequestCancelled() {
+  requests_completed_++;
+  benchmark_client_counters_.cancelled_attempts_.inc();
+}
+
 void BenchmarkClientHttpImpl::exportLatency(const uint32_t response_code,
                                             const uint64_t latency_ns) {
   if (response_code > 99 && response_code <= 199) {
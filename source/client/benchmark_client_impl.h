@@ -24,6 +24,7 @@
 
 #include "source/client/stream_decoder.h"
 #include "source/common/statistic_impl.h"
+#include "source/common/timing_wheel.h"
 
 namespace Nighthawk {
 namespace Client {
@@ -32,6 +33,7 @@ using namespace std::chrono_literals;
 
 #define ALL_BENCHMARK_CLIENT_COUNTERS(COUNTER)                                                     \
   COUNTER(stream_resets)                                                                           \
+  COUNTER(request_timeouts)                                                                        \
   COUNTER(http_1xx)                                                                                \
   COUNTER(http_2xx)                                                                                \
   COUNTER(http_3xx)                                                                                \
@@ -39,7 +41,15 @@ using namespace std::chrono_literals;
   COUNTER(http_5xx)                                                                                \
   COUNTER(http_xxx)                                                                                \
   COUNTER(pool_overflow)                                                                           \
-  COUNTER(pool_connection_failure)
+  COUNTER(pool_connection_failure)                                                                 \
+  COUNTER(attempted_requests)                                                                      \
+  COUNTER(hedged_attempts)                                                                         \
+  COUNTER(hedged_requests)                                                                         \
+  COUNTER(hedge_wins)                                                                              \
+  COUNTER(retried_attempts)                                                                        \
+  COUNTER(retried_requests)                                                                        \
+  COUNTER(retry_budget_exhausted)                                                                  \
+  COUNTER(cancelled_attempts)
 
 // For counter metrics, Nighthawk use Envoy Counter directly. For histogram metrics, Nighthawk uses
 // its own Statistic instead of Envoy Histogram. Here BenchmarkClientCounters contains only counters
@@ -72,6 +82,45 @@ struct BenchmarkClientStatistic {
   StatisticPtr latency_5xx_statistic;
   StatisticPtr latency_xxx_statistic;
   StatisticPtr origin_latency_statistic;
+  // Statistics per request class, indexed by Request::requestClass(). Empty when the request
+  // source doesn't classify its requests.
+  std::vector<RequestClassStatisticPtr> request_class_statistics;
+  // Tracks the time from issuing a request until abandoning it because it timed out. Only set when
+  // a request timeout is configured.
+  StatisticPtr request_timeout_statistic;
+  // Track the latency of the first attempt of a request, and the time from issuing a request until
+  // the first successful response to any of its attempts. Only set when hedging or retries are
+  // configured.
+  StatisticPtr first_attempt_statistic;
+  StatisticPtr final_response_statistic;
+  // Track the latency between the request leaving and the response arriving at the socket, as
+  // timestamped by the kernel, and the remainder of the latency up to the response headers. Only
+  // set when socket timestamping is enabled.
+  StatisticPtr wire_latency_statistic;
+  StatisticPtr client_overhead_statistic;
+};
+
+/**
+ * Configures sending requests in multiple attempts. Hedging issues one additional attempt for a
+ * request that didn't complete within a percentile of the recently observed latencies, retrying
+ * issues a new attempt after all attempts of a request failed. The first successful attempt wins,
+ * and the remaining ones are cancelled.
+ */
+struct RequestAttemptConfig {
+  // Percentile of the recent attempt latencies after which a hedge attempt is issued. Zero disables
+  // hedging. The hedge delay is computed from windows of 1000 first attempt latencies, so no hedge
+  // attempts are issued until the first window filled. It is capped at a second.
+  double hedge_delay_percentile{};
+  // The maximum number of retries per request. Zero disables retries.
+  uint32_t max_retries{};
+  // Retries are only issued while the number of retried attempts stays within this percentage of
+  // the number of requests.
+  double retry_budget_percent{20};
+
+  /**
+   * @return bool true iff requests may be sent in more than one attempt.
+   */
+  bool enabled() const { return hedge_delay_percentile > 0 || max_retries > 0; }
 };
 
 class Http1PoolImpl : public Envoy::Http::FixedHttpConnPoolImpl {
@@ -119,6 +168,36 @@ public:
   void setMaxRequestsPerConnection(uint32_t max_requests_per_connection) {
     max_requests_per_connection_ = max_requests_per_connection;
   }
+  /**
+   * @param request_timeout requests that didn't complete within this time after being issued will
+   * be abandoned. Zero disables request timeouts.
+   */
+  void setRequestTimeout(std::chrono::nanoseconds request_timeout);
+  /**
+   * @param config configures hedging and retrying requests. Requests are sent in a single attempt
+   * by default.
+   */
+  void setRequestAttemptConfig(const RequestAttemptConfig& config);
+  /**
+   * @param cluster_names clusters which bind their connections to one of the source addresses of
+   * the worker. When set, requests are spread over these clusters round robin, instead of being
+   * sent via the cluster passed at construction.
+   */
+  void setSourceAddressClusters(std::vector<std::string> cluster_names) {
+    source_address_clusters_ = std::move(cluster_names);
+  }
+  /**
+   * @param request_event_log log which gets a record of every request. May be nullptr.
+   */
+  void setRequestEventLog(RequestEventLogPtr request_event_log) {
+    request_event_log_ = std::move(request_event_log);
+  }
+  /**
+   * @param slowest_request_tracker retains the details of the slowest requests. May be nullptr.
+   */
+  void setSlowestRequestTracker(SlowestRequestTrackerPtr slowest_request_tracker) {
+    slowest_request_tracker_ = std::move(slowest_request_tracker);
+  }
 
   // BenchmarkClient
   void terminate() override;
@@ -127,28 +206,56 @@ public:
   void setShouldMeasureLatencies(bool measure_latencies) override {
     measure_latencies_ = measure_latencies;
   }
-  bool tryStartRequest(CompletionCallback caller_completion_callback) override;
+  bool tryStartRequest(CompletionCallback caller_completion_callback,
+                       Envoy::MonotonicTime intended_start) override;
   Envoy::Stats::Scope& scope() const override { return *scope_; }
+  std::vector<nighthawk::client::SlowRequest> slowestRequests() const override;
 
   // StreamDecoderCompletionCallback
   void onComplete(bool success, const Envoy::Http::ResponseHeaderMap& headers) override;
   void onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason reason) override;
   void exportLatency(const uint32_t response_code, const uint64_t latency_ns) override;
+  void onRequestTimeout(const uint64_t time_to_timeout_ns) override;
+  void onRequestCancelled() override;
 
   // Helpers
   absl::optional<::Envoy::Upstream::HttpPoolData> pool() {
-    const auto thread_local_cluster = cluster_manager_->getThreadLocalCluster(cluster_name_);
+    if (source_address_clusters_.empty()) {
+      return pool(cluster_name_);
+    }
+    // Only moves on to the next source address once a request got dispatched to this one.
+    const std::string& cluster_name =
+        source_address_clusters_[next_source_address_cluster_ % source_address_clusters_.size()];
+    return pool(cluster_name);
+  }
+  absl::optional<::Envoy::Upstream::HttpPoolData> pool(absl::string_view cluster_name) {
+    const auto thread_local_cluster = cluster_manager_->getThreadLocalCluster(cluster_name);
     return thread_local_cluster->httpConnPool(Envoy::Upstream::ResourcePriority::Default, protocol_,
                                               nullptr);
   }
 
 private:
+  class AttemptedRequest;
+  using AttemptedRequestSharedPtr = std::shared_ptr<AttemptedRequest>;
+
+  StreamDecoder* createStreamDecoder(const Request& request, uint64_t content_length,
+                                     CompletionCallback completion_callback,
+                                     Envoy::MonotonicTime intended_start);
+  void startStream(Envoy::Upstream::HttpPoolData& pool_data, StreamDecoder& stream_decoder);
+  void startAttempt(const AttemptedRequestSharedPtr& attempted_request,
+                    Envoy::Upstream::HttpPoolData& pool_data);
+  void onAttemptComplete(const AttemptedRequestSharedPtr& attempted_request, size_t attempt,
+                         bool complete, bool success);
+  void onHedgeDelayExpired(const AttemptedRequestSharedPtr& attempted_request);
+  void finishAttemptedRequest(AttemptedRequest& attempted_request, bool complete, bool success);
+  bool retryBudgetAllowsRetry() const;
+  void trackHedgeDelay(std::chrono::nanoseconds first_attempt_latency);
+
   Envoy::Api::Api& api_;
   Envoy::Event::Dispatcher& dispatcher_;
   Envoy::Stats::ScopeSharedPtr scope_;
   BenchmarkClientStatistic statistic_;
   const Envoy::Http::Protocol protocol_;
-  std::chrono::seconds timeout_{5s};
   uint32_t connection_limit_{1};
   uint32_t max_pending_requests_{1};
   uint32_t max_active_requests_{UINT32_MAX};
@@ -162,10 +269,26 @@ private:
   Envoy::Upstream::ClusterManagerPtr& cluster_manager_;
   Envoy::Tracing::HttpTracerSharedPtr& http_tracer_;
   std::string cluster_name_;
+  // Clusters bound to the source addresses of the worker, and the one to send the next request to.
+  std::vector<std::string> source_address_clusters_;
+  uint64_t next_source_address_cluster_{};
   const RequestGenerator request_generator_;
   const bool provide_resource_backpressure_;
   const std::string latency_response_header_name_;
   Envoy::Event::TimerPtr drain_timer_;
+  size_t pools_to_drain_{};
+  // Enforces the request timeout for all requests in flight, using a single timer.
+  std::unique_ptr<TimingWheel> request_timeout_wheel_;
+  RequestAttemptConfig attempt_config_;
+  // Issues hedge attempts, once the hedge delay of a request expired. Only set when hedging.
+  std::unique_ptr<TimingWheel> hedge_wheel_;
+  // Collects the latencies of first attempts, from which the hedge delay is computed periodically.
+  std::unique_ptr<HdrStatistic> hedge_latency_window_;
+  // Zero until the first window of latencies filled, in which case no hedge attempts are issued.
+  // Capped at the timeout of the hedge wheel.
+  std::chrono::nanoseconds hedge_delay_{};
+  RequestEventLogPtr request_event_log_;
+  SlowestRequestTrackerPtr slowest_request_tracker_;
 };
 
 } // namespace Client
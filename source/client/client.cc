@@ -26,6 +26,7 @@
 #include "source/client/factories_impl.h"
 #include "source/client/options_impl.h"
 #include "source/client/output_collector_impl.h"
+#include "source/client/overhead_calibration.h"
 #include "source/client/process_impl.h"
 #include "source/client/remote_process_impl.h"
 #include "source/common/frequency.h"
@@ -54,6 +55,7 @@ bool Main::run() {
       spdlog::level::from_str(lower), "[%T.%f][%t][%L] %v", log_lock, false);
   Envoy::Event::RealTimeSystem time_system; // NO_CHECK_FORMAT(real_time)
   ProcessPtr process;
+  absl::optional<nighthawk::client::Result> calibration;
   std::unique_ptr<nighthawk::client::NighthawkService::Stub> stub;
   std::shared_ptr<grpc::Channel> channel;
 
@@ -75,8 +77,21 @@ bool Main::run() {
     envoy::config::core::v3::TypedExtensionConfig typed_dns_resolver_config;
     Envoy::Network::DnsResolverFactory& dns_resolver_factory =
         Envoy::Network::createDefaultDnsResolverFactory(typed_dns_resolver_config);
+    auto process_wide = std::make_shared<Envoy::ProcessWide>();
+    if (options_->calibrateOverhead()) {
+      absl::StatusOr<nighthawk::client::Result> calibration_or_status =
+          OverheadCalibration::calibrate(*options_, dns_resolver_factory,
+                                         typed_dns_resolver_config, time_system, process_wide);
+      if (!calibration_or_status.ok()) {
+        ENVOY_LOG(error, "Overhead calibration failed: {}",
+                  calibration_or_status.status().ToString());
+        return false;
+      }
+      calibration = std::move(*calibration_or_status);
+    }
     absl::StatusOr<ProcessPtr> process_or_status = ProcessImpl::CreateProcessImpl(
-        *options_, dns_resolver_factory, std::move(typed_dns_resolver_config), time_system);
+        *options_, dns_resolver_factory, std::move(typed_dns_resolver_config), time_system,
+        process_wide);
     if (!process_or_status.ok()) {
       ENVOY_LOG(error, "Unable to create ProcessImpl: {}", process_or_status.status().ToString());
       return false;
@@ -91,6 +106,12 @@ bool Main::run() {
         std::make_unique<SignalHandler>([&process]() { process->requestExecutionCancellation(); });
     result = process->run(output_collector);
   }
+  if (calibration.has_value()) {
+    nighthawk::client::Output output = output_collector.toProto();
+    OverheadCalibration::compareWithBenchmark(output, calibration.value());
+    *output.add_results() = calibration.value();
+    output_collector.setOutput(output);
+  }
   auto formatter = output_formatter_factory.create(options_->outputFormat());
   absl::StatusOr<std::string> formatted_proto = formatter->formatProto(output_collector.toProto());
   if (!formatted_proto.ok()) {
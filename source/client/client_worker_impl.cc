@@ -1,12 +1,21 @@
 #include "source/client/client_worker_impl.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "external/envoy/source/common/memory/stats.h"
 #include "external/envoy/source/common/stats/symbol_table.h"
 
+#include "source/client/source_address_utility.h"
 #include "source/common/cached_time_source_impl.h"
+#include "source/common/perf_event_counters.h"
 #include "source/common/phase_impl.h"
 #include "source/common/termination_predicate_impl.h"
 #include "source/common/utility.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -21,16 +30,17 @@ ClientWorkerImpl::ClientWorkerImpl(Envoy::Api::Api& api, Envoy::ThreadLocal::Ins
                                    Envoy::Stats::Store& store, const int worker_number,
                                    const Envoy::MonotonicTime starting_time,
                                    Envoy::Tracing::HttpTracerSharedPtr& http_tracer,
-                                   const HardCodedWarmupStyle hardcoded_warmup_style)
+                                   const HardCodedWarmupStyle hardcoded_warmup_style,
+                                   const bool collect_perf_counters,
+                                   std::vector<PhaseObserver*> phase_observers,
+                                   const std::vector<std::string>& source_addresses)
     : WorkerImpl(api, tls, store),
       time_source_(std::make_unique<CachedTimeSourceImpl>(*dispatcher_)),
       termination_predicate_factory_(termination_predicate_factory),
       sequencer_factory_(sequencer_factory), worker_scope_(store_.createScope("cluster.")),
       worker_number_scope_(worker_scope_->createScope(fmt::format("{}.", worker_number))),
       worker_number_(worker_number), http_tracer_(http_tracer),
-      request_generator_(
-          request_generator_factory.create(cluster_manager, *dispatcher_, *worker_number_scope_,
-                                           fmt::format("{}.requestsource", worker_number))),
+      request_generator_(createRequestSource(request_generator_factory, cluster_manager)),
       benchmark_client_(benchmark_client_factory.create(
           api, *dispatcher_, *worker_number_scope_, cluster_manager, http_tracer_,
           fmt::format("{}", worker_number), worker_number, *request_generator_)),
@@ -38,18 +48,63 @@ ClientWorkerImpl::ClientWorkerImpl(Envoy::Api::Api& api, Envoy::ThreadLocal::Ins
           std::make_unique<PhaseImpl>("main",
                                       sequencer_factory_.create(
                                           *time_source_, *dispatcher_,
-                                          [this](CompletionCallback f) -> bool {
-                                            return benchmark_client_->tryStartRequest(std::move(f));
+                                          [this](CompletionCallback f,
+                                                 Envoy::MonotonicTime due) -> bool {
+                                            return benchmark_client_->tryStartRequest(std::move(f),
+                                                                                      due);
                                           },
                                           termination_predicate_factory_.create(
                                               *time_source_, *worker_number_scope_, starting_time),
                                           *worker_number_scope_, starting_time),
                                       true)),
-      hardcoded_warmup_style_(hardcoded_warmup_style) {}
+      hardcoded_warmup_style_(hardcoded_warmup_style),
+      collect_perf_counters_(collect_perf_counters),
+      phase_observers_(std::move(phase_observers)) {
+  // The stats store hands out the same counter instance for a given name, so the counters we
+  // resolve here are the ones the benchmark client, sequencer and cluster increment.
+  for (size_t i = 0; i < counters_.size(); i++) {
+    counters_[i] = &worker_number_scope_->counterFromString(std::string(workerCounterName(i)));
+  }
+  active_connection_gauges_.push_back(&worker_number_scope_->gaugeFromString(
+      "upstream_cx_active", Envoy::Stats::Gauge::ImportMode::Accumulate));
+  // Connections bound to source addresses go through per source address clusters, which report
+  // their stats as "cluster.<worker>.source.<address>.<stat>". Those add to the totals of the
+  // worker. Only the cluster stats exist there.
+  for (const std::string& address : source_addresses) {
+    const std::string stat_name = SourceAddressUtility::statName(worker_number, address);
+    active_connection_gauges_.push_back(
+        &worker_scope_->gaugeFromString(absl::StrCat(stat_name, ".upstream_cx_active"),
+                                        Envoy::Stats::Gauge::ImportMode::Accumulate));
+    for (size_t i = 0; i < counters_.size(); i++) {
+      const absl::string_view counter_name = workerCounterName(i);
+      if (absl::StartsWith(counter_name, "upstream_")) {
+        source_address_counters_.emplace_back(
+            i, &worker_scope_->counterFromString(absl::StrCat(stat_name, ".", counter_name)));
+      }
+    }
+  }
+}
+
+RequestSourcePtr
+ClientWorkerImpl::createRequestSource(const RequestSourceFactory& request_generator_factory,
+                                      Envoy::Upstream::ClusterManagerPtr& cluster_manager) {
+  // The allocator counts the live allocations of the whole process. The workers are created one
+  // after the other on the main thread, so what gets allocated while creating the request source
+  // is what it holds on to. Zero when the allocator doesn't report its statistics.
+  const uint64_t allocated_before = Envoy::Memory::Stats::totalCurrentlyAllocated();
+  RequestSourcePtr request_source =
+      request_generator_factory.create(cluster_manager, *dispatcher_, *worker_number_scope_,
+                                       fmt::format("{}.requestsource", worker_number_));
+  const uint64_t allocated_after = Envoy::Memory::Stats::totalCurrentlyAllocated();
+  request_source_memory_bytes_ =
+      allocated_after > allocated_before ? allocated_after - allocated_before : 0;
+  return request_source;
+}
 
 void ClientWorkerImpl::simpleWarmup() {
   ENVOY_LOG(debug, "> worker {}: warmup start.", worker_number_);
-  if (benchmark_client_->tryStartRequest([this](bool, bool) { dispatcher_->exit(); })) {
+  if (benchmark_client_->tryStartRequest([this](bool, bool) { dispatcher_->exit(); },
+                                         time_source_->monotonicTime())) {
     dispatcher_->run(Envoy::Event::Dispatcher::RunType::RunUntilExit);
   } else {
     ENVOY_LOG(warn, "> worker {}: failed to initiate warmup request.", worker_number_);
@@ -64,20 +119,40 @@ void ClientWorkerImpl::work() {
     simpleWarmup();
   }
   benchmark_client_->setShouldMeasureLatencies(phase_->shouldMeasureLatencies());
+  // The counters only count the thread which opens them, so that has to happen here.
+  std::unique_ptr<PerfEventCounters> perf_event_counters;
+  if (collect_perf_counters_) {
+    perf_event_counters = std::make_unique<PerfEventCounters>();
+    if (!perf_event_counters->available()) {
+      ENVOY_LOG(warn, "> worker {}: perf events are not available.", worker_number_);
+    }
+    perf_event_counters->start();
+  }
+  for (PhaseObserver* phase_observer : phase_observers_) {
+    phase_observer->onPhaseStarted();
+  }
   phase_->run();
+  for (PhaseObserver* phase_observer : phase_observers_) {
+    phase_observer->onPhaseCompleted();
+  }
+  if (perf_event_counters != nullptr) {
+    perf_event_counters->stop();
+    perf_counter_values_ = perf_event_counters->values();
+  }
+  reportRequestClassMix();
 
   // Save a final snapshot of the worker-specific counter accumulations before
   // we exit the thread.
-  for (const auto& stat : store_.counters()) {
-    // First, we strip the cluster prefix
-    std::string stat_name = std::string(absl::StripPrefix(stat->name(), "cluster."));
-    stat_name = std::string(absl::StripPrefix(stat_name, "worker."));
-    // Second, we strip our own prefix if it's there, else we skip.
-    const std::string worker_prefix = fmt::format("{}.", worker_number_);
-    if (stat->value() && absl::StartsWith(stat_name, worker_prefix)) {
-      threadLocalCounterValues_[std::string(absl::StripPrefix(stat_name, worker_prefix))] =
-          stat->value();
-    }
+  for (size_t i = 0; i < counters_.size(); i++) {
+    counter_values_[i] = counters_[i]->value();
+  }
+  for (const auto& [index, counter] : source_address_counters_) {
+    counter_values_[index] += counter->value();
+  }
+  // The connections are kept until shutdownThread(), so with prefetching and without connection
+  // churn this is the most the worker held open at any one time.
+  for (const Envoy::Stats::Gauge* gauge : active_connection_gauges_) {
+    open_connections_ += gauge->value();
   }
   // Note that benchmark_client_ is not terminated here, but in shutdownThread() below. This is to
   // to prevent the shutdown artifacts from influencing the test result counters. The main thread
@@ -85,6 +160,23 @@ void ClientWorkerImpl::work() {
   // should be consistent.
 }
 
+void ClientWorkerImpl::reportRequestClassMix() {
+  const std::vector<RequestClassMix> mix = request_generator_->requestClassMix();
+  const std::vector<std::string> names = request_generator_->requestClassNames();
+  uint64_t total = 0;
+  for (const RequestClassMix& request_class_mix : mix) {
+    total += request_class_mix.yielded;
+  }
+  // The target is expressed as a number of requests rather than as a share, so that it adds up
+  // over the workers like the achieved number does.
+  for (size_t i = 0; i < std::min(mix.size(), names.size()); i++) {
+    const std::string prefix = absl::StrCat("benchmark.class.", names[i], ".");
+    worker_number_scope_->counterFromString(absl::StrCat(prefix, "requests")).add(mix[i].yielded);
+    worker_number_scope_->counterFromString(absl::StrCat(prefix, "target_requests"))
+        .add(std::llround(total * mix[i].target_share));
+  }
+}
+
 void ClientWorkerImpl::shutdownThread() {
   benchmark_client_->terminate();
   request_generator_->destroyOnThread();
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "envoy/api/api.h"
@@ -11,6 +15,7 @@
 #include "nighthawk/client/benchmark_client.h"
 #include "nighthawk/client/client_worker.h"
 #include "nighthawk/client/factories.h"
+#include "nighthawk/client/phase_observer.h"
 #include "nighthawk/common/factories.h"
 #include "nighthawk/common/phase.h"
 #include "nighthawk/common/request_source.h"
@@ -35,12 +40,22 @@ public:
                    Envoy::Stats::Store& store, const int worker_number,
                    const Envoy::MonotonicTime starting_time,
                    Envoy::Tracing::HttpTracerSharedPtr& http_tracer,
-                   const HardCodedWarmupStyle hardcoded_warmup_style);
+                   const HardCodedWarmupStyle hardcoded_warmup_style,
+                   const bool collect_perf_counters,
+                   std::vector<PhaseObserver*> phase_observers,
+                   const std::vector<std::string>& source_addresses = {});
   StatisticPtrMap statistics() const override;
 
-  const std::map<std::string, uint64_t>& threadLocalCounterValues() override {
-    return threadLocalCounterValues_;
+  const WorkerCounterValues& counterValues() const override { return counter_values_; }
+  const WorkerCounterBlock& counterBlock() const override { return counters_; }
+  std::vector<nighthawk::client::SlowRequest> slowestRequests() const override {
+    return benchmark_client_->slowestRequests();
   }
+  const std::map<std::string, uint64_t>& perfCounterValues() const override {
+    return perf_counter_values_;
+  }
+  uint64_t requestSourceMemoryBytes() const override { return request_source_memory_bytes_; }
+  uint64_t openConnections() const override { return open_connections_; }
 
   const Phase& phase() const override { return *phase_; }
 
@@ -52,7 +67,14 @@ protected:
   void work() override;
 
 private:
+  RequestSourcePtr createRequestSource(const RequestSourceFactory& request_generator_factory,
+                                       Envoy::Upstream::ClusterManagerPtr& cluster_manager);
   void simpleWarmup();
+  /**
+   * Reports the mix of request classes which the request source yielded, and the mix it aimed for,
+   * as the "requests" and "target_requests" counters of each class.
+   */
+  void reportRequestClassMix();
 
   std::unique_ptr<Envoy::TimeSource> time_source_;
   const TerminationPredicateFactory& termination_predicate_factory_;
@@ -61,12 +83,26 @@ private:
   Envoy::Stats::ScopeSharedPtr worker_number_scope_;
   const int worker_number_;
   Envoy::Tracing::HttpTracerSharedPtr& http_tracer_;
+  // Set while creating request_generator_, so it has to be declared before it.
+  uint64_t request_source_memory_bytes_{0};
   RequestSourcePtr request_generator_;
   BenchmarkClientPtr benchmark_client_;
   PhasePtr phase_;
   Envoy::LocalInfo::LocalInfoPtr local_info_;
-  std::map<std::string, uint64_t> threadLocalCounterValues_;
+  // Counters of the worker's typed counter block, resolved by name once at construction.
+  WorkerCounterBlock counters_;
+  WorkerCounterValues counter_values_{};
+  // Counters of the clusters bound to the source addresses of the worker, each with the index of
+  // the worker counter it adds to. Resolved by name once at construction.
+  std::vector<std::pair<size_t, Envoy::Stats::Counter*>> source_address_counters_;
+  // The upstream_cx_active gauges of the cluster of the worker and of the clusters bound to its
+  // source addresses. Resolved by name once at construction.
+  std::vector<Envoy::Stats::Gauge*> active_connection_gauges_;
+  uint64_t open_connections_{0};
   const HardCodedWarmupStyle hardcoded_warmup_style_;
+  const bool collect_perf_counters_;
+  const std::vector<PhaseObserver*> phase_observers_;
+  std::map<std::string, uint64_t> perf_counter_values_;
 };
 
 using ClientWorkerImplPtr = std::unique_ptr<ClientWorkerImpl>;
@@ -7,6 +7,9 @@
 #include "source/client/benchmark_client_impl.h"
 #include "source/client/output_collector_impl.h"
 #include "source/client/output_formatter_impl.h"
+#include "source/client/request_event_log.h"
+#include "source/client/slowest_request_tracker.h"
+#include "source/client/source_address_utility.h"
 #include "source/common/platform_util_impl.h"
 #include "source/common/rate_limiter_impl.h"
 #include "source/common/request_source_impl.h"
@@ -24,8 +27,10 @@ namespace Client {
 
 OptionBasedFactoryImpl::OptionBasedFactoryImpl(const Options& options) : options_(options) {}
 
-BenchmarkClientFactoryImpl::BenchmarkClientFactoryImpl(const Options& options)
-    : OptionBasedFactoryImpl(options) {}
+BenchmarkClientFactoryImpl::BenchmarkClientFactoryImpl(const Options& options,
+                                                       uint32_t number_of_workers)
+    : OptionBasedFactoryImpl(options), number_of_workers_(number_of_workers),
+      source_addresses_(SourceAddressUtility::expandSourceAddresses(options.sourceAddresses())) {}
 
 BenchmarkClientPtr BenchmarkClientFactoryImpl::create(
     Envoy::Api::Api& api, Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
@@ -49,6 +54,27 @@ BenchmarkClientPtr BenchmarkClientFactoryImpl::create(
                                      std::make_unique<SinkableHdrStatistic>(scope, worker_id),
                                      std::make_unique<SinkableHdrStatistic>(scope, worker_id),
                                      std::make_unique<SinkableHdrStatistic>(scope, worker_id));
+  for (const std::string& request_class_name : request_generator.requestClassNames()) {
+    statistic.request_class_statistics.push_back(std::make_unique<RequestClassStatistic>(
+        scope, request_class_name, statistic_factory.create(),
+        std::make_unique<StreamingStatistic>()));
+  }
+  const std::chrono::nanoseconds request_timeout = options_.requestTimeout();
+  if (request_timeout.count() > 0) {
+    statistic.request_timeout_statistic = statistic_factory.create();
+  }
+  RequestAttemptConfig attempt_config;
+  attempt_config.hedge_delay_percentile = options_.hedgeDelayPercentile();
+  attempt_config.max_retries = options_.maxRetries();
+  attempt_config.retry_budget_percent = options_.retryBudgetPercent();
+  if (attempt_config.enabled()) {
+    statistic.first_attempt_statistic = statistic_factory.create();
+    statistic.final_response_statistic = statistic_factory.create();
+  }
+  if (options_.socketTimestamping()) {
+    statistic.wire_latency_statistic = statistic_factory.create();
+    statistic.client_overhead_statistic = statistic_factory.create();
+  }
   auto benchmark_client = std::make_unique<BenchmarkClientHttpImpl>(
       api, dispatcher, scope, statistic, options_.protocol(), cluster_manager, http_tracer,
       cluster_name, request_generator.get(), !options_.openLoop(),
@@ -58,9 +84,36 @@ BenchmarkClientPtr BenchmarkClientFactoryImpl::create(
   benchmark_client->setMaxPendingRequests(options_.maxPendingRequests());
   benchmark_client->setMaxActiveRequests(options_.maxActiveRequests());
   benchmark_client->setMaxRequestsPerConnection(options_.maxRequestsPerConnection());
+  benchmark_client->setRequestTimeout(request_timeout);
+  benchmark_client->setRequestAttemptConfig(attempt_config);
+  // The bootstrap holds a cluster for each source address of the worker, named by index.
+  const std::vector<std::string> source_addresses = sourceAddressesForWorker(worker_id);
+  if (!source_addresses.empty()) {
+    std::vector<std::string> source_address_clusters;
+    for (size_t i = 0; i < source_addresses.size(); i++) {
+      source_address_clusters.push_back(SourceAddressUtility::clusterName(worker_id, i));
+    }
+    benchmark_client->setSourceAddressClusters(std::move(source_address_clusters));
+  }
+  const std::string request_event_log = options_.requestEventLog();
+  if (!request_event_log.empty()) {
+    benchmark_client->setRequestEventLog(std::make_unique<RequestEventLog>(
+        fmt::format("{}.worker_{}", request_event_log, worker_id),
+        options_.requestEventLogCapacity(), worker_id));
+  }
+  const uint32_t slowest_requests = options_.slowestRequests();
+  if (slowest_requests > 0) {
+    benchmark_client->setSlowestRequestTracker(std::make_unique<SlowestRequestTracker>(
+        slowest_requests, worker_id, options_.slowestRequestsHeaders()));
+  }
   return benchmark_client;
 }
 
+std::vector<std::string> BenchmarkClientFactoryImpl::sourceAddressesForWorker(int worker_id) const {
+  return SourceAddressUtility::sourceAddressesForWorker(source_addresses_, worker_id,
+                                                        number_of_workers_);
+}
+
 SequencerFactoryImpl::SequencerFactoryImpl(const Options& options)
     : OptionBasedFactoryImpl(options) {}
 
@@ -29,13 +29,30 @@ protected:
 
 class BenchmarkClientFactoryImpl : public OptionBasedFactoryImpl, public BenchmarkClientFactory {
 public:
-  BenchmarkClientFactoryImpl(const Options& options);
+  /**
+   * @param options the options to configure benchmark clients with.
+   * @param number_of_workers the number of workers, used to determine which source addresses each
+   * worker binds its connections to.
+   */
+  BenchmarkClientFactoryImpl(const Options& options, uint32_t number_of_workers = 1);
   BenchmarkClientPtr create(Envoy::Api::Api& api, Envoy::Event::Dispatcher& dispatcher,
                             Envoy::Stats::Scope& scope,
                             Envoy::Upstream::ClusterManagerPtr& cluster_manager,
                             Envoy::Tracing::HttpTracerSharedPtr& http_tracer,
                             absl::string_view cluster_name, int worker_id,
                             RequestSource& request_generator) const override;
+
+  /**
+   * @param worker_id the worker to get the source addresses for.
+   * @return std::vector<std::string> the source addresses the connections of the worker are bound
+   * to. Empty when no source addresses are configured.
+   */
+  std::vector<std::string> sourceAddressesForWorker(int worker_id) const;
+
+private:
+  const uint32_t number_of_workers_;
+  // The configured source addresses, expanded once.
+  const std::vector<std::string> source_addresses_;
 };
 
 class SequencerFactoryImpl : public OptionBasedFactoryImpl, public SequencerFactory {
@@ -0,0 +1,72 @@
+#include "source/client/memory_usage_sampler.h"
+
+#include "external/envoy/source/common/memory/stats.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+#include "source/common/utility.h"
+
+namespace Nighthawk {
+namespace Client {
+
+MemoryUsageSampler::MemoryUsageSampler(Envoy::TimeSource& time_source, uint32_t phases,
+                                       std::chrono::nanoseconds interval)
+    : ThreadedPhaseObserver(time_source, phases), interval_(interval) {}
+
+MemoryUsageSampler::~MemoryUsageSampler() { stop(); }
+
+bool MemoryUsageSampler::onFirstPhaseStarted() {
+  sampleLocked(nighthawk::client::MemorySample::MAIN_PHASE_STARTED);
+  return interval_.count() > 0;
+}
+
+void MemoryUsageSampler::onLastPhaseCompleted() {
+  sampleLocked(nighthawk::client::MemorySample::MAIN_PHASE_COMPLETED);
+}
+
+void MemoryUsageSampler::runWhilePhasesExecute() {
+  while (!waitForPhases(interval_)) {
+    sampleLocked(nighthawk::client::MemorySample::INTERVAL);
+  }
+}
+
+nighthawk::client::MemorySample
+MemoryUsageSampler::sample(nighthawk::client::MemorySample::Trigger trigger) {
+  Envoy::Thread::LockGuard guard(lock_);
+  return sampleLocked(trigger);
+}
+
+std::vector<nighthawk::client::MemorySample> MemoryUsageSampler::stop() {
+  stopThread();
+  Envoy::Thread::LockGuard guard(lock_);
+  return samples_;
+}
+
+nighthawk::client::MemorySample MemoryUsageSampler::currentMemoryUsage() {
+  nighthawk::client::MemorySample sample;
+  sample.set_resident_set_size_bytes(Utility::residentSetSizeBytes().value_or(0));
+  sample.set_peak_resident_set_size_bytes(Utility::peakResidentSetSizeBytes().value_or(0));
+  sample.set_allocated_bytes(Envoy::Memory::Stats::totalCurrentlyAllocated());
+  sample.set_heap_size_bytes(Envoy::Memory::Stats::totalCurrentlyReserved());
+  sample.set_page_heap_free_bytes(Envoy::Memory::Stats::totalPageHeapFree());
+  sample.set_page_heap_unmapped_bytes(Envoy::Memory::Stats::totalPageHeapUnmapped());
+  sample.set_thread_cache_bytes(Envoy::Memory::Stats::totalThreadCacheBytes());
+  return sample;
+}
+
+nighthawk::client::MemorySample
+MemoryUsageSampler::sampleLocked(nighthawk::client::MemorySample::Trigger trigger) {
+  nighthawk::client::MemorySample sample = currentMemoryUsage();
+  const Envoy::MonotonicTime now = time_source_.monotonicTime();
+  if (!first_sample_time_.has_value()) {
+    first_sample_time_ = now;
+  }
+  sample.set_trigger(trigger);
+  *sample.mutable_offset() = Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - first_sample_time_.value())
+          .count());
+  samples_.push_back(sample);
+  return sample;
+}
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "api/client/output.pb.h"
+
+#include "source/client/threaded_phase_observer.h"
+
+#include "absl/types/optional.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Samples the memory usage of the process and the allocator at the boundaries of the main phase of
+ * the workers, and optionally at an interval while the workers execute it. The interval samples are
+ * taken from a thread of its own, so the workers are never held up by them.
+ */
+class MemoryUsageSampler : public ThreadedPhaseObserver {
+public:
+  /**
+   * @param time_source used to time the samples and the interval.
+   * @param phases the number of workers which will report the start and completion of their main
+   * phase.
+   * @param interval how often to sample while the workers execute their main phase. Zero to only
+   * sample at the phase boundaries.
+   */
+  MemoryUsageSampler(Envoy::TimeSource& time_source, uint32_t phases,
+                     std::chrono::nanoseconds interval);
+  ~MemoryUsageSampler() override;
+
+  /**
+   * Takes and records a sample. The offsets of the samples are relative to the first sample which
+   * gets taken. Thread safe.
+   *
+   * @param trigger why the sample gets taken.
+   * @return nighthawk::client::MemorySample the sample.
+   */
+  nighthawk::client::MemorySample sample(nighthawk::client::MemorySample::Trigger trigger);
+
+  /**
+   * Stops sampling at the interval, if that is still running. Must be called after the workers have
+   * completed.
+   *
+   * @return std::vector<nighthawk::client::MemorySample> the samples, in the order they were taken.
+   */
+  std::vector<nighthawk::client::MemorySample> stop();
+
+  /**
+   * @return nighthawk::client::MemorySample the current memory usage of the process and the
+   * allocator, without the trigger and offset.
+   */
+  static nighthawk::client::MemorySample currentMemoryUsage();
+
+protected:
+  // ThreadedPhaseObserver
+  bool onFirstPhaseStarted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) override;
+  void onLastPhaseCompleted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) override;
+  void runWhilePhasesExecute() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) override;
+
+private:
+  nighthawk::client::MemorySample sampleLocked(nighthawk::client::MemorySample::Trigger trigger)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const std::chrono::nanoseconds interval_;
+  absl::optional<Envoy::MonotonicTime> first_sample_time_ ABSL_GUARDED_BY(lock_);
+  std::vector<nighthawk::client::MemorySample> samples_ ABSL_GUARDED_BY(lock_);
+};
+
+using MemoryUsageSamplerPtr = std::unique_ptr<MemoryUsageSampler>;
+
+} // namespace Client
+} // namespace Nighthawk
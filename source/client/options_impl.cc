@@ -7,6 +7,7 @@
 #include "api/client/options.pb.validate.h"
 
 #include "source/client/output_formatter_impl.h"
+#include "source/client/source_address_utility.h"
 #include "source/common/uri_impl.h"
 #include "source/common/utility.h"
 #include "source/common/version_info.h"
@@ -24,6 +25,22 @@ using ::nighthawk::client::Protocol;
 #define TCLAP_SET_IF_SPECIFIED(command, value_member)                                              \
   ((value_member) = (((command).isSet()) ? ((command).getValue()) : (value_member)))
 
+namespace {
+
+// Parses the value of a duration argument, like "1.5s", which must not be negative.
+std::chrono::nanoseconds parseNonNegativeDuration(const TCLAP::ValueArg<std::string>& arg) {
+  Envoy::ProtobufWkt::Duration duration;
+  if (!Envoy::Protobuf::util::TimeUtil::FromString(arg.getValue(), &duration)) {
+    throw MalformedArgvException(fmt::format("Invalid value for --{}", arg.getName()));
+  }
+  if (duration.nanos() < 0 || duration.seconds() < 0) {
+    throw MalformedArgvException(fmt::format("--{} is out of range", arg.getName()));
+  }
+  return std::chrono::nanoseconds(Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(duration));
+}
+
+} // namespace
+
 OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
   setNonTrivialDefaults();
   // Override some defaults, we are in CLI-mode.
@@ -165,6 +182,140 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
       "{source_address:{address:\"127.0.0.1\",port_value:0}}",
       false, "", "string", cmd);
 
+  TCLAP::MultiArg<std::string> source_addresses(
+      "", "source-address",
+      "Local source address to bind upstream connections to. Either an IP address or a CIDR range "
+      "like 10.0.0.0/24, of which every address is used. May be specified multiple times, with "
+      "all addresses of the same family. Connections are spread over the addresses, which must be "
+      "assigned to a local interface, to go beyond the ephemeral port range of a single source "
+      "address. Workers use disjoint addresses when there are at least as many addresses as "
+      "workers, and split their --connections over their addresses, so they need at least as "
+      "many connections as addresses. Connection counters are reported per source address. At "
+      "most 65536 addresses are supported. Takes precedence over the source address in "
+      "--upstream-bind-config. Default: empty, connections use the address selected by the "
+      "kernel or by --upstream-bind-config.",
+      false, "string", cmd);
+
+  TCLAP::SwitchArg low_memory_connections(
+      "", "low-memory-connections",
+      "Cap the data buffered per upstream connection at 32 KiB, and for HTTP/2 use the minimum "
+      "flow control windows and disable the HPACK dynamic table for responses. This bounds what "
+      "busy connections may hold, but leaves the fixed footprint of a connection, like its codec "
+      "and per-stream state, as is. Trades throughput on busy connections for footprint. Default "
+      "is false.",
+      cmd);
+
+  TCLAP::SwitchArg report_memory_usage(
+      "", "report-memory-usage",
+      "Report the growth of the resident set size of the process over the execution, in total and "
+      "as an upper bound per upstream connection left open, as the memory.rss_growth_bytes and "
+      "memory.rss_growth_bytes_per_connection_upper_bound counters, along with an estimate of the "
+      "memory held by the statistics, request sources and connection pools. Also samples the "
+      "resident set size and the allocator statistics right before the workers start and when the "
+      "main phase starts and completes, see --memory-sample-interval. Default is false.",
+      cmd);
+
+  TCLAP::SwitchArg socket_timestamping(
+      "", "socket-timestamping",
+      "Enable kernel software timestamps on the upstream sockets, to separate network latency from "
+      "client overhead. Reports the time between the request leaving and the response arriving at "
+      "the socket as the wire_latency histogram, and the remainder of the latency to the response "
+      "headers as the client_overhead histogram. Only supported for plaintext HTTP/1 over TCP. "
+      "Default is false.",
+      cmd);
+
+  TCLAP::SwitchArg tsc_clock(
+      "", "tsc-clock",
+      "Derive latency timestamps from the invariant time stamp counter (TSC) of the CPU, which is "
+      "cheaper to read than CLOCK_MONOTONIC. The counter is calibrated against CLOCK_MONOTONIC at "
+      "startup and re-checked periodically. Falls back to CLOCK_MONOTONIC when the CPU has no "
+      "invariant TSC, or when it turns out to be unreliable. Default is false.",
+      cmd);
+
+  TCLAP::SwitchArg calibrate_overhead(
+      "", "calibrate-overhead",
+      "Before the benchmark, measure the latency and the throughput ceiling of a single worker of "
+      "Nighthawk itself against an in-process zero-work responder over loopback, using the same "
+      "per worker settings. The baseline is added to the output as the calibration result, along "
+      "with the p50 and p99 request latency of the benchmark above it. The baseline paces requests "
+      "like a single one of the workers, without contention between workers. Only supported for "
+      "plaintext HTTP/1 target URIs. Default is false.",
+      cmd);
+
+  TCLAP::SwitchArg overhead_adjusted_percentiles(
+      "", "overhead-adjusted-percentiles",
+      "Also show the latency percentiles in the human readable output with the median latency of "
+      "the calibration subtracted, as an estimate of the latency of the target alone. The estimate "
+      "assumes that the overhead of Nighthawk is the same at every percentile, which it isn't, so "
+      "it is least accurate in the tail. Requires --calibrate-overhead. Default is false.",
+      cmd);
+
+  TCLAP::ValueArg<std::string> request_event_log(
+      "", "request-event-log",
+      "Path prefix of a per-worker binary log with a fixed-size record for each request: its id, "
+      "class, connection, status, response size, and the times it was intended to start, started, "
+      "got a connection, received its first and last byte. Worker N writes to "
+      "<prefix>.worker_N. Use nighthawk_output_transform --request-event-log to convert or "
+      "summarize a log. Default is empty, which disables the log.",
+      false, "", "path prefix", cmd);
+  TCLAP::ValueArg<uint32_t> request_event_log_capacity(
+      "", "request-event-log-capacity",
+      fmt::format("The number of records each request event log holds. When it is exhausted, the "
+                  "log wraps around and overwrites the oldest records. Each record takes 80 bytes "
+                  "(default: {}).",
+                  request_event_log_capacity_),
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> slowest_requests(
+      "", "slowest-requests",
+      "The number of slowest successful requests to report the details of in the output, across "
+      "all workers: latency, time spent waiting for a connection, time to first byte, method, "
+      "path, authority, response code, connection id and upstream host. Each worker retains this "
+      "many of its slowest requests, and only collects the details of a request when it is slower "
+      "than the fastest one retained. Default is 0, which disables the capture.",
+      false, 0, "uint32_t", cmd);
+  TCLAP::MultiArg<std::string> slowest_requests_headers(
+      "", "slowest-requests-header",
+      "Name of a request or response header to record the value of for the slowest requests. May "
+      "be specified multiple times.",
+      false, "string", cmd);
+  TCLAP::SwitchArg perf_counters(
+      "", "perf-counters",
+      "Count the perf events of each worker over its main phase via perf_event_open: task clock, "
+      "context switches, CPU migrations and page faults, as well as cycles, instructions and cache "
+      "misses where the hardware allows. Reported as perf.* counters per result, along with "
+      "instructions, cycles and task clock per request and context switches per 1000 requests. "
+      "Only supported on Linux. Default is false.",
+      cmd);
+  TCLAP::ValueArg<std::string> cpu_profile(
+      "", "cpu-profile",
+      "Write a CPU profile to this path, covering only the main phase of the workers instead of "
+      "the whole process. See --profile-delay and --profile-duration to narrow it down further. "
+      "Requires a build with --define tcmalloc=gperftools. Default is empty, which disables CPU "
+      "profiling.",
+      false, "", "path", cmd);
+  TCLAP::ValueArg<std::string> heap_profile(
+      "", "heap-profile",
+      "Write heap profiles with this path prefix, covering only the main phase of the workers "
+      "instead of the whole process. Requires a build with --define tcmalloc=gperftools. Default "
+      "is empty, which disables heap profiling.",
+      false, "", "path prefix", cmd);
+  TCLAP::ValueArg<std::string> profile_delay(
+      "", "profile-delay",
+      "How long after the first worker starts its main phase to start profiling. For example, to "
+      "skip the first 5 seconds of load generation, specify 5s. Default is 0s.",
+      false, "", "duration", cmd);
+  TCLAP::ValueArg<std::string> profile_duration(
+      "", "profile-duration",
+      "How long to profile for. Default is empty, which profiles until the last worker completes "
+      "its main phase.",
+      false, "", "duration", cmd);
+  TCLAP::ValueArg<std::string> memory_sample_interval(
+      "", "memory-sample-interval",
+      "How often to sample the memory usage of the process while the workers execute their main "
+      "phase, for example 1s. Requires --report-memory-usage. Default is empty, which only "
+      "samples right before the workers start and when the main phase starts and completes.",
+      false, "", "duration", cmd);
+
   TCLAP::ValueArg<std::string> transport_socket(
       "", "transport-socket",
       "Transport socket configuration in json. "
@@ -250,6 +401,32 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
       "Add uniformly distributed absolute request-release timing jitter. For example, to add 10 us "
       "of jitter, specify .00001s. Default is empty / no uniform jitter.",
       false, "", "duration", cmd);
+  TCLAP::ValueArg<std::string> request_timeout(
+      "", "request-timeout",
+      "Per-request timeout. Requests that didn't complete within this time after being issued are "
+      "abandoned, and reported as timeouts instead of stream resets. For example, to time out "
+      "requests after 500 ms, specify .5s. Default is empty / no request timeout.",
+      false, "", "duration", cmd);
+  TCLAP::ValueArg<double> hedge_delay_percentile(
+      "", "hedge-delay-percentile",
+      "Issue a single hedge attempt for requests that didn't complete within this percentile of "
+      "the recently observed latencies. The first attempt to succeed wins, and the other one gets "
+      "cancelled. For example, specify 95 to hedge the slowest 5% of the requests. The hedge delay "
+      "is recomputed from every 1000 first attempt latencies, so no hedge attempts are issued "
+      "until those of the first 1000 requests were observed. It is capped at 1s. Default is 0 / "
+      "no hedging.",
+      false, 0, "double", cmd);
+  TCLAP::ValueArg<uint32_t> max_retries(
+      "", "max-retries",
+      "Maximum number of times a request is retried after its attempts failed with a stream "
+      "reset, connection failure or request timeout. Default is 0 / no retries.",
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<double> retry_budget_percent(
+      "", "retry-budget-percent",
+      fmt::format("Retries are only issued while the number of retries stays within this "
+                  "percentage of the requests. (default: {}).",
+                  retry_budget_percent_),
+      false, 0, "double", cmd);
   TCLAP::ValueArg<std::string> nighthawk_service(
       "", "nighthawk-service",
       "Nighthawk service uri. Example: grpc://localhost:8843/. Default is empty.", false, "",
@@ -288,7 +465,9 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
   TCLAP::UnlabeledValueArg<std::string> uri(
       "uri",
       "URI to benchmark. http:// and https:// are supported, "
-      "but in case of https no certificates are validated. "
+      "but in case of https no certificates are validated. Unix domain sockets can be "
+      "targeted with unix:///path/to/socket:/request/path, or unix://@name:/request/path "
+      "for abstract sockets. "
       "Provide a URI when you need to benchmark a single endpoint. For multiple "
       "endpoints, set --multi-target-* instead.",
       false, "", "uri format", cmd);
@@ -478,6 +657,12 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
       throw MalformedArgvException("Invalid value for --jitter-uniform");
     }
   }
+  if (request_timeout.isSet()) {
+    request_timeout_ = parseNonNegativeDuration(request_timeout);
+  }
+  TCLAP_SET_IF_SPECIFIED(hedge_delay_percentile, hedge_delay_percentile_);
+  TCLAP_SET_IF_SPECIFIED(max_retries, max_retries_);
+  TCLAP_SET_IF_SPECIFIED(retry_budget_percent, retry_budget_percent_);
   TCLAP_SET_IF_SPECIFIED(nighthawk_service, nighthawk_service_);
   TCLAP_SET_IF_SPECIFIED(multi_target_use_https, multi_target_use_https_);
   TCLAP_SET_IF_SPECIFIED(multi_target_path, multi_target_path_);
@@ -497,6 +682,29 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
     }
   }
   TCLAP_SET_IF_SPECIFIED(labels, labels_);
+  TCLAP_SET_IF_SPECIFIED(source_addresses, source_addresses_);
+  TCLAP_SET_IF_SPECIFIED(low_memory_connections, low_memory_connections_);
+  TCLAP_SET_IF_SPECIFIED(report_memory_usage, report_memory_usage_);
+  TCLAP_SET_IF_SPECIFIED(socket_timestamping, socket_timestamping_);
+  TCLAP_SET_IF_SPECIFIED(tsc_clock, tsc_clock_);
+  TCLAP_SET_IF_SPECIFIED(calibrate_overhead, calibrate_overhead_);
+  TCLAP_SET_IF_SPECIFIED(overhead_adjusted_percentiles, overhead_adjusted_percentiles_);
+  TCLAP_SET_IF_SPECIFIED(request_event_log, request_event_log_);
+  TCLAP_SET_IF_SPECIFIED(request_event_log_capacity, request_event_log_capacity_);
+  TCLAP_SET_IF_SPECIFIED(slowest_requests, slowest_requests_);
+  TCLAP_SET_IF_SPECIFIED(slowest_requests_headers, slowest_requests_headers_);
+  TCLAP_SET_IF_SPECIFIED(perf_counters, perf_counters_);
+  TCLAP_SET_IF_SPECIFIED(cpu_profile, cpu_profile_);
+  TCLAP_SET_IF_SPECIFIED(heap_profile, heap_profile_);
+  if (profile_delay.isSet()) {
+    profile_delay_ = parseNonNegativeDuration(profile_delay);
+  }
+  if (profile_duration.isSet()) {
+    profile_duration_ = parseNonNegativeDuration(profile_duration);
+  }
+  if (memory_sample_interval.isSet()) {
+    memory_sample_interval_ = parseNonNegativeDuration(memory_sample_interval);
+  }
   TCLAP_SET_IF_SPECIFIED(simple_warmup, simple_warmup_);
   TCLAP_SET_IF_SPECIFIED(no_duration, no_duration_);
   if (stats_sinks.isSet()) {
@@ -729,6 +937,41 @@ OptionsImpl::OptionsImpl(const nighthawk::client::CommandLineOptions& options) {
     upstream_bind_config_.emplace(envoy::config::core::v3::BindConfig());
     upstream_bind_config_.value().MergeFrom(options.upstream_bind_config());
   }
+  std::copy(options.source_addresses().begin(), options.source_addresses().end(),
+            std::back_inserter(source_addresses_));
+  low_memory_connections_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, low_memory_connections,
+                                                            low_memory_connections_);
+  report_memory_usage_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, report_memory_usage, report_memory_usage_);
+  socket_timestamping_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, socket_timestamping, socket_timestamping_);
+  tsc_clock_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, tsc_clock, tsc_clock_);
+  calibrate_overhead_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, calibrate_overhead, calibrate_overhead_);
+  overhead_adjusted_percentiles_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      options, overhead_adjusted_percentiles, overhead_adjusted_percentiles_);
+  request_event_log_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, request_event_log, request_event_log_);
+  request_event_log_capacity_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      options, request_event_log_capacity, request_event_log_capacity_);
+  slowest_requests_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, slowest_requests, slowest_requests_);
+  std::copy(options.slowest_requests_headers().begin(), options.slowest_requests_headers().end(),
+            std::back_inserter(slowest_requests_headers_));
+  perf_counters_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, perf_counters, perf_counters_);
+  cpu_profile_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, cpu_profile, cpu_profile_);
+  heap_profile_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, heap_profile, heap_profile_);
+  if (options.has_profile_delay()) {
+    profile_delay_ = std::chrono::nanoseconds(
+        Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(options.profile_delay()));
+  }
+  if (options.has_profile_duration()) {
+    profile_duration_ = std::chrono::nanoseconds(
+        Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(options.profile_duration()));
+  }
+  if (options.has_memory_sample_interval()) {
+    memory_sample_interval_ = std::chrono::nanoseconds(
+        Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(options.memory_sample_interval()));
+  }
   if (options.has_transport_socket()) {
     transport_socket_.emplace(envoy::config::core::v3::TransportSocket());
     transport_socket_.value().MergeFrom(options.transport_socket());
@@ -747,6 +990,15 @@ OptionsImpl::OptionsImpl(const nighthawk::client::CommandLineOptions& options) {
     jitter_uniform_ = std::chrono::nanoseconds(
         Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(options.jitter_uniform()));
   }
+  if (options.has_request_timeout()) {
+    request_timeout_ = std::chrono::nanoseconds(
+        Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(options.request_timeout()));
+  }
+  hedge_delay_percentile_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, hedge_delay_percentile, hedge_delay_percentile_);
+  max_retries_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, max_retries, max_retries_);
+  retry_budget_percent_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, retry_budget_percent, retry_budget_percent_);
   for (const envoy::config::metrics::v3::StatsSink& stats_sink : options.stats_sinks()) {
     stats_sinks_.push_back(stats_sink);
   }
@@ -791,6 +1043,7 @@ void OptionsImpl::setNonTrivialDefaults() {
   // fails.
   failure_predicates_["requestsource.upstream_rq_5xx"] = 0;
   jitter_uniform_ = std::chrono::nanoseconds(0);
+  request_timeout_ = std::chrono::nanoseconds(0);
 }
 
 void OptionsImpl::validate() const {
@@ -826,6 +1079,19 @@ void OptionsImpl::validate() const {
   if (uri_.has_value()) {
     try {
       UriImpl uri(uri_.value());
+      if (uri.scheme() == "unix" && protocol() == Envoy::Http::Protocol::Http3) {
+        throw MalformedArgvException("HTTP/3 can't be used with a unix domain socket target URI.");
+      }
+      if (uri.scheme() == "unix" && !source_addresses_.empty()) {
+        throw MalformedArgvException(
+            "--source-address can't be used with a unix domain socket target URI.");
+      }
+      if (socket_timestamping_ && uri.scheme() != "http") {
+        throw MalformedArgvException("--socket-timestamping requires a plaintext http target URI.");
+      }
+      if (calibrate_overhead_ && uri.scheme() != "http") {
+        throw MalformedArgvException("--calibrate-overhead requires a plaintext http target URI.");
+      }
     } catch (const UriException&) {
       throw MalformedArgvException(fmt::format("Invalid target URI: ''", uri_.value()));
     }
@@ -841,6 +1107,49 @@ void OptionsImpl::validate() const {
       throw MalformedArgvException("--multi-target-path must be specified.");
     }
   }
+  if (socket_timestamping_) {
+    if (protocol() != Envoy::Http::Protocol::Http11) {
+      throw MalformedArgvException("--socket-timestamping is only supported for HTTP/1.");
+    }
+    if (multi_target_use_https_ || transport_socket_.has_value()) {
+      throw MalformedArgvException(
+          "--socket-timestamping can't be combined with --multi-target-use-https or "
+          "--transport-socket.");
+    }
+  }
+  if (calibrate_overhead_) {
+    if (!uri_.has_value()) {
+      throw MalformedArgvException("--calibrate-overhead requires a target URI.");
+    }
+    if (protocol() != Envoy::Http::Protocol::Http11 || transport_socket_.has_value()) {
+      throw MalformedArgvException(
+          "--calibrate-overhead is only supported for HTTP/1 without --transport-socket.");
+    }
+    if (!nighthawk_service_.empty()) {
+      throw MalformedArgvException("--calibrate-overhead can't be used with --nighthawk-service.");
+    }
+  }
+  if (overhead_adjusted_percentiles_ && !calibrate_overhead_) {
+    throw MalformedArgvException("--overhead-adjusted-percentiles requires --calibrate-overhead.");
+  }
+  if ((profile_delay_.count() > 0 || profile_duration_.count() > 0) && cpu_profile_.empty() &&
+      heap_profile_.empty()) {
+    throw MalformedArgvException(
+        "--profile-delay and --profile-duration require --cpu-profile or --heap-profile.");
+  }
+  if (memory_sample_interval_.count() > 0 && !report_memory_usage_) {
+    throw MalformedArgvException("--memory-sample-interval requires --report-memory-usage.");
+  }
+  if (!slowest_requests_headers_.empty() && slowest_requests_ == 0) {
+    throw MalformedArgvException("--slowest-requests-header requires --slowest-requests.");
+  }
+  if (!source_addresses_.empty()) {
+    try {
+      SourceAddressUtility::expandSourceAddresses(source_addresses_);
+    } catch (const NighthawkException& e) {
+      throw MalformedArgvException(fmt::format("Invalid --source-address: {}", e.what()));
+    }
+  }
 
   try {
     Envoy::MessageUtil::validate(*toCommandLineOptionsInternal(),
@@ -927,6 +1236,38 @@ CommandLineOptionsPtr OptionsImpl::toCommandLineOptionsInternal() const {
   if (upstream_bind_config_.has_value()) {
     *(command_line_options->mutable_upstream_bind_config()) = upstream_bind_config_.value();
   }
+  for (const std::string& source_address : source_addresses_) {
+    *command_line_options->add_source_addresses() = source_address;
+  }
+  command_line_options->mutable_low_memory_connections()->set_value(low_memory_connections_);
+  command_line_options->mutable_report_memory_usage()->set_value(report_memory_usage_);
+  command_line_options->mutable_socket_timestamping()->set_value(socket_timestamping_);
+  command_line_options->mutable_tsc_clock()->set_value(tsc_clock_);
+  command_line_options->mutable_calibrate_overhead()->set_value(calibrate_overhead_);
+  command_line_options->mutable_overhead_adjusted_percentiles()->set_value(
+      overhead_adjusted_percentiles_);
+  command_line_options->mutable_request_event_log()->set_value(request_event_log_);
+  command_line_options->mutable_request_event_log_capacity()->set_value(
+      request_event_log_capacity_);
+  command_line_options->mutable_slowest_requests()->set_value(slowest_requests_);
+  for (const std::string& header_name : slowest_requests_headers_) {
+    *command_line_options->add_slowest_requests_headers() = header_name;
+  }
+  command_line_options->mutable_perf_counters()->set_value(perf_counters_);
+  command_line_options->mutable_cpu_profile()->set_value(cpu_profile_);
+  command_line_options->mutable_heap_profile()->set_value(heap_profile_);
+  if (profile_delay_.count() > 0) {
+    *command_line_options->mutable_profile_delay() =
+        Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(profile_delay_.count());
+  }
+  if (profile_duration_.count() > 0) {
+    *command_line_options->mutable_profile_duration() =
+        Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(profile_duration_.count());
+  }
+  if (memory_sample_interval_.count() > 0) {
+    *command_line_options->mutable_memory_sample_interval() =
+        Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(memory_sample_interval_.count());
+  }
   if (transport_socket_.has_value()) {
     *(command_line_options->mutable_transport_socket()) = transport_socket_.value();
   }
@@ -952,6 +1293,13 @@ CommandLineOptionsPtr OptionsImpl::toCommandLineOptionsInternal() const {
     *command_line_options->mutable_jitter_uniform() =
         Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(jitter_uniform_.count());
   }
+  if (request_timeout_.count() > 0) {
+    *command_line_options->mutable_request_timeout() =
+        Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(request_timeout_.count());
+  }
+  command_line_options->mutable_hedge_delay_percentile()->set_value(hedge_delay_percentile_);
+  command_line_options->mutable_max_retries()->set_value(max_retries_);
+  command_line_options->mutable_retry_budget_percent()->set_value(retry_budget_percent_);
   command_line_options->mutable_nighthawk_service()->set_value(nighthawk_service_);
   for (const auto& label : labels_) {
     *command_line_options->add_labels() = label;
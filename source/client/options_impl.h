@@ -58,6 +58,27 @@ public:
   const absl::optional<envoy::config::core::v3::BindConfig>& upstreamBindConfig() const override {
     return upstream_bind_config_;
   }
+  std::vector<std::string> sourceAddresses() const override { return source_addresses_; }
+  bool lowMemoryConnections() const override { return low_memory_connections_; }
+  bool reportMemoryUsage() const override { return report_memory_usage_; }
+  bool socketTimestamping() const override { return socket_timestamping_; }
+  bool tscClock() const override { return tsc_clock_; }
+  bool calibrateOverhead() const override { return calibrate_overhead_; }
+  bool overheadAdjustedPercentiles() const override { return overhead_adjusted_percentiles_; }
+  std::string requestEventLog() const override { return request_event_log_; }
+  uint32_t requestEventLogCapacity() const override { return request_event_log_capacity_; }
+  uint32_t slowestRequests() const override { return slowest_requests_; }
+  std::vector<std::string> slowestRequestsHeaders() const override {
+    return slowest_requests_headers_;
+  }
+  bool perfCounters() const override { return perf_counters_; }
+  std::string cpuProfile() const override { return cpu_profile_; }
+  std::string heapProfile() const override { return heap_profile_; }
+  std::chrono::nanoseconds profileDelay() const override { return profile_delay_; }
+  std::chrono::nanoseconds profileDuration() const override { return profile_duration_; }
+  std::chrono::nanoseconds memorySampleInterval() const override {
+    return memory_sample_interval_;
+  }
   const absl::optional<envoy::config::core::v3::TransportSocket>& transportSocket() const override {
     return transport_socket_;
   }
@@ -85,6 +106,10 @@ public:
   bool openLoop() const override { return open_loop_; }
 
   std::chrono::nanoseconds jitterUniform() const override { return jitter_uniform_; }
+  std::chrono::nanoseconds requestTimeout() const override { return request_timeout_; }
+  double hedgeDelayPercentile() const override { return hedge_delay_percentile_; }
+  uint32_t maxRetries() const override { return max_retries_; }
+  double retryBudgetPercent() const override { return retry_budget_percent_; }
   std::string nighthawkService() const override { return nighthawk_service_; }
   std::vector<std::string> labels() const override { return labels_; };
 
@@ -136,6 +161,23 @@ private:
   uint32_t request_body_size_{0};
   envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context_;
   absl::optional<envoy::config::core::v3::BindConfig> upstream_bind_config_;
+  std::vector<std::string> source_addresses_;
+  bool low_memory_connections_{false};
+  bool report_memory_usage_{false};
+  bool socket_timestamping_{false};
+  bool tsc_clock_{false};
+  bool calibrate_overhead_{false};
+  bool overhead_adjusted_percentiles_{false};
+  std::string request_event_log_;
+  uint32_t request_event_log_capacity_{1048576};
+  uint32_t slowest_requests_{0};
+  std::vector<std::string> slowest_requests_headers_;
+  bool perf_counters_{false};
+  std::string cpu_profile_;
+  std::string heap_profile_;
+  std::chrono::nanoseconds profile_delay_{0};
+  std::chrono::nanoseconds profile_duration_{0};
+  std::chrono::nanoseconds memory_sample_interval_{0};
   absl::optional<envoy::config::core::v3::TransportSocket> transport_socket_;
   absl::optional<envoy::config::core::v3::TypedExtensionConfig> request_source_plugin_config_;
 
@@ -155,6 +197,10 @@ private:
   TerminationPredicateMap failure_predicates_;
   bool open_loop_{false};
   std::chrono::nanoseconds jitter_uniform_;
+  std::chrono::nanoseconds request_timeout_;
+  double hedge_delay_percentile_{0};
+  uint32_t max_retries_{0};
+  double retry_budget_percent_{20};
   std::string nighthawk_service_;
   bool h2_use_multiple_connections_{false}; // Deprecated.
   std::vector<nighthawk::client::MultiTarget::Endpoint> multi_target_endpoints_;
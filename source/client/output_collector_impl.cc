@@ -55,5 +55,28 @@ void OutputCollectorImpl::addResult(
       Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(execution_duration.count());
 }
 
+void OutputCollectorImpl::setSlowestRequests(
+    const std::vector<nighthawk::client::SlowRequest>& slowest_requests) {
+  output_.clear_slowest_requests();
+  for (const nighthawk::client::SlowRequest& slow_request : slowest_requests) {
+    *output_.add_slowest_requests() = slow_request;
+  }
+}
+
+void OutputCollectorImpl::setProfiles(const std::vector<nighthawk::client::Profile>& profiles) {
+  output_.clear_profiles();
+  for (const nighthawk::client::Profile& profile : profiles) {
+    *output_.add_profiles() = profile;
+  }
+}
+
+void OutputCollectorImpl::setMemorySamples(
+    const std::vector<nighthawk::client::MemorySample>& memory_samples) {
+  output_.clear_memory_samples();
+  for (const nighthawk::client::MemorySample& memory_sample : memory_samples) {
+    *output_.add_memory_samples() = memory_sample;
+  }
+}
+
 } // namespace Client
 } // namespace Nighthawk
\ No newline at end of file
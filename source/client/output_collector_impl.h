@@ -22,6 +22,11 @@ public:
                  const std::map<std::string, uint64_t>& counters,
                  const std::chrono::nanoseconds execution_duration,
                  const absl::optional<Envoy::SystemTime>& first_acquisition_time) override;
+  void setSlowestRequests(
+      const std::vector<nighthawk::client::SlowRequest>& slowest_requests) override;
+  void setProfiles(const std::vector<nighthawk::client::Profile>& profiles) override;
+  void
+  setMemorySamples(const std::vector<nighthawk::client::MemorySample>& memory_samples) override;
   void setOutput(const nighthawk::client::Output& output) override { output_ = output; }
 
   nighthawk::client::Output toProto() const override;
@@ -16,6 +16,7 @@
 #include "source/common/version_info.h"
 
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/strip.h"
 
@@ -24,6 +25,44 @@ namespace Client {
 
 using ::nighthawk::client::Protocol;
 
+namespace {
+
+// Returns the median of the statistic with the id in the result, if the result has that statistic
+// and it holds durations.
+absl::optional<int64_t> medianNanoseconds(const nighthawk::client::Result& result,
+                                          absl::string_view statistic_id) {
+  for (const auto& statistic : result.statistics()) {
+    if (statistic.id() != statistic_id) {
+      continue;
+    }
+    for (const auto& percentile : statistic.percentiles()) {
+      if (percentile.percentile() >= .5 && percentile.has_duration()) {
+        return Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(percentile.duration());
+      }
+    }
+  }
+  return absl::nullopt;
+}
+
+std::string formatMebibytes(uint64_t bytes) {
+  return fmt::format("{:.1f} MiB", bytes / (1024.0 * 1024.0));
+}
+
+absl::string_view memorySampleTriggerName(nighthawk::client::MemorySample::Trigger trigger) {
+  switch (trigger) {
+  case nighthawk::client::MemorySample::WORKERS_STARTING:
+    return "workers starting";
+  case nighthawk::client::MemorySample::MAIN_PHASE_STARTED:
+    return "main phase started";
+  case nighthawk::client::MemorySample::MAIN_PHASE_COMPLETED:
+    return "main phase completed";
+  default:
+    return "interval";
+  }
+}
+
+} // namespace
+
 std::vector<std::string> OutputFormatterImpl::getLowerCaseOutputFormats() {
   const Envoy::Protobuf::EnumDescriptor* enum_descriptor =
       nighthawk::client::OutputFormat::OutputFormatOptions_descriptor();
@@ -59,6 +98,12 @@ absl::StatusOr<std::string>
 ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
   std::stringstream ss;
   ss << "Nighthawk - A layer 7 protocol benchmarking tool." << std::endl << std::endl;
+  const nighthawk::client::Result* calibration = nullptr;
+  for (const auto& result : output.results()) {
+    if (result.name() == "calibration") {
+      calibration = &result;
+    }
+  }
   for (const auto& result : output.results()) {
     if (result.name() == "global") {
       for (const auto& statistic : result.statistics()) {
@@ -66,6 +111,12 @@ ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output)
         if (statistic.count() == 0) {
           continue;
         }
+        // On request, the percentiles are also shown with the median latency of the client itself
+        // subtracted. That's only an estimate, as the overhead isn't the same at every percentile.
+        const absl::optional<int64_t> overhead =
+            calibration != nullptr && output.options().overhead_adjusted_percentiles().value()
+                ? medianNanoseconds(*calibration, statistic.id())
+                : absl::nullopt;
         const std::string s_min = statistic.has_min() ? formatProtoDuration(statistic.min())
                                                       : fmt::format("{}", statistic.raw_min());
         const std::string s_max = statistic.has_max() ? formatProtoDuration(statistic.max())
@@ -85,15 +136,18 @@ ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output)
         ss << fmt::format("pstdev: {}", s_pstdev) << std::endl;
 
         bool header_written = false;
-        iteratePercentiles(statistic, [&ss, this, &header_written](
+        iteratePercentiles(statistic, [&ss, this, &header_written, &overhead](
                                           const nighthawk::client::Percentile& percentile) {
           const auto p = percentile.percentile();
           // Don't show the min / max, as we already show that above.
           if (p > 0 && p < 1) {
             if (!header_written) {
               ss << std::endl
-                 << fmt::format("  {:<{}}{:<{}}{:<{}}", "Percentile", 12, "Count", 12, "Value", 15)
-                 << std::endl;
+                 << fmt::format("  {:<{}}{:<{}}{:<{}}", "Percentile", 12, "Count", 12, "Value", 15);
+              if (overhead.has_value()) {
+                ss << fmt::format("{}", "Adjusted (estimate)");
+              }
+              ss << std::endl;
               header_written = true;
             }
             auto s_percentile = fmt::format("{:.{}g}", p, 8);
@@ -101,8 +155,15 @@ ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output)
                               percentile.has_duration()
                                   ? formatProtoDuration(percentile.duration())
                                   : fmt::format("{}", static_cast<int64_t>(percentile.raw_value())),
-                              15)
-               << std::endl;
+                              15);
+            if (overhead.has_value() && percentile.has_duration()) {
+              const int64_t adjusted =
+                  Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(percentile.duration()) -
+                  overhead.value();
+              ss << formatProtoDuration(Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(
+                  std::max<int64_t>(adjusted, 0)));
+            }
+            ss << std::endl;
           }
         });
         ss << std::endl;
@@ -118,6 +179,88 @@ ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output)
       ss << std::endl;
     }
   }
+  if (calibration != nullptr) {
+    for (const auto& counter : calibration->counters()) {
+      if (counter.name() == "calibration.worker_throughput_ceiling_rps") {
+        ss << fmt::format("Throughput ceiling of a single client worker: {} requests per second",
+                          counter.value())
+           << std::endl;
+      } else if (counter.name() == "calibration.adjusted_request_to_response_p50_ns" ||
+                 counter.name() == "calibration.adjusted_request_to_response_p99_ns") {
+        const std::string adjusted = formatProtoDuration(
+            Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(counter.value()));
+        ss << fmt::format("Request latency above the calibration baseline at {}: {}",
+                          absl::EndsWith(counter.name(), "p50_ns") ? "p50" : "p99", adjusted)
+           << std::endl;
+      } else if (counter.name() == "calibration.benchmark_workers" && counter.value() > 1) {
+        ss << fmt::format("The calibration baseline paces requests like a single one of the {} "
+                          "workers of the benchmark, without contention between workers.",
+                          counter.value())
+           << std::endl;
+      }
+    }
+    ss << std::endl;
+  }
+  if (!output.slowest_requests().empty()) {
+    ss << "Slowest requests" << std::endl;
+    for (const nighthawk::client::SlowRequest& request : output.slowest_requests()) {
+      ss << fmt::format("  {} | {} {}{} | status {} | worker {} | connection {} {}",
+                        formatProtoDuration(request.latency()), request.method(),
+                        request.authority(), request.path(), request.response_code(),
+                        request.worker(), request.connection_id(), request.upstream_host())
+         << std::endl;
+      ss << fmt::format("    waited for a connection: {} | first byte after: {}",
+                        formatProtoDuration(request.pool_wait()),
+                        formatProtoDuration(request.time_to_first_byte()))
+         << std::endl;
+      for (const envoy::config::core::v3::HeaderValue& header : request.request_headers()) {
+        ss << fmt::format("    request header {}: {}", header.key(), header.value()) << std::endl;
+      }
+      for (const envoy::config::core::v3::HeaderValue& header : request.response_headers()) {
+        ss << fmt::format("    response header {}: {}", header.key(), header.value()) << std::endl;
+      }
+    }
+    ss << std::endl;
+  }
+  if (!output.profiles().empty()) {
+    ss << "Profiles" << std::endl;
+    for (const nighthawk::client::Profile& profile : output.profiles()) {
+      ss << fmt::format("  {} profile {} | started {} into the main phase | ran for {}",
+                        profile.type() == nighthawk::client::Profile::CPU ? "CPU" : "heap",
+                        profile.path(), formatProtoDuration(profile.offset()),
+                        formatProtoDuration(profile.duration()))
+         << std::endl;
+    }
+    ss << std::endl;
+  }
+  if (!output.memory_samples().empty()) {
+    ss << "Memory usage" << std::endl;
+    for (const nighthawk::client::MemorySample& sample : output.memory_samples()) {
+      ss << fmt::format("  {:<21}| {} | resident {} | peak resident {}",
+                        memorySampleTriggerName(sample.trigger()),
+                        formatProtoDuration(sample.offset()),
+                        formatMebibytes(sample.resident_set_size_bytes()),
+                        formatMebibytes(sample.peak_resident_set_size_bytes()))
+         << std::endl;
+      // The part of the heap which is mapped in but doesn't hold live allocations is fragmented.
+      const uint64_t mapped_heap =
+          sample.heap_size_bytes() > sample.page_heap_unmapped_bytes()
+              ? sample.heap_size_bytes() - sample.page_heap_unmapped_bytes()
+              : 0;
+      if (mapped_heap > 0 && mapped_heap >= sample.allocated_bytes()) {
+        ss << fmt::format(
+                  "    allocated {} | heap {} | fragmentation {:.1f}% | page heap free {} | thread "
+                  "caches {}",
+                  formatMebibytes(sample.allocated_bytes()),
+                  formatMebibytes(sample.heap_size_bytes()),
+                  100.0 * (mapped_heap - sample.allocated_bytes()) / mapped_heap,
+                  formatMebibytes(sample.page_heap_free_bytes()),
+                  formatMebibytes(sample.thread_cache_bytes()))
+           << std::endl;
+      }
+    }
+    ss << std::endl;
+  }
 
   return ss.str();
 }
@@ -10,6 +10,7 @@
 #include "source/client/options_impl.h"
 #include "source/client/output_collector_impl.h"
 #include "source/client/output_formatter_impl.h"
+#include "source/client/request_event_log.h"
 #include "source/common/utility.h"
 #include "source/common/version_info.h"
 
@@ -28,9 +29,27 @@ OutputTransformMain::OutputTransformMain(int argc, const char* const* argv, std:
   TCLAP::ValuesConstraint<std::string> output_formats_allowed(output_formats);
   TCLAP::ValueArg<std::string> output_format(
       "", "output-format", fmt::format("Output format. Possible values: {}.", output_formats), true,
-      "", &output_formats_allowed, cmd);
+      "", &output_formats_allowed);
+  TCLAP::ValueArg<std::string> request_event_log(
+      "", "request-event-log",
+      "Transform the request event log of a single worker, as written by nighthawk_client "
+      "--request-event-log, instead of output read from stdin.",
+      true, "", "path");
+  cmd.xorAdd(output_format, request_event_log);
+  std::vector<std::string> request_event_log_formats = {"summary", "csv"};
+  TCLAP::ValuesConstraint<std::string> request_event_log_formats_allowed(
+      request_event_log_formats);
+  TCLAP::ValueArg<std::string> request_event_log_format(
+      "", "request-event-log-format",
+      fmt::format("Format to transform a request event log to. Possible values: {}. The summary "
+                  "counts the outcomes, and lists the latency percentiles and the {} slowest "
+                  "requests with the time spent in each phase. Default is summary.",
+                  request_event_log_formats, SlowestRequestEvents),
+      false, "summary", &request_event_log_formats_allowed, cmd);
   Utility::parseCommand(cmd, argc, argv);
   output_format_ = output_format.getValue();
+  request_event_log_ = request_event_log.getValue();
+  request_event_log_format_ = request_event_log_format.getValue();
 }
 
 std::string OutputTransformMain::readInput() {
@@ -40,6 +59,9 @@ std::string OutputTransformMain::readInput() {
 }
 
 uint32_t OutputTransformMain::run() {
+  if (!request_event_log_.empty()) {
+    return transformRequestEventLog();
+  }
   // Figure out the desired output format, and read attempt to read the input proto
   // from stdin.
   nighthawk::client::OutputFormat_OutputFormatOptions translated_format;
@@ -66,5 +88,20 @@ uint32_t OutputTransformMain::run() {
   return 0;
 }
 
+uint32_t OutputTransformMain::transformRequestEventLog() {
+  const absl::StatusOr<std::vector<RequestEventRecord>> records =
+      RequestEventLog::read(request_event_log_);
+  if (!records.ok()) {
+    std::cerr << "Input error: " << records.status().message();
+    return 1;
+  }
+  if (request_event_log_format_ == "csv") {
+    std::cout << RequestEventLog::formatCsv(*records);
+  } else {
+    std::cout << RequestEventLog::formatSummary(*records, SlowestRequestEvents);
+  }
+  return 0;
+}
+
 } // namespace Client
 } // namespace Nighthawk
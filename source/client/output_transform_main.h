@@ -12,9 +12,15 @@ public:
   uint32_t run();
 
 private:
+  // The number of slowest requests listed in a request event log summary.
+  static constexpr size_t SlowestRequestEvents = 10;
+
   std::string readInput();
+  uint32_t transformRequestEventLog();
   Envoy::Event::RealTimeSystem time_system_; // NO_CHECK_FORMAT(real_time)
   std::string output_format_;
+  std::string request_event_log_;
+  std::string request_event_log_format_;
   std::istream& input_;
 };
 
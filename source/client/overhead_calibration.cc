@@ -0,0 +1,191 @@
+#include "source/client/overhead_calibration.h"
+
+#include <google/protobuf/util/time_util.h>
+
+#include <algorithm>
+
+#include "nighthawk/common/exception.h"
+
+#include "source/client/options_impl.h"
+#include "source/client/output_collector_impl.h"
+#include "source/client/process_impl.h"
+#include "source/client/zero_work_responder.h"
+
+#include "absl/strings/match.h"
+#include "absl/types/optional.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+constexpr absl::string_view RequestLatencyStatistic = "benchmark_http_client.request_to_response";
+
+// Returns the request latency at the first reported percentile at or above the given one.
+absl::optional<int64_t> requestLatencyNanoseconds(const nighthawk::client::Result& result,
+                                                  double percentile) {
+  for (const nighthawk::client::Statistic& statistic : result.statistics()) {
+    if (statistic.id() != RequestLatencyStatistic) {
+      continue;
+    }
+    for (const nighthawk::client::Percentile& reported : statistic.percentiles()) {
+      if (reported.percentile() >= percentile && reported.has_duration()) {
+        return Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(reported.duration());
+      }
+    }
+  }
+  return absl::nullopt;
+}
+
+} // namespace
+
+OptionsPtr OverheadCalibration::createCalibrationOptions(const Options& options, uint16_t port,
+                                                        bool saturate) {
+  const CommandLineOptionsPtr benchmark_options = options.toCommandLineOptions();
+  nighthawk::client::CommandLineOptions command_line_options;
+  command_line_options.mutable_uri()->set_value(fmt::format("http://127.0.0.1:{}/", port));
+  command_line_options.mutable_address_family()->set_value(nighthawk::client::AddressFamily::V4);
+  command_line_options.mutable_duration()->set_seconds(RunDuration.count());
+  // The responder serves all connections on a single thread, so it would become the bottleneck
+  // when driven by more than one worker.
+  command_line_options.mutable_concurrency()->set_value("1");
+  // How requests are issued, per worker.
+  *command_line_options.mutable_verbosity() = benchmark_options->verbosity();
+  *command_line_options.mutable_requests_per_second() = benchmark_options->requests_per_second();
+  *command_line_options.mutable_connections() = benchmark_options->connections();
+  *command_line_options.mutable_timeout() = benchmark_options->timeout();
+  *command_line_options.mutable_prefetch_connections() =
+      benchmark_options->prefetch_connections();
+  *command_line_options.mutable_burst_size() = benchmark_options->burst_size();
+  if (benchmark_options->has_request_options()) {
+    *command_line_options.mutable_request_options() = benchmark_options->request_options();
+  }
+  *command_line_options.mutable_max_pending_requests() =
+      benchmark_options->max_pending_requests();
+  *command_line_options.mutable_max_requests_per_connection() =
+      benchmark_options->max_requests_per_connection();
+  *command_line_options.mutable_sequencer_idle_strategy() =
+      benchmark_options->sequencer_idle_strategy();
+  *command_line_options.mutable_experimental_h1_connection_reuse_strategy() =
+      benchmark_options->experimental_h1_connection_reuse_strategy();
+  *command_line_options.mutable_open_loop() = benchmark_options->open_loop();
+  *command_line_options.mutable_jitter_uniform() = benchmark_options->jitter_uniform();
+  *command_line_options.mutable_low_memory_connections() =
+      benchmark_options->low_memory_connections();
+  *command_line_options.mutable_socket_timestamping() = benchmark_options->socket_timestamping();
+  *command_line_options.mutable_tsc_clock() = benchmark_options->tsc_clock();
+  if (saturate) {
+    command_line_options.mutable_requests_per_second()->set_value(1000000);
+    command_line_options.mutable_open_loop()->set_value(false);
+  }
+  return std::make_unique<OptionsImpl>(command_line_options);
+}
+
+absl::StatusOr<nighthawk::client::Result> OverheadCalibration::calibrate(
+    const Options& options, Envoy::Network::DnsResolverFactory& dns_resolver_factory,
+    const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+    Envoy::Event::TimeSystem& time_system,
+    const std::shared_ptr<Envoy::ProcessWide>& process_wide) {
+  std::unique_ptr<ZeroWorkResponder> responder;
+  try {
+    responder = std::make_unique<ZeroWorkResponder>();
+  } catch (const NighthawkException& e) {
+    return absl::InternalError(e.what());
+  }
+  ENVOY_LOG(info, "Calibrating the measurement overhead against a loopback responder.");
+  absl::StatusOr<nighthawk::client::Result> baseline =
+      runOnce(*createCalibrationOptions(options, responder->port(), false), dns_resolver_factory,
+              typed_dns_resolver_config, time_system, process_wide);
+  if (!baseline.ok()) {
+    return baseline;
+  }
+  ENVOY_LOG(info, "Determining the throughput ceiling against a loopback responder.");
+  const absl::StatusOr<nighthawk::client::Result> saturated =
+      runOnce(*createCalibrationOptions(options, responder->port(), true), dns_resolver_factory,
+              typed_dns_resolver_config, time_system, process_wide);
+  if (!saturated.ok()) {
+    return saturated.status();
+  }
+  uint64_t requests = 0;
+  for (const nighthawk::client::Counter& counter : saturated->counters()) {
+    if (counter.name() == "upstream_rq_total") {
+      requests = counter.value();
+    }
+  }
+  const int64_t duration_ns =
+      Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(saturated->execution_duration());
+  nighthawk::client::Counter* ceiling = baseline->add_counters();
+  ceiling->set_name(std::string(ThroughputCeilingCounter));
+  ceiling->set_value(duration_ns > 0 ? requests * 1000000000 / duration_ns : 0);
+  baseline->set_name(std::string(ResultName));
+  ENVOY_LOG(info, "The throughput ceiling of a single worker is {} requests per second.",
+            ceiling->value());
+  return baseline;
+}
+
+void OverheadCalibration::compareWithBenchmark(const nighthawk::client::Output& output,
+                                               nighthawk::client::Result& baseline) {
+  const nighthawk::client::Result* global = nullptr;
+  uint64_t workers = 0;
+  for (const nighthawk::client::Result& result : output.results()) {
+    if (result.name() == "global") {
+      global = &result;
+    } else if (absl::StartsWith(result.name(), "worker_")) {
+      workers++;
+    }
+  }
+  // Per worker results are only reported when there is more than one worker.
+  workers = std::max<uint64_t>(workers, 1);
+  nighthawk::client::Counter* workers_counter = baseline.add_counters();
+  workers_counter->set_name(std::string(BenchmarkWorkersCounter));
+  workers_counter->set_value(workers);
+  if (global == nullptr) {
+    return;
+  }
+  for (const auto& [percentile, name] :
+       {std::make_pair(.5, AdjustedMedianCounter), std::make_pair(.99, AdjustedP99Counter)}) {
+    const absl::optional<int64_t> benchmark_latency =
+        requestLatencyNanoseconds(*global, percentile);
+    const absl::optional<int64_t> baseline_latency =
+        requestLatencyNanoseconds(baseline, percentile);
+    if (!benchmark_latency.has_value() || !baseline_latency.has_value()) {
+      continue;
+    }
+    nighthawk::client::Counter* adjusted = baseline.add_counters();
+    adjusted->set_name(std::string(name));
+    adjusted->set_value(std::max<int64_t>(*benchmark_latency - *baseline_latency, 0));
+  }
+  if (workers > 1) {
+    ENVOY_LOG(info,
+              "The calibration paced requests like a single one of the {} workers of the "
+              "benchmark, without contention between workers, so it may underestimate the "
+              "overhead.",
+              workers);
+  }
+}
+
+absl::StatusOr<nighthawk::client::Result> OverheadCalibration::runOnce(
+    const Options& options, Envoy::Network::DnsResolverFactory& dns_resolver_factory,
+    const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+    Envoy::Event::TimeSystem& time_system,
+    const std::shared_ptr<Envoy::ProcessWide>& process_wide) {
+  absl::StatusOr<ProcessPtr> process = ProcessImpl::CreateProcessImpl(
+      options, dns_resolver_factory, typed_dns_resolver_config, time_system, process_wide);
+  if (!process.ok()) {
+    return process.status();
+  }
+  OutputCollectorImpl collector(time_system, options);
+  const bool success = (*process)->run(collector);
+  (*process)->shutdown();
+  if (!success) {
+    return absl::InternalError("A calibration run failed.");
+  }
+  for (const nighthawk::client::Result& result : collector.toProto().results()) {
+    if (result.name() == "global") {
+      return result;
+    }
+  }
+  return absl::InternalError("A calibration run didn't produce a global result.");
+}
+
+} // namespace Client
+} // namespace Nighthawk
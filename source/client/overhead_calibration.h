@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "envoy/event/timer.h"
+
+#include "nighthawk/client/options.h"
+
+#include "external/envoy/source/common/common/logger.h"
+#include "external/envoy/source/common/network/dns_resolver/dns_factory_util.h"
+#include "external/envoy/source/exe/process_wide.h"
+#include "external/envoy_api/envoy/config/core/v3/extension.pb.h"
+
+#include "api/client/output.pb.h"
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Measures how much latency the client adds itself, by benchmarking a ZeroWorkResponder over
+ * loopback with the per worker settings of the actual benchmark. The responder serves on a single
+ * thread, so the calibration runs use a single worker. The resulting baseline holds:
+ * - the latency statistics of a run which paces requests like a worker of the actual benchmark
+ *   does, which reflect the intrinsic latency of the event loop, codec and timestamping.
+ * - the throughput ceiling of a worker, as determined by a closed-loop run at the highest allowed
+ *   rate.
+ * Once the benchmark completed, compareWithBenchmark() adds how its request latency compares to the
+ * baseline. The baseline paces requests like a single one of the workers of the benchmark, without
+ * any contention between workers, so it underestimates the overhead when the workers of the
+ * benchmark compete for the CPU.
+ */
+class OverheadCalibration : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  // How long each of the two calibration runs lasts.
+  static constexpr std::chrono::seconds RunDuration{3};
+  // Name of the result which holds the baseline in the output.
+  static constexpr absl::string_view ResultName = "calibration";
+  // Name of the counter of the baseline result which holds the throughput ceiling of a single
+  // worker, in requests per second.
+  static constexpr absl::string_view ThroughputCeilingCounter =
+      "calibration.worker_throughput_ceiling_rps";
+  // Name of the counter of the baseline result which holds the number of workers of the benchmark
+  // it was compared with, of which it paces requests like a single one.
+  static constexpr absl::string_view BenchmarkWorkersCounter = "calibration.benchmark_workers";
+  // Names of the counters of the baseline result which hold the request latency percentiles of the
+  // benchmark with the ones of the baseline subtracted, in nanoseconds. Clamped at zero.
+  static constexpr absl::string_view AdjustedMedianCounter =
+      "calibration.adjusted_request_to_response_p50_ns";
+  static constexpr absl::string_view AdjustedP99Counter =
+      "calibration.adjusted_request_to_response_p99_ns";
+
+  /**
+   * Derives the options of a calibration run from the options of the actual benchmark. Only the
+   * options which affect how a worker issues requests are carried over. Everything else, like the
+   * targets, the number of workers and anything with side effects outside of the process, keeps
+   * its default.
+   *
+   * @param options the options of the actual benchmark.
+   * @param port the loopback port of the responder to target.
+   * @param saturate when true, the run issues requests as fast as possible in closed-loop mode, to
+   * find the throughput ceiling.
+   * @return OptionsPtr the options of the calibration run.
+   */
+  static OptionsPtr createCalibrationOptions(const Options& options, uint16_t port,
+                                             bool saturate);
+
+  /**
+   * Runs the calibration. Only a single process may run at a time, so this has to be called before
+   * the process of the actual benchmark gets created.
+   *
+   * @param options the options of the actual benchmark.
+   * @param dns_resolver_factory used to create the DNS resolver of the calibration processes.
+   * @param typed_dns_resolver_config the config that defined dns_resolver_factory.
+   * @param time_system the time system the calibration processes use.
+   * @param process_wide shared with the calibration processes.
+   * @return absl::StatusOr<nighthawk::client::Result> the baseline, named ResultName, or an error
+   * when a calibration run failed.
+   */
+  static absl::StatusOr<nighthawk::client::Result>
+  calibrate(const Options& options, Envoy::Network::DnsResolverFactory& dns_resolver_factory,
+            const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+            Envoy::Event::TimeSystem& time_system,
+            const std::shared_ptr<Envoy::ProcessWide>& process_wide);
+
+  /**
+   * Compares the baseline with the output of the actual benchmark, by adding the counters named
+   * BenchmarkWorkersCounter, AdjustedMedianCounter and AdjustedP99Counter to it. The latency
+   * counters are left out when either of them lacks request latency percentiles.
+   *
+   * @param output the output of the actual benchmark.
+   * @param baseline the result of calibrate(), to add the counters to.
+   */
+  static void compareWithBenchmark(const nighthawk::client::Output& output,
+                                   nighthawk::client::Result& baseline);
+
+private:
+  // Runs a single calibration run, and returns its global result.
+  static absl::StatusOr<nighthawk::client::Result>
+  runOnce(const Options& options, Envoy::Network::DnsResolverFactory& dns_resolver_factory,
+          const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+          Envoy::Event::TimeSystem& time_system,
+          const std::shared_ptr<Envoy::ProcessWide>& process_wide);
+};
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,88 @@
+#include "source/client/phase_profiler.h"
+
+#include "external/envoy/source/common/profiler/profiler.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+namespace Nighthawk {
+namespace Client {
+
+PhaseProfiler::PhaseProfiler(Envoy::TimeSource& time_source, uint32_t phases,
+                             std::string cpu_profile_path, std::string heap_profile_path,
+                             std::chrono::nanoseconds delay, std::chrono::nanoseconds duration)
+    : ThreadedPhaseObserver(time_source, phases), cpu_profile_path_(std::move(cpu_profile_path)),
+      heap_profile_path_(std::move(heap_profile_path)), delay_(delay), duration_(duration) {}
+
+PhaseProfiler::~PhaseProfiler() { stop(); }
+
+bool PhaseProfiler::onFirstPhaseStarted() {
+  first_phase_start_ = time_source_.monotonicTime();
+  return true;
+}
+
+std::vector<nighthawk::client::Profile> PhaseProfiler::stop() {
+  stopThread();
+  Envoy::Thread::LockGuard guard(lock_);
+  return profiles_;
+}
+
+bool PhaseProfiler::startCpuProfiler(const std::string& path) {
+  return Envoy::Profiler::Cpu::startProfiler(path);
+}
+
+void PhaseProfiler::stopCpuProfiler() { Envoy::Profiler::Cpu::stopProfiler(); }
+
+bool PhaseProfiler::startHeapProfiler(const std::string& path_prefix) {
+  return Envoy::Profiler::Heap::startProfiler(path_prefix);
+}
+
+void PhaseProfiler::stopHeapProfiler() { Envoy::Profiler::Heap::stopProfiler(); }
+
+void PhaseProfiler::runWhilePhasesExecute() {
+  if (delay_.count() > 0 && waitForPhases(delay_)) {
+    ENVOY_LOG(warn, "The main phase completed within the profiling delay, nothing was profiled.");
+    return;
+  }
+  const Envoy::MonotonicTime start = time_source_.monotonicTime();
+  const bool cpu_profiling = !cpu_profile_path_.empty() && startCpuProfiler(cpu_profile_path_);
+  if (!cpu_profile_path_.empty() && !cpu_profiling) {
+    ENVOY_LOG(warn, "Failed to start the CPU profiler. Profiling requires a build with "
+                    "--define tcmalloc=gperftools.");
+  }
+  const bool heap_profiling = !heap_profile_path_.empty() && startHeapProfiler(heap_profile_path_);
+  if (!heap_profile_path_.empty() && !heap_profiling) {
+    ENVOY_LOG(warn, "Failed to start the heap profiler. Profiling requires a build with "
+                    "--define tcmalloc=gperftools.");
+  }
+  if (!cpu_profiling && !heap_profiling) {
+    return;
+  }
+  ENVOY_LOG(info, "Started profiling.");
+  waitForPhases(duration_.count() > 0 ? absl::make_optional(duration_) : absl::nullopt);
+  if (cpu_profiling) {
+    stopCpuProfiler();
+  }
+  if (heap_profiling) {
+    stopHeapProfiler();
+  }
+  const Envoy::MonotonicTime end = time_source_.monotonicTime();
+  ENVOY_LOG(info, "Stopped profiling.");
+
+  nighthawk::client::Profile profile;
+  *profile.mutable_offset() =
+      Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration((start - first_phase_start_).count());
+  *profile.mutable_duration() =
+      Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration((end - start).count());
+  if (cpu_profiling) {
+    profile.set_type(nighthawk::client::Profile::CPU);
+    profile.set_path(cpu_profile_path_);
+    profiles_.push_back(profile);
+  }
+  if (heap_profiling) {
+    profile.set_type(nighthawk::client::Profile::HEAP);
+    profile.set_path(heap_profile_path_);
+    profiles_.push_back(profile);
+  }
+}
+
+} // namespace Client
+} // namespace Nighthawk
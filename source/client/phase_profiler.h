@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "external/envoy/source/common/common/logger.h"
+
+#include "api/client/output.pb.h"
+
+#include "source/client/threaded_phase_observer.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Runs the CPU and heap profilers linked into the process while the workers execute their main
+ * phase, so that the profiles cover steady-state load generation only instead of also covering
+ * startup, warmup and shutdown. Profiling starts a configurable delay after the first worker starts
+ * its main phase, and stops when the last worker completes it, or earlier when a duration is
+ * configured. Profiling is driven from a thread of its own, so the workers are never held up
+ * waiting for it.
+ */
+class PhaseProfiler : public ThreadedPhaseObserver,
+                      public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * @param time_source used to time the delay and the duration.
+   * @param phases the number of workers which will report the start and completion of their main
+   * phase.
+   * @param cpu_profile_path where to write the CPU profile. Empty to not profile the CPU.
+   * @param heap_profile_path the prefix of the heap profile files. Empty to not profile the heap.
+   * @param delay how long after the first main phase starts to start profiling.
+   * @param duration how long to profile for. Zero to profile until the last main phase completes.
+   */
+  PhaseProfiler(Envoy::TimeSource& time_source, uint32_t phases, std::string cpu_profile_path,
+                std::string heap_profile_path, std::chrono::nanoseconds delay,
+                std::chrono::nanoseconds duration);
+  ~PhaseProfiler() override;
+
+  /**
+   * Stops profiling if it is still running, and waits for the profiles to be written. Must be
+   * called after the workers have completed.
+   *
+   * @return std::vector<nighthawk::client::Profile> the profiles which were written.
+   */
+  std::vector<nighthawk::client::Profile> stop();
+
+protected:
+  // ThreadedPhaseObserver
+  bool onFirstPhaseStarted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) override;
+  void runWhilePhasesExecute() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) override;
+
+  // The profilers, which tests override.
+  virtual bool startCpuProfiler(const std::string& path);
+  virtual void stopCpuProfiler();
+  virtual bool startHeapProfiler(const std::string& path_prefix);
+  virtual void stopHeapProfiler();
+
+private:
+  const std::string cpu_profile_path_;
+  const std::string heap_profile_path_;
+  const std::chrono::nanoseconds delay_;
+  const std::chrono::nanoseconds duration_;
+  Envoy::MonotonicTime first_phase_start_ ABSL_GUARDED_BY(lock_);
+  std::vector<nighthawk::client::Profile> profiles_ ABSL_GUARDED_BY(lock_);
+};
+
+using PhaseProfilerPtr = std::unique_ptr<PhaseProfiler>;
+
+} // namespace Client
+} // namespace Nighthawk
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "nighthawk/client/options.h"
+#include "nighthawk/common/exception.h"
 #include "nighthawk/common/uri.h"
 
 #include "external/envoy/source/common/common/statusor.h"
@@ -12,6 +13,7 @@
 #include "external/envoy_api/envoy/extensions/upstreams/http/v3/http_protocol_options.pb.h"
 
 #include "source/client/sni_utility.h"
+#include "source/client/source_address_utility.h"
 #include "source/common/uri_impl.h"
 #include "source/common/utility.h"
 
@@ -21,6 +23,8 @@ namespace {
 using ::envoy::config::bootstrap::v3::Bootstrap;
 using ::envoy::config::cluster::v3::CircuitBreakers;
 using ::envoy::config::cluster::v3::Cluster;
+using ::envoy::config::core::v3::Address;
+using ::envoy::config::core::v3::BindConfig;
 using ::envoy::config::core::v3::Http2ProtocolOptions;
 using ::envoy::config::core::v3::Http3ProtocolOptions;
 using ::envoy::config::core::v3::SocketAddress;
@@ -32,12 +36,21 @@ using ::envoy::extensions::transport_sockets::quic::v3::QuicUpstreamTransport;
 using ::envoy::extensions::transport_sockets::tls::v3::CommonTlsContext;
 using ::envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext;
 
-// Adds the address and port specified in the URI to the endpoints.
+// Per connection buffer limit used in low memory mode. Envoy defaults to 1 MiB.
+constexpr uint32_t kLowMemoryConnectionBufferLimitBytes = 32 * 1024;
+// The smallest HTTP/2 flow control window allowed by RFC 7540.
+constexpr uint32_t kMinHttp2WindowSize = 65535;
+
+// Adds the address and port specified in the URI to the endpoints, or the socket path for unix
+// domain socket URIs.
 void addUriToEndpoints(const Uri& uri, LocalityLbEndpoints* endpoints) {
-  SocketAddress* socket_address = endpoints->add_lb_endpoints()
-                                      ->mutable_endpoint()
-                                      ->mutable_address()
-                                      ->mutable_socket_address();
+  Address* address = endpoints->add_lb_endpoints()->mutable_endpoint()->mutable_address();
+  if (uri.address()->type() == Envoy::Network::Address::Type::Pipe) {
+    // The string representation of abstract sockets starts with '@', just like the config expects.
+    address->mutable_pipe()->set_path(uri.address()->asString());
+    return;
+  }
+  SocketAddress* socket_address = address->mutable_socket_address();
   socket_address->set_address(uri.address()->ip()->addressAsString());
   socket_address->set_port_value(uri.port());
 }
@@ -113,14 +126,15 @@ absl::StatusOr<TransportSocket> createTransportSocket(const Client::Options& opt
   return transport_socket;
 }
 
-// Creates circuit breakers configuration based on the specified options.
-CircuitBreakers createCircuitBreakers(const Client::Options& options) {
+// Creates circuit breakers configuration based on the specified options, allowing up to
+// max_connections connections.
+CircuitBreakers createCircuitBreakers(const Client::Options& options, uint32_t max_connections) {
   CircuitBreakers circuit_breakers;
   CircuitBreakers::Thresholds* thresholds = circuit_breakers.add_thresholds();
 
   // We do not support any retrying.
   thresholds->mutable_max_retries()->set_value(0);
-  thresholds->mutable_max_connections()->set_value(options.connections());
+  thresholds->mutable_max_connections()->set_value(max_connections);
 
   // We specialize on 0 below, as that is not supported natively. The benchmark client will track
   // in flight work and avoid creating pending requests in this case.
@@ -149,6 +163,13 @@ Cluster createNighthawkClusterForWorker(const Client::Options& options,
     Http2ProtocolOptions* http2_options =
         http_options.mutable_explicit_http_config()->mutable_http2_protocol_options();
     http2_options->mutable_max_concurrent_streams()->set_value(options.maxConcurrentStreams());
+    if (options.lowMemoryConnections()) {
+      // Limit what the server may have in flight to us, and don't keep a dynamic table around for
+      // decoding response headers.
+      http2_options->mutable_initial_stream_window_size()->set_value(kMinHttp2WindowSize);
+      http2_options->mutable_initial_connection_window_size()->set_value(kMinHttp2WindowSize);
+      http2_options->mutable_hpack_table_size()->set_value(0);
+    }
 
   } else if (options.protocol() == Envoy::Http::Protocol::Http3) {
     Http3ProtocolOptions* http3_options =
@@ -164,7 +185,11 @@ Cluster createNighthawkClusterForWorker(const Client::Options& options,
       ["envoy.extensions.upstreams.http.v3.HttpProtocolOptions"]
           .PackFrom(http_options);
 
-  *cluster.mutable_circuit_breakers() = createCircuitBreakers(options);
+  *cluster.mutable_circuit_breakers() = createCircuitBreakers(options, options.connections());
+  if (options.lowMemoryConnections()) {
+    cluster.mutable_per_connection_buffer_limit_bytes()->set_value(
+        kLowMemoryConnectionBufferLimitBytes);
+  }
 
   cluster.set_type(Cluster::STATIC);
 
@@ -177,6 +202,35 @@ Cluster createNighthawkClusterForWorker(const Client::Options& options,
   return cluster;
 }
 
+// Creates a cluster which binds the connections of the specified worker to one of its source
+// addresses. The cluster is a copy of the worker cluster, which only gets a share of the
+// connections of the worker. The shares add up to the connections of the worker, the first
+// clusters get one more connection when they don't divide evenly.
+Cluster createSourceAddressClusterForWorker(const Client::Options& options,
+                                            const Cluster& worker_cluster, int worker_number,
+                                            size_t index, const std::string& source_address,
+                                            size_t number_of_source_addresses) {
+  Cluster cluster = worker_cluster;
+  cluster.set_name(Client::SourceAddressUtility::clusterName(worker_number, index));
+  cluster.set_alt_stat_name(Client::SourceAddressUtility::statName(worker_number, source_address));
+  cluster.mutable_load_assignment()->set_cluster_name(cluster.name());
+
+  const uint32_t max_connections = options.connections() / number_of_source_addresses +
+                                   (index < options.connections() % number_of_source_addresses);
+  *cluster.mutable_circuit_breakers() = createCircuitBreakers(options, max_connections);
+
+  // The cluster level bind config takes precedence over the one in the cluster manager, so carry
+  // over the socket options the user may have specified.
+  BindConfig* bind_config = cluster.mutable_upstream_bind_config();
+  if (options.upstreamBindConfig().has_value()) {
+    *bind_config = options.upstreamBindConfig().value();
+  }
+  SocketAddress* socket_address = bind_config->mutable_source_address();
+  socket_address->set_address(source_address);
+  socket_address->set_port_value(0);
+  return cluster;
+}
+
 // Extracts URIs of the targets and the request source (if specified) from the
 // Nighthawk options.
 // Resolves all the extracted URIs.
@@ -232,6 +286,14 @@ absl::StatusOr<Bootstrap> createBootstrapConfiguration(
     return uri_status;
   }
 
+  std::vector<std::string> source_addresses;
+  try {
+    source_addresses =
+        Client::SourceAddressUtility::expandSourceAddresses(options.sourceAddresses());
+  } catch (const NighthawkException& ex) {
+    return absl::InvalidArgumentError(ex.what());
+  }
+
   Bootstrap bootstrap;
   for (int worker_number = 0; worker_number < number_of_workers; worker_number++) {
     Cluster nighthawk_cluster = createNighthawkClusterForWorker(options, uris, worker_number);
@@ -242,9 +304,30 @@ absl::StatusOr<Bootstrap> createBootstrapConfiguration(
         return transport_socket.status();
       }
       *nighthawk_cluster.mutable_transport_socket() = *transport_socket;
+    } else if (options.socketTimestamping()) {
+      TransportSocket* transport_socket = nighthawk_cluster.mutable_transport_socket();
+      transport_socket->set_name("nighthawk.transport_sockets.socket_timestamping");
+      transport_socket->mutable_typed_config()->PackFrom(
+          nighthawk::client::SocketTimestampingConfig());
     }
     *bootstrap.mutable_static_resources()->add_clusters() = nighthawk_cluster;
 
+    const std::vector<std::string> worker_source_addresses =
+        Client::SourceAddressUtility::sourceAddressesForWorker(source_addresses, worker_number,
+                                                               number_of_workers);
+    // Every source address needs at least one of the connections of the worker.
+    if (worker_source_addresses.size() > options.connections()) {
+      return absl::InvalidArgumentError(fmt::format(
+          "Worker {} has {} source addresses, which is more than its {} connections. Specify "
+          "fewer source addresses, or more connections.",
+          worker_number, worker_source_addresses.size(), options.connections()));
+    }
+    for (size_t i = 0; i < worker_source_addresses.size(); i++) {
+      *bootstrap.mutable_static_resources()->add_clusters() = createSourceAddressClusterForWorker(
+          options, nighthawk_cluster, worker_number, i, worker_source_addresses[i],
+          worker_source_addresses.size());
+    }
+
     if (request_source_uri != nullptr) {
       *bootstrap.mutable_static_resources()->add_clusters() =
           createRequestSourceClusterForWorker(options, *request_source_uri, worker_number);
@@ -34,6 +34,9 @@
 
 #include "source/client/process_bootstrap.h"
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_replace.h"
 #include "absl/types/optional.h"
 
@@ -49,6 +52,7 @@
 #include "api/client/output.pb.h"
 
 #include "source/common/frequency.h"
+#include "source/common/perf_event_counters.h"
 #include "source/common/uri_impl.h"
 #include "source/common/utility.h"
 
@@ -57,6 +61,7 @@
 #include "source/client/client_worker_impl.h"
 #include "source/client/factories_impl.h"
 #include "source/client/options_impl.h"
+#include "source/client/slowest_request_tracker.h"
 #include "source/client/sni_utility.h"
 
 using namespace std::chrono_literals;
@@ -162,6 +167,20 @@ class NullServerInstance : public Envoy::Server::Instance {
   }
 };
 
+/**
+ * Adds counters to others, by name. Unlike std::map::merge(), which keeps the value already there
+ * when both have a counter of the same name, values of the same name are summed.
+ *
+ * @param counters the counters to add.
+ * @param accumulated the counters that get them added.
+ */
+void addCounters(const std::map<std::string, uint64_t>& counters,
+                 std::map<std::string, uint64_t>& accumulated) {
+  for (const auto& [name, value] : counters) {
+    accumulated[name] += value;
+  }
+}
+
 } // namespace
 
 // We customize ProdClusterManagerFactory for the sole purpose of returning our specialized
@@ -230,12 +249,15 @@ ProcessImpl::ProcessImpl(const Options& options, Envoy::Event::TimeSystem& time_
     : options_(options), number_of_workers_(BootstrapFactory::determineConcurrency(options_)),
       process_wide_(process_wide == nullptr ? std::make_shared<Envoy::ProcessWide>()
                                             : process_wide),
-      time_system_(time_system), stats_allocator_(symbol_table_), store_root_(stats_allocator_),
+      tsc_time_system_(options.tscClock() ? TscTimeSystem::create() : nullptr),
+      time_system_(tsc_time_system_ != nullptr ? *tsc_time_system_ : time_system),
+      stats_allocator_(symbol_table_), store_root_(stats_allocator_),
       quic_stat_names_(store_root_.symbolTable()),
       api_(std::make_unique<Envoy::Api::Impl>(platform_impl_.threadFactory(), store_root_,
                                               time_system_, platform_impl_.fileSystem(), generator_,
                                               bootstrap_)),
-      dispatcher_(api_->allocateDispatcher("main_thread")), benchmark_client_factory_(options),
+      dispatcher_(api_->allocateDispatcher("main_thread")),
+      benchmark_client_factory_(options, number_of_workers_),
       termination_predicate_factory_(options), sequencer_factory_(options),
       request_generator_factory_(options, *api_), init_manager_("nh_init_manager"),
       local_info_(new Envoy::LocalInfo::LocalInfoImpl(
@@ -362,6 +384,18 @@ void ProcessImpl::createWorkers(const uint32_t concurrency,
       computeFirstWorkerStart(time_system_, scheduled_start, concurrency);
   const std::chrono::nanoseconds inter_worker_delay =
       computeInterWorkerDelay(concurrency, options_.requestsPerSecond());
+  std::vector<PhaseObserver*> phase_observers;
+  if (!options_.cpuProfile().empty() || !options_.heapProfile().empty()) {
+    phase_profiler_ = std::make_unique<PhaseProfiler>(
+        time_system_, concurrency, options_.cpuProfile(), options_.heapProfile(),
+        options_.profileDelay(), options_.profileDuration());
+    phase_observers.push_back(phase_profiler_.get());
+  }
+  if (options_.reportMemoryUsage()) {
+    memory_usage_sampler_ = std::make_unique<MemoryUsageSampler>(time_system_, concurrency,
+                                                                 options_.memorySampleInterval());
+    phase_observers.push_back(memory_usage_sampler_.get());
+  }
   int worker_number = 0;
   while (workers_.size() < concurrency) {
     workers_.push_back(std::make_unique<ClientWorkerImpl>(
@@ -369,7 +403,9 @@ void ProcessImpl::createWorkers(const uint32_t concurrency,
         sequencer_factory_, request_generator_factory_, store_root_, worker_number,
         first_worker_start + (inter_worker_delay * worker_number), http_tracer_,
         options_.simpleWarmup() ? ClientWorkerImpl::HardCodedWarmupStyle::ON
-                                : ClientWorkerImpl::HardCodedWarmupStyle::OFF));
+                                : ClientWorkerImpl::HardCodedWarmupStyle::OFF,
+        options_.perfCounters(), phase_observers,
+        benchmark_client_factory_.sourceAddressesForWorker(worker_number)));
     worker_number++;
   }
 }
@@ -510,6 +546,8 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
     ENVOY_LOG(error, "Scheduled execution date already transpired.");
     return false;
   }
+  nighthawk::client::MemorySample memory_before_start;
+  uint64_t statistics_bytes_before_start = 0;
   {
     auto guard = std::make_unique<Envoy::Thread::LockGuard>(workers_lock_);
     if (cancelled_) {
@@ -574,6 +612,12 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
       flush_worker_->start();
     }
 
+    if (options_.reportMemoryUsage()) {
+      // Everything but the connections and the state of the requests has been set up by now.
+      memory_before_start =
+          memory_usage_sampler_->sample(nighthawk::client::MemorySample::WORKERS_STARTING);
+      statistics_bytes_before_start = workerStatisticsMemoryBytes();
+    }
     for (auto& w : workers_) {
       w->start();
     }
@@ -589,8 +633,20 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
     flush_worker_->waitForCompletion();
   }
 
+  // The typed worker counters are snapshotted by the workers right after their execution completes,
+  // and merged by index below. Counters outside of the typed blocks are obtained by querying the
+  // live counters. To make sure the aggregated numbers line up, we must take care not to shut down
+  // the benchmark clients before we do this, as that will increment certain counters like
+  // connections closed, etc.
+  std::vector<std::map<std::string, uint64_t>> worker_counters(workers_.size());
+  std::map<std::string, uint64_t> counters;
+  mapCountersOutsideWorkerCounterBlocks(worker_counters, counters);
+
   int i = 0;
   std::chrono::nanoseconds total_execution_duration = 0ns;
+  WorkerCounterValues merged_counter_values{};
+  std::vector<nighthawk::client::SlowRequest> slowest_requests;
+  std::map<std::string, uint64_t> merged_perf_counter_values;
   absl::optional<Envoy::SystemTime> first_acquisition_time = absl::nullopt;
 
   for (auto& worker : workers_) {
@@ -607,25 +663,41 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
     // results will be precisely the same.
     if (workers_.size() > 1) {
       StatisticFactoryImpl statistic_factory(options_);
+      addCounters(workerCounterValuesToMap(worker->counterValues()), worker_counters[i]);
+      addPerfCounters(worker->perfCounterValues(), worker->counterValues(), worker_counters[i]);
       collector.addResult(fmt::format("worker_{}", i),
-                          vectorizeStatisticPtrMap(worker->statistics()),
-                          worker->threadLocalCounterValues(), sequencer_execution_duration,
-                          worker_first_acquisition_time);
+                          vectorizeStatisticPtrMap(worker->statistics()), worker_counters[i],
+                          sequencer_execution_duration, worker_first_acquisition_time);
+    }
+    mergeWorkerCounterValues(merged_counter_values, worker->counterValues());
+    for (const auto& perf_counter : worker->perfCounterValues()) {
+      merged_perf_counter_values[perf_counter.first] += perf_counter.second;
+    }
+    for (nighthawk::client::SlowRequest& slow_request : worker->slowestRequests()) {
+      slowest_requests.push_back(std::move(slow_request));
     }
     total_execution_duration += sequencer_execution_duration;
     i++;
   }
 
-  // Note that above we use use counter values snapshotted by the workers right after its
-  // execution completes. Here we query the live counters to get to the global numbers. To make
-  // sure the global aggregated numbers line up, we must take care not to shut down the benchmark
-  // client before we do this, as that will increment certain counters like connections closed,
-  // etc.
-  const auto& counters = Utility().mapCountersFromStore(
-      store_root_, [](absl::string_view, uint64_t value) { return value > 0; });
+  addCounters(workerCounterValuesToMap(merged_counter_values), counters);
+  if (options_.reportMemoryUsage()) {
+    addMemoryUsageCounters(memory_before_start, statistics_bytes_before_start, counters);
+  }
+  addPerfCounters(merged_perf_counter_values, merged_counter_values, counters);
   StatisticFactoryImpl statistic_factory(options_);
   collector.addResult("global", mergeWorkerStatistics(workers_), counters,
                       total_execution_duration / workers_.size(), first_acquisition_time);
+  if (!slowest_requests.empty()) {
+    collector.setSlowestRequests(
+        SlowestRequestTracker::merge(std::move(slowest_requests), options_.slowestRequests()));
+  }
+  if (phase_profiler_ != nullptr) {
+    collector.setProfiles(phase_profiler_->stop());
+  }
+  if (memory_usage_sampler_ != nullptr) {
+    collector.setMemorySamples(memory_usage_sampler_->stop());
+  }
   if (counters.find("sequencer.failed_terminations") == counters.end()) {
     return true;
   } else {
@@ -645,6 +717,115 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
   }
 }
 
+void ProcessImpl::mapCountersOutsideWorkerCounterBlocks(
+    std::vector<std::map<std::string, uint64_t>>& worker_counters,
+    std::map<std::string, uint64_t>& global_counters) const {
+  // The counter blocks have been snapshotted by the workers. Recognizing their counters by address
+  // leaves only the counters outside of them to have their names looked at.
+  absl::flat_hash_set<const Envoy::Stats::Counter*> block_counters;
+  for (const ClientWorkerPtr& worker : workers_) {
+    block_counters.insert(worker->counterBlock().begin(), worker->counterBlock().end());
+  }
+  store_root_.forEachCounter(nullptr, [&](Envoy::Stats::Counter& counter) {
+    const uint64_t value = counter.value();
+    if (value == 0 || block_counters.contains(&counter)) {
+      return;
+    }
+    const std::string name = counter.name();
+    absl::string_view stat_name = name;
+    if (!absl::ConsumePrefix(&stat_name, "cluster.")) {
+      absl::ConsumePrefix(&stat_name, "worker.");
+    }
+    const size_t separator = stat_name.find('.');
+    uint32_t worker_number;
+    if (separator != absl::string_view::npos &&
+        absl::SimpleAtoi(stat_name.substr(0, separator), &worker_number)) {
+      stat_name.remove_prefix(separator + 1);
+      if (worker_number < worker_counters.size()) {
+        worker_counters[worker_number][std::string(stat_name)] += value;
+      }
+    }
+    global_counters[std::string(stat_name)] += value;
+  });
+}
+
+void ProcessImpl::addMemoryUsageCounters(
+    const nighthawk::client::MemorySample& memory_before_start,
+    uint64_t statistics_bytes_before_start, std::map<std::string, uint64_t>& counters) const {
+  const auto growth = [](uint64_t before, uint64_t after) {
+    return after > before ? after - before : 0;
+  };
+  const uint64_t statistics_bytes = workerStatisticsMemoryBytes();
+  counters["memory.statistics_bytes"] = statistics_bytes;
+  uint64_t request_sources_bytes = 0;
+  for (const ClientWorkerPtr& worker : workers_) {
+    request_sources_bytes += worker->requestSourceMemoryBytes();
+  }
+  if (request_sources_bytes > 0) {
+    counters["memory.request_sources_bytes"] = request_sources_bytes;
+  }
+
+  // The workers hold on to their connections until they are shut down, so they are accounted for.
+  const nighthawk::client::MemorySample memory_after_completion =
+      MemoryUsageSampler::currentMemoryUsage();
+  if (memory_before_start.resident_set_size_bytes() == 0 ||
+      memory_after_completion.resident_set_size_bytes() == 0) {
+    ENVOY_LOG(warn, "The resident set size can't be determined on this platform.");
+    return;
+  }
+  const uint64_t rss_growth = growth(memory_before_start.resident_set_size_bytes(),
+                                     memory_after_completion.resident_set_size_bytes());
+  // Connections which were closed along the way freed most of what they held, so only those still
+  // open are counted. The growth also covers what got set up lazily after the baseline, such as
+  // the threads of the workers and the stats created on first use, and the resident set size
+  // doesn't shrink when memory is freed, so the share per connection is an upper bound.
+  uint64_t connections = 0;
+  for (const ClientWorkerPtr& worker : workers_) {
+    connections += worker->openConnections();
+  }
+  counters["memory.rss_growth_bytes"] = rss_growth;
+  if (connections > 0) {
+    counters["memory.rss_growth_bytes_per_connection_upper_bound"] = rss_growth / connections;
+  }
+  ENVOY_LOG(info,
+            "Resident set size grew by {} bytes over the execution, at most {} per open "
+            "connection.",
+            rss_growth, connections > 0 ? rss_growth / connections : 0);
+
+  // Everything the workers allocate over the execution and hold on to until they are shut down is
+  // attributed to the connection pools, except for what the statistics grew by. The allocator
+  // counts live allocations, which is a closer estimate than the resident set size, so that is
+  // used when it reports its statistics.
+  const uint64_t process_growth =
+      memory_before_start.allocated_bytes() > 0
+          ? growth(memory_before_start.allocated_bytes(), memory_after_completion.allocated_bytes())
+          : rss_growth;
+  const uint64_t statistics_growth = growth(statistics_bytes_before_start, statistics_bytes);
+  counters["memory.connection_pools_bytes_estimate"] =
+      process_growth > statistics_growth ? process_growth - statistics_growth : 0;
+}
+
+uint64_t ProcessImpl::workerStatisticsMemoryBytes() const {
+  uint64_t bytes = 0;
+  for (const ClientWorkerPtr& worker : workers_) {
+    for (const auto& statistic : worker->statistics()) {
+      bytes += statistic.second->memoryUsageBytes();
+    }
+  }
+  return bytes;
+}
+
+void ProcessImpl::addPerfCounters(const std::map<std::string, uint64_t>& perf_counter_values,
+                                  const WorkerCounterValues& counter_values,
+                                  std::map<std::string, uint64_t>& counters) const {
+  if (perf_counter_values.empty()) {
+    return;
+  }
+  counters.insert(perf_counter_values.begin(), perf_counter_values.end());
+  PerfEventCounters::addPerRequestCounters(
+      counters, counter_values[static_cast<size_t>(WorkerCounter::UpstreamRqTotal)]);
+}
+
 bool ProcessImpl::run(OutputCollector& collector) {
   UriPtr tracing_uri;
 
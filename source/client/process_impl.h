@@ -40,6 +40,9 @@
 #include "source/client/benchmark_client_impl.h"
 #include "source/client/factories_impl.h"
 #include "source/client/flush_worker_impl.h"
+#include "source/client/memory_usage_sampler.h"
+#include "source/client/phase_profiler.h"
+#include "source/common/tsc_time_system.h"
 
 namespace Nighthawk {
 namespace Client {
@@ -116,6 +119,47 @@ private:
   std::vector<StatisticPtr>
   mergeWorkerStatistics(const std::vector<ClientWorkerPtr>& workers) const;
   void setupForHRTimers();
+  /**
+   * Gets the non-zero counters outside of the typed worker counter blocks, like those of custom
+   * predicates, request classes or the request source and source address clusters, in a single
+   * pass over the store. The counters of the blocks are recognized by address, and skipped. Names
+   * are stripped of their "cluster.<worker>." or "worker.<worker>." prefix, like
+   * Utility::mapCountersFromStore() does.
+   *
+   * @param worker_counters gets the counters of each worker added, indexed by worker number. Must
+   * have an entry for every worker.
+   * @param global_counters gets the counters added, summed over all workers.
+   */
+  void mapCountersOutsideWorkerCounterBlocks(
+      std::vector<std::map<std::string, uint64_t>>& worker_counters,
+      std::map<std::string, uint64_t>& global_counters) const;
+  /**
+   * Adds the growth of the resident set size over the execution to the counters, in total and as
+   * an upper bound per upstream connection left open, along with an estimate of the memory held by
+   * the statistics, the request sources and the connection pools.
+   *
+   * @param memory_before_start the memory usage sampled right before the workers were started.
+   * @param statistics_bytes_before_start the memory held by the statistics of the workers right
+   * before they were started.
+   * @param counters the counters to add the memory usage counters to.
+   */
+  void addMemoryUsageCounters(const nighthawk::client::MemorySample& memory_before_start,
+                              uint64_t statistics_bytes_before_start,
+                              std::map<std::string, uint64_t>& counters) const;
+  /**
+   * @return uint64_t an estimate of the memory held by the statistics of all workers, in bytes.
+   */
+  uint64_t workerStatisticsMemoryBytes() const;
+  /**
+   * Adds perf event counters, and the per request ratios derived from them, to a counter map.
+   *
+   * @param perf_counter_values the perf event counters to add. Nothing gets added when empty.
+   * @param counter_values the worker counters over the same workers as the perf event counters.
+   * @param counters the counters to add the perf event counters to.
+   */
+  void addPerfCounters(const std::map<std::string, uint64_t>& perf_counter_values,
+                       const WorkerCounterValues& counter_values,
+                       std::map<std::string, uint64_t>& counters) const;
   /**
    * If there are sinks configured in bootstrap, populate stats_sinks with sinks
    * created through NighthawkStatsSinkFactory and add them to store_root_.
@@ -167,6 +211,8 @@ private:
   const int number_of_workers_;
   std::shared_ptr<Envoy::ProcessWide> process_wide_;
   Envoy::PlatformImpl platform_impl_;
+  // Set when the TSC clock got requested and is available, in which case time_system_ refers to it.
+  std::unique_ptr<TscTimeSystem> tsc_time_system_;
   Envoy::Event::TimeSystem& time_system_;
   Envoy::Stats::SymbolTableImpl symbol_table_;
   Envoy::Stats::AllocatorImpl stats_allocator_;
@@ -210,6 +256,10 @@ private:
   Envoy::Thread::MutexBasicLockable workers_lock_;
   bool cancelled_{false};
   std::unique_ptr<FlushWorkerImpl> flush_worker_;
+  // Set when profiling the main phase of the workers, which report to it while they run.
+  PhaseProfilerPtr phase_profiler_;
+  // Set when reporting the memory usage, to sample it at the phase boundaries of the workers.
+  MemoryUsageSamplerPtr memory_usage_sampler_;
   Envoy::Router::ContextImpl router_context_;
   // Null server implementation used as a placeholder. Its methods should never get called
   // because Nighthawk is not a full Envoy server that performs xDS config validation.
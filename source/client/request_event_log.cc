@@ -0,0 +1,227 @@
+#include "source/client/request_event_log.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include "nighthawk/common/exception.h"
+
+#include "external/envoy/source/common/common/logger.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+constexpr absl::string_view kMagic = "NHEVLOG1";
+
+absl::string_view outcomeName(RequestOutcome outcome) {
+  switch (outcome) {
+  case RequestOutcome::Success:
+    return "success";
+  case RequestOutcome::StreamReset:
+    return "stream_reset";
+  case RequestOutcome::Timeout:
+    return "timeout";
+  case RequestOutcome::Cancelled:
+    return "cancelled";
+  case RequestOutcome::PoolFailure:
+    return "pool_failure";
+  }
+  return "unknown";
+}
+
+// Returns the time between two points of a record, or zero when either of them wasn't reached.
+int64_t phase(int64_t from_ns, int64_t to_ns) {
+  return from_ns == 0 || to_ns == 0 ? 0 : to_ns - from_ns;
+}
+
+int64_t latency(const RequestEventRecord& record) {
+  return phase(record.start_ns, record.last_byte_ns);
+}
+
+std::string formatMicroseconds(int64_t ns) { return absl::StrFormat("%.3f", ns / 1000.0); }
+
+} // namespace
+
+struct RequestEventLog::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t capacity;
+  // Only written by the owning worker. Readers look at the file after the worker is done.
+  std::atomic<uint64_t> records_written;
+  uint32_t worker_number;
+  char padding[28];
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "The record counter is part of the file format.");
+
+RequestEventLog::RequestEventLog(const std::string& path, uint64_t capacity,
+                                 uint32_t worker_number)
+    : path_(path), capacity_(capacity) {
+  static_assert(sizeof(Header) == HeaderSize, "The header layout is part of the file format.");
+  if (capacity_ == 0) {
+    throw NighthawkException("The capacity of a request event log must be positive.");
+  }
+  mapping_size_ = HeaderSize + capacity_ * sizeof(RequestEventRecord);
+  fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0 || ftruncate(fd_, mapping_size_) != 0) {
+    const int error = errno;
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    throw NighthawkException(
+        fmt::format("Failed to create request event log '{}': {}", path_, strerror(error)));
+  }
+  // Populating the mapping up front keeps page faults out of the measurement.
+  mapping_ =
+      mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+  if (mapping_ == MAP_FAILED) {
+    const int error = errno;
+    close(fd_);
+    throw NighthawkException(
+        fmt::format("Failed to map request event log '{}': {}", path_, strerror(error)));
+  }
+  header_ = new (mapping_) Header();
+  memcpy(header_->magic, kMagic.data(), sizeof(header_->magic));
+  header_->version = Version;
+  header_->record_size = sizeof(RequestEventRecord);
+  header_->capacity = capacity_;
+  header_->records_written.store(0, std::memory_order_relaxed);
+  header_->worker_number = worker_number;
+  records_ = reinterpret_cast<RequestEventRecord*>(static_cast<char*>(mapping_) + HeaderSize);
+}
+
+RequestEventLog::~RequestEventLog() {
+  const uint64_t written = header_->records_written.load(std::memory_order_relaxed);
+  munmap(mapping_, mapping_size_);
+  // Don't leave the unused part of the log behind on disk.
+  if (written < capacity_ && ftruncate(fd_, HeaderSize + written * sizeof(RequestEventRecord))) {
+    ENVOY_LOG_MISC(warn, "Failed to truncate request event log '{}': {}", path_, strerror(errno));
+  }
+  close(fd_);
+}
+
+void RequestEventLog::append(const RequestEventRecord& record) {
+  const uint64_t written = header_->records_written.load(std::memory_order_relaxed);
+  records_[written % capacity_] = record;
+  header_->records_written.store(written + 1, std::memory_order_release);
+}
+
+absl::StatusOr<std::vector<RequestEventRecord>> RequestEventLog::read(const std::string& path) {
+  std::ifstream stream(path, std::ios_base::binary);
+  if (!stream) {
+    return absl::NotFoundError(absl::StrCat("Failed to open request event log '", path, "'."));
+  }
+  char raw_header[HeaderSize];
+  if (!stream.read(raw_header, HeaderSize)) {
+    return absl::InvalidArgumentError(absl::StrCat("'", path, "' is too short for a header."));
+  }
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t capacity;
+  uint64_t written;
+  memcpy(&version, raw_header + offsetof(Header, version), sizeof(version));
+  memcpy(&record_size, raw_header + offsetof(Header, record_size), sizeof(record_size));
+  memcpy(&capacity, raw_header + offsetof(Header, capacity), sizeof(capacity));
+  memcpy(&written, raw_header + offsetof(Header, records_written), sizeof(written));
+  if (absl::string_view(raw_header, kMagic.size()) != kMagic || version != Version ||
+      record_size != sizeof(RequestEventRecord) || capacity == 0) {
+    return absl::InvalidArgumentError(absl::StrCat("'", path, "' isn't a request event log."));
+  }
+  const uint64_t count = std::min(written, capacity);
+  std::vector<RequestEventRecord> records(count);
+  if (count > 0 && !stream.read(reinterpret_cast<char*>(records.data()),
+                                count * sizeof(RequestEventRecord))) {
+    return absl::InvalidArgumentError(absl::StrCat("'", path, "' is truncated."));
+  }
+  // When the log wrapped around, the oldest retained record is where the next one would go.
+  if (written > capacity) {
+    std::rotate(records.begin(), records.begin() + written % capacity, records.end());
+  }
+  return records;
+}
+
+std::string RequestEventLog::formatCsv(const std::vector<RequestEventRecord>& records) {
+  std::string csv = "request_id,request_class,connection_id,intended_start_ns,start_ns,connect_ns,"
+                    "first_byte_ns,last_byte_ns,status,response_bytes,outcome\n";
+  for (const RequestEventRecord& record : records) {
+    absl::StrAppend(&csv, record.request_id, ",", record.request_class, ",", record.connection_id,
+                    ",", record.intended_start_ns, ",", record.start_ns, ",", record.connect_ns,
+                    ",", record.first_byte_ns, ",", record.last_byte_ns, ",", record.status, ",",
+                    record.response_bytes, ",", outcomeName(record.outcome), "\n");
+  }
+  return csv;
+}
+
+std::string RequestEventLog::formatSummary(const std::vector<RequestEventRecord>& records,
+                                           size_t slowest) {
+  std::string summary = absl::StrCat(records.size(), " requests\n");
+  uint64_t outcome_counts[static_cast<uint32_t>(RequestOutcome::PoolFailure) + 1]{};
+  std::vector<const RequestEventRecord*> completed;
+  for (const RequestEventRecord& record : records) {
+    const uint32_t outcome = static_cast<uint32_t>(record.outcome);
+    if (outcome <= static_cast<uint32_t>(RequestOutcome::PoolFailure)) {
+      outcome_counts[outcome]++;
+    }
+    if (record.outcome == RequestOutcome::Success) {
+      completed.push_back(&record);
+    }
+  }
+  for (uint32_t outcome = 0; outcome <= static_cast<uint32_t>(RequestOutcome::PoolFailure);
+       outcome++) {
+    if (outcome_counts[outcome] > 0) {
+      absl::StrAppend(&summary, "  ", outcomeName(static_cast<RequestOutcome>(outcome)), ": ",
+                      outcome_counts[outcome], "\n");
+    }
+  }
+  if (completed.empty()) {
+    return summary;
+  }
+  std::sort(completed.begin(), completed.end(),
+            [](const RequestEventRecord* a, const RequestEventRecord* b) {
+              return latency(*a) > latency(*b);
+            });
+  absl::StrAppend(&summary, "Latency of successful requests (us):\n");
+  for (const double percentile : {0.5, 0.9, 0.99, 0.999, 1.0}) {
+    // Nearest rank, counting from the end as the records are sorted from slow to fast.
+    const size_t rank = std::clamp<size_t>(std::ceil(percentile * completed.size()), 1,
+                                           completed.size());
+    const size_t index = completed.size() - rank;
+    absl::StrAppend(&summary, absl::StrFormat("  p%-6g %s\n", percentile * 100,
+                                              formatMicroseconds(latency(*completed[index]))));
+  }
+  absl::StrAppend(&summary, "Slowest successful requests (us):\n",
+                  absl::StrFormat("  %10s %6s %10s %12s %12s %12s %12s %12s\n", "request_id",
+                                  "class", "connection", "scheduling", "queueing", "first_byte",
+                                  "body", "total"));
+  for (size_t i = 0; i < std::min(slowest, completed.size()); i++) {
+    const RequestEventRecord& record = *completed[i];
+    absl::StrAppend(
+        &summary,
+        absl::StrFormat("  %10d %6d %10d %12s %12s %12s %12s %12s\n", record.request_id,
+                        record.request_class, record.connection_id,
+                        formatMicroseconds(phase(record.intended_start_ns, record.start_ns)),
+                        formatMicroseconds(phase(record.start_ns, record.connect_ns)),
+                        formatMicroseconds(phase(record.connect_ns, record.first_byte_ns)),
+                        formatMicroseconds(phase(record.first_byte_ns, record.last_byte_ns)),
+                        formatMicroseconds(latency(record))));
+  }
+  return summary;
+}
+
+} // namespace Client
+} // namespace Nighthawk
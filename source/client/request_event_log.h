@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * How a request ended, as recorded in the request event log.
+ */
+enum class RequestOutcome : uint32_t {
+  // A complete response was received.
+  Success = 0,
+  // The stream got reset before the response was complete.
+  StreamReset = 1,
+  // The request got abandoned because it exceeded its timeout.
+  Timeout = 2,
+  // The request got abandoned, for example because another attempt won.
+  Cancelled = 3,
+  // The connection pool couldn't provide a connection.
+  PoolFailure = 4,
+};
+
+/**
+ * Fixed-size record of a single request in the request event log. Times are in nanoseconds of the
+ * monotonic clock of the process, and are zero when the request didn't get to that point.
+ */
+struct RequestEventRecord {
+  // Sequence number of the request within the log of its worker.
+  uint64_t request_id;
+  // Index of the class of the request, as reported by the request source.
+  uint32_t request_class;
+  // The response code, or zero when no response headers were received.
+  uint32_t status;
+  // Id of the upstream connection the request was sent on, or zero when it didn't get one.
+  uint64_t connection_id;
+  // When the request was due to start: when the sequencer released it, or when the sequencer first
+  // tried to start it and the client had no room for it.
+  int64_t intended_start_ns;
+  // When the request was handed to the connection pool.
+  int64_t start_ns;
+  // When the request got a stream on a connection and was sent.
+  int64_t connect_ns;
+  // When the response headers were received.
+  int64_t first_byte_ns;
+  // When the request completed.
+  int64_t last_byte_ns;
+  // The number of response body bytes received.
+  uint64_t response_bytes;
+  RequestOutcome outcome;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(RequestEventRecord) == 80, "The record layout is part of the file format.");
+
+/**
+ * Appends request records to a file which is memory mapped up front, so recording a request
+ * amounts to copying the record into the mapping: no allocations, locks or system calls. Each
+ * worker owns a log of its own. The file has a fixed capacity. When it is exhausted, the log wraps
+ * around and overwrites the oldest records, which bounds both the memory and the disk footprint.
+ *
+ * The file starts with a 64 byte header, followed by the records:
+ * - magic "NHEVLOG1" (8 bytes)
+ * - format version, record size (uint32 each)
+ * - capacity in records, number of records appended (uint64 each)
+ * - worker number (uint32), followed by padding.
+ */
+class RequestEventLog {
+public:
+  static constexpr uint32_t Version = 1;
+  static constexpr size_t HeaderSize = 64;
+
+  /**
+   * Creates the log file, replacing any existing file at the path.
+   *
+   * @param path the path of the log file.
+   * @param capacity the number of records the log holds before it wraps around.
+   * @param worker_number the worker that owns the log, recorded in the header.
+   * @throws NighthawkException when the file can't be created or mapped.
+   */
+  RequestEventLog(const std::string& path, uint64_t capacity, uint32_t worker_number);
+  ~RequestEventLog();
+
+  /**
+   * @return uint64_t the id for the next request, unique within this log.
+   */
+  uint64_t nextRequestId() { return next_request_id_++; }
+
+  /**
+   * Appends a record, overwriting the oldest record when the log is full.
+   * @param record the record to append.
+   */
+  void append(const RequestEventRecord& record);
+
+  /**
+   * Reads a log file written by RequestEventLog.
+   *
+   * @param path the path of the log file.
+   * @return absl::StatusOr<std::vector<RequestEventRecord>> the records in the order they were
+   * appended, which only includes the most recent ones when the log wrapped around. An error when
+   * the file can't be read or isn't a request event log.
+   */
+  static absl::StatusOr<std::vector<RequestEventRecord>> read(const std::string& path);
+
+  /**
+   * @param records the records to format.
+   * @return std::string the records as comma separated values, with a header line.
+   */
+  static std::string formatCsv(const std::vector<RequestEventRecord>& records);
+
+  /**
+   * @param records the records to summarize.
+   * @param slowest the number of slowest requests to list.
+   * @return std::string a human readable summary: the outcomes, the latency percentiles, and the
+   * slowest requests with the time they spent in each phase.
+   */
+  static std::string formatSummary(const std::vector<RequestEventRecord>& records,
+                                   size_t slowest);
+
+private:
+  struct Header;
+
+  const std::string path_;
+  const uint64_t capacity_;
+  int fd_{-1};
+  void* mapping_{};
+  size_t mapping_size_{};
+  Header* header_{};
+  RequestEventRecord* records_{};
+  uint64_t next_request_id_{};
+};
+
+using RequestEventLogPtr = std::unique_ptr<RequestEventLog>;
+
+} // namespace Client
+} // namespace Nighthawk
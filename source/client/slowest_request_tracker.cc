@@ -0,0 +1,65 @@
+#include "source/client/slowest_request_tracker.h"
+
+#include <google/protobuf/util/time_util.h>
+
+#include <algorithm>
+
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+namespace Nighthawk {
+namespace Client {
+
+SlowestRequestTracker::SlowestRequestTracker(uint32_t capacity, uint32_t worker_number,
+                                             const std::vector<std::string>& header_names)
+    : capacity_(capacity), worker_number_(worker_number) {
+  for (const std::string& header_name : header_names) {
+    header_names_.emplace_back(header_name);
+  }
+  heap_.reserve(capacity_);
+}
+
+void SlowestRequestTracker::add(uint64_t latency_ns, nighthawk::client::SlowRequest&& request) {
+  if (!qualifies(latency_ns)) {
+    return;
+  }
+  if (heap_.size() == capacity_) {
+    std::pop_heap(heap_.begin(), heap_.end(), fasterThan);
+    heap_.pop_back();
+  }
+  request.set_worker(worker_number_);
+  *request.mutable_latency() =
+      Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(latency_ns);
+  heap_.push_back({latency_ns, std::move(request)});
+  std::push_heap(heap_.begin(), heap_.end(), fasterThan);
+}
+
+std::vector<nighthawk::client::SlowRequest> SlowestRequestTracker::slowestRequests() const {
+  std::vector<Entry> entries = heap_;
+  std::sort_heap(entries.begin(), entries.end(), fasterThan);
+  std::vector<nighthawk::client::SlowRequest> requests;
+  requests.reserve(entries.size());
+  for (Entry& entry : entries) {
+    requests.push_back(std::move(entry.request));
+  }
+  return requests;
+}
+
+std::vector<nighthawk::client::SlowRequest>
+SlowestRequestTracker::merge(std::vector<nighthawk::client::SlowRequest> requests,
+                             uint32_t capacity) {
+  const auto slower = [](const nighthawk::client::SlowRequest& a,
+                         const nighthawk::client::SlowRequest& b) {
+    return Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(a.latency()) >
+           Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(b.latency());
+  };
+  if (requests.size() > capacity) {
+    std::partial_sort(requests.begin(), requests.begin() + capacity, requests.end(), slower);
+    requests.resize(capacity);
+  } else {
+    std::sort(requests.begin(), requests.end(), slower);
+  }
+  return requests;
+}
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/http/header_map.h"
+
+#include "api/client/output.pb.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Retains the details of the slowest requests of a worker. The retained requests are kept in a
+ * min-heap keyed by latency, so the fastest of them is the threshold a new request has to beat.
+ * Checking the threshold is cheap, and only requests that beat it have their details collected.
+ * Not thread safe: each worker owns a tracker of its own.
+ */
+class SlowestRequestTracker {
+public:
+  /**
+   * @param capacity the number of requests to retain.
+   * @param worker_number the worker that owns the tracker, recorded with each request.
+   * @param header_names names of the request and response headers to record with each request.
+   */
+  SlowestRequestTracker(uint32_t capacity, uint32_t worker_number,
+                        const std::vector<std::string>& header_names);
+
+  /**
+   * @param latency_ns the latency of a completed request.
+   * @return bool true when the request is slow enough to be retained, in which case it should be
+   * passed to add().
+   */
+  bool qualifies(uint64_t latency_ns) const {
+    return heap_.size() < capacity_ || (capacity_ > 0 && latency_ns > heap_.front().latency_ns);
+  }
+
+  /**
+   * Retains a request, evicting the fastest retained request when at capacity. Requests that don't
+   * qualify are ignored.
+   *
+   * @param latency_ns the latency of the request.
+   * @param request the details of the request. The worker and latency get filled in.
+   */
+  void add(uint64_t latency_ns, nighthawk::client::SlowRequest&& request);
+
+  /**
+   * @return const std::vector<Envoy::Http::LowerCaseString>& the names of the headers to record.
+   */
+  const std::vector<Envoy::Http::LowerCaseString>& headerNames() const { return header_names_; }
+
+  /**
+   * @return std::vector<nighthawk::client::SlowRequest> the retained requests, slowest first.
+   */
+  std::vector<nighthawk::client::SlowRequest> slowestRequests() const;
+
+  /**
+   * Merges the slowest requests of several workers.
+   *
+   * @param requests the requests to merge.
+   * @param capacity the number of requests to retain.
+   * @return std::vector<nighthawk::client::SlowRequest> the slowest of the requests, slowest
+   * first.
+   */
+  static std::vector<nighthawk::client::SlowRequest>
+  merge(std::vector<nighthawk::client::SlowRequest> requests, uint32_t capacity);
+
+private:
+  struct Entry {
+    uint64_t latency_ns;
+    nighthawk::client::SlowRequest request;
+  };
+  // Orders the heap such that the fastest retained request is on top.
+  static bool fasterThan(const Entry& a, const Entry& b) { return a.latency_ns > b.latency_ns; }
+
+  const uint32_t capacity_;
+  const uint32_t worker_number_;
+  std::vector<Envoy::Http::LowerCaseString> header_names_;
+  std::vector<Entry> heap_;
+};
+
+using SlowestRequestTrackerPtr = std::unique_ptr<SlowestRequestTracker>;
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,213 @@
+#include "source/client/socket_timestamping_transport_socket.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+
+// The kernel headers rely on the definitions of the C library headers above.
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+#include <cerrno>
+
+#include "envoy/registry/registry.h"
+
+#include "external/envoy/source/common/common/logger.h"
+#include "external/envoy/source/common/common/macros.h"
+
+#include "api/client/options.pb.h"
+
+#include "absl/container/inlined_vector.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+constexpr int kTimestampingFlags = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE |
+                                   SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_OPT_ID |
+                                   SOF_TIMESTAMPING_OPT_TSONLY;
+
+// Large enough for the timestamping and extended error control messages of a single message.
+constexpr size_t kControlBufferSize = 512;
+
+Envoy::SystemTime toSystemTime(const timespec& ts) {
+  return Envoy::SystemTime(std::chrono::duration_cast<Envoy::SystemTime::duration>(
+      std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+}
+
+// Returns the software timestamp carried by the control messages, if any.
+absl::optional<Envoy::SystemTime> softwareTimestamp(msghdr& msg) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+      const auto* timestamps = reinterpret_cast<const scm_timestamping*>(CMSG_DATA(cmsg));
+      if (timestamps->ts[0].tv_sec != 0 || timestamps->ts[0].tv_nsec != 0) {
+        return toSystemTime(timestamps->ts[0]);
+      }
+    }
+  }
+  return absl::nullopt;
+}
+
+// Returns the transmit timestamp report carried by the control messages of a message read from
+// the error queue, if any.
+const sock_extended_err* transmitTimestampReport(msghdr& msg) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+        (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+      const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (error->ee_errno == ENOMSG && error->ee_origin == SO_EE_ORIGIN_TIMESTAMPING &&
+          error->ee_info == SCM_TSTAMP_SND) {
+        return error;
+      }
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+const std::string& ConnectionWireTimestamps::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "nighthawk.socket_timestamping.wire_timestamps");
+}
+
+void SocketTimestampingTransportSocket::setTransportSocketCallbacks(
+    Envoy::Network::TransportSocketCallbacks& callbacks) {
+  callbacks_ = &callbacks;
+  callbacks.connection().streamInfo().filterState()->setData(
+      ConnectionWireTimestamps::key(), wire_timestamps_,
+      Envoy::StreamInfo::FilterState::StateType::ReadOnly,
+      Envoy::StreamInfo::FilterState::LifeSpan::Connection);
+  RawBufferSocket::setTransportSocketCallbacks(callbacks);
+}
+
+void SocketTimestampingTransportSocket::onConnected() {
+  // The kernel keys transmit timestamps by the offset of the last byte of a send, counted from the
+  // moment timestamping gets enabled. Enabling it before anything is written makes that offset
+  // match bytes_written_.
+  const int flags = kTimestampingFlags;
+  timestamping_enabled_ = setsockopt(callbacks_->ioHandle().fdDoNotUse(), SOL_SOCKET,
+                                     SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+  if (!timestamping_enabled_) {
+    ENVOY_LOG_MISC(warn, "Failed to enable SO_TIMESTAMPING on an upstream socket: errno {}.",
+                   errno);
+  }
+  RawBufferSocket::onConnected();
+}
+
+Envoy::Network::IoResult SocketTimestampingTransportSocket::doWrite(Envoy::Buffer::Instance& buffer,
+                                                                   bool end_stream) {
+  const Envoy::Network::IoResult result = RawBufferSocket::doWrite(buffer, end_stream);
+  if (timestamping_enabled_ && result.bytes_processed_ > 0 && !writing_request_) {
+    writing_request_ = true;
+    request_timestamp_key_ = bytes_written_ + result.bytes_processed_ - 1;
+    request_sent_.reset();
+    response_received_.reset();
+  }
+  bytes_written_ += result.bytes_processed_;
+  return result;
+}
+
+void SocketTimestampingTransportSocket::drainErrorQueue() {
+  const int fd = callbacks_->ioHandle().fdDoNotUse();
+  char control[kControlBufferSize];
+  while (true) {
+    msghdr msg{};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    const sock_extended_err* report = transmitTimestampReport(msg);
+    if (report != nullptr && report->ee_data == static_cast<uint32_t>(request_timestamp_key_)) {
+      request_sent_ = softwareTimestamp(msg);
+    }
+  }
+}
+
+Envoy::Network::IoResult
+SocketTimestampingTransportSocket::doRead(Envoy::Buffer::Instance& buffer) {
+  if (!timestamping_enabled_) {
+    return RawBufferSocket::doRead(buffer);
+  }
+  // Transmit timestamps are generated before the request reaches the peer, so the timestamp of the
+  // request is in the error queue by the time its response can be read.
+  drainErrorQueue();
+  const int fd = callbacks_->ioHandle().fdDoNotUse();
+  Envoy::Network::PostIoAction action = Envoy::Network::PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  char control[kControlBufferSize];
+  while (true) {
+    Envoy::Buffer::Reservation reservation = buffer.reserveForRead();
+    absl::InlinedVector<iovec, 8> iov(reservation.numSlices());
+    for (uint64_t i = 0; i < reservation.numSlices(); i++) {
+      iov[i] = {reservation.slices()[i].mem_, reservation.slices()[i].len_};
+    }
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = iov.size();
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    const ssize_t rc = recvmsg(fd, &msg, MSG_DONTWAIT);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        action = Envoy::Network::PostIoAction::Close;
+      }
+      break;
+    }
+    if (rc == 0) {
+      end_stream = true;
+      break;
+    }
+    if (writing_request_) {
+      writing_request_ = false;
+      response_received_ = softwareTimestamp(msg);
+    }
+    reservation.commit(rc);
+    bytes_read += rc;
+    if (callbacks_->shouldDrainReadBuffer()) {
+      callbacks_->setTransportSocketIsReadable();
+      break;
+    }
+  }
+  absl::optional<WireTimestamps>& current_exchange = wire_timestamps_->current_exchange_;
+  if (request_sent_.has_value() && response_received_.has_value()) {
+    current_exchange = WireTimestamps{request_sent_.value(), response_received_.value()};
+  } else {
+    current_exchange.reset();
+  }
+  return {action, bytes_read, end_stream};
+}
+
+Envoy::Network::TransportSocketPtr SocketTimestampingTransportSocketFactory::createTransportSocket(
+    Envoy::Network::TransportSocketOptionsConstSharedPtr,
+    Envoy::Upstream::HostDescriptionConstSharedPtr) const {
+  return std::make_unique<SocketTimestampingTransportSocket>();
+}
+
+std::string SocketTimestampingTransportSocketConfigFactory::name() const {
+  return "nighthawk.transport_sockets.socket_timestamping";
+}
+
+Envoy::ProtobufTypes::MessagePtr
+SocketTimestampingTransportSocketConfigFactory::createEmptyConfigProto() {
+  return std::make_unique<nighthawk::client::SocketTimestampingConfig>();
+}
+
+Envoy::Network::UpstreamTransportSocketFactoryPtr
+SocketTimestampingTransportSocketConfigFactory::createTransportSocketFactory(
+    const Envoy::Protobuf::Message&, Envoy::Server::Configuration::TransportSocketFactoryContext&) {
+  return std::make_unique<SocketTimestampingTransportSocketFactory>();
+}
+
+REGISTER_FACTORY(SocketTimestampingTransportSocketConfigFactory,
+                 Envoy::Server::Configuration::UpstreamTransportSocketConfigFactory);
+
+} // namespace Client
+} // namespace Nighthawk
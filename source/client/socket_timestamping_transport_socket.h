@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/stream_info/filter_state.h"
+
+#include "external/envoy/source/common/network/raw_buffer_socket.h"
+
+#include "absl/types/optional.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Kernel timestamps of a single request/response exchange on a connection. The timestamps are taken
+ * from the system clock by the kernel, so only their difference is meaningful.
+ */
+struct WireTimestamps {
+  // When the first send of the request was handed to the network device.
+  Envoy::SystemTime request_sent;
+  // When the first bytes of the response were received from the network device.
+  Envoy::SystemTime response_received;
+
+  std::chrono::nanoseconds wireLatency() const { return response_received - request_sent; }
+};
+
+/**
+ * Wire timestamps of the current exchange of a connection. The transport socket publishes them in
+ * the filter state of its connection under key(), where the stream decoders of the connection look
+ * them up when the connection pool hands them the connection.
+ */
+class ConnectionWireTimestamps : public Envoy::StreamInfo::FilterState::Object {
+public:
+  /**
+   * @return const std::string& the filter state key the timestamps are published under.
+   */
+  static const std::string& key();
+
+  /**
+   * @return const absl::optional<WireTimestamps>& the timestamps of the current exchange, as of
+   * the most recent read of the connection. Response decoding happens right after the read that
+   * delivered the data, so a decoder finds the timestamps of its own request here. Not set when the
+   * timestamps of the exchange weren't (all) reported.
+   */
+  const absl::optional<WireTimestamps>& currentExchange() const { return current_exchange_; }
+
+private:
+  friend class SocketTimestampingTransportSocket;
+
+  absl::optional<WireTimestamps> current_exchange_;
+};
+
+/**
+ * Plaintext transport socket which enables SO_TIMESTAMPING software timestamps on its socket, and
+ * reads them back for every request/response exchange. Exchanges are delimited by the direction
+ * of the traffic: the first write after reading a response starts the next exchange. That matches
+ * HTTP/1, where a connection has a single request in flight.
+ *
+ * The transmit timestamp of the first write of an exchange is read from the socket error queue,
+ * the receive timestamp of the first read of the response is read from the control messages
+ * accompanying the data. Data is received straight into a reservation of the read buffer, so the
+ * socket needs no buffer of its own.
+ */
+class SocketTimestampingTransportSocket : public Envoy::Network::RawBufferSocket {
+public:
+  // Envoy::Network::TransportSocket
+  void setTransportSocketCallbacks(Envoy::Network::TransportSocketCallbacks& callbacks) override;
+  void onConnected() override;
+  Envoy::Network::IoResult doRead(Envoy::Buffer::Instance& buffer) override;
+  Envoy::Network::IoResult doWrite(Envoy::Buffer::Instance& buffer, bool end_stream) override;
+
+  /**
+   * @return const absl::optional<WireTimestamps>& the timestamps of the current exchange, as of the
+   * most recent read. See ConnectionWireTimestamps::currentExchange().
+   */
+  const absl::optional<WireTimestamps>& currentExchange() const {
+    return wire_timestamps_->currentExchange();
+  }
+
+private:
+  void drainErrorQueue();
+
+  Envoy::Network::TransportSocketCallbacks* callbacks_{};
+  // Whether timestamping could be enabled on the socket.
+  bool timestamping_enabled_{};
+  // Total number of bytes written, which is what the kernel keys transmit timestamps by.
+  uint64_t bytes_written_{};
+  // Set while writing a request, cleared when the response starts coming in.
+  bool writing_request_{};
+  // Key of the transmit timestamp of the first write of the current exchange.
+  uint64_t request_timestamp_key_{};
+  absl::optional<Envoy::SystemTime> request_sent_;
+  absl::optional<Envoy::SystemTime> response_received_;
+  // Shared with the filter state of the connection.
+  const std::shared_ptr<ConnectionWireTimestamps> wire_timestamps_{
+      std::make_shared<ConnectionWireTimestamps>()};
+};
+
+/**
+ * Creates SocketTimestampingTransportSocket instances for upstream connections.
+ */
+class SocketTimestampingTransportSocketFactory : public Envoy::Network::RawBufferSocketFactory {
+public:
+  // Envoy::Network::UpstreamTransportSocketFactory
+  Envoy::Network::TransportSocketPtr
+  createTransportSocket(Envoy::Network::TransportSocketOptionsConstSharedPtr options,
+                        Envoy::Upstream::HostDescriptionConstSharedPtr host) const override;
+};
+
+/**
+ * Registers the "nighthawk.transport_sockets.socket_timestamping" upstream transport socket.
+ */
+class SocketTimestampingTransportSocketConfigFactory
+    : public Envoy::Server::Configuration::UpstreamTransportSocketConfigFactory {
+public:
+  std::string name() const override;
+  Envoy::ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+  Envoy::Network::UpstreamTransportSocketFactoryPtr createTransportSocketFactory(
+      const Envoy::Protobuf::Message& config,
+      Envoy::Server::Configuration::TransportSocketFactoryContext& context) override;
+};
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,135 @@
+#include "source/client/source_address_utility.h"
+
+#include <arpa/inet.h>
+
+#include "nighthawk/common/exception.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/int128.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "fmt/format.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+std::string ipv4ToString(uint32_t value) {
+  in_addr address;
+  address.s_addr = htonl(value);
+  char buffer[INET_ADDRSTRLEN];
+  return inet_ntop(AF_INET, &address, buffer, sizeof(buffer));
+}
+
+std::string ipv6ToString(absl::uint128 value) {
+  in6_addr address;
+  for (int i = 15; i >= 0; i--) {
+    address.s6_addr[i] = static_cast<uint8_t>(absl::Uint128Low64(value) & 0xff);
+    value >>= 8;
+  }
+  char buffer[INET6_ADDRSTRLEN];
+  return inet_ntop(AF_INET6, &address, buffer, sizeof(buffer));
+}
+
+// Appends the addresses in the range to the output, in ascending order. The network portion of
+// the address is used as the first address of the range.
+void appendRange(const std::string& spec, const std::string& address, uint32_t host_bits,
+                 bool is_v6, std::vector<std::string>& output) {
+  const uint64_t range_size = uint64_t(1) << host_bits;
+  if (is_v6) {
+    in6_addr parsed;
+    if (inet_pton(AF_INET6, address.c_str(), &parsed) != 1) {
+      throw NighthawkException(fmt::format("Invalid source address '{}'", spec));
+    }
+    absl::uint128 network = 0;
+    for (const uint8_t byte : parsed.s6_addr) {
+      network = (network << 8) | byte;
+    }
+    network &= ~((absl::uint128(1) << host_bits) - 1);
+    for (uint64_t i = 0; i < range_size; i++) {
+      output.push_back(ipv6ToString(network + i));
+    }
+  } else {
+    in_addr parsed;
+    if (inet_pton(AF_INET, address.c_str(), &parsed) != 1) {
+      throw NighthawkException(fmt::format("Invalid source address '{}'", spec));
+    }
+    const uint32_t network =
+        ntohl(parsed.s_addr) & ~static_cast<uint32_t>((uint64_t(1) << host_bits) - 1);
+    for (uint64_t i = 0; i < range_size; i++) {
+      output.push_back(ipv4ToString(network + static_cast<uint32_t>(i)));
+    }
+  }
+}
+
+} // namespace
+
+std::vector<std::string>
+SourceAddressUtility::expandSourceAddresses(const std::vector<std::string>& specs) {
+  std::vector<std::string> addresses;
+  absl::flat_hash_set<std::string> seen;
+  bool first_is_v6 = false;
+  for (const std::string& spec : specs) {
+    const std::vector<absl::string_view> parts = absl::StrSplit(spec, absl::MaxSplits('/', 1));
+    const std::string address(parts[0]);
+    const bool is_v6 = address.find(':') != std::string::npos;
+    if (addresses.empty()) {
+      first_is_v6 = is_v6;
+    } else if (is_v6 != first_is_v6) {
+      throw NighthawkException("Source addresses must all be of the same address family");
+    }
+    const uint32_t max_prefix_length = is_v6 ? 128 : 32;
+    uint32_t prefix_length = max_prefix_length;
+    if (parts.size() == 2 &&
+        (!absl::SimpleAtoi(parts[1], &prefix_length) || prefix_length > max_prefix_length)) {
+      throw NighthawkException(fmt::format("Invalid prefix length in source address '{}'", spec));
+    }
+    // Check the size before expanding, so huge ranges are rejected without allocating them.
+    const uint32_t host_bits = max_prefix_length - prefix_length;
+    if (host_bits > 16 || addresses.size() + (uint64_t(1) << host_bits) > MaxSourceAddresses) {
+      throw NighthawkException(fmt::format(
+          "Source addresses expand to more than the supported maximum of {} addresses",
+          MaxSourceAddresses));
+    }
+    const size_t first_new = addresses.size();
+    appendRange(spec, address, host_bits, is_v6, addresses);
+    for (size_t i = first_new; i < addresses.size(); i++) {
+      if (!seen.insert(addresses[i]).second) {
+        throw NighthawkException(
+            fmt::format("Source address '{}' is specified more than once", addresses[i]));
+      }
+    }
+  }
+  return addresses;
+}
+
+std::vector<std::string>
+SourceAddressUtility::sourceAddressesForWorker(const std::vector<std::string>& addresses,
+                                               uint32_t worker_number,
+                                               uint32_t number_of_workers) {
+  std::vector<std::string> worker_addresses;
+  if (addresses.empty()) {
+    return worker_addresses;
+  }
+  if (addresses.size() < number_of_workers) {
+    worker_addresses.push_back(addresses[worker_number % addresses.size()]);
+    return worker_addresses;
+  }
+  for (size_t i = worker_number; i < addresses.size(); i += number_of_workers) {
+    worker_addresses.push_back(addresses[i]);
+  }
+  return worker_addresses;
+}
+
+std::string SourceAddressUtility::clusterName(uint32_t worker_number, size_t index) {
+  return fmt::format("{}.source_{}", worker_number, index);
+}
+
+std::string SourceAddressUtility::statName(uint32_t worker_number, absl::string_view address) {
+  return fmt::format("{}.source.{}", worker_number,
+                     absl::StrReplaceAll(address, {{".", "_"}, {":", "_"}}));
+}
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Helpers for spreading upstream connections over multiple local source addresses. Each source
+ * address gets its own cluster per worker, as Envoy binds the source address per cluster. This
+ * multiplies the number of ephemeral ports available for connecting to a single destination.
+ */
+class SourceAddressUtility {
+public:
+  // The maximum number of source addresses a configuration may expand to.
+  static constexpr uint64_t MaxSourceAddresses = 65536;
+
+  /**
+   * Expands source address specifications into individual addresses.
+   *
+   * @param specs IPv4 or IPv6 addresses, or CIDR ranges like "10.0.0.0/24". A range expands to
+   * every address it contains, including its network and broadcast addresses. All entries must be
+   * of the same address family.
+   * @return std::vector<std::string> the addresses in the order they were specified. Throws
+   * NighthawkException when a specification is malformed, when the address families are mixed,
+   * when an address is specified more than once, or when the specifications expand to more than
+   * MaxSourceAddresses addresses.
+   */
+  static std::vector<std::string> expandSourceAddresses(const std::vector<std::string>& specs);
+
+  /**
+   * Partitions the source addresses over the workers. When there are at least as many addresses as
+   * workers, each address is used by a single worker. Otherwise the workers share the addresses
+   * round robin.
+   *
+   * @param addresses the expanded source addresses.
+   * @param worker_number the worker to get the addresses for.
+   * @param number_of_workers the total number of workers.
+   * @return std::vector<std::string> the addresses the worker should bind its connections to.
+   * Empty iff no addresses were passed.
+   */
+  static std::vector<std::string>
+  sourceAddressesForWorker(const std::vector<std::string>& addresses, uint32_t worker_number,
+                           uint32_t number_of_workers);
+
+  /**
+   * @param worker_number the worker that owns the cluster.
+   * @param index the index of the source address in the addresses of the worker.
+   * @return std::string the name of the cluster binding connections to the source address.
+   */
+  static std::string clusterName(uint32_t worker_number, size_t index);
+
+  /**
+   * @param worker_number the worker that owns the cluster.
+   * @param address the source address the cluster binds connections to.
+   * @return std::string the stat name of the cluster. Cluster stats end up being reported as
+   * "source.<address>.<stat>", with dots and colons in the address replaced by underscores.
+   */
+  static std::string statName(uint32_t worker_number, absl::string_view address);
+};
+
+} // namespace Client
+} // namespace Nighthawk
@@ -1,5 +1,8 @@
 #include "source/client/stream_decoder.h"
 
+#include <google/protobuf/util/time_util.h>
+
+#include <algorithm>
 #include <memory>
 
 #include "external/envoy/source/common/http/http1/codec_impl.h"
@@ -8,9 +11,46 @@
 #include "external/envoy/source/common/stream_info/stream_info_impl.h"
 #include "external/envoy/source/extensions/request_id/uuid/config.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Nighthawk {
 namespace Client {
 
+RequestClassStatistic::RequestClassStatistic(Envoy::Stats::Scope& parent_scope,
+                                             absl::string_view name, StatisticPtr&& response_stat,
+                                             StatisticPtr&& response_body_size_stat)
+    : scope(parent_scope.createScope(absl::StrCat("benchmark.class.", name, "."))),
+      response_statistic(std::move(response_stat)),
+      response_body_size_statistic(std::move(response_body_size_stat)),
+      counters({ALL_REQUEST_CLASS_COUNTERS(POOL_COUNTER(*scope))}) {
+  response_statistic->setId(
+      absl::StrCat("benchmark_http_client.class_", name, ".request_to_response"));
+  response_body_size_statistic->setId(
+      absl::StrCat("benchmark_http_client.class_", name, ".response_body_size"));
+}
+
+void RequestClassStatistic::recordCompletion(bool success,
+                                             absl::optional<uint32_t> response_code) {
+  if (!success) {
+    counters.stream_resets_.inc();
+    return;
+  }
+  const uint32_t status = response_code.value_or(0);
+  if (status > 99 && status <= 199) {
+    counters.http_1xx_.inc();
+  } else if (status > 199 && status <= 299) {
+    counters.http_2xx_.inc();
+  } else if (status > 299 && status <= 399) {
+    counters.http_3xx_.inc();
+  } else if (status > 399 && status <= 499) {
+    counters.http_4xx_.inc();
+  } else if (status > 499 && status <= 599) {
+    counters.http_5xx_.inc();
+  } else {
+    counters.http_xxx_.inc();
+  }
+}
+
 void StreamDecoder::decodeHeaders(Envoy::Http::ResponseHeaderMapPtr&& headers, bool end_stream) {
   ASSERT(!complete_);
   stream_info_.upstreamInfo()->upstreamTiming().onFirstUpstreamRxByteReceived(time_source_);
@@ -19,6 +59,12 @@ void StreamDecoder::decodeHeaders(Envoy::Http::ResponseHeaderMapPtr&& headers, b
   response_header_sizes_statistic_.addValue(response_headers_->byteSize());
   const uint64_t response_code = Envoy::Http::Utility::getResponseStatus(*response_headers_);
   stream_info_.response_code_ = static_cast<uint32_t>(response_code);
+  if (request_event_log_ != nullptr) {
+    request_event_.first_byte_ns = nanoseconds(time_source_.monotonicTime());
+  }
+  if (wire_latency_statistic_ != nullptr && measure_latencies_) {
+    recordWireLatency();
+  }
   if (!latency_response_header_name_.empty()) {
     const auto timing_header_name = Envoy::Http::LowerCaseString(latency_response_header_name_);
     const Envoy::Http::HeaderMap::GetResult& timing_header =
@@ -40,12 +86,38 @@ void StreamDecoder::decodeHeaders(Envoy::Http::ResponseHeaderMapPtr&& headers, b
   }
 }
 
+void StreamDecoder::recordWireLatency() {
+  if (wire_timestamps_ == nullptr) {
+    return;
+  }
+  // The response headers are decoded right after the read that delivered them, so the current
+  // exchange of the connection is the one of this request.
+  const absl::optional<WireTimestamps>& exchange = wire_timestamps_->currentExchange();
+  if (!exchange.has_value() || exchange->wireLatency().count() < 0) {
+    return;
+  }
+  const std::chrono::nanoseconds latency = time_source_.monotonicTime() - request_start_;
+  const std::chrono::nanoseconds wire_latency = exchange->wireLatency();
+  wire_latency_statistic_->addValue(wire_latency.count());
+  client_overhead_statistic_->addValue(
+      latency > wire_latency ? (latency - wire_latency).count() : 0);
+}
+
 void StreamDecoder::decodeData(Envoy::Buffer::Instance& data, bool end_stream) {
   ASSERT(!complete_);
   complete_ = end_stream;
   // This will show up in the zipkin UI as 'response_size'. In Envoy this tracks bytes send by Envoy
   // to the downstream.
   stream_info_.addBytesSent(data.length());
+  if (response_observer_ != nullptr) {
+    const uint64_t retained = response_body_prefix_.size();
+    const uint64_t to_retain =
+        std::min<uint64_t>(data.length(), response_observer_->maxResponseBodyBytes() - retained);
+    if (to_retain > 0) {
+      response_body_prefix_.resize(retained + to_retain);
+      data.copyOut(0, to_retain, response_body_prefix_.data() + retained);
+    }
+  }
   if (complete_) {
     onComplete(true);
   }
@@ -63,21 +135,58 @@ void StreamDecoder::decodeTrailers(Envoy::Http::ResponseTrailerMapPtr&& headers)
 
 void StreamDecoder::onComplete(bool success) {
   ASSERT(!success || complete_);
+  unschedule();
   if (success && measure_latencies_) {
-    latency_statistic_.addValue((time_source_.monotonicTime() - request_start_).count());
+    const uint64_t latency_ns = (time_source_.monotonicTime() - request_start_).count();
+    latency_statistic_.addValue(latency_ns);
+    if (request_class_statistic_ != nullptr) {
+      request_class_statistic_->response_statistic->addValue(latency_ns);
+    }
+    if (slowest_request_tracker_ != nullptr && slowest_request_tracker_->qualifies(latency_ns)) {
+      slowest_request_tracker_->add(latency_ns, describeSlowRequest());
+    }
     // At this point StreamDecoder::decodeHeaders() should have been called.
     if (stream_info_.response_code_.has_value()) {
-      decoder_completion_callback_.exportLatency(
-          stream_info_.response_code_.value(),
-          (time_source_.monotonicTime() - request_start_).count());
+      decoder_completion_callback_.exportLatency(stream_info_.response_code_.value(), latency_ns);
     } else {
       ENVOY_LOG_EVERY_POW_2(warn, "response_code is not available in onComplete");
     }
   }
   stream_info_.upstreamInfo()->upstreamTiming().onLastUpstreamRxByteReceived(time_source_);
   response_body_sizes_statistic_.addValue(stream_info_.bytesSent());
+  if (request_class_statistic_ != nullptr) {
+    request_class_statistic_->response_body_size_statistic->addValue(stream_info_.bytesSent());
+    if (abandon_reason_ == AbandonReason::Timeout) {
+      request_class_statistic_->counters.request_timeouts_.inc();
+    } else if (abandon_reason_ == AbandonReason::None) {
+      request_class_statistic_->recordCompletion(success, stream_info_.response_code_);
+    }
+  }
   stream_info_.onRequestComplete();
-  decoder_completion_callback_.onComplete(success, *response_headers_);
+  if (request_event_log_ != nullptr) {
+    RequestOutcome outcome = success ? RequestOutcome::Success : RequestOutcome::StreamReset;
+    if (abandon_reason_ == AbandonReason::Timeout) {
+      outcome = RequestOutcome::Timeout;
+    } else if (abandon_reason_ == AbandonReason::Cancelled) {
+      outcome = RequestOutcome::Cancelled;
+    }
+    appendRequestEvent(outcome);
+  }
+  switch (abandon_reason_) {
+  case AbandonReason::None:
+    decoder_completion_callback_.onComplete(success, *response_headers_);
+    break;
+  case AbandonReason::Timeout:
+    decoder_completion_callback_.onRequestTimeout(
+        (time_source_.monotonicTime() - connect_start_).count());
+    break;
+  case AbandonReason::Cancelled:
+    decoder_completion_callback_.onRequestCancelled();
+    break;
+  }
+  if (response_observer_ != nullptr) {
+    response_observer_->onResponse(success, response_headers_.get(), response_body_prefix_);
+  }
   finalizeActiveSpan();
   caller_completion_callback_(complete_, success);
   dispatcher_.deferredDelete(std::unique_ptr<StreamDecoder>(this));
@@ -93,17 +202,31 @@ void StreamDecoder::onResetStream(Envoy::Http::StreamResetReason reason,
 void StreamDecoder::onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason reason,
                                   absl::string_view /* transport_failure_reason */,
                                   Envoy::Upstream::HostDescriptionConstSharedPtr) {
+  unschedule();
+  pool_request_ = nullptr;
   decoder_completion_callback_.onPoolFailure(reason);
+  if (response_observer_ != nullptr) {
+    response_observer_->onResponse(false, nullptr, "");
+  }
   stream_info_.setResponseFlag(Envoy::StreamInfo::ResponseFlag::UpstreamConnectionFailure);
+  if (request_event_log_ != nullptr) {
+    appendRequestEvent(RequestOutcome::PoolFailure);
+  }
   finalizeActiveSpan();
   caller_completion_callback_(false, false);
   dispatcher_.deferredDelete(std::unique_ptr<StreamDecoder>(this));
 }
 
 void StreamDecoder::onPoolReady(Envoy::Http::RequestEncoder& encoder,
-                                Envoy::Upstream::HostDescriptionConstSharedPtr,
-                                const Envoy::StreamInfo::StreamInfo&,
+                                Envoy::Upstream::HostDescriptionConstSharedPtr host,
+                                const Envoy::StreamInfo::StreamInfo& stream_info,
                                 absl::optional<Envoy::Http::Protocol>) {
+  pool_request_ = nullptr;
+  request_encoder_ = &encoder;
+  if (wire_latency_statistic_ != nullptr) {
+    wire_timestamps_ = stream_info.filterState().getDataReadOnly<ConnectionWireTimestamps>(
+        ConnectionWireTimestamps::key());
+  }
   // Make sure we hear about stream resets on the encoder.
   encoder.getStream().addCallbacks(*this);
   stream_info_.upstreamInfo()->upstreamTiming().onFirstUpstreamTxByteSent(
@@ -137,6 +260,84 @@ void StreamDecoder::onPoolReady(Envoy::Http::RequestEncoder& encoder,
   if (measure_latencies_) {
     connect_statistic_.addValue((request_start_ - connect_start_).count());
   }
+  if (request_event_log_ != nullptr || slowest_request_tracker_ != nullptr) {
+    connection_id_ = stream_info.downstreamAddressProvider().connectionID().value_or(0);
+    request_event_.connection_id = connection_id_;
+    request_event_.connect_ns = nanoseconds(request_start_);
+  }
+  if (slowest_request_tracker_ != nullptr) {
+    upstream_host_ = std::move(host);
+  }
+}
+
+void StreamDecoder::appendRequestEvent(RequestOutcome outcome) {
+  request_event_.last_byte_ns = nanoseconds(time_source_.monotonicTime());
+  request_event_.status = stream_info_.response_code_.value_or(0);
+  request_event_.response_bytes = stream_info_.bytesSent();
+  request_event_.outcome = outcome;
+  request_event_log_->append(request_event_);
+}
+
+nighthawk::client::SlowRequest StreamDecoder::describeSlowRequest() const {
+  nighthawk::client::SlowRequest request;
+  *request.mutable_pool_wait() = Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(
+      (request_start_ - connect_start_).count());
+  const absl::optional<Envoy::MonotonicTime>& first_byte =
+      stream_info_.upstreamInfo()->upstreamTiming().first_upstream_rx_byte_received_;
+  if (first_byte.has_value()) {
+    *request.mutable_time_to_first_byte() = Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(
+        (first_byte.value() - request_start_).count());
+  }
+  request.set_method(std::string(request_headers_->getMethodValue()));
+  request.set_path(std::string(request_headers_->getPathValue()));
+  request.set_authority(std::string(request_headers_->getHostValue()));
+  request.set_response_code(stream_info_.response_code_.value_or(0));
+  request.set_connection_id(connection_id_);
+  if (upstream_host_ != nullptr && upstream_host_->address() != nullptr) {
+    request.set_upstream_host(upstream_host_->address()->asString());
+  }
+  for (const Envoy::Http::LowerCaseString& header_name : slowest_request_tracker_->headerNames()) {
+    const Envoy::Http::HeaderMap::GetResult request_header = request_headers_->get(header_name);
+    if (!request_header.empty()) {
+      envoy::config::core::v3::HeaderValue* header = request.add_request_headers();
+      header->set_key(header_name.get());
+      header->set_value(std::string(request_header[0]->value().getStringView()));
+    }
+    if (response_headers_ == nullptr) {
+      continue;
+    }
+    const Envoy::Http::HeaderMap::GetResult response_header = response_headers_->get(header_name);
+    if (!response_header.empty()) {
+      envoy::config::core::v3::HeaderValue* header = request.add_response_headers();
+      header->set_key(header_name.get());
+      header->set_value(std::string(response_header[0]->value().getStringView()));
+    }
+  }
+  return request;
+}
+
+void StreamDecoder::onExpired() {
+  stream_info_.setResponseFlag(Envoy::StreamInfo::ResponseFlag::UpstreamRequestTimeout);
+  abandon(AbandonReason::Timeout);
+}
+
+void StreamDecoder::cancel() {
+  unschedule();
+  abandon(AbandonReason::Cancelled);
+}
+
+void StreamDecoder::abandon(AbandonReason reason) {
+  abandon_reason_ = reason;
+  if (request_encoder_ != nullptr) {
+    // The stream callbacks will hear about the reset, and complete the request from there.
+    request_encoder_->getStream().resetStream(Envoy::Http::StreamResetReason::LocalReset);
+    return;
+  }
+  // The request is still waiting for a connection. The pool won't call us back after cancelling.
+  ASSERT(pool_request_ != nullptr);
+  pool_request_->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+  pool_request_ = nullptr;
+  onComplete(false);
 }
 
 // TODO(https://github.com/envoyproxy/nighthawk/issues/139): duplicated from
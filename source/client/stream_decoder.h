@@ -7,6 +7,8 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/http/conn_pool.h"
 #include "envoy/server/tracer_config.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "nighthawk/common/operation_callback.h"
 #include "nighthawk/common/request_source.h"
@@ -17,6 +19,11 @@
 #include "external/envoy/source/common/stream_info/stream_info_impl.h"
 #include "external/envoy/source/common/tracing/http_tracer_impl.h"
 
+#include "source/client/request_event_log.h"
+#include "source/client/slowest_request_tracker.h"
+#include "source/client/socket_timestamping_transport_socket.h"
+#include "source/common/timing_wheel.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -26,8 +33,61 @@ public:
   virtual void onComplete(bool success, const Envoy::Http::ResponseHeaderMap& headers) PURE;
   virtual void onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason reason) PURE;
   virtual void exportLatency(const uint32_t response_code, const uint64_t latency_ns) PURE;
+  /**
+   * Called instead of onComplete() when a request got abandoned because it exceeded its timeout.
+   * @param time_to_timeout_ns the time between issuing the request and abandoning it.
+   */
+  virtual void onRequestTimeout(const uint64_t time_to_timeout_ns) PURE;
+  /**
+   * Called instead of onComplete() when a request got abandoned through StreamDecoder::cancel().
+   */
+  virtual void onRequestCancelled() PURE;
+};
+
+#define ALL_REQUEST_CLASS_COUNTERS(COUNTER)                                                        \
+  COUNTER(stream_resets)                                                                           \
+  COUNTER(request_timeouts)                                                                        \
+  COUNTER(http_1xx)                                                                                \
+  COUNTER(http_2xx)                                                                                \
+  COUNTER(http_3xx)                                                                                \
+  COUNTER(http_4xx)                                                                                \
+  COUNTER(http_5xx)                                                                                \
+  COUNTER(http_xxx)
+
+struct RequestClassCounters {
+  ALL_REQUEST_CLASS_COUNTERS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * Latency, response size and status statistics of a single class of requests, as classified by
+ * the request source. Instances are created up front per worker and addressed by class index, so
+ * tracking them does not involve any per-request lookups by name.
+ */
+struct RequestClassStatistic {
+  /**
+   * @param parent_scope the scope in which the counters of the request class will be created.
+   * @param name the name of the request class, as reported by the request source.
+   * @param response_stat statistic that will track request-to-response latencies of the class.
+   * @param response_body_size_stat statistic that will track response body sizes of the class.
+   */
+  RequestClassStatistic(Envoy::Stats::Scope& parent_scope, absl::string_view name,
+                        StatisticPtr&& response_stat, StatisticPtr&& response_body_size_stat);
+
+  /**
+   * Tracks the outcome of a request that belongs to this class.
+   * @param success whether the request completed successfully.
+   * @param response_code the response code that was received, if any.
+   */
+  void recordCompletion(bool success, absl::optional<uint32_t> response_code);
+
+  Envoy::Stats::ScopeSharedPtr scope;
+  StatisticPtr response_statistic;
+  StatisticPtr response_body_size_statistic;
+  RequestClassCounters counters;
+};
+
+using RequestClassStatisticPtr = std::unique_ptr<RequestClassStatistic>;
+
 // TODO(oschaaf): create a StreamDecoderPool?
 
 /**
@@ -37,6 +97,7 @@ class StreamDecoder : public Envoy::Http::ResponseDecoder,
                       public Envoy::Http::StreamCallbacks,
                       public Envoy::Http::ConnectionPool::Callbacks,
                       public Envoy::Event::DeferredDeletable,
+                      public TimingWheelEntry,
                       public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
 public:
   StreamDecoder(Envoy::Event::Dispatcher& dispatcher, Envoy::TimeSource& time_source,
@@ -91,13 +152,84 @@ public:
                    const Envoy::StreamInfo::StreamInfo& stream_info,
                    absl::optional<Envoy::Http::Protocol> protocol) override;
 
+  // TimingWheelEntry
+  void onExpired() override;
+
+  /**
+   * Abandons the request, for example because another attempt of the same request already
+   * succeeded. Resets the stream, or cancels the pool request when no stream was assigned yet.
+   */
+  void cancel();
+
   static Envoy::StreamInfo::ResponseFlag
   streamResetReasonToResponseFlag(Envoy::Http::StreamResetReason reset_reason);
   void finalizeActiveSpan();
   void setupForTracing();
+  /**
+   * @param request_class_statistic statistics of the class the request belongs to, which will be
+   * updated alongside the aggregate statistics. May be nullptr when requests aren't classified.
+   */
+  void setRequestClassStatistic(RequestClassStatistic* request_class_statistic) {
+    request_class_statistic_ = request_class_statistic;
+  }
+  /**
+   * @param response_observer observer that will be notified of the outcome of the request, along
+   * with the leading bytes of the response body it asks for. May be nullptr.
+   */
+  void setResponseObserver(ResponseObserverSharedPtr response_observer) {
+    response_observer_ = std::move(response_observer);
+  }
+  /**
+   * @param wire_latency_statistic statistic that will track the latency between the request
+   * leaving and the response arriving at the socket, as timestamped by the kernel.
+   * @param client_overhead_statistic statistic that will track the remainder of the latency up to
+   * receiving the response headers, which is spent in the client.
+   */
+  void setWireLatencyStatistics(Statistic* wire_latency_statistic,
+                                Statistic* client_overhead_statistic) {
+    wire_latency_statistic_ = wire_latency_statistic;
+    client_overhead_statistic_ = client_overhead_statistic;
+  }
+  /**
+   * @param request_event_log log to append a record of the request to once it is done.
+   * @param request_id id of the request within the log.
+   * @param request_class index of the class of the request.
+   * @param intended_start when the request was due to start.
+   */
+  void setRequestEventLog(RequestEventLog* request_event_log, uint64_t request_id,
+                          uint32_t request_class, Envoy::MonotonicTime intended_start) {
+    request_event_log_ = request_event_log;
+    request_event_.request_id = request_id;
+    request_event_.request_class = request_class;
+    request_event_.intended_start_ns = nanoseconds(intended_start);
+    request_event_.start_ns = nanoseconds(connect_start_);
+  }
+  /**
+   * @param slowest_request_tracker tracker that gets the details of the request when it is among
+   * the slowest ones. May be nullptr.
+   */
+  void setSlowestRequestTracker(SlowestRequestTracker* slowest_request_tracker) {
+    slowest_request_tracker_ = slowest_request_tracker;
+  }
+  /**
+   * @param pool_request handle returned by the connection pool while the stream is pending, which
+   * allows abandoning the request when it times out before a connection becomes available.
+   */
+  void setPoolRequest(Envoy::Http::ConnectionPool::Cancellable* pool_request) {
+    pool_request_ = pool_request;
+  }
 
 private:
+  enum class AbandonReason { None, Timeout, Cancelled };
+
   void onComplete(bool success);
+  void recordWireLatency();
+  void appendRequestEvent(RequestOutcome outcome);
+  nighthawk::client::SlowRequest describeSlowRequest() const;
+  static int64_t nanoseconds(Envoy::MonotonicTime time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+  }
+  void abandon(AbandonReason reason);
   static const std::string& staticUploadContent() {
     static const auto s = new std::string(4194304, 'a');
     return *s;
@@ -127,6 +259,22 @@ private:
   Envoy::Tracing::HttpTracerSharedPtr& http_tracer_;
   Envoy::Tracing::SpanPtr active_span_;
   const std::string latency_response_header_name_;
+  RequestClassStatistic* request_class_statistic_{};
+  Statistic* wire_latency_statistic_{};
+  Statistic* client_overhead_statistic_{};
+  // Published by the transport socket of the connection the request went out on.
+  const ConnectionWireTimestamps* wire_timestamps_{};
+  ResponseObserverSharedPtr response_observer_;
+  std::string response_body_prefix_;
+  Envoy::Http::ConnectionPool::Cancellable* pool_request_{};
+  Envoy::Http::RequestEncoder* request_encoder_{};
+  AbandonReason abandon_reason_{AbandonReason::None};
+  RequestEventLog* request_event_log_{};
+  RequestEventRecord request_event_{};
+  SlowestRequestTracker* slowest_request_tracker_{};
+  // Only retained when tracking the slowest requests.
+  Envoy::Upstream::HostDescriptionConstSharedPtr upstream_host_;
+  uint64_t connection_id_{};
 };
 
 } // namespace Client
@@ -0,0 +1,64 @@
+#include "source/client/threaded_phase_observer.h"
+
+namespace Nighthawk {
+namespace Client {
+
+ThreadedPhaseObserver::ThreadedPhaseObserver(Envoy::TimeSource& time_source, uint32_t phases)
+    : time_source_(time_source), phases_(phases) {}
+
+void ThreadedPhaseObserver::onPhaseStarted() {
+  Envoy::Thread::LockGuard guard(lock_);
+  if (started_phases_++ > 0 || stopped_) {
+    return;
+  }
+  if (onFirstPhaseStarted()) {
+    thread_ = std::thread([this]() {
+      Envoy::Thread::LockGuard guard(lock_);
+      runWhilePhasesExecute();
+    });
+  }
+}
+
+void ThreadedPhaseObserver::onPhaseCompleted() {
+  Envoy::Thread::LockGuard guard(lock_);
+  if (++completed_phases_ == phases_ && !stopped_) {
+    onLastPhaseCompleted();
+  }
+  phases_completed_event_.notifyAll();
+}
+
+bool ThreadedPhaseObserver::waitForPhases(absl::optional<std::chrono::nanoseconds> timeout) {
+  if (!timeout.has_value()) {
+    while (!phasesCompleted()) {
+      phases_completed_event_.wait(lock_);
+    }
+    return true;
+  }
+  const Envoy::MonotonicTime deadline = time_source_.monotonicTime() + timeout.value();
+  while (!phasesCompleted()) {
+    const Envoy::MonotonicTime now = time_source_.monotonicTime();
+    if (now >= deadline) {
+      return false;
+    }
+    phases_completed_event_.waitFor(lock_, deadline - now);
+  }
+  return true;
+}
+
+void ThreadedPhaseObserver::stopThread() {
+  {
+    Envoy::Thread::LockGuard guard(lock_);
+    stopped_ = true;
+    phases_completed_event_.notifyAll();
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool ThreadedPhaseObserver::phasesCompleted() const {
+  return stopped_ || completed_phases_ >= phases_;
+}
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "envoy/common/time.h"
+
+#include "nighthawk/client/phase_observer.h"
+
+#include "external/envoy/source/common/common/thread.h"
+
+#include "absl/types/optional.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Tracks the main phases of the workers, and runs work of its own on a thread of its own while they
+ * execute, so the workers are never held up by it. The thread starts when the first worker starts
+ * its main phase, and gets to wait for the last one to complete it.
+ */
+class ThreadedPhaseObserver : public PhaseObserver {
+public:
+  // PhaseObserver
+  void onPhaseStarted() final;
+  void onPhaseCompleted() final;
+
+protected:
+  /**
+   * @param time_source used to time the waits.
+   * @param phases the number of workers which will report the start and completion of their main
+   * phase.
+   */
+  ThreadedPhaseObserver(Envoy::TimeSource& time_source, uint32_t phases);
+
+  /**
+   * Called when the first main phase starts, unless stopped before.
+   *
+   * @return bool true to call runWhilePhasesExecute() on the thread.
+   */
+  virtual bool onFirstPhaseStarted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) PURE;
+
+  /**
+   * Called when the last main phase completes, unless stopped before.
+   */
+  virtual void onLastPhaseCompleted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {}
+
+  /**
+   * Runs on the thread. Should return once waitForPhases() does.
+   */
+  virtual void runWhilePhasesExecute() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) PURE;
+
+  /**
+   * Waits until all phases completed or the timeout passed, whichever comes first. Stopping counts
+   * as completion.
+   *
+   * @param timeout how long to wait at most. Waits for the phases to complete when absent.
+   * @return bool true when all phases completed.
+   */
+  bool waitForPhases(absl::optional<std::chrono::nanoseconds> timeout)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  /**
+   * Makes the thread return from waitForPhases(), and waits for it to finish. Later phases are
+   * ignored. Derived classes must call this before they get destroyed, as the thread uses them.
+   */
+  void stopThread() ABSL_LOCKS_EXCLUDED(lock_);
+
+  Envoy::TimeSource& time_source_;
+  Envoy::Thread::MutexBasicLockable lock_;
+
+private:
+  bool phasesCompleted() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const uint32_t phases_;
+  Envoy::Thread::CondVar phases_completed_event_;
+  uint32_t started_phases_ ABSL_GUARDED_BY(lock_){0};
+  uint32_t completed_phases_ ABSL_GUARDED_BY(lock_){0};
+  bool stopped_ ABSL_GUARDED_BY(lock_){false};
+  std::thread thread_;
+};
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,236 @@
+#include "source/client/zero_work_responder.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "nighthawk/common/exception.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+constexpr absl::string_view kResponse = "HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n";
+constexpr absl::string_view kEndOfHeaders = "\r\n\r\n";
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadSize = 16384;
+
+// Returns the value of the content-length header in the request headers, or zero when absent.
+uint64_t contentLength(absl::string_view headers) {
+  for (absl::string_view line : absl::StrSplit(headers, "\r\n")) {
+    const size_t colon = line.find(':');
+    if (colon == absl::string_view::npos ||
+        !absl::EqualsIgnoreCase(line.substr(0, colon), "content-length")) {
+      continue;
+    }
+    uint64_t length;
+    if (absl::SimpleAtoi(absl::StripAsciiWhitespace(line.substr(colon + 1)), &length)) {
+      return length;
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+ZeroWorkResponder::ZeroWorkResponder() {
+  listener_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  if (listener_fd_ < 0 ||
+      bind(listener_fd_, reinterpret_cast<sockaddr*>(&address), address_length) != 0 ||
+      listen(listener_fd_, SOMAXCONN) != 0 ||
+      getsockname(listener_fd_, reinterpret_cast<sockaddr*>(&address), &address_length) != 0) {
+    const int error = errno;
+    ::close(listener_fd_);
+    throw NighthawkException(
+        fmt::format("Failed to listen on a loopback port: {}", strerror(error)));
+  }
+  port_ = ntohs(address.sin_port);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epoll_event listener_event{};
+  listener_event.events = EPOLLIN;
+  listener_event.data.fd = listener_fd_;
+  epoll_event wakeup_event{};
+  wakeup_event.events = EPOLLIN;
+  wakeup_event.data.fd = wakeup_fd_;
+  if (epoll_fd_ < 0 || wakeup_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listener_fd_, &listener_event) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &wakeup_event) != 0) {
+    const int error = errno;
+    ::close(wakeup_fd_);
+    ::close(epoll_fd_);
+    ::close(listener_fd_);
+    throw NighthawkException(fmt::format("Failed to set up epoll: {}", strerror(error)));
+  }
+  thread_ = std::thread([this]() { serve(); });
+  ENVOY_LOG(debug, "Zero-work responder listening on 127.0.0.1:{}", port_);
+}
+
+ZeroWorkResponder::~ZeroWorkResponder() {
+  const uint64_t wakeup = 1;
+  if (write(wakeup_fd_, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) {
+    ENVOY_LOG(error, "Failed to stop the zero-work responder: {}", strerror(errno));
+  }
+  thread_.join();
+  for (const auto& connection : connections_) {
+    ::close(connection.first);
+  }
+  ::close(wakeup_fd_);
+  ::close(epoll_fd_);
+  ::close(listener_fd_);
+}
+
+void ZeroWorkResponder::serve() {
+  epoll_event events[kMaxEvents];
+  while (true) {
+    const int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ENVOY_LOG(error, "epoll_wait failed in the zero-work responder: {}", strerror(errno));
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == wakeup_fd_) {
+        return;
+      }
+      if (fd == listener_fd_) {
+        accept();
+        continue;
+      }
+      auto it = connections_.find(fd);
+      if (it == connections_.end()) {
+        continue;
+      }
+      bool keep_open = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0;
+      if (keep_open && (events[i].events & EPOLLOUT) != 0) {
+        keep_open = flush(fd, it->second);
+      }
+      if (keep_open && (events[i].events & EPOLLIN) != 0) {
+        keep_open = onReadable(fd, it->second);
+      }
+      if (!keep_open) {
+        close(fd);
+      }
+    }
+  }
+}
+
+void ZeroWorkResponder::accept() {
+  while (true) {
+    const int fd = accept4(listener_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+      ::close(fd);
+      continue;
+    }
+    connections_[fd] = Connection();
+  }
+}
+
+bool ZeroWorkResponder::onReadable(int fd, Connection& connection) {
+  char buffer[kReadSize];
+  while (true) {
+    const ssize_t rc = read(fd, buffer, sizeof(buffer));
+    if (rc == 0) {
+      return false;
+    }
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        return false;
+      }
+      break;
+    }
+    connection.input.append(buffer, rc);
+  }
+  respond(connection);
+  return flush(fd, connection);
+}
+
+void ZeroWorkResponder::respond(Connection& connection) {
+  absl::string_view input = connection.input;
+  while (!input.empty()) {
+    if (connection.body_remaining > 0) {
+      const uint64_t skip = std::min<uint64_t>(connection.body_remaining, input.size());
+      connection.body_remaining -= skip;
+      input.remove_prefix(skip);
+      continue;
+    }
+    const size_t end_of_headers = input.find(kEndOfHeaders);
+    if (end_of_headers == absl::string_view::npos) {
+      break;
+    }
+    connection.body_remaining = contentLength(input.substr(0, end_of_headers));
+    input.remove_prefix(end_of_headers + kEndOfHeaders.size());
+    connection.output.append(kResponse.data(), kResponse.size());
+  }
+  connection.input.erase(0, connection.input.size() - input.size());
+}
+
+bool ZeroWorkResponder::flush(int fd, Connection& connection) {
+  size_t written = 0;
+  while (written < connection.output.size()) {
+    const ssize_t rc =
+        send(fd, connection.output.data() + written, connection.output.size() - written,
+             MSG_NOSIGNAL);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        return false;
+      }
+      break;
+    }
+    written += rc;
+  }
+  connection.output.erase(0, written);
+  // Only wait for the socket to become writable while there is output pending.
+  const bool wait_for_writable = !connection.output.empty();
+  if (wait_for_writable == connection.waiting_for_writable) {
+    return true;
+  }
+  connection.waiting_for_writable = wait_for_writable;
+  epoll_event event{};
+  event.events = wait_for_writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void ZeroWorkResponder::close(int fd) {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  connections_.erase(fd);
+}
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "external/envoy/source/common/common/logger.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Nighthawk {
+namespace Client {
+
+/**
+ * Minimal HTTP/1.1 server on an ephemeral IPv4 loopback port, which answers every request with an
+ * empty 200 response without doing any other work. It serves as the target of overhead calibration
+ * runs, so the latency measured against it is what the client adds itself. Connections are served
+ * by a single thread which polls them with epoll.
+ */
+class ZeroWorkResponder : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * Starts listening and serving.
+   * @throws NighthawkException when the listener or the serving thread can't be set up.
+   */
+  ZeroWorkResponder();
+  ~ZeroWorkResponder();
+
+  /**
+   * @return uint16_t the loopback port the responder listens on.
+   */
+  uint16_t port() const { return port_; }
+
+private:
+  struct Connection {
+    // Received data which doesn't form a complete request yet.
+    std::string input;
+    // Responses which couldn't be written yet, because the socket buffer was full.
+    std::string output;
+    // The number of bytes of the body of the current request which still have to be skipped.
+    uint64_t body_remaining{};
+    // Whether the connection is registered for EPOLLOUT.
+    bool waiting_for_writable{};
+  };
+
+  void serve();
+  void accept();
+  // Returns false when the connection should be closed.
+  bool onReadable(int fd, Connection& connection);
+  bool flush(int fd, Connection& connection);
+  // Consumes the complete requests in the input of the connection, queueing a response for each.
+  static void respond(Connection& connection);
+  void close(int fd);
+
+  int listener_fd_{-1};
+  int epoll_fd_{-1};
+  int wakeup_fd_{-1};
+  uint16_t port_{};
+  absl::flat_hash_map<int, Connection> connections_;
+  std::thread thread_;
+};
+
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,48 @@
+#include "source/common/alias_table.h"
+
+#include <numeric>
+
+#include "nighthawk/common/exception.h"
+
+namespace Nighthawk {
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+    : probabilities_(weights.size(), 1.0), aliases_(weights.size()) {
+  const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+  if (weights.empty() || !(total > 0)) {
+    throw NighthawkException("An alias table needs at least one entry with a positive weight");
+  }
+  std::vector<size_t> small;
+  std::vector<size_t> large;
+  std::vector<double> scaled(weights.size());
+  for (size_t i = 0; i < weights.size(); i++) {
+    if (weights[i] < 0) {
+      throw NighthawkException("Alias table weights must not be negative");
+    }
+    normalized_weights_.push_back(weights[i] / total);
+    scaled[i] = normalized_weights_[i] * weights.size();
+    (scaled[i] < 1.0 ? small : large).push_back(i);
+  }
+  // Pair each under-full column with an over-full one, which donates the remaining share.
+  while (!small.empty() && !large.empty()) {
+    const size_t less = small.back();
+    small.pop_back();
+    const size_t more = large.back();
+    probabilities_[less] = scaled[less];
+    aliases_[less] = more;
+    scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+    if (scaled[more] < 1.0) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+  // Whatever remains is full up to rounding errors, and keeps the default probability of 1.
+  for (const size_t index : small) {
+    aliases_[index] = index;
+  }
+  for (const size_t index : large) {
+    aliases_[index] = index;
+  }
+}
+
+} // namespace Nighthawk
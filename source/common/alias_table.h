@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/random/random.h"
+
+namespace Nighthawk {
+
+/**
+ * Alias table (Vose's method) for sampling indices according to a discrete distribution in O(1)
+ * time, regardless of the number of entries.
+ */
+class AliasTable {
+public:
+  /**
+   * @param weights relative, non-negative weights of the entries. At least one weight must be
+   * greater than zero.
+   */
+  explicit AliasTable(const std::vector<double>& weights);
+
+  /**
+   * @param generator uniform random bit generator to draw the random numbers from.
+   * @return size_t the index of a sampled entry.
+   */
+  template <class Generator> size_t sample(Generator& generator) const {
+    const size_t column = absl::Uniform<size_t>(generator, 0u, probabilities_.size());
+    return absl::Uniform<double>(generator, 0, 1) < probabilities_[column] ? column
+                                                                           : aliases_[column];
+  }
+
+  /**
+   * @param index index of an entry.
+   * @return double the probability with which the entry will be sampled.
+   */
+  double probability(size_t index) const { return normalized_weights_[index]; }
+
+  /**
+   * @return size_t the number of entries.
+   */
+  size_t size() const { return probabilities_.size(); }
+
+private:
+  std::vector<double> normalized_weights_;
+  std::vector<double> probabilities_;
+  std::vector<size_t> aliases_;
+};
+
+} // namespace Nighthawk
@@ -0,0 +1,147 @@
+#include "source/common/perf_event_counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "absl/strings/str_join.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Nighthawk {
+namespace {
+
+#if defined(__linux__)
+
+struct EventDescriptor {
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr EventDescriptor kEvents[] = {
+    {"perf.task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"perf.context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"perf.cpu_migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+    {"perf.page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"perf.cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"perf.instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"perf.cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+};
+
+// The layout of what read(2) returns for the read format we request.
+struct ReadFormat {
+  uint64_t value;
+  uint64_t time_enabled;
+  uint64_t time_running;
+};
+
+int openEvent(const EventDescriptor& event, bool exclude_kernel) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.disabled = 1;
+  attr.exclude_kernel = exclude_kernel ? 1 : 0;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // Count the calling thread, on whatever CPU it runs.
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+#endif
+
+} // namespace
+
+PerfEventCounters::PerfEventCounters() {
+#if defined(__linux__)
+  std::vector<std::string> unavailable;
+  for (const EventDescriptor& event : kEvents) {
+    int fd = openEvent(event, false);
+    // Unprivileged processes may not be allowed to count kernel activity. Hardware events are
+    // still worth counting in user space only. Software events like context switches happen in
+    // the kernel, so counting them in user space only would report zeroes.
+    if (fd < 0 && (errno == EACCES || errno == EPERM) && event.type == PERF_TYPE_HARDWARE) {
+      fd = openEvent(event, true);
+    }
+    if (fd < 0) {
+      unavailable.push_back(event.name);
+      continue;
+    }
+    counters_.push_back({event.name, fd});
+  }
+  if (!unavailable.empty()) {
+    ENVOY_LOG(debug, "Perf events which can't be counted: {}", absl::StrJoin(unavailable, ", "));
+  }
+#endif
+}
+
+PerfEventCounters::~PerfEventCounters() {
+#if defined(__linux__)
+  for (const Counter& counter : counters_) {
+    close(counter.fd);
+  }
+#endif
+}
+
+void PerfEventCounters::start() {
+#if defined(__linux__)
+  for (const Counter& counter : counters_) {
+    ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+void PerfEventCounters::stop() {
+#if defined(__linux__)
+  for (const Counter& counter : counters_) {
+    ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+#endif
+}
+
+std::map<std::string, uint64_t> PerfEventCounters::values() const {
+  std::map<std::string, uint64_t> values;
+#if defined(__linux__)
+  for (const Counter& counter : counters_) {
+    ReadFormat data;
+    if (read(counter.fd, &data, sizeof(data)) != sizeof(data)) {
+      ENVOY_LOG(warn, "Failed to read perf event counter {}: {}", counter.name, strerror(errno));
+      continue;
+    }
+    uint64_t value = data.value;
+    if (data.time_running > 0 && data.time_running < data.time_enabled) {
+      value = static_cast<uint64_t>(static_cast<double>(value) * data.time_enabled /
+                                    data.time_running);
+    }
+    values[counter.name] = value;
+  }
+#endif
+  return values;
+}
+
+void PerfEventCounters::addPerRequestCounters(std::map<std::string, uint64_t>& counters,
+                                              uint64_t requests) {
+  if (requests == 0) {
+    return;
+  }
+  const auto add_ratio = [&counters, requests](const std::string& counter,
+                                               const std::string& ratio, uint64_t scale) {
+    const auto it = counters.find(counter);
+    if (it != counters.end()) {
+      counters[ratio] = it->second * scale / requests;
+    }
+  };
+  add_ratio("perf.instructions", "perf.instructions_per_request", 1);
+  add_ratio("perf.cycles", "perf.cycles_per_request", 1);
+  add_ratio("perf.task_clock_ns", "perf.task_clock_ns_per_request", 1);
+  add_ratio("perf.context_switches", "perf.context_switches_per_1k_requests", 1000);
+}
+
+} // namespace Nighthawk
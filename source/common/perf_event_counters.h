@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "external/envoy/source/common/common/logger.h"
+
+namespace Nighthawk {
+
+/**
+ * Counts the perf events of the calling thread via perf_event_open(2). Software events (task clock,
+ * context switches, CPU migrations and page faults) are available wherever perf events are.
+ * Hardware events (cycles, instructions and cache misses) are skipped when the CPU, the hypervisor
+ * or perf_event_paranoid doesn't allow counting them. Events which can't be counted are left out of
+ * values(). The counters only count the thread that created them, so creating, starting, stopping
+ * and reading them must all happen on that thread.
+ */
+class PerfEventCounters : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * Opens the counters, which start out disabled.
+   */
+  PerfEventCounters();
+  ~PerfEventCounters();
+
+  PerfEventCounters(const PerfEventCounters&) = delete;
+  PerfEventCounters& operator=(const PerfEventCounters&) = delete;
+
+  /**
+   * @return bool true when at least one event can be counted.
+   */
+  bool available() const { return !counters_.empty(); }
+
+  /**
+   * Zeroes and enables the counters.
+   */
+  void start();
+
+  /**
+   * Disables the counters. Their values remain readable.
+   */
+  void stop();
+
+  /**
+   * @return std::map<std::string, uint64_t> the counts of the events which could be counted, keyed
+   * by counter name (for example "perf.context_switches"). Counts of events which had to share the
+   * hardware with other events are extrapolated to the time the counters were enabled.
+   */
+  std::map<std::string, uint64_t> values() const;
+
+  /**
+   * Adds the per request ratios which can be derived from the perf event counters in a counter map:
+   * instructions, cycles and task clock nanoseconds per request, and context switches per 1000
+   * requests.
+   *
+   * @param counters counter map holding perf event counters, to add the ratios to.
+   * @param requests the number of requests the perf events were counted for.
+   */
+  static void addPerRequestCounters(std::map<std::string, uint64_t>& counters, uint64_t requests);
+
+private:
+  struct Counter {
+    std::string name;
+    int fd;
+  };
+  std::vector<Counter> counters_;
+};
+
+} // namespace Nighthawk
@@ -8,11 +8,18 @@ namespace Nighthawk {
 
 class RequestImpl : public Request {
 public:
-  RequestImpl(HeaderMapPtr header) : header_(std::move(header)) {}
+  RequestImpl(HeaderMapPtr header, uint32_t request_class = 0,
+              ResponseObserverSharedPtr response_observer = nullptr)
+      : header_(std::move(header)), request_class_(request_class),
+        response_observer_(std::move(response_observer)) {}
   HeaderMapPtr header() const override { return header_; }
+  uint32_t requestClass() const override { return request_class_; }
+  ResponseObserverSharedPtr responseObserver() const override { return response_observer_; }
 
 private:
   HeaderMapPtr header_;
+  const uint32_t request_class_;
+  const ResponseObserverSharedPtr response_observer_;
 };
 
 } // namespace Nighthawk
@@ -105,22 +105,25 @@ void SequencerImpl::run(bool from_periodic_timer) {
 
   while (rate_limiter_->tryAcquireOne()) {
     // The rate limiter says it's OK to proceed and call the target. Let's see if the target is OK
-    // with that as well.
-    const bool target_could_start = target_([this, now](bool, bool) {
-      // Update cached time, as we need an accurate value for latency reporting.
-      dispatcher_.updateApproximateMonotonicTime();
-      const auto dur = time_source_.monotonicTime() - now;
-      latency_statistic_->addValue(dur.count());
-      targets_completed_++;
-      // Callbacks may fire after stop() is called. When the worker teardown runs the dispatcher,
-      // in-flight work might wrap up and fire this callback. By then we wouldn't want to
-      // re-enable any timers here.
-      if (this->running_) {
-        // Immediately schedule us to check again, as chances are we can get on with the next
-        // task.
-        spin_timer_->enableHRTimer(0ms);
-      }
-    });
+    // with that as well. When the target refused earlier, the operation was due since then.
+    const Envoy::MonotonicTime due = blocked_ ? blocked_start_ : now;
+    const bool target_could_start = target_(
+        [this, now](bool, bool) {
+          // Update cached time, as we need an accurate value for latency reporting.
+          dispatcher_.updateApproximateMonotonicTime();
+          const auto dur = time_source_.monotonicTime() - now;
+          latency_statistic_->addValue(dur.count());
+          targets_completed_++;
+          // Callbacks may fire after stop() is called. When the worker teardown runs the
+          // dispatcher, in-flight work might wrap up and fire this callback. By then we wouldn't
+          // want to re-enable any timers here.
+          if (this->running_) {
+            // Immediately schedule us to check again, as chances are we can get on with the next
+            // task.
+            spin_timer_->enableHRTimer(0ms);
+          }
+        },
+        due);
     if (target_could_start) {
       unblockAndUpdateStatisticIfNeeded(now);
       targets_initiated_++;
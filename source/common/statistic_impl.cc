@@ -1,8 +1,10 @@
 #include "source/common/statistic_impl.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <fstream>
+#include <numeric>
 #include <sstream>
 
 #include "external/dep_hdrhistogram_c/src/hdr_histogram_log.h"
@@ -26,6 +28,72 @@ static void setDurationFromNanos(Envoy::ProtobufWkt::Duration& mutable_duration,
   mutable_duration.set_nanos(nanos % one_billion);
 }
 
+/**
+ * @param a a histogram.
+ * @param b another histogram.
+ * @return bool true when a value maps to the same counts index in both histograms, so their counts
+ * can be added index by index.
+ */
+bool haveSameLayout(const hdr_histogram& a, const hdr_histogram& b) {
+  return a.unit_magnitude == b.unit_magnitude &&
+         a.sub_bucket_half_count_magnitude == b.sub_bucket_half_count_magnitude &&
+         a.counts_len == b.counts_len && a.normalizing_index_offset == 0 &&
+         b.normalizing_index_offset == 0;
+}
+
+/**
+ * Sets the counts of an empty histogram to the sum of the counts of two histograms with the same
+ * layout. The loop has no dependencies between iterations, so the compiler vectorizes it.
+ *
+ * @param target the empty histogram to fill in.
+ * @param a a histogram with the same layout as target.
+ * @param b another histogram with the same layout as target.
+ */
+void addCountsOfSameLayout(hdr_histogram& target, const hdr_histogram& a, const hdr_histogram& b) {
+  int64_t* __restrict target_counts = target.counts;
+  const int64_t* __restrict a_counts = a.counts;
+  const int64_t* __restrict b_counts = b.counts;
+  for (int32_t i = 0; i < target.counts_len; i++) {
+    target_counts[i] = a_counts[i] + b_counts[i];
+  }
+  target.total_count = a.total_count + b.total_count;
+  target.min_value = std::min(a.min_value, b.min_value);
+  target.max_value = std::max(a.max_value, b.max_value);
+}
+
+/**
+ * @param tick a percentile reported by toProto(), in the range [0, 100).
+ * @return double the next percentile to report. The same log-spaced ticks as the percentile
+ * iterator of the HdrHistogram library with 5 ticks per half distance: steps of 10 up to the
+ * 50th percentile, 5 up to the 75th, 2.5 up to the 87.5th, and so on.
+ */
+double nextReportedPercentile(double tick) {
+  const int64_t halvings = static_cast<int64_t>(std::log(100 / (100.0 - tick)) / std::log(2)) + 1;
+  const int64_t half_distance = static_cast<int64_t>(std::pow(2, static_cast<double>(halvings)));
+  return tick + 100.0 / (5 * half_distance);
+}
+
+/**
+ * @param percentile a percentile in the range [0, 100].
+ * @param total_count the number of recorded values, at least 1.
+ * @return int64_t the lowest cumulative count that reaches the percentile, at least 1. Compares
+ * like the percentile iterator of the HdrHistogram library does, so rounding can't shift a tick
+ * into another bucket.
+ */
+int64_t countReachingPercentile(double percentile, int64_t total_count) {
+  const auto reaches = [percentile, total_count](int64_t count) {
+    return 100.0 * count / total_count >= percentile;
+  };
+  int64_t count = static_cast<int64_t>(std::ceil(percentile / 100 * total_count));
+  while (count > 1 && reaches(count - 1)) {
+    count--;
+  }
+  while (count < total_count && !reaches(count)) {
+    count++;
+  }
+  return std::max<int64_t>(count, 1);
+}
+
 } // namespace
 
 std::string StatisticImpl::toString() const {
@@ -80,6 +148,8 @@ absl::Status StatisticImpl::deserializeNative(std::istream&) {
   return absl::Status{absl::StatusCode::kUnimplemented, "deserializeNative not implemented."};
 }
 
+uint64_t StatisticImpl::memoryUsageBytes() const { return sizeof(*this) + id_.capacity(); }
+
 void SimpleStatistic::addValue(uint64_t value) {
   StatisticImpl::addValue(value);
   sum_x_ += value;
@@ -233,6 +303,11 @@ StatisticPtr InMemoryStatistic::combine(const Statistic& statistic) const {
   return combined;
 }
 
+uint64_t InMemoryStatistic::memoryUsageBytes() const {
+  return StatisticImpl::memoryUsageBytes() + samples_.capacity() * sizeof(int64_t) +
+         streaming_stats_->memoryUsageBytes();
+}
+
 const int HdrStatistic::SignificantDigits = 4;
 
 HdrStatistic::HdrStatistic() : histogram_(nullptr) {
@@ -273,10 +348,25 @@ uint64_t HdrStatistic::min() const {
 }
 uint64_t HdrStatistic::max() const { return hdr_value_at_percentile(histogram_, 100); }
 
+uint64_t HdrStatistic::percentile(double percentile) const {
+  return hdr_value_at_percentile(histogram_, percentile);
+}
+
+void HdrStatistic::reset() { hdr_reset(histogram_); }
+
 StatisticPtr HdrStatistic::combine(const Statistic& statistic) const {
   auto combined = std::make_unique<HdrStatistic>();
   const auto& b = dynamic_cast<const HdrStatistic&>(statistic);
 
+  // Histograms we created ourselves share a layout, and can be merged by adding up their counts.
+  // Deserialized histograms may have been configured differently, and go through hdr_add(), which
+  // maps each recorded value into the combined histogram.
+  if (haveSameLayout(*combined->histogram_, *histogram_) &&
+      haveSameLayout(*combined->histogram_, *b.histogram_)) {
+    addCountsOfSameLayout(*combined->histogram_, *histogram_, *b.histogram_);
+    return combined;
+  }
+
   // Dropping a value can happen when it exceeds the configured minimum
   // or maximum value we passed when initializing histogram_.
   int dropped;
@@ -288,27 +378,78 @@ StatisticPtr HdrStatistic::combine(const Statistic& statistic) const {
   return combined;
 }
 
-nighthawk::client::Statistic HdrStatistic::toProto(SerializationDomain domain) const {
-  nighthawk::client::Statistic proto = StatisticImpl::toProto(domain);
+std::vector<uint64_t> HdrStatistic::percentiles(const std::vector<double>& percentiles) const {
+  std::vector<size_t> order(percentiles.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&percentiles](size_t a, size_t b) { return percentiles[a] < percentiles[b]; });
+  // Rounds the same way hdr_value_at_percentile() does.
+  std::vector<int64_t> counts_at(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    const double requested = std::min(percentiles[order[i]], 100.0);
+    counts_at[i] = std::max<int64_t>(
+        static_cast<int64_t>(requested / 100 * histogram_->total_count + 0.5), 1);
+  }
+  const std::vector<std::pair<uint64_t, int64_t>> buckets = bucketsReachingCounts(counts_at);
+  std::vector<uint64_t> values(percentiles.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    values[order[i]] = buckets[i].first;
+  }
+  return values;
+}
 
+std::vector<std::pair<uint64_t, int64_t>>
+HdrStatistic::bucketsReachingCounts(const std::vector<int64_t>& counts_at) const {
+  std::vector<std::pair<uint64_t, int64_t>> buckets(counts_at.size(), {0, 0});
+  size_t next = 0;
   struct hdr_iter iter;
-  struct hdr_iter_percentiles* percentiles;
-  hdr_iter_percentile_init(&iter, histogram_, 5 /*ticks_per_half_distance*/);
-
-  percentiles = &iter.specifics.percentiles;
-  while (hdr_iter_next(&iter)) {
-    nighthawk::client::Percentile* percentile;
+  hdr_iter_recorded_init(&iter, histogram_);
+  while (next < counts_at.size() && hdr_iter_next(&iter)) {
+    while (next < counts_at.size() && iter.cumulative_count >= counts_at[next]) {
+      buckets[next] = {static_cast<uint64_t>(iter.highest_equivalent_value), iter.cumulative_count};
+      next++;
+    }
+  }
+  return buckets;
+}
 
-    percentile = proto.add_percentiles();
+nighthawk::client::Statistic HdrStatistic::toProto(SerializationDomain domain) const {
+  nighthawk::client::Statistic proto = StatisticImpl::toProto(domain);
+  const auto add_percentile = [&proto, domain](double tick, uint64_t value, int64_t count) {
+    nighthawk::client::Percentile* percentile = proto.add_percentiles();
     if (domain == Statistic::SerializationDomain::DURATION) {
-      setDurationFromNanos(*percentile->mutable_duration(), iter.highest_equivalent_value);
+      setDurationFromNanos(*percentile->mutable_duration(), value);
     } else {
-      percentile->set_raw_value(iter.highest_equivalent_value);
+      percentile->set_raw_value(value);
     }
-    percentile->set_percentile(percentiles->percentile / 100.0);
-    percentile->set_count(iter.cumulative_count);
-  }
+    percentile->set_percentile(tick / 100.0);
+    percentile->set_count(count);
+  };
 
+  const int64_t total_count = histogram_->total_count;
+  if (total_count == 0) {
+    add_percentile(100, 0, 0);
+    return proto;
+  }
+  // Reports the ticks up to and including the first one that lands in the bucket of the highest
+  // recorded value, followed by the 100th percentile, like the percentile iterator of the
+  // HdrHistogram library does. Their values come out of a single walk over the recorded values.
+  const int64_t count_below_max =
+      total_count - hdr_count_at_value(histogram_, hdr_max(histogram_));
+  std::vector<double> ticks;
+  std::vector<int64_t> counts_at;
+  for (double tick = 0;; tick = nextReportedPercentile(tick)) {
+    ticks.push_back(tick);
+    counts_at.push_back(countReachingPercentile(tick, total_count));
+    if (counts_at.back() > count_below_max) {
+      break;
+    }
+  }
+  const std::vector<std::pair<uint64_t, int64_t>> buckets = bucketsReachingCounts(counts_at);
+  for (size_t i = 0; i < ticks.size(); i++) {
+    add_percentile(ticks[i], buckets[i].first, buckets[i].second);
+  }
+  add_percentile(100, buckets.back().first, total_count);
   return proto;
 }
 
@@ -341,6 +482,10 @@ absl::Status HdrStatistic::deserializeNative(std::istream& stream) {
   return absl::Status{absl::StatusCode::kInternal, "Failed to read back HdrHistogram data"};
 }
 
+uint64_t HdrStatistic::memoryUsageBytes() const {
+  return StatisticImpl::memoryUsageBytes() + hdr_get_memory_size(histogram_);
+}
+
 CircllhistStatistic::CircllhistStatistic() {
   histogram_ = hist_alloc();
   ASSERT(histogram_ != nullptr);
@@ -348,6 +493,12 @@ CircllhistStatistic::CircllhistStatistic() {
 
 CircllhistStatistic::~CircllhistStatistic() { hist_free(histogram_); }
 
+uint64_t CircllhistStatistic::memoryUsageBytes() const {
+  // Each bucket is stored along with its count, padded to two 64 bit words. The histogram
+  // allocates its buckets in chunks, so this is a lower bound.
+  return StatisticImpl::memoryUsageBytes() + hist_num_buckets(histogram_) * 2 * sizeof(uint64_t);
+}
+
 void CircllhistStatistic::addValue(uint64_t value) {
   hist_insert_intscale(histogram_, value, 0, 1);
   StatisticImpl::addValue(value);
@@ -402,57 +553,40 @@ nighthawk::client::Statistic CircllhistStatistic::toProto(SerializationDomain do
 }
 
 SinkableStatistic::SinkableStatistic(Envoy::Stats::Scope& scope, absl::optional<int> worker_id)
-    : Envoy::Stats::HistogramImplHelper(scope.symbolTable()), scope_(scope), worker_id_(worker_id) {
-}
+    : scope_(scope), worker_id_(worker_id) {}
 
-SinkableStatistic::~SinkableStatistic() {
-  // We must explicitly free the StatName here in order to supply the
-  // SymbolTable reference.
-  MetricImpl::clear(scope_.symbolTable());
+void SinkableStatistic::resolveSinkHistogram(absl::string_view id) {
+  // Nighthawk::Statistic records latencies in nanoseconds, which Envoy has no unit for.
+  sink_histogram_ =
+      &scope_.histogramFromString(std::string(id), Envoy::Stats::Histogram::Unit::Unspecified);
 }
 
-Envoy::Stats::Histogram::Unit SinkableStatistic::unit() const {
-  return Envoy::Stats::Histogram::Unit::Unspecified;
-}
-
-Envoy::Stats::SymbolTable& SinkableStatistic::symbolTable() { return scope_.symbolTable(); }
-
 SinkableHdrStatistic::SinkableHdrStatistic(Envoy::Stats::Scope& scope,
                                            absl::optional<int> worker_id)
     : SinkableStatistic(scope, worker_id) {}
 
-void SinkableHdrStatistic::recordValue(uint64_t value) {
+void SinkableHdrStatistic::addValue(uint64_t value) {
   HdrStatistic::addValue(value);
-  // Currently in Envoy Scope implementation, deliverHistogramToSinks() will flush the histogram
-  // value directly to stats Sinks.
-  scope_.deliverHistogramToSinks(*this, value);
+  recordInSinkHistogram(value);
 }
 
-std::string SinkableHdrStatistic::tagExtractedName() const {
-  if (worker_id().has_value()) {
-    return fmt::format("{}.{}", worker_id().value(), id());
-  } else {
-    return id();
-  }
+void SinkableHdrStatistic::setId(absl::string_view id) {
+  HdrStatistic::setId(id);
+  resolveSinkHistogram(id);
 }
 
 SinkableCircllhistStatistic::SinkableCircllhistStatistic(Envoy::Stats::Scope& scope,
                                                          absl::optional<int> worker_id)
     : SinkableStatistic(scope, worker_id) {}
 
-void SinkableCircllhistStatistic::recordValue(uint64_t value) {
+void SinkableCircllhistStatistic::addValue(uint64_t value) {
   CircllhistStatistic::addValue(value);
-  // Currently in Envoy Scope implementation, deliverHistogramToSinks() will flush the histogram
-  // value directly to stats Sinks.
-  scope_.deliverHistogramToSinks(*this, value);
+  recordInSinkHistogram(value);
 }
 
-std::string SinkableCircllhistStatistic::tagExtractedName() const {
-  if (worker_id().has_value()) {
-    return fmt::format("{}.{}", worker_id().value(), id());
-  } else {
-    return id();
-  }
+void SinkableCircllhistStatistic::setId(absl::string_view id) {
+  CircllhistStatistic::setId(id);
+  resolveSinkHistogram(id);
 }
 
 } // namespace Nighthawk
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "nighthawk/common/statistic.h"
@@ -28,6 +29,9 @@ public:
   uint64_t min() const override;
   absl::StatusOr<std::unique_ptr<std::istream>> serializeNative() const override;
   absl::Status deserializeNative(std::istream&) override;
+  // Accounts for the members of this base class. Implementations which hold on to more memory
+  // add that.
+  uint64_t memoryUsageBytes() const override;
 
 protected:
   std::string id_;
@@ -124,6 +128,7 @@ public:
   StatisticPtr createNewInstanceOfSameType() const override {
     return std::make_unique<InMemoryStatistic>();
   };
+  uint64_t memoryUsageBytes() const override;
 
 private:
   std::vector<int64_t> samples_;
@@ -145,6 +150,27 @@ public:
   uint64_t max() const override;
   uint64_t min() const override;
 
+  /**
+   * @param percentile the percentile to look up, in the range [0, 100].
+   * @return uint64_t the (approximate) value at the percentile. Zero when no values were recorded.
+   */
+  uint64_t percentile(double percentile) const;
+
+  /**
+   * Looks up a set of percentiles in a single walk over the histogram, instead of one walk per
+   * percentile.
+   *
+   * @param percentiles the percentiles to look up, each in the range [0, 100], in any order.
+   * @return std::vector<uint64_t> the (approximate) values at the percentiles, in the order they
+   * were requested. Equal to what percentile() returns for each of them.
+   */
+  std::vector<uint64_t> percentiles(const std::vector<double>& percentiles) const;
+
+  /**
+   * Discards all recorded values.
+   */
+  void reset();
+
   StatisticPtr combine(const Statistic& statistic) const override;
   nighthawk::client::Statistic toProto(SerializationDomain domain) const override;
   uint64_t significantDigits() const override { return SignificantDigits; }
@@ -154,8 +180,21 @@ public:
 
   absl::StatusOr<std::unique_ptr<std::istream>> serializeNative() const override;
   absl::Status deserializeNative(std::istream&) override;
+  uint64_t memoryUsageBytes() const override;
 
 private:
+  /**
+   * Walks the recorded values once, and finds the first bucket at which each of a set of
+   * cumulative counts is reached.
+   *
+   * @param counts_at the cumulative counts to look for, in ascending order, each at least 1.
+   * @return std::vector<std::pair<uint64_t, int64_t>> for each of counts_at, the highest value
+   * equivalent to the bucket that reaches it and the cumulative count up to and including that
+   * bucket. Zeroes for counts beyond the number of recorded values.
+   */
+  std::vector<std::pair<uint64_t, int64_t>>
+  bucketsReachingCounts(const std::vector<int64_t>& counts_at) const;
+
   static const int SignificantDigits;
   struct hdr_histogram* histogram_;
 };
@@ -181,83 +220,71 @@ public:
   uint64_t significantDigits() const override { return 1; }
   StatisticPtr createNewInstanceOfSameType() const override;
   nighthawk::client::Statistic toProto(SerializationDomain domain) const override;
+  uint64_t memoryUsageBytes() const override;
 
 private:
   histogram_t* histogram_;
 };
 
 /**
- * In order to be able to flush a histogram value to downstream Envoy stats Sinks, abstract class
- * SinkableStatistic takes the Scope reference in the constructor and wraps the
- * Envoy::Stats::HistogramHelper interface. Implementation of sinkable Nighthawk Statistic class
- * will inherit from this class.
+ * Base class of the Nighthawk statistics whose samples also go to the downstream Envoy stats Sinks.
+ * Samples are recorded into an Envoy histogram of the scope, named after the id of the statistic.
+ * The thread local store keeps such histograms per thread and merges them when the stats get
+ * flushed to the sinks, so recording a sample doesn't hand it to every sink.
  */
-class SinkableStatistic : public Envoy::Stats::HistogramImplHelper {
+class SinkableStatistic {
 public:
-  // Calling HistogramImplHelper(SymbolTable& symbol_table) constructor to construct an empty
-  // MetricImpl. This is to bypass the complicated logic of setting up SymbolTable/StatName in
-  // Envoy.
   SinkableStatistic(Envoy::Stats::Scope& scope, absl::optional<int> worker_id);
-  ~SinkableStatistic() override;
+  virtual ~SinkableStatistic() = default;
 
-  // Currently Envoy Histogram Unit supports {Unspecified, Bytes, Microseconds, Milliseconds}. By
-  // default, Nighthawk::Statistic uses nanosecond as the unit of latency histograms, so Unspecified
-  // is returned here to isolate Nighthawk Statistic from Envoy Histogram Unit.
-  Envoy::Stats::Histogram::Unit unit() const override;
-  Envoy::Stats::SymbolTable& symbolTable() override;
   // Return the id of the worker where this statistic is defined. Per worker
   // statistic should always set worker_id. Return absl::nullopt when the
   // statistic is not defined per worker.
   const absl::optional<int> worker_id() const { return worker_id_; }
+  // Return the Envoy histogram the samples are recorded into, or nullptr until the id of the
+  // statistic has been set.
+  const Envoy::Stats::Histogram* sinkHistogram() const { return sink_histogram_; }
 
 protected:
-  // This is used in child class for delivering the histogram data to sinks.
-  Envoy::Stats::Scope& scope_;
+  // Looks up the Envoy histogram named after the id of the statistic. Samples recorded before this
+  // don't reach the sinks.
+  void resolveSinkHistogram(absl::string_view id);
+  void recordInSinkHistogram(uint64_t value) {
+    if (sink_histogram_ != nullptr) {
+      sink_histogram_->recordValue(value);
+    }
+  }
 
 private:
+  Envoy::Stats::Scope& scope_;
   // worker_id can be used in downstream stats Sinks as the stats tag.
   absl::optional<int> worker_id_;
+  Envoy::Stats::Histogram* sink_histogram_{nullptr};
 };
 
 // Implementation of sinkable Nighthawk Statistic with HdrHistogram.
 class SinkableHdrStatistic : public SinkableStatistic, public HdrStatistic {
 public:
-  // The constructor takes the Scope reference which is used to flush a histogram value to
-  // downstream stats Sinks through deliverHistogramToSinks().
+  // The constructor takes the Scope in which the Envoy histogram feeding the stats Sinks gets
+  // created once the id is set.
   SinkableHdrStatistic(Envoy::Stats::Scope& scope, absl::optional<int> worker_id = absl::nullopt);
 
-  // Envoy::Stats::Histogram
-  void recordValue(uint64_t value) override;
-  bool used() const override { return count() > 0; }
-  // Overriding name() to return Nighthawk::Statistic::id().
-  std::string name() const override { return id(); }
-  // Overriding tagExtractedName() to return string(worker_id) + "." + Nighthawk::Statistic::id()
-  // when worker_id is set. The worker_id prefix can be used in customized stats sinks.
-  std::string tagExtractedName() const override;
-
   // Nighthawk::Statistic
-  void addValue(uint64_t value) override { recordValue(value); }
+  void addValue(uint64_t value) override;
+  void setId(absl::string_view id) override;
 };
 
 // Implementation of sinkable Nighthawk Statistic with Circllhist Histogram.
 class SinkableCircllhistStatistic : public SinkableStatistic, public CircllhistStatistic {
 public:
-  // The constructor takes the Scope reference which is used to flush a histogram value to
-  // downstream stats Sinks through deliverHistogramToSinks().
+  // The constructor takes the Scope in which the Envoy histogram feeding the stats Sinks gets
+  // created once the id is set.
   SinkableCircllhistStatistic(Envoy::Stats::Scope& scope,
                               absl::optional<int> worker_id = absl::nullopt);
 
-  // Envoy::Stats::Histogram
-  void recordValue(uint64_t value) override;
-  bool used() const override { return count() > 0; }
-  // Overriding name() to return Nighthawk::Statistic::id().
-  std::string name() const override { return id(); }
-  // Overriding tagExtractedName() to return string(worker_id) + "." + Nighthawk::Statistic::id()
-  // when worker_id is set. The worker_id prefix can be used in customized stats sinks.
-  std::string tagExtractedName() const override;
-
   // Nighthawk::Statistic
-  void addValue(uint64_t value) override { recordValue(value); }
+  void addValue(uint64_t value) override;
+  void setId(absl::string_view id) override;
 };
 
 } // namespace Nighthawk
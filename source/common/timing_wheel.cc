@@ -0,0 +1,126 @@
+#include "source/common/timing_wheel.h"
+
+#include <algorithm>
+
+#include "external/envoy/source/common/common/assert.h"
+
+namespace Nighthawk {
+
+TimingWheelEntry::~TimingWheelEntry() { unschedule(); }
+
+void TimingWheelEntry::unschedule() {
+  if (wheel_ != nullptr) {
+    wheel_->unschedule(*this);
+  }
+}
+
+TimingWheel::TimingWheel(Envoy::Event::Dispatcher& dispatcher, Envoy::TimeSource& time_source,
+                         std::chrono::nanoseconds timeout, uint32_t slots_per_timeout)
+    : time_source_(time_source), timeout_(timeout),
+      tick_(std::max(timeout / std::max(slots_per_timeout, 1u), std::chrono::nanoseconds(1))),
+      start_(time_source_.monotonicTime()),
+      // One extra slot for rounding deadlines up, and one for the tick we are in.
+      slots_((timeout_ + tick_ - std::chrono::nanoseconds(1)) / tick_ + 2),
+      timer_(dispatcher.createTimer([this]() { onTick(); })) {
+  ASSERT(timeout_.count() > 0);
+}
+
+TimingWheel::~TimingWheel() {
+  // Entries may outlive the wheel. Make sure they won't reach back into it.
+  const auto detach = [](EntryList& list) {
+    for (TimingWheelEntry* entry = list.head; entry != nullptr; entry = entry->next_) {
+      entry->wheel_ = nullptr;
+    }
+  };
+  detach(expiring_);
+  for (EntryList& slot : slots_) {
+    detach(slot);
+  }
+}
+
+void TimingWheel::pushBack(EntryList& list, TimingWheelEntry& entry) {
+  entry.previous_ = list.tail;
+  entry.next_ = nullptr;
+  (list.tail != nullptr ? list.tail->next_ : list.head) = &entry;
+  list.tail = &entry;
+}
+
+void TimingWheel::remove(EntryList& list, TimingWheelEntry& entry) {
+  (entry.previous_ != nullptr ? entry.previous_->next_ : list.head) = entry.next_;
+  (entry.next_ != nullptr ? entry.next_->previous_ : list.tail) = entry.previous_;
+  entry.previous_ = nullptr;
+  entry.next_ = nullptr;
+}
+
+void TimingWheel::schedule(TimingWheelEntry& entry) { schedule(entry, timeout_); }
+
+void TimingWheel::schedule(TimingWheelEntry& entry, std::chrono::nanoseconds delay) {
+  entry.unschedule();
+  if (size_ == 0) {
+    // Nothing was scheduled, so there is nothing to catch up on for the ticks we skipped.
+    expired_through_tick_ = ticksSinceStart();
+  }
+  const std::chrono::nanoseconds deadline =
+      (time_source_.monotonicTime() - start_) + std::min(delay, timeout_);
+  // Round up, so entries never expire early. Entries that are due right away expire on the next
+  // tick, as the current one may already have been expired.
+  const uint64_t deadline_tick = (deadline + tick_ - std::chrono::nanoseconds(1)) / tick_;
+  entry.deadline_tick_ = std::max(deadline_tick, expired_through_tick_ + 1);
+  entry.slot_ = entry.deadline_tick_ % slots_.size();
+  pushBack(slots_[entry.slot_], entry);
+  entry.wheel_ = this;
+  if (size_++ == 0) {
+    armTimer();
+  }
+}
+
+void TimingWheel::unschedule(TimingWheelEntry& entry) {
+  ASSERT(entry.wheel_ == this);
+  remove(listOf(entry), entry);
+  entry.wheel_ = nullptr;
+  if (--size_ == 0) {
+    timer_->disableTimer();
+  }
+}
+
+uint64_t TimingWheel::ticksSinceStart() const {
+  return (time_source_.monotonicTime() - start_) / tick_;
+}
+
+void TimingWheel::armTimer() {
+  const std::chrono::nanoseconds until_next_tick =
+      tick_ * (ticksSinceStart() + 1) - (time_source_.monotonicTime() - start_);
+  timer_->enableHRTimer(std::chrono::duration_cast<std::chrono::microseconds>(until_next_tick));
+}
+
+void TimingWheel::onTick() {
+  const uint64_t now_tick = ticksSinceStart();
+  // When the event loop stalled for a while, a single pass over all slots is enough to catch up.
+  const uint64_t ticks_to_expire =
+      std::min<uint64_t>(now_tick - expired_through_tick_, slots_.size());
+  for (uint64_t tick = now_tick - ticks_to_expire + 1; tick <= now_tick; tick++) {
+    EntryList& slot = slots_[tick % slots_.size()];
+    for (TimingWheelEntry* entry = slot.head; entry != nullptr;) {
+      TimingWheelEntry* next = entry->next_;
+      if (entry->deadline_tick_ <= now_tick) {
+        // Move the entry over to the expiring list.
+        remove(slot, *entry);
+        pushBack(expiring_, *entry);
+        entry->slot_ = slots_.size();
+      }
+      entry = next;
+    }
+  }
+  expired_through_tick_ = now_tick;
+  // Expiry callbacks may schedule and unschedule entries, including the ones on the expiring list.
+  while (expiring_.head != nullptr) {
+    TimingWheelEntry* entry = expiring_.head;
+    unschedule(*entry);
+    entry->onExpired();
+  }
+  if (size_ > 0) {
+    armTimer();
+  }
+}
+
+} // namespace Nighthawk
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Nighthawk {
+
+class TimingWheel;
+
+/**
+ * Something that can be scheduled to expire in a TimingWheel.
+ */
+class TimingWheelEntry {
+public:
+  virtual ~TimingWheelEntry();
+
+  /**
+   * Called by the timing wheel when the entry expires. The entry is no longer scheduled at this
+   * point.
+   */
+  virtual void onExpired() PURE;
+
+  /**
+   * Removes the entry from the timing wheel it is scheduled in, if any. Safe to call when the
+   * entry isn't scheduled.
+   */
+  void unschedule();
+
+  /**
+   * @return bool true iff the entry is scheduled in a timing wheel.
+   */
+  bool scheduled() const { return wheel_ != nullptr; }
+
+private:
+  friend class TimingWheel;
+
+  TimingWheel* wheel_{};
+  uint64_t deadline_tick_{};
+  // Index of the slot holding the entry. Equals the number of slots while the entry is expiring.
+  size_t slot_{};
+  // Neighbors in the list of the slot holding the entry. Entries link up among themselves, so
+  // scheduling never allocates.
+  TimingWheelEntry* previous_{};
+  TimingWheelEntry* next_{};
+};
+
+/**
+ * Expires entries after a timeout, using a single dispatcher timer for all of them. Entries
+ * are hashed into slots by deadline, so scheduling and unscheduling are O(1) and the timer only
+ * ever needs to be armed for the next tick. Entries expire on the first tick at or after their
+ * deadline, so they may expire up to one tick late, but never early. The timer is only armed while
+ * entries are scheduled. Not thread safe; intended to be used by a single worker.
+ */
+class TimingWheel {
+public:
+  /**
+   * @param dispatcher dispatcher used to create the tick timer.
+   * @param time_source time source used to compute deadlines.
+   * @param timeout the time after which scheduled entries expire. Must be greater than zero.
+   * @param slots_per_timeout the number of ticks the timeout is divided into, which determines the
+   * resolution of the deadlines.
+   */
+  TimingWheel(Envoy::Event::Dispatcher& dispatcher, Envoy::TimeSource& time_source,
+              std::chrono::nanoseconds timeout, uint32_t slots_per_timeout = 32);
+  ~TimingWheel();
+
+  /**
+   * Schedules an entry to expire after the timeout. Entries that are already scheduled will be
+   * rescheduled.
+   * @param entry the entry to schedule. Must stay alive until it expires or is unscheduled.
+   */
+  void schedule(TimingWheelEntry& entry);
+
+  /**
+   * Schedules an entry to expire after a delay. Entries that are already scheduled will be
+   * rescheduled.
+   * @param entry the entry to schedule. Must stay alive until it expires or is unscheduled.
+   * @param delay the time after which the entry expires. Delays longer than the timeout of the
+   * wheel are capped to the timeout.
+   */
+  void schedule(TimingWheelEntry& entry, std::chrono::nanoseconds delay);
+
+  /**
+   * @return uint64_t the number of currently scheduled entries.
+   */
+  uint64_t size() const { return size_; }
+
+  /**
+   * @return std::chrono::nanoseconds the resolution of the deadlines.
+   */
+  std::chrono::nanoseconds tick() const { return tick_; }
+
+private:
+  friend class TimingWheelEntry;
+
+  // Doubly linked list of entries, threaded through their previous_ and next_ members.
+  struct EntryList {
+    TimingWheelEntry* head{};
+    TimingWheelEntry* tail{};
+  };
+
+  static void pushBack(EntryList& list, TimingWheelEntry& entry);
+  static void remove(EntryList& list, TimingWheelEntry& entry);
+  EntryList& listOf(const TimingWheelEntry& entry) {
+    return entry.slot_ == slots_.size() ? expiring_ : slots_[entry.slot_];
+  }
+  void unschedule(TimingWheelEntry& entry);
+  uint64_t ticksSinceStart() const;
+  void armTimer();
+  void onTick();
+
+  Envoy::TimeSource& time_source_;
+  const std::chrono::nanoseconds timeout_;
+  const std::chrono::nanoseconds tick_;
+  const Envoy::MonotonicTime start_;
+  // Holds the entries scheduled to expire at tick t in slot t % slots_.size(). When the event loop
+  // lags behind, a slot may also hold entries of a later revolution, so expiry checks deadlines.
+  std::vector<EntryList> slots_;
+  // Entries that are due, and will have their expiry callbacks run during the current tick.
+  EntryList expiring_;
+  // All slots up to and including this tick have been expired.
+  uint64_t expired_through_tick_{};
+  uint64_t size_{};
+  Envoy::Event::TimerPtr timer_;
+};
+
+} // namespace Nighthawk
@@ -0,0 +1,162 @@
+#include "source/common/tsc_time_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace Nighthawk {
+namespace {
+
+// How long each of the two calibration rounds takes.
+constexpr std::chrono::milliseconds kCalibrationDuration{10};
+// Calibration is preceded by a round of this duration, of which the result is discarded.
+constexpr std::chrono::milliseconds kWarmupDuration{1};
+// The maximum relative difference between the results of the two calibration rounds.
+constexpr double kMaxCalibrationDeviation = 1e-4;
+// A sample of the counter and the clock is retried when reading them took longer than this.
+constexpr std::chrono::microseconds kMaxSampleDuration{20};
+constexpr int kMaxSampleAttempts = 5;
+
+uint64_t readTsc() {
+#if defined(__x86_64__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Samples the counter and monotonic time at (approximately) the same moment, by taking the midpoint
+// of the counter values read right before and after reading the clock.
+std::pair<uint64_t, Envoy::MonotonicTime> sample(Envoy::TimeSource& time_source) {
+  const uint64_t before = readTsc();
+  const Envoy::MonotonicTime time = time_source.monotonicTime();
+  const uint64_t after = readTsc();
+  return {before + (after - before) / 2, time};
+}
+
+// Returns the number of nanoseconds per tick, measured over (at least) the duration. Only the
+// samples at either end matter, so the thread sleeps in between.
+double calibrate(Envoy::TimeSource& time_source, std::chrono::nanoseconds duration) {
+  const auto start = sample(time_source);
+  std::this_thread::sleep_for(duration);
+  const auto end = sample(time_source);
+  if (end.first <= start.first) {
+    return 0;
+  }
+  return static_cast<double>((end.second - start.second).count()) / (end.first - start.first);
+}
+
+std::atomic<uint64_t> next_id{1};
+
+} // namespace
+
+bool TscTimeSystem::hasInvariantTsc() {
+#if defined(__x86_64__)
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  // The invariant TSC flag of the advanced power management information.
+  return (edx & (1u << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<TscTimeSystem> TscTimeSystem::create() {
+  if (!hasInvariantTsc()) {
+    ENVOY_LOG(warn, "The CPU doesn't have an invariant TSC.");
+    return nullptr;
+  }
+  Envoy::Event::RealTimeSystem real_time_system; // NO_CHECK_FORMAT(real_time)
+  // The first clock reads are slow, which would skew the first calibration round.
+  calibrate(real_time_system, kWarmupDuration);
+  // Two independent calibration rounds should agree, otherwise the counter isn't trustworthy.
+  const double first = calibrate(real_time_system, kCalibrationDuration);
+  const double second = calibrate(real_time_system, kCalibrationDuration);
+  if (first <= 0 || second <= 0 || std::abs(first - second) / first > kMaxCalibrationDeviation) {
+    ENVOY_LOG(warn, "TSC calibration yielded inconsistent results: {} and {} ns per tick.", first,
+              second);
+    return nullptr;
+  }
+  ENVOY_LOG(info, "Calibrated the TSC at {} ns per tick.", (first + second) / 2);
+  return std::unique_ptr<TscTimeSystem>(new TscTimeSystem((first + second) / 2));
+}
+
+TscTimeSystem::TscTimeSystem(double ns_per_tick)
+    : ns_per_tick_(ns_per_tick),
+      drift_check_ticks_(static_cast<uint64_t>(
+          std::chrono::nanoseconds(DriftCheckInterval).count() / ns_per_tick)),
+      max_sample_ticks_(static_cast<uint64_t>(
+          std::chrono::nanoseconds(kMaxSampleDuration).count() / ns_per_tick)),
+      id_(next_id++) {}
+
+TscTimeSystem::ThreadAnchor& TscTimeSystem::threadAnchor() {
+  static thread_local ThreadAnchor anchor;
+  return anchor;
+}
+
+Envoy::MonotonicTime TscTimeSystem::monotonicTime() {
+  if (!reliable()) {
+    return RealTimeSystem::monotonicTime();
+  }
+  ThreadAnchor& anchor = threadAnchor();
+  const uint64_t tsc = readTsc();
+  // When the counter went backwards, the unsigned difference wraps around, which also triggers a
+  // drift check.
+  if (anchor.owner_id != id_ || tsc - anchor.tsc >= drift_check_ticks_) {
+    return reanchor(anchor);
+  }
+  anchor.last_time = std::max(anchor.last_time, timeAt(anchor, tsc));
+  return anchor.last_time;
+}
+
+Envoy::MonotonicTime TscTimeSystem::timeAt(const ThreadAnchor& anchor, uint64_t tsc) const {
+  return anchor.time +
+         std::chrono::nanoseconds(static_cast<int64_t>((tsc - anchor.tsc) * ns_per_tick_));
+}
+
+Envoy::MonotonicTime TscTimeSystem::reanchor(ThreadAnchor& anchor) {
+  // Being interrupted in between reading the counter and the clock would skew the anchor, and make
+  // the next drift check fail. Such samples are retried.
+  uint64_t tsc;
+  Envoy::MonotonicTime now;
+  for (int attempt = 1;; attempt++) {
+    const uint64_t before = readTsc();
+    now = RealTimeSystem::monotonicTime();
+    const uint64_t after = readTsc();
+    tsc = before + (after - before) / 2;
+    if (after - before <= max_sample_ticks_ || attempt == kMaxSampleAttempts) {
+      break;
+    }
+  }
+  if (anchor.owner_id == id_) {
+    const std::chrono::nanoseconds drift =
+        tsc < anchor.tsc ? std::chrono::nanoseconds::max() : timeAt(anchor, tsc) - now;
+    // Threads may not read the time for much longer than the drift check interval, for example the
+    // main thread while the workers run. Those just re-anchor after a long pause.
+    const int64_t intervals =
+        tsc < anchor.tsc ? 1 : std::max<int64_t>((tsc - anchor.tsc) / drift_check_ticks_, 1);
+    const std::chrono::nanoseconds max_drift = MaxDrift * intervals;
+    if (intervals <= MaxDriftCheckIntervals && (drift > max_drift || drift < -max_drift)) {
+      reliable_.store(false, std::memory_order_relaxed);
+      ENVOY_LOG(warn, "The TSC drifted away from the monotonic clock, falling back to the latter.");
+    }
+    anchor.last_time = std::max(anchor.last_time, now);
+  } else {
+    anchor.owner_id = id_;
+    anchor.last_time = now;
+  }
+  anchor.tsc = tsc;
+  anchor.time = now;
+  return anchor.last_time;
+}
+
+} // namespace Nighthawk
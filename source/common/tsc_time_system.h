@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "external/envoy/source/common/common/logger.h"
+#include "external/envoy/source/common/event/real_time_system.h"
+
+namespace Nighthawk {
+
+/**
+ * Time system which derives monotonic time from the invariant time stamp counter (TSC) of the CPU,
+ * which is cheaper to read than CLOCK_MONOTONIC. The counter is calibrated against CLOCK_MONOTONIC
+ * when the time system is created. Every thread re-anchors the counter to CLOCK_MONOTONIC
+ * periodically, which bounds the error accumulated because of calibration inaccuracies. When the
+ * counter drifts away too far, all threads fall back to CLOCK_MONOTONIC for good. Everything else,
+ * like system time and timers, is provided by the real time system.
+ *
+ * Plugging this into Envoy::Api::Api makes the dispatchers, and therefore CachedTimeSourceImpl, as
+ * well as the latency measurements which use the time source of the api use the counter.
+ */
+class TscTimeSystem : public Envoy::Event::RealTimeSystem,
+                      public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  // How often each thread compares the counter against CLOCK_MONOTONIC.
+  static constexpr std::chrono::milliseconds DriftCheckInterval{100};
+  // The counter is considered to be unreliable when it deviates more than this from
+  // CLOCK_MONOTONIC per drift check interval. A thread which didn't read the time for several
+  // intervals tolerates a proportionally larger deviation, as the calibration error accumulates
+  // with the time passed since the thread last re-anchored, up to MaxDriftCheckIntervals.
+  static constexpr std::chrono::microseconds MaxDrift{500};
+  // A thread which didn't read the time for more intervals than this re-anchors without checking
+  // the drift, which would mostly reflect the calibration error accumulated over the pause.
+  static constexpr int64_t MaxDriftCheckIntervals{10};
+
+  /**
+   * Calibrates the counter, which takes about 21ms. The calling thread sleeps in between the
+   * samples taken for calibration, rather than spinning.
+   *
+   * @return std::unique_ptr<TscTimeSystem> a calibrated time system, or nullptr when the CPU
+   * doesn't have an invariant TSC, or when calibration yields inconsistent results.
+   */
+  static std::unique_ptr<TscTimeSystem> create();
+
+  /**
+   * @return bool true iff the CPU has a TSC which ticks at a constant rate, regardless of frequency
+   * scaling and power states.
+   */
+  static bool hasInvariantTsc();
+
+  // Envoy::TimeSource
+  Envoy::MonotonicTime monotonicTime() override;
+
+  /**
+   * @return bool false once the counter got found to be unreliable, after which monotonicTime()
+   * reads CLOCK_MONOTONIC.
+   */
+  bool reliable() const { return reliable_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return double the number of nanoseconds per tick, as determined by calibration.
+   */
+  double nanosecondsPerTick() const { return ns_per_tick_; }
+
+private:
+  // The anchor of a thread, which maps a counter value to a point in monotonic time.
+  struct ThreadAnchor {
+    uint64_t owner_id{};
+    uint64_t tsc{};
+    Envoy::MonotonicTime time;
+    // The last time returned on the thread, which keeps time from going backwards when
+    // re-anchoring.
+    Envoy::MonotonicTime last_time;
+  };
+
+  explicit TscTimeSystem(double ns_per_tick);
+  Envoy::MonotonicTime timeAt(const ThreadAnchor& anchor, uint64_t tsc) const;
+  Envoy::MonotonicTime reanchor(ThreadAnchor& anchor);
+  static ThreadAnchor& threadAnchor();
+
+  const double ns_per_tick_;
+  const uint64_t drift_check_ticks_;
+  const uint64_t max_sample_ticks_;
+  // Distinguishes the anchors of this instance from those of instances which lived before it.
+  const uint64_t id_;
+  std::atomic<bool> reliable_{true};
+};
+
+} // namespace Nighthawk
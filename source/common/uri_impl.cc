@@ -1,6 +1,9 @@
 #include "source/common/uri_impl.h"
 
+#include "envoy/common/exception.h"
+
 #include "external/envoy/source/common/http/utility.h"
+#include "external/envoy/source/common/network/address_impl.h"
 #include "external/envoy/source/common/network/dns_resolver/dns_factory_util.h"
 #include "external/envoy/source/common/network/utility.h"
 #include "external/envoy_api/envoy/config/core/v3/resolver.pb.h"
@@ -24,6 +27,11 @@ bool UriImpl::isValid() const {
 
 UriImpl::UriImpl(absl::string_view uri, absl::string_view default_scheme)
     : scheme_(default_scheme) {
+  constexpr absl::string_view unix_scheme_prefix = "unix://";
+  if (absl::StartsWithIgnoreCase(uri, unix_scheme_prefix)) {
+    parseUnixSocketUri(uri.substr(unix_scheme_prefix.size()));
+    return;
+  }
   absl::string_view host, path;
   Envoy::Http::Utility::extractHostPathFromUri(uri, host, path);
 
@@ -62,6 +70,24 @@ UriImpl::UriImpl(absl::string_view uri, absl::string_view default_scheme)
   }
 }
 
+void UriImpl::parseUnixSocketUri(absl::string_view socket_and_path) {
+  scheme_ = "unix";
+  // Like nginx does, we separate the socket path from the request path with a colon:
+  // unix:///run/sidecar.sock:/path, or unix://@sidecar:/path for abstract sockets.
+  const size_t path_separator = socket_and_path.find(":/");
+  pipe_path_ = std::string(socket_and_path.substr(0, path_separator));
+  path_ = path_separator == absl::string_view::npos
+              ? "/"
+              : std::string(socket_and_path.substr(path_separator + 1));
+  if (pipe_path_.size() < 2 || (pipe_path_[0] != '/' && pipe_path_[0] != '@')) {
+    throw UriException("Invalid URI, the socket path must be absolute, or start with '@' for "
+                       "an abstract socket");
+  }
+  // There is no host to speak of, so requests will carry a Host header of "localhost".
+  host_without_port_ = "localhost";
+  host_and_port_ = host_without_port_;
+}
+
 bool UriImpl::performDnsLookup(Envoy::Event::Dispatcher& dispatcher,
                                Envoy::Network::DnsResolver& dns_resolver,
                                const Envoy::Network::DnsLookupFamily dns_lookup_family) {
@@ -99,6 +125,16 @@ UriImpl::resolve(Envoy::Event::Dispatcher& dispatcher, Envoy::Network::DnsResolv
   }
   resolve_attempted_ = true;
 
+  if (!pipe_path_.empty()) {
+    try {
+      address_ = std::make_shared<Envoy::Network::Address::PipeInstance>(pipe_path_);
+    } catch (const Envoy::EnvoyException& ex) {
+      ENVOY_LOG(warn, "Bad unix domain socket path '{}': {}", pipe_path_, ex.what());
+      throw UriException("Could not determine address");
+    }
+    return address_;
+  }
+
   bool ok = performDnsLookup(dispatcher, dns_resolver, dns_lookup_family);
 
   // Ensure that we figured out a fitting match for the requested dns lookup family.
@@ -32,6 +32,7 @@ public:
   }
 
 private:
+  void parseUnixSocketUri(absl::string_view socket_and_path);
   bool isValid() const;
   bool performDnsLookup(Envoy::Event::Dispatcher& dispatcher,
                         Envoy::Network::DnsResolver& dns_resolver,
@@ -44,6 +45,8 @@ private:
   std::string path_;
   uint64_t port_{};
   std::string scheme_;
+  // The path of the unix domain socket for unix:// uris. Starts with '@' for abstract sockets.
+  std::string pipe_path_;
 
   Envoy::Network::Address::InstanceConstSharedPtr address_;
   bool resolve_attempted_{};
@@ -1,5 +1,9 @@
 #include "source/common/utility.h"
 
+#include <unistd.h>
+
+#include <fstream>
+
 #include "nighthawk/common/exception.h"
 
 #include "external/envoy/source/common/http/utility.h"
@@ -82,4 +86,28 @@ bool Utility::parseHostPort(const std::string& host_port, std::string* address,
          RE2::FullMatch(host_port, R"(([-.0-9a-zA-Z]+):(\d+))", address, port);
 }
 
+absl::optional<uint64_t> Utility::residentSetSizeBytes() {
+  // The second field of statm holds the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size_pages = 0;
+  uint64_t resident_pages = 0;
+  if (!(statm >> size_pages >> resident_pages)) {
+    return absl::nullopt;
+  }
+  return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+absl::optional<uint64_t> Utility::peakResidentSetSizeBytes() {
+  // The high water mark of the resident set size is reported as "VmHWM:  <size> kB".
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    uint64_t size_kb = 0;
+    if (RE2::FullMatch(line, R"(VmHWM:\s*(\d+) kB)", &size_kb)) {
+      return size_kb * 1024;
+    }
+  }
+  return absl::nullopt;
+}
+
 } // namespace Nighthawk
@@ -11,6 +11,7 @@
 #include "api/client/options.pb.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "re2/re2.h"
 #include "tclap/CmdLine.h"
 
@@ -64,6 +65,18 @@ public:
    * @return bool true if the input could be parsed as host:port
    */
   static bool parseHostPort(const std::string& host_port, std::string* host, int* port);
+
+  /**
+   * @return absl::optional<uint64_t> the resident set size of the process in bytes, or
+   * absl::nullopt when it can't be determined on this platform.
+   */
+  static absl::optional<uint64_t> residentSetSizeBytes();
+
+  /**
+   * @return absl::optional<uint64_t> the largest resident set size the process reached so far in
+   * bytes, or absl::nullopt when it can't be determined on this platform.
+   */
+  static absl::optional<uint64_t> peakResidentSetSizeBytes();
 };
 
 } // namespace Nighthawk
@@ -1,5 +1,9 @@
 #include "source/request_source/request_options_list_plugin_impl.h"
 
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
 #include "external/envoy/source/common/protobuf/message_validator_impl.h"
 #include "external/envoy/source/common/protobuf/utility.h"
 #include "external/envoy/source/exe/platform_impl.h"
@@ -10,6 +14,26 @@
 #include "source/common/request_source_impl.h"
 
 namespace Nighthawk {
+namespace {
+
+// Throws when the entries of a weighted options_list all have a weight of zero, as there is nothing
+// to pick from then.
+void validateWeights(const nighthawk::client::RequestOptionsList& options_list) {
+  bool weighted = false;
+  for (const nighthawk::client::RequestOptions& request_options : options_list.options()) {
+    if (!request_options.has_weight() || request_options.weight().value() > 0) {
+      return;
+    }
+    weighted = true;
+  }
+  if (weighted) {
+    throw Envoy::EnvoyException(
+        "the options_list is weighted, but none of its entries has a positive weight");
+  }
+}
+
+} // namespace
+
 std::string FileBasedOptionsListRequestSourceFactory::name() const {
   return "nighthawk.file-based-request-source-plugin";
 }
@@ -37,6 +61,7 @@ RequestSourcePtr FileBasedOptionsListRequestSourceFactory::createRequestSourcePl
     util.loadFromFile(config.file_path(), loaded_list,
                       Envoy::ProtobufMessage::getStrictValidationVisitor(), api);
   }
+  validateWeights(loaded_list);
   auto loaded_list_ptr = std::make_unique<const nighthawk::client::RequestOptionsList>(loaded_list);
   return std::make_unique<OptionsListRequestSource>(config.num_requests(), std::move(header),
                                                     std::move(loaded_list_ptr));
@@ -58,6 +83,7 @@ RequestSourcePtr InLineOptionsListRequestSourceFactory::createRequestSourcePlugi
   const auto& any = dynamic_cast<const Envoy::ProtobufWkt::Any&>(message);
   nighthawk::request_source::InLineOptionsListRequestSourceConfig config;
   Envoy::MessageUtil::unpackTo(any, config);
+  validateWeights(config.options_list());
   auto loaded_list_ptr =
       std::make_unique<const nighthawk::client::RequestOptionsList>(config.options_list());
   return std::make_unique<OptionsListRequestSource>(config.num_requests(), std::move(header),
@@ -70,7 +96,26 @@ OptionsListRequestSource::OptionsListRequestSource(
     const uint32_t total_requests, Envoy::Http::RequestHeaderMapPtr header,
     std::unique_ptr<const nighthawk::client::RequestOptionsList> options_list)
     : header_(std::move(header)), options_list_(std::move(options_list)),
-      total_requests_(total_requests) {}
+      total_requests_(total_requests), yields_per_options_index_(options_list_->options_size()) {
+  const auto& options = options_list_->options();
+  if (std::any_of(options.begin(), options.end(),
+                  [](const nighthawk::client::RequestOptions& request_options) {
+                    return request_options.has_weight();
+                  })) {
+    std::vector<double> weights;
+    for (const nighthawk::client::RequestOptions& request_options : options) {
+      weights.push_back(request_options.has_weight() ? request_options.weight().value() : 1);
+    }
+    alias_table_ = std::make_unique<const AliasTable>(weights);
+  }
+}
+
+uint32_t OptionsListRequestSource::nextOptionsIndex(uint32_t request_number) {
+  const uint32_t index = alias_table_ != nullptr ? alias_table_->sample(bit_gen_)
+                                                 : request_number % options_list_->options_size();
+  ++yields_per_options_index_[index];
+  return index;
+}
 
 RequestGenerator OptionsListRequestSource::get() {
   request_count_.push_back(0);
@@ -90,8 +135,8 @@ RequestGenerator OptionsListRequestSource::get() {
     }
 
     // Increment the counter and get the request_option from the list for the current iteration.
-    const uint32_t index = lambda_counter % options_list_->options_size();
-    nighthawk::client::RequestOptions request_option = options_list_->options().at(index);
+    const uint32_t index = nextOptionsIndex(lambda_counter);
+    const nighthawk::client::RequestOptions& request_option = options_list_->options().at(index);
     ++lambda_counter;
 
     // Override the default values with the values from the request_option
@@ -106,11 +151,31 @@ RequestGenerator OptionsListRequestSource::get() {
       auto lower_case_key = Envoy::Http::LowerCaseString(std::string(option_header.header().key()));
       header->setCopy(lower_case_key, std::string(option_header.header().value()));
     }
-    return std::make_unique<RequestImpl>(std::move(header));
+    return std::make_unique<RequestImpl>(std::move(header), index);
   };
   return request_generator;
 }
 
+std::vector<std::string> OptionsListRequestSource::requestClassNames() const {
+  std::vector<std::string> names;
+  if (options_list_->options_size() > 1) {
+    for (int i = 0; i < options_list_->options_size(); i++) {
+      names.push_back(std::to_string(i));
+    }
+  }
+  return names;
+}
+
+std::vector<RequestClassMix> OptionsListRequestSource::requestClassMix() const {
+  std::vector<RequestClassMix> mix;
+  if (alias_table_ != nullptr) {
+    for (size_t i = 0; i < yields_per_options_index_.size(); i++) {
+      mix.push_back({yields_per_options_index_[i], alias_table_->probability(i)});
+    }
+  }
+  return mix;
+}
+
 void OptionsListRequestSource::initOnThread() {}
 void OptionsListRequestSource::destroyOnThread() {}
 
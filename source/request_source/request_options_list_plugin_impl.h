@@ -11,6 +11,7 @@
 #include "api/client/options.pb.h"
 #include "api/request_source/request_source_plugin.pb.h"
 
+#include "source/common/alias_table.h"
 #include "source/common/uri_impl.h"
 
 namespace Nighthawk {
@@ -25,7 +26,10 @@ namespace Nighthawk {
 // source. The RequestGenerator produced by get() will use options from the options_list to
 // overwrite values in the default header, and create new requests. if total_requests is greater
 // than the length of options_list, it will loop. If the options_list_ is empty, we just return the
-// default header. This is not thread safe.
+// default header. This is not thread safe. When the options_list holds more than one entry, each
+// yielded request is classified by the index of the entry it was created from. When any entry has a
+// weight, entries are sampled in proportion to their weights through an alias table instead of
+// being cycled through, and the achieved mix is reported against the targets by requestClassMix().
 class OptionsListRequestSource : public RequestSource {
 public:
   OptionsListRequestSource(
@@ -40,11 +44,23 @@ public:
   void initOnThread() override;
   void destroyOnThread() override;
 
+  // Names the request classes after the indices of the entries in the options_list.
+  std::vector<std::string> requestClassNames() const override;
+
+  // Only reports a mix when the options_list is weighted.
+  std::vector<RequestClassMix> requestClassMix() const override;
+
 private:
+  uint32_t nextOptionsIndex(uint32_t request_number);
+
   Envoy::Http::RequestHeaderMapPtr header_;
   std::unique_ptr<const nighthawk::client::RequestOptionsList> options_list_;
   std::vector<uint32_t> request_count_;
   const uint32_t total_requests_;
+  // Only set when the options_list is weighted.
+  std::unique_ptr<const AliasTable> alias_table_;
+  absl::BitGen bit_gen_;
+  std::vector<uint64_t> yields_per_options_index_;
 };
 
 // Factory that creates a OptionsListRequestSource from a FileBasedOptionsListRequestSourceConfig
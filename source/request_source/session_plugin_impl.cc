@@ -0,0 +1,230 @@
+#include "source/request_source/session_plugin_impl.h"
+
+#include "nighthawk/common/exception.h"
+
+#include "external/envoy/source/common/http/header_map_impl.h"
+#include "external/envoy/source/common/protobuf/utility.h"
+
+#include "source/common/request_impl.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Nighthawk {
+
+using nighthawk::request_source::SessionRequestSourceConfig;
+
+SessionValueTemplate::SessionValueTemplate(
+    absl::string_view value, absl::flat_hash_map<std::string, uint32_t>& variable_indices) {
+  segments_.push_back({});
+  while (!value.empty()) {
+    const size_t open = value.find("{{");
+    const size_t close = open == absl::string_view::npos ? open : value.find("}}", open + 2);
+    if (close == absl::string_view::npos) {
+      absl::StrAppend(&segments_.back().literal, value);
+      break;
+    }
+    absl::StrAppend(&segments_.back().literal, value.substr(0, open));
+    const std::string name(value.substr(open + 2, close - open - 2));
+    // Indices are handed out in order of first reference.
+    segments_.back().variable =
+        variable_indices.try_emplace(name, variable_indices.size()).first->second;
+    segments_.push_back({});
+    value.remove_prefix(close + 2);
+  }
+}
+
+std::string SessionValueTemplate::render(const std::vector<std::string>& variables) const {
+  std::string rendered;
+  for (const Segment& segment : segments_) {
+    absl::StrAppend(&rendered, segment.literal);
+    if (segment.variable.has_value()) {
+      absl::StrAppend(&rendered, variables[segment.variable.value()]);
+    }
+  }
+  return rendered;
+}
+
+SessionScript::SessionScript(const SessionRequestSourceConfig& config,
+                             const Envoy::Http::RequestHeaderMap& default_header)
+    : max_response_body_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_response_body_bytes, 4096)) {
+  absl::flat_hash_map<std::string, uint32_t> variable_indices;
+  for (int i = 0; i < config.steps_size(); i++) {
+    const SessionRequestSourceConfig::Step& step_config = config.steps(i);
+    const nighthawk::client::RequestOptions& request_options = step_config.request_options();
+    Step step;
+    step.name = step_config.name().empty() ? std::to_string(i) : step_config.name();
+    Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+    Envoy::Http::HeaderMapImpl::copyFrom(*header, default_header);
+    if (request_options.request_method() != envoy::config::core::v3::METHOD_UNSPECIFIED) {
+      header->setMethod(
+          envoy::config::core::v3::RequestMethod_Name(request_options.request_method()));
+    }
+    const uint32_t content_length = request_options.request_body_size().value();
+    if (content_length > 0) {
+      header->setContentLength(content_length);
+    }
+    for (const envoy::config::core::v3::HeaderValueOption& option_header :
+         request_options.request_headers()) {
+      const Envoy::Http::LowerCaseString key(option_header.header().key());
+      SessionValueTemplate value_template(option_header.header().value(), variable_indices);
+      if (value_template.hasReferences()) {
+        step.templated_headers.emplace_back(key, std::move(value_template));
+      } else {
+        header->setCopy(key, option_header.header().value());
+      }
+    }
+    step.header = std::move(header);
+    for (const SessionRequestSourceConfig::Extraction& extraction_config :
+         step_config.extractions()) {
+      Extraction extraction;
+      extraction.variable =
+          variable_indices.try_emplace(extraction_config.variable(), variable_indices.size())
+              .first->second;
+      if (extraction_config.has_response_body()) {
+        extraction.body_after = extraction_config.response_body().after();
+        extraction.body_until = extraction_config.response_body().until();
+        step.needs_response_body = true;
+      } else {
+        extraction.header = Envoy::Http::LowerCaseString(extraction_config.response_header());
+      }
+      step.extractions.push_back(std::move(extraction));
+    }
+    steps_.push_back(std::move(step));
+  }
+  if (steps_.empty()) {
+    throw NighthawkException("A session needs at least one step");
+  }
+  variable_count_ = variable_indices.size();
+}
+
+Session::Session(std::shared_ptr<const SessionScript> script,
+                 std::shared_ptr<ReadyQueue> ready_queue)
+    : script_(std::move(script)), ready_queue_(std::move(ready_queue)),
+      variables_(script_->variableCount()) {}
+
+RequestPtr Session::nextRequest() {
+  const SessionScript::Step& step = script_->steps()[current_step_];
+  HeaderMapPtr header = step.header;
+  if (!step.templated_headers.empty()) {
+    Envoy::Http::RequestHeaderMapPtr rendered_header = Envoy::Http::RequestHeaderMapImpl::create();
+    Envoy::Http::HeaderMapImpl::copyFrom(*rendered_header, *step.header);
+    for (const auto& templated_header : step.templated_headers) {
+      rendered_header->setCopy(templated_header.first, templated_header.second.render(variables_));
+    }
+    header = std::move(rendered_header);
+  }
+  return std::make_unique<RequestImpl>(std::move(header), current_step_, shared_from_this());
+}
+
+uint32_t Session::maxResponseBodyBytes() const {
+  return script_->steps()[current_step_].needs_response_body ? script_->maxResponseBodyBytes() : 0;
+}
+
+void Session::onResponse(bool success, const Envoy::Http::ResponseHeaderMap* headers,
+                         absl::string_view body) {
+  const SessionScript::Step& step = script_->steps()[current_step_];
+  bool proceed = success;
+  for (const SessionScript::Extraction& extraction : step.extractions) {
+    if (!proceed) {
+      break;
+    }
+    proceed = extract(extraction, headers, body);
+  }
+  if (!proceed) {
+    ENVOY_LOG_EVERY_POW_2(debug, "Session step '{}' failed, starting over.", step.name);
+    restart();
+  } else if (++current_step_ == script_->steps().size()) {
+    restart();
+  }
+  ready_queue_->push_back(this);
+}
+
+bool Session::extract(const SessionScript::Extraction& extraction,
+                      const Envoy::Http::ResponseHeaderMap* headers, absl::string_view body) {
+  if (extraction.header.has_value()) {
+    if (headers == nullptr) {
+      return false;
+    }
+    const Envoy::Http::HeaderMap::GetResult result = headers->get(extraction.header.value());
+    if (result.empty()) {
+      return false;
+    }
+    variables_[extraction.variable] = std::string(result[0]->value().getStringView());
+    return true;
+  }
+  const size_t start = body.find(extraction.body_after);
+  if (start == absl::string_view::npos) {
+    return false;
+  }
+  body.remove_prefix(start + extraction.body_after.size());
+  if (!extraction.body_until.empty()) {
+    body = body.substr(0, body.find(extraction.body_until));
+  }
+  variables_[extraction.variable] = std::string(body);
+  return true;
+}
+
+void Session::restart() {
+  current_step_ = 0;
+  for (std::string& variable : variables_) {
+    variable.clear();
+  }
+}
+
+SessionRequestSource::SessionRequestSource(const SessionRequestSourceConfig& config,
+                                           Envoy::Http::RequestHeaderMapPtr header)
+    : script_(std::make_shared<const SessionScript>(config, *header)),
+      ready_queue_(std::make_shared<Session::ReadyQueue>()) {
+  const uint32_t concurrent_sessions =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, concurrent_sessions, 1);
+  for (uint32_t i = 0; i < concurrent_sessions; i++) {
+    sessions_.push_back(std::make_shared<Session>(script_, ready_queue_));
+    ready_queue_->push_back(sessions_.back().get());
+  }
+}
+
+RequestGenerator SessionRequestSource::get() {
+  RequestGenerator request_generator = [this]() -> RequestPtr {
+    // All sessions are waiting for a response. The caller will try again later.
+    if (ready_queue_->empty()) {
+      return nullptr;
+    }
+    Session* session = ready_queue_->front();
+    ready_queue_->pop_front();
+    return session->nextRequest();
+  };
+  return request_generator;
+}
+
+void SessionRequestSource::initOnThread() {}
+void SessionRequestSource::destroyOnThread() {}
+
+std::vector<std::string> SessionRequestSource::requestClassNames() const {
+  std::vector<std::string> names;
+  for (const SessionScript::Step& step : script_->steps()) {
+    names.push_back(step.name);
+  }
+  return names;
+}
+
+std::string SessionRequestSourcePluginConfigFactory::name() const {
+  return "nighthawk.session-request-source-plugin";
+}
+
+Envoy::ProtobufTypes::MessagePtr SessionRequestSourcePluginConfigFactory::createEmptyConfigProto() {
+  return std::make_unique<SessionRequestSourceConfig>();
+}
+
+RequestSourcePtr SessionRequestSourcePluginConfigFactory::createRequestSourcePlugin(
+    const Envoy::Protobuf::Message& message, Envoy::Api::Api&,
+    Envoy::Http::RequestHeaderMapPtr header) {
+  const auto& any = dynamic_cast<const Envoy::ProtobufWkt::Any&>(message);
+  SessionRequestSourceConfig config;
+  Envoy::MessageUtil::unpackTo(any, config);
+  return std::make_unique<SessionRequestSource>(config, std::move(header));
+}
+
+REGISTER_FACTORY(SessionRequestSourcePluginConfigFactory, RequestSourcePluginConfigFactory);
+
+} // namespace Nighthawk
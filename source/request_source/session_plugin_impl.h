@@ -0,0 +1,163 @@
+// Implementation of a RequestSourceConfigFactory that makes a SessionRequestSource.
+#pragma once
+
+#include <deque>
+
+#include "envoy/registry/registry.h"
+
+#include "nighthawk/request_source/request_source_plugin_config_factory.h"
+
+#include "external/envoy/source/common/common/logger.h"
+
+#include "api/request_source/request_source_plugin.pb.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Nighthawk {
+
+// A header value which may reference session variables as {{name}}, compiled into literal segments
+// and variable indices so rendering it doesn't involve any parsing or lookups by name.
+class SessionValueTemplate {
+public:
+  // @param value the raw value, which may contain {{name}} references.
+  // @param variable_indices maps variable names to indices. Names that are referenced but not yet
+  // known will be added.
+  SessionValueTemplate(absl::string_view value,
+                       absl::flat_hash_map<std::string, uint32_t>& variable_indices);
+
+  // @return true iff the value references at least one session variable.
+  bool hasReferences() const { return segments_.size() > 1 || segments_[0].variable.has_value(); }
+
+  // @param variables the values of the session variables, indexed by variable index.
+  // @return std::string the value with references replaced by the values of the variables.
+  std::string render(const std::vector<std::string>& variables) const;
+
+private:
+  struct Segment {
+    std::string literal;
+    absl::optional<uint32_t> variable;
+  };
+  std::vector<Segment> segments_;
+};
+
+// The compiled steps of a session scenario. Immutable after construction, and shared by all
+// sessions on a worker.
+class SessionScript {
+public:
+  // Extracts a value from a response into the session variable with index |variable|. Extracts from
+  // the response header |header| when set, from the response body otherwise.
+  struct Extraction {
+    uint32_t variable;
+    absl::optional<Envoy::Http::LowerCaseString> header;
+    std::string body_after;
+    std::string body_until;
+  };
+
+  struct Step {
+    std::string name;
+    // The request header with all values that don't reference session variables filled in.
+    HeaderMapPtr header;
+    // The header values that need to be rendered per request.
+    std::vector<std::pair<Envoy::Http::LowerCaseString, SessionValueTemplate>> templated_headers;
+    std::vector<Extraction> extractions;
+    // Whether any of the extractions needs the response body.
+    bool needs_response_body{};
+  };
+
+  // @param config the session configuration to compile.
+  // @param default_header header with the values that are used unless a step overrides them.
+  SessionScript(const nighthawk::request_source::SessionRequestSourceConfig& config,
+                const Envoy::Http::RequestHeaderMap& default_header);
+
+  const std::vector<Step>& steps() const { return steps_; }
+  uint32_t variableCount() const { return variable_count_; }
+  uint32_t maxResponseBodyBytes() const { return max_response_body_bytes_; }
+
+private:
+  std::vector<Step> steps_;
+  uint32_t variable_count_{};
+  uint32_t max_response_body_bytes_;
+};
+
+// A virtual session, which runs through the steps of a SessionScript one request at a time. The
+// session observes the response to each of its requests, extracts values from it into its
+// variables, and becomes ready for its next step once that's done. When a request fails or an
+// extraction doesn't find its value, the session starts over with the first step.
+class Session : public ResponseObserver,
+                public std::enable_shared_from_this<Session>,
+                public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  using ReadyQueue = std::deque<Session*>;
+
+  // @param script the steps to run through.
+  // @param ready_queue queue the session will append itself to whenever it becomes ready to send
+  // its next request.
+  Session(std::shared_ptr<const SessionScript> script, std::shared_ptr<ReadyQueue> ready_queue);
+
+  // @return RequestPtr the request for the current step of the session. The session will observe
+  // the response to it.
+  RequestPtr nextRequest();
+
+  // ResponseObserver
+  uint32_t maxResponseBodyBytes() const override;
+  void onResponse(bool success, const Envoy::Http::ResponseHeaderMap* headers,
+                  absl::string_view body) override;
+
+private:
+  bool extract(const SessionScript::Extraction& extraction,
+               const Envoy::Http::ResponseHeaderMap* headers, absl::string_view body);
+  void restart();
+
+  const std::shared_ptr<const SessionScript> script_;
+  const std::shared_ptr<ReadyQueue> ready_queue_;
+  std::vector<std::string> variables_;
+  uint32_t current_step_{};
+};
+
+// Request source which runs a number of concurrent virtual sessions, each sending the requests of a
+// scripted sequence of steps. Later steps may use values extracted from responses to earlier ones,
+// for example ids from a listing or session tokens and cookies. Requests are classified by step, so
+// each step gets its own latency statistics. The generator yields nullptr while all sessions are
+// waiting for a response. This is not thread safe.
+class SessionRequestSource : public RequestSource {
+public:
+  SessionRequestSource(const nighthawk::request_source::SessionRequestSourceConfig& config,
+                       Envoy::Http::RequestHeaderMapPtr header);
+  RequestGenerator get() override;
+
+  // default implementation
+  void initOnThread() override;
+  void destroyOnThread() override;
+
+  // Names the request classes after the steps.
+  std::vector<std::string> requestClassNames() const override;
+
+private:
+  std::shared_ptr<const SessionScript> script_;
+  std::shared_ptr<Session::ReadyQueue> ready_queue_;
+  std::vector<std::shared_ptr<Session>> sessions_;
+};
+
+// Factory that creates a SessionRequestSource from a SessionRequestSourceConfig proto. Registered
+// as an Envoy plugin.
+// Usage: assume you are passed an appropriate Any type object called config, an Api object called
+// api, and a default header called header. auto& config_factory =
+//     Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+//         "nighthawk.session-request-source-plugin");
+// RequestSourcePtr plugin =
+//     config_factory.createRequestSourcePlugin(config, std::move(api), std::move(header));
+class SessionRequestSourcePluginConfigFactory : public virtual RequestSourcePluginConfigFactory {
+public:
+  std::string name() const override;
+  Envoy::ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+  // This implementation is thread safe.
+  RequestSourcePtr createRequestSourcePlugin(const Envoy::Protobuf::Message& message,
+                                             Envoy::Api::Api& api,
+                                             Envoy::Http::RequestHeaderMapPtr header) override;
+};
+
+// This factory will be activated through RequestSourceFactory in factories.h
+DECLARE_FACTORY(SessionRequestSourcePluginConfigFactory);
+
+} // namespace Nighthawk
@@ -0,0 +1,105 @@
+#include "source/server/cache_emulation.h"
+
+#include "external/envoy/source/common/common/hash.h"
+#include "external/envoy/source/common/singleton/const_singleton.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+
+namespace Nighthawk {
+namespace Server {
+namespace {
+
+class CacheHeaderNameValues {
+public:
+  const Envoy::Http::LowerCaseString CacheControl{"cache-control"};
+  const Envoy::Http::LowerCaseString ETag{"etag"};
+  const Envoy::Http::LowerCaseString IfModifiedSince{"if-modified-since"};
+  const Envoy::Http::LowerCaseString IfNoneMatch{"if-none-match"};
+  const Envoy::Http::LowerCaseString LastModified{"last-modified"};
+};
+
+using CacheHeaderNames = Envoy::ConstSingleton<CacheHeaderNameValues>;
+
+constexpr absl::string_view kHttpDateFormat = "%a, %d %b %Y %H:%M:%S GMT";
+
+// Content was last modified at some second of 2020.
+constexpr int64_t kLastModifiedEpochSeconds = 1577836800;
+constexpr int64_t kLastModifiedRangeSeconds = 366 * 24 * 3600;
+
+// Derives independent values from one hash, so that the body size and max age of a path don't
+// correlate. This is the splitmix64 finalizer.
+uint64_t mix(uint64_t hash, uint64_t salt) {
+  uint64_t value = hash + salt * 0x9e3779b97f4a7c15;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+
+bool matchesEntityTag(absl::string_view header_value, absl::string_view etag) {
+  for (absl::string_view candidate : absl::StrSplit(header_value, ',')) {
+    candidate = absl::StripAsciiWhitespace(candidate);
+    // If-None-Match uses the weak comparison, which ignores the weakness indicator.
+    absl::ConsumePrefix(&candidate, "W/");
+    if (candidate == "*" || candidate == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+CacheEmulation::CacheEmulation(const nighthawk::server::CacheEmulation& config)
+    : body_size_(config.body_size()), max_age_seconds_(config.max_age_seconds()) {}
+
+CacheEmulation::Content CacheEmulation::lookup(absl::string_view path) const {
+  const uint64_t hash = Envoy::HashUtil::xxHash64(path);
+  Content content;
+  content.body_size = body_size_.sample(mix(hash, 1));
+  content.max_age_seconds = max_age_seconds_.sample(mix(hash, 2));
+  content.etag = absl::StrCat("\"", absl::Hex(hash, absl::kZeroPad16), "\"");
+  content.last_modified = absl::FromUnixSeconds(
+      kLastModifiedEpochSeconds + static_cast<int64_t>(mix(hash, 3) % kLastModifiedRangeSeconds));
+  return content;
+}
+
+bool CacheEmulation::isNotModified(const Envoy::Http::RequestHeaderMap& request_headers,
+                                   const Content& content) {
+  const auto if_none_match = request_headers.get(CacheHeaderNames::get().IfNoneMatch);
+  if (!if_none_match.empty()) {
+    for (size_t i = 0; i < if_none_match.size(); i++) {
+      if (matchesEntityTag(if_none_match[i]->value().getStringView(), content.etag)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  const auto if_modified_since = request_headers.get(CacheHeaderNames::get().IfModifiedSince);
+  if (if_modified_since.size() != 1) {
+    return false;
+  }
+  absl::Time since;
+  std::string error;
+  return absl::ParseTime(kHttpDateFormat, if_modified_since[0]->value().getStringView(),
+                         absl::UTCTimeZone(), &since, &error) &&
+         content.last_modified <= since;
+}
+
+void CacheEmulation::addResponseHeaders(Envoy::Http::ResponseHeaderMap& response_headers,
+                                        const Content& content) {
+  response_headers.setCopy(CacheHeaderNames::get().ETag, content.etag);
+  response_headers.setCopy(CacheHeaderNames::get().LastModified,
+                           formatHttpDate(content.last_modified));
+  response_headers.setCopy(CacheHeaderNames::get().CacheControl,
+                           absl::StrCat("public, max-age=", content.max_age_seconds));
+}
+
+std::string CacheEmulation::formatHttpDate(absl::Time time) {
+  return absl::FormatTime(kHttpDateFormat, time, absl::UTCTimeZone());
+}
+
+} // namespace Server
+} // namespace Nighthawk
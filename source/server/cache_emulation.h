@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/http/header_map.h"
+
+#include "api/server/response_options.pb.h"
+
+#include "source/server/distribution_sampler.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace Nighthawk {
+namespace Server {
+
+/**
+ * Emulates an origin of cacheable content, where the request path identifies the content. Whatever
+ * describes the content derives from a hash of the path, so no per-path state is kept, and all
+ * workers agree on the response for a path. See CacheEmulation in response_options.proto.
+ */
+class CacheEmulation {
+public:
+  /**
+   * Describes the content identified by a path.
+   */
+  struct Content {
+    uint64_t body_size;
+    uint64_t max_age_seconds;
+    // A strong entity tag, including the quotes.
+    std::string etag;
+    absl::Time last_modified;
+  };
+
+  /**
+   * @param config the cache emulation configuration. Must have passed validation.
+   */
+  explicit CacheEmulation(const nighthawk::server::CacheEmulation& config);
+
+  /**
+   * @param path the request path, which identifies the content.
+   * @return Content the description of the content.
+   */
+  Content lookup(absl::string_view path) const;
+
+  /**
+   * Evaluates the conditional request headers against the content. If-None-Match takes precedence
+   * over If-Modified-Since, as RFC 7232 prescribes.
+   *
+   * @param request_headers the request headers.
+   * @param content the content the request is for.
+   * @return bool true if the client already has the content, and should get a 304.
+   */
+  static bool isNotModified(const Envoy::Http::RequestHeaderMap& request_headers,
+                            const Content& content);
+
+  /**
+   * Adds the ETag, Last-Modified and Cache-Control headers describing the content.
+   *
+   * @param response_headers the response headers to add to.
+   * @param content the content the response is for.
+   */
+  static void addResponseHeaders(Envoy::Http::ResponseHeaderMap& response_headers,
+                                 const Content& content);
+
+  /**
+   * @param time the time to format.
+   * @return std::string the time formatted as an HTTP date, like "Sun, 06 Nov 1994 08:49:37 GMT".
+   */
+  static std::string formatHttpDate(absl::Time time);
+
+private:
+  const DistributionSampler body_size_;
+  const DistributionSampler max_age_seconds_;
+};
+
+} // namespace Server
+} // namespace Nighthawk
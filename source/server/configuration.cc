@@ -1,6 +1,9 @@
 #include "source/server/configuration.h"
 
+#include <fstream>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/core/v3/base.pb.h"
@@ -10,11 +13,122 @@
 
 #include "api/server/response_options.pb.validate.h"
 
+#include "source/server/distribution_sampler.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 
 namespace Nighthawk {
 namespace Server {
 namespace Configuration {
+namespace {
+
+// The largest response body the test server serves.
+constexpr uint64_t kMaxResponseBodySize = 4194304;
+// The most CPU work a request may ask for: ten seconds.
+constexpr uint64_t kMaxCpuWorkMicroseconds = 10000000;
+// The longest a request may occupy a service slot: one minute.
+constexpr uint64_t kMaxServiceTimeMicroseconds = 60000000;
+
+// Calls the callback with each distribution the options hold, its name, and the largest value it
+// may yield.
+void forEachDistribution(
+    const nighthawk::server::ResponseOptions& response_options,
+    const std::function<void(const nighthawk::server::Distribution&, absl::string_view, uint64_t)>&
+        callback) {
+  if (response_options.has_response_body_size_distribution()) {
+    callback(response_options.response_body_size_distribution(), "response_body_size_distribution",
+             kMaxResponseBodySize);
+  }
+  if (response_options.has_cache_emulation()) {
+    callback(response_options.cache_emulation().body_size(), "body_size", kMaxResponseBodySize);
+    callback(response_options.cache_emulation().max_age_seconds(), "max_age_seconds", UINT32_MAX);
+  }
+  if (response_options.has_cpu_work_microseconds()) {
+    callback(response_options.cpu_work_microseconds(), "cpu_work_microseconds",
+             kMaxCpuWorkMicroseconds);
+  }
+  if (response_options.has_queueing_server()) {
+    callback(response_options.queueing_server().service_time_microseconds(),
+             "service_time_microseconds", kMaxServiceTimeMicroseconds);
+  }
+}
+
+void validateHistogram(const nighthawk::server::Distribution::Histogram& histogram,
+                       absl::string_view name) {
+  uint64_t total_weight = 0;
+  for (const nighthawk::server::Distribution::Histogram::Bucket& bucket : histogram.buckets()) {
+    if (bucket.min() > bucket.max()) {
+      throw Envoy::EnvoyException(
+          fmt::format("invalid {} distribution: bucket min {} exceeds max {}", name, bucket.min(),
+                      bucket.max()));
+    }
+    if (bucket.weight() > UINT64_MAX - total_weight) {
+      throw Envoy::EnvoyException(
+          fmt::format("invalid {} distribution: the bucket weights add up to more than {}", name,
+                      UINT64_MAX));
+    }
+    total_weight += bucket.weight();
+  }
+}
+
+void validateDistribution(const nighthawk::server::Distribution& distribution,
+                          absl::string_view name, uint64_t max_value) {
+  if (distribution.has_histogram_file()) {
+    nighthawk::server::Distribution loaded;
+    *loaded.mutable_histogram() = loadHistogramFile(distribution.histogram_file());
+    validateDistribution(loaded, name, max_value);
+    return;
+  }
+  if (distribution.has_histogram()) {
+    validateHistogram(distribution.histogram(), name);
+  }
+  const DistributionSampler sampler(distribution);
+  if (sampler.min() > sampler.max()) {
+    throw Envoy::EnvoyException(fmt::format("invalid {} distribution: min {} exceeds max {}", name,
+                                            sampler.min(), sampler.max()));
+  }
+  if (sampler.max() > max_value) {
+    throw Envoy::EnvoyException(fmt::format("invalid {} distribution: values may not exceed {}",
+                                            name, max_value));
+  }
+}
+
+// Validates what proto validation can't express about the distributions in the options.
+void validateDistributions(const nighthawk::server::ResponseOptions& response_options) {
+  forEachDistribution(response_options, validateDistribution);
+}
+
+void readHistogramFilesInto(nighthawk::server::Distribution& distribution) {
+  if (distribution.has_histogram_file()) {
+    *distribution.mutable_histogram() = loadHistogramFile(distribution.histogram_file());
+  }
+}
+
+void validatePathProfiles(const nighthawk::server::ResponseOptions& response_options) {
+  absl::flat_hash_set<std::string> paths;
+  absl::flat_hash_set<std::string> prefixes;
+  for (const nighthawk::server::PathProfile& path_profile : response_options.path_profiles()) {
+    if (path_profile.response_options().path_profiles_size() > 0) {
+      throw Envoy::EnvoyException("path profiles may not have path profiles of their own");
+    }
+    const bool unique = path_profile.has_prefix()
+                            ? prefixes.insert(path_profile.prefix()).second
+                            : paths.insert(path_profile.path()).second;
+    if (!unique) {
+      throw Envoy::EnvoyException(
+          fmt::format("duplicate path profile for '{}'", path_profile.has_prefix()
+                                                             ? path_profile.prefix()
+                                                             : path_profile.path()));
+    }
+    validateResponseOptions(applyPathProfile(response_options, path_profile));
+  }
+}
+
+} // namespace
 
 bool mergeJsonConfig(absl::string_view json, nighthawk::server::ResponseOptions& config,
                      std::string& error_message) {
@@ -23,8 +137,19 @@ bool mergeJsonConfig(absl::string_view json, nighthawk::server::ResponseOptions&
     nighthawk::server::ResponseOptions json_config;
     auto& validation_visitor = Envoy::ProtobufMessage::getStrictValidationVisitor();
     Envoy::MessageUtil::loadFromJson(std::string(json), json_config, validation_visitor);
+    if (json_config.path_profiles_size() > 0) {
+      throw Envoy::EnvoyException("path_profiles can only be set in static configuration");
+    }
+    forEachDistribution(json_config, [](const nighthawk::server::Distribution& distribution,
+                                        absl::string_view name, uint64_t) {
+      if (distribution.has_histogram_file()) {
+        throw Envoy::EnvoyException(fmt::format(
+            "{}: histogram files can only be named in static configuration", name));
+      }
+    });
     config.MergeFrom(json_config);
     Envoy::MessageUtil::validate(config, validation_visitor);
+    validateDistributions(config);
   } catch (const Envoy::EnvoyException& exception) {
     error_message = fmt::format("Error merging json config: {}", exception.what());
   }
@@ -77,6 +202,75 @@ void validateResponseOptions(const nighthawk::server::ResponseOptions& response_
                      "cannot specify both response_headers and v3_response_headers ",
                      "configuration was: ", response_options.ShortDebugString()));
   }
+  validateDistributions(response_options);
+  validatePathProfiles(response_options);
+}
+
+nighthawk::server::Distribution::Histogram loadHistogramFile(const std::string& path) {
+  std::ifstream stream(path);
+  if (!stream.is_open()) {
+    throw Envoy::EnvoyException(fmt::format("unable to open histogram file '{}'", path));
+  }
+  nighthawk::server::Distribution::Histogram histogram;
+  std::string line;
+  int line_number = 0;
+  while (std::getline(stream, line)) {
+    line_number++;
+    const absl::string_view content = absl::StripAsciiWhitespace(line);
+    if (content.empty() || absl::StartsWith(content, "#")) {
+      continue;
+    }
+    const std::vector<absl::string_view> fields =
+        absl::StrSplit(content, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+    std::vector<uint64_t> values(fields.size());
+    bool valid = fields.size() == 2 || fields.size() == 3;
+    for (size_t i = 0; valid && i < fields.size(); i++) {
+      valid = absl::SimpleAtoi(fields[i], &values[i]);
+    }
+    if (!valid || values.back() == 0) {
+      throw Envoy::EnvoyException(fmt::format(
+          "histogram file '{}' line {}: expected '<min> <max> <weight>' or '<value> <weight>', "
+          "with a positive weight, got '{}'",
+          path, line_number, content));
+    }
+    nighthawk::server::Distribution::Histogram::Bucket* bucket = histogram.add_buckets();
+    bucket->set_min(values.front());
+    bucket->set_max(values[values.size() - 2]);
+    bucket->set_weight(values.back());
+  }
+  if (histogram.buckets().empty()) {
+    throw Envoy::EnvoyException(fmt::format("histogram file '{}' has no buckets", path));
+  }
+  return histogram;
+}
+
+void readHistogramFiles(nighthawk::server::ResponseOptions& response_options) {
+  if (response_options.has_response_body_size_distribution()) {
+    readHistogramFilesInto(*response_options.mutable_response_body_size_distribution());
+  }
+  if (response_options.has_cache_emulation()) {
+    readHistogramFilesInto(*response_options.mutable_cache_emulation()->mutable_body_size());
+    readHistogramFilesInto(*response_options.mutable_cache_emulation()->mutable_max_age_seconds());
+  }
+  if (response_options.has_cpu_work_microseconds()) {
+    readHistogramFilesInto(*response_options.mutable_cpu_work_microseconds());
+  }
+  if (response_options.has_queueing_server()) {
+    readHistogramFilesInto(
+        *response_options.mutable_queueing_server()->mutable_service_time_microseconds());
+  }
+  for (nighthawk::server::PathProfile& path_profile : *response_options.mutable_path_profiles()) {
+    readHistogramFiles(*path_profile.mutable_response_options());
+  }
+}
+
+nighthawk::server::ResponseOptions
+applyPathProfile(const nighthawk::server::ResponseOptions& response_options,
+                 const nighthawk::server::PathProfile& path_profile) {
+  nighthawk::server::ResponseOptions profile_options = response_options;
+  profile_options.clear_path_profiles();
+  profile_options.MergeFrom(path_profile.response_options());
+  return profile_options;
 }
 
 } // namespace Configuration
@@ -44,6 +44,38 @@ void applyConfigToResponseHeaders(Envoy::Http::ResponseHeaderMap& response_heade
 envoy::config::core::v3::HeaderValueOption upgradeDeprecatedEnvoyV2HeaderValueOptionToV3(
     const envoy::api::v2::core::HeaderValueOption& v2_header_value_option);
 
+/**
+ * Reads a histogram file. See Distribution.histogram_file in response_options.proto for the format.
+ *
+ * @param path The path of the file.
+ * @return nighthawk::server::Distribution::Histogram the histogram the file holds.
+ *
+ * @throws Envoy::EnvoyException if the file can't be read or parsed.
+ */
+nighthawk::server::Distribution::Histogram loadHistogramFile(const std::string& path);
+
+/**
+ * Replaces the histogram files named in the options, including those of its path profiles, by the
+ * histograms they hold, so that they are read only once.
+ *
+ * @param response_options The options to modify.
+ *
+ * @throws Envoy::EnvoyException if a file can't be read or parsed.
+ */
+void readHistogramFiles(nighthawk::server::ResponseOptions& response_options);
+
+/**
+ * Computes the options for the requests which a path profile matches.
+ *
+ * @param response_options The options holding the profile.
+ * @param path_profile The profile.
+ * @return nighthawk::server::ResponseOptions the options with the profile merged in, and without
+ * path profiles.
+ */
+nighthawk::server::ResponseOptions
+applyPathProfile(const nighthawk::server::ResponseOptions& response_options,
+                 const nighthawk::server::PathProfile& path_profile);
+
 /**
  * Validates the ResponseOptions.
  *
@@ -0,0 +1,71 @@
+#include "source/server/cpu_work.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace Nighthawk {
+namespace Server {
+namespace {
+
+// Calibration takes the best of a number of rounds, as interruptions only make a round slower.
+constexpr int kCalibrationRounds = 10;
+constexpr std::chrono::nanoseconds kCalibrationRoundDuration = std::chrono::milliseconds(1);
+
+// Keeps the compiler from optimizing the compute loop away.
+std::atomic<uint64_t> sink{0};
+
+} // namespace
+
+const CpuWork& CpuWork::get() {
+  static const CpuWork* cpu_work = new CpuWork();
+  return *cpu_work;
+}
+
+CpuWork::CpuWork() {
+  uint64_t iterations = 1024;
+  int rounds = 0;
+  while (rounds < kCalibrationRounds) {
+    const std::chrono::nanoseconds start = threadCpuTime();
+    sink.fetch_xor(spin(iterations), std::memory_order_relaxed);
+    const std::chrono::nanoseconds elapsed = threadCpuTime() - start;
+    if (elapsed < kCalibrationRoundDuration) {
+      // Too short to time accurately.
+      iterations *= 2;
+      continue;
+    }
+    iterations_per_microsecond_ =
+        std::max(iterations_per_microsecond_, iterations * 1000.0 / elapsed.count());
+    rounds++;
+  }
+  ENVOY_LOG(info, "Calibrated CPU work at {:.1f} iterations per microsecond.",
+            iterations_per_microsecond_);
+}
+
+std::chrono::nanoseconds CpuWork::burn(std::chrono::microseconds duration) const {
+  const std::chrono::nanoseconds start = threadCpuTime();
+  sink.fetch_xor(spin(static_cast<uint64_t>(duration.count() * iterations_per_microsecond_)),
+                 std::memory_order_relaxed);
+  return threadCpuTime() - start;
+}
+
+std::chrono::nanoseconds CpuWork::threadCpuTime() {
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+uint64_t CpuWork::spin(uint64_t iterations) {
+  // A xorshift generator: cheap, serially dependent, and opaque to the optimizer.
+  uint64_t value = 0x9e3779b97f4a7c15;
+  for (uint64_t i = 0; i < iterations; i++) {
+    value ^= value << 13;
+    value ^= value >> 7;
+    value ^= value << 17;
+  }
+  return value;
+}
+
+} // namespace Server
+} // namespace Nighthawk
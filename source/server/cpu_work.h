@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "external/envoy/source/common/common/logger.h"
+
+namespace Nighthawk {
+namespace Server {
+
+/**
+ * Burns CPU on the calling thread, to emulate backends which are busy computing rather than idly
+ * waiting. The work is a fixed number of iterations of a compute loop, calibrated to the speed of
+ * the host, rather than spinning until a clock says enough time passed. That way the work takes
+ * longer when the thread competes for the CPU, as real work would.
+ */
+class CpuWork : public Envoy::Logger::Loggable<Envoy::Logger::Id::misc> {
+public:
+  /**
+   * @return const CpuWork& the process wide instance, which calibrates on first use.
+   */
+  static const CpuWork& get();
+
+  /**
+   * Runs as many iterations as take the duration of CPU time on an otherwise idle host.
+   *
+   * @param duration the CPU time to burn.
+   * @return std::chrono::nanoseconds the CPU time the calling thread actually spent.
+   */
+  std::chrono::nanoseconds burn(std::chrono::microseconds duration) const;
+
+  /**
+   * @return double how many iterations of the compute loop run per microsecond of CPU time.
+   */
+  double iterationsPerMicrosecond() const { return iterations_per_microsecond_; }
+
+  /**
+   * @return std::chrono::nanoseconds the CPU time the calling thread consumed so far.
+   */
+  static std::chrono::nanoseconds threadCpuTime();
+
+private:
+  CpuWork();
+  static uint64_t spin(uint64_t iterations);
+
+  double iterations_per_microsecond_{0};
+};
+
+} // namespace Server
+} // namespace Nighthawk
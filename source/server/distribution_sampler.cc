@@ -0,0 +1,65 @@
+#include "source/server/distribution_sampler.h"
+
+#include <algorithm>
+
+#include "absl/numeric/int128.h"
+
+namespace Nighthawk {
+namespace Server {
+
+DistributionSampler::DistributionSampler(const nighthawk::server::Distribution& distribution) {
+  switch (distribution.distribution_type_case()) {
+  case nighthawk::server::Distribution::DistributionTypeCase::kConstant:
+    min_ = max_ = distribution.constant();
+    break;
+  case nighthawk::server::Distribution::DistributionTypeCase::kUniform:
+    min_ = distribution.uniform().min();
+    max_ = distribution.uniform().max();
+    break;
+  case nighthawk::server::Distribution::DistributionTypeCase::kHistogram:
+    histogram_ = &distribution.histogram();
+    min_ = UINT64_MAX;
+    cumulative_weights_.reserve(histogram_->buckets_size());
+    for (const nighthawk::server::Distribution::Histogram::Bucket& bucket : histogram_->buckets()) {
+      min_ = std::min(min_, bucket.min());
+      max_ = std::max(max_, bucket.max());
+      cumulative_weights_.push_back(
+          (cumulative_weights_.empty() ? 0 : cumulative_weights_.back()) + bucket.weight());
+    }
+    break;
+  case nighthawk::server::Distribution::DistributionTypeCase::kHistogramFile:
+    // Files are read into histograms when the configuration is loaded.
+  case nighthawk::server::Distribution::DistributionTypeCase::DISTRIBUTION_TYPE_NOT_SET:
+    break;
+  }
+}
+
+uint64_t DistributionSampler::sample(uint64_t random) const {
+  if (!cumulative_weights_.empty()) {
+    // The high half of the product picks the bucket, in proportion to the weights. The low half is
+    // what remains of the random value, and picks the value within the bucket.
+    const absl::uint128 scaled = absl::uint128(random) * cumulative_weights_.back();
+    const uint64_t point = absl::Uint128High64(scaled);
+    // The first bucket whose cumulative weight exceeds the point, which skips empty buckets.
+    const auto it = std::upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), point);
+    if (it != cumulative_weights_.end()) {
+      const nighthawk::server::Distribution::Histogram::Bucket& bucket =
+          histogram_->buckets(static_cast<int>(it - cumulative_weights_.begin()));
+      return sampleRange(bucket.min(), bucket.max(), absl::Uint128Low64(scaled));
+    }
+  }
+  return sampleRange(min_, max_, random);
+}
+
+uint64_t DistributionSampler::sampleRange(uint64_t min, uint64_t max, uint64_t random) {
+  const uint64_t span = max - min + 1;
+  if (span == 0) {
+    // The range covers all uint64_t values.
+    return random;
+  }
+  // Scales the random value into the span, which is cheaper than a modulo.
+  return min + absl::Uint128High64(absl::uint128(random) * span);
+}
+
+} // namespace Server
+} // namespace Nighthawk
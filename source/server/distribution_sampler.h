@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "api/server/response_options.pb.h"
+
+namespace Nighthawk {
+namespace Server {
+
+/**
+ * Draws values from a nighthawk::server::Distribution. A sample is a function of the random value
+ * passed in, so callers choose whether samples vary per request, or are fixed per key by passing in
+ * a hash of the key.
+ */
+class DistributionSampler {
+public:
+  /**
+   * @param distribution the distribution to draw values from. Must have passed validation, and
+   * outlive the sampler.
+   */
+  explicit DistributionSampler(const nighthawk::server::Distribution& distribution);
+
+  /**
+   * @param random a uniformly distributed random value.
+   * @return uint64_t the value drawn for the random value.
+   */
+  uint64_t sample(uint64_t random) const;
+
+  /**
+   * @return uint64_t the smallest value the distribution yields.
+   */
+  uint64_t min() const { return min_; }
+
+  /**
+   * @return uint64_t the largest value the distribution yields.
+   */
+  uint64_t max() const { return max_; }
+
+private:
+  // Draws a value in [min, max], each equally likely.
+  static uint64_t sampleRange(uint64_t min, uint64_t max, uint64_t random);
+
+  uint64_t min_{0};
+  uint64_t max_{0};
+  const nighthawk::server::Distribution::Histogram* histogram_{nullptr};
+  // The sum of the weights of each bucket and the buckets before it, so that the bucket a point
+  // falls in can be found with a binary search.
+  std::vector<uint64_t> cumulative_weights_;
+};
+
+} // namespace Server
+} // namespace Nighthawk
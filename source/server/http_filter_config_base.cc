@@ -1,5 +1,8 @@
 #include "source/server/http_filter_config_base.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "source/server/well_known_headers.h"
 
 namespace Nighthawk {
@@ -8,7 +11,55 @@ namespace Server {
 FilterConfigurationBase::FilterConfigurationBase(
     const nighthawk::server::ResponseOptions& proto_config, absl::string_view filter_name)
     : filter_name_(filter_name),
-      server_config_(std::make_shared<nighthawk::server::ResponseOptions>(proto_config)) {}
+      server_config_(std::make_shared<nighthawk::server::ResponseOptions>(proto_config)) {
+  Configuration::readHistogramFiles(*server_config_);
+  for (const nighthawk::server::PathProfile& path_profile : server_config_->path_profiles()) {
+    auto profile_config = std::make_shared<const nighthawk::server::ResponseOptions>(
+        Configuration::applyPathProfile(*server_config_, path_profile));
+    if (path_profile.has_prefix()) {
+      prefix_configs_.emplace(path_profile.prefix(), std::move(profile_config));
+      prefix_lengths_.push_back(path_profile.prefix().size());
+    } else {
+      path_configs_.emplace(path_profile.path(), std::move(profile_config));
+    }
+  }
+  std::sort(prefix_lengths_.begin(), prefix_lengths_.end(), std::greater<size_t>());
+  prefix_lengths_.erase(std::unique(prefix_lengths_.begin(), prefix_lengths_.end()),
+                        prefix_lengths_.end());
+  server_config_->clear_path_profiles();
+}
+
+EffectiveFilterConfigurationPtr
+FilterConfigurationBase::staticConfigurationForPath(absl::string_view path) const {
+  path = path.substr(0, path.find_first_of("?#"));
+  if (!path_configs_.empty()) {
+    const auto it = path_configs_.find(path);
+    if (it != path_configs_.end()) {
+      return it->second;
+    }
+  }
+  for (const size_t prefix_length : prefix_lengths_) {
+    if (prefix_length <= path.size()) {
+      const auto it = prefix_configs_.find(path.substr(0, prefix_length));
+      if (it != prefix_configs_.end()) {
+        return it->second;
+      }
+    }
+  }
+  return server_config_;
+}
+
+std::vector<EffectiveFilterConfigurationPtr>
+FilterConfigurationBase::staticConfigurations() const {
+  std::vector<EffectiveFilterConfigurationPtr> configs{server_config_};
+  for (const auto& path_config : path_configs_) {
+    configs.push_back(path_config.second);
+  }
+  for (const auto& prefix_config : prefix_configs_) {
+    configs.push_back(prefix_config.second);
+  }
+  return configs;
+}
 
 const absl::StatusOr<EffectiveFilterConfigurationPtr>
 FilterConfigurationBase::computeEffectiveConfiguration(
@@ -18,7 +69,8 @@ FilterConfigurationBase::computeEffectiveConfiguration(
     // We could be more flexible and look for the first request header that has a value,
     // but without a proper understanding of a real use case for that, we are assuming that any
     // existence of duplicate headers here is an error.
-    nighthawk::server::ResponseOptions response_options = *server_config_;
+    nighthawk::server::ResponseOptions response_options =
+        *staticConfigurationForPath(headers.getPathValue());
     std::string error_message;
     if (Configuration::mergeJsonConfig(request_config_header[0]->value().getStringView(),
                                        response_options, error_message)) {
@@ -31,7 +83,7 @@ FilterConfigurationBase::computeEffectiveConfiguration(
     return absl::InvalidArgumentError(
         "Received multiple configuration headers in the request, expected only one.");
   }
-  return server_config_;
+  return staticConfigurationForPath(headers.getPathValue());
 }
 
 bool FilterConfigurationBase::validateOrSendError(
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "envoy/server/filter_config.h"
 
@@ -10,6 +11,7 @@
 
 #include "source/server/configuration.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 
 namespace Nighthawk {
@@ -38,8 +40,9 @@ public:
                           absl::string_view filter_name);
 
   /**
-   * Copmute the effective configuration, based on considering the static configuration as well as
-   * any configuration provided via request headers.
+   * Copmute the effective configuration, based on considering the static configuration, the path
+   * profile matching the request path, if any, as well as any configuration provided via request
+   * headers.
    *
    * @param request_headers Full set of request headers to be inspected for configuration.
    * @return const absl::StatusOr<EffectiveFilterConfigurationPtr> The effective configuration, or
@@ -64,9 +67,31 @@ public:
    */
   absl::string_view filter_name() const { return filter_name_; }
 
+protected:
+  /**
+   * @return std::vector<EffectiveFilterConfigurationPtr> the static configuration, and that of each
+   * path profile. These are what computeEffectiveConfiguration() returns for requests which don't
+   * carry configuration in their headers, and live as long as this instance.
+   */
+  std::vector<EffectiveFilterConfigurationPtr> staticConfigurations() const;
+
 private:
+  /**
+   * @param path the request path.
+   * @return EffectiveFilterConfigurationPtr the static configuration for the path, which is that of
+   * the path profile matching it, if any.
+   */
+  EffectiveFilterConfigurationPtr staticConfigurationForPath(absl::string_view path) const;
+
   const std::string filter_name_;
+  // The static configuration, without its path profiles.
   const std::shared_ptr<nighthawk::server::ResponseOptions> server_config_;
+  // The static configuration of each path profile, keyed by path or prefix.
+  absl::flat_hash_map<std::string, EffectiveFilterConfigurationPtr> path_configs_;
+  absl::flat_hash_map<std::string, EffectiveFilterConfigurationPtr> prefix_configs_;
+  // The distinct lengths of the prefixes, longest first. A request path is matched against the
+  // prefixes by looking up its own prefixes of these lengths.
+  std::vector<size_t> prefix_lengths_;
 };
 
 } // namespace Server
@@ -4,40 +4,227 @@
 
 #include "envoy/server/filter_config.h"
 
+#include "external/envoy/source/common/buffer/buffer_impl.h"
+#include "external/envoy/source/common/http/header_map_impl.h"
+
+#include "source/server/cache_emulation.h"
 #include "source/server/configuration.h"
+#include "source/server/cpu_work.h"
+#include "source/server/distribution_sampler.h"
 #include "source/server/well_known_headers.h"
 
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 
 namespace Nighthawk {
 namespace Server {
+namespace {
+
+// Response bodies are served from this, so that they don't need to be allocated and filled per
+// request. The size MUST match the cap on response body sizes in response_options.proto.
+const std::string& staticResponseContent() {
+  static const auto s = new std::string(4194304, 'a');
+  return *s;
+}
+
+TestServerStats generateTestServerStats(Envoy::Stats::Scope& scope, const std::string& prefix) {
+  return {ALL_TEST_SERVER_STATS(POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+QueueingServerStats generateQueueingServerStats(Envoy::Stats::Scope& scope,
+                                                const std::string& prefix) {
+  return {ALL_QUEUEING_SERVER_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                    POOL_GAUGE_PREFIX(scope, prefix),
+                                    POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+} // namespace
+
+ResponseSamplers::ResponseSamplers(const nighthawk::server::ResponseOptions& options) {
+  if (options.has_queueing_server()) {
+    service_time_microseconds.emplace(options.queueing_server().service_time_microseconds());
+  }
+  if (options.has_cpu_work_microseconds()) {
+    cpu_work_microseconds.emplace(options.cpu_work_microseconds());
+  }
+  if (options.has_response_body_size_distribution()) {
+    response_body_size.emplace(options.response_body_size_distribution());
+  }
+  if (options.has_cache_emulation()) {
+    cache_emulation.emplace(options.cache_emulation());
+  }
+}
 
 HttpTestServerDecoderFilterConfig::HttpTestServerDecoderFilterConfig(
-    const nighthawk::server::ResponseOptions& proto_config)
-    : FilterConfigurationBase(proto_config, "test-server") {}
+    const nighthawk::server::ResponseOptions& proto_config, Envoy::Stats::Scope& scope,
+    const std::string& stats_prefix)
+    : FilterConfigurationBase(proto_config, "test-server"),
+      stats_(generateTestServerStats(scope, absl::StrCat(stats_prefix, "test-server."))),
+      queueing_server_stats_(generateQueueingServerStats(
+          scope, absl::StrCat(stats_prefix, "test-server.queueing_server."))) {
+  for (const EffectiveFilterConfigurationPtr& config : staticConfigurations()) {
+    static_samplers_.emplace(config.get(), std::make_unique<ResponseSamplers>(*config));
+  }
+}
+
+const ResponseSamplers* HttpTestServerDecoderFilterConfig::staticSamplers(
+    const nighthawk::server::ResponseOptions& options) const {
+  const auto it = static_samplers_.find(&options);
+  return it == static_samplers_.end() ? nullptr : it->second.get();
+}
+
+ServiceQueueSharedPtr HttpTestServerDecoderFilterConfig::serviceQueue(
+    const nighthawk::server::QueueingServer& queueing_server) {
+  absl::MutexLock lock(&mutex_);
+  ServiceQueueSharedPtr& service_queue =
+      service_queues_[{queueing_server.slots(), queueing_server.max_queue_length()}];
+  if (service_queue == nullptr) {
+    service_queue = std::make_shared<ServiceQueue>(
+        queueing_server.slots(), queueing_server.max_queue_length(), queueing_server_stats_);
+  }
+  return service_queue;
+}
 
 HttpTestServerDecoderFilter::HttpTestServerDecoderFilter(
     HttpTestServerDecoderFilterConfigSharedPtr config)
     : config_(std::move(config)) {}
 
-void HttpTestServerDecoderFilter::onDestroy() {}
+void HttpTestServerDecoderFilter::onDestroy() {
+  switch (queueing_state_) {
+  case QueueingState::Waiting:
+    service_queue_->cancel(waiter_);
+    break;
+  case QueueingState::Serving:
+    service_timer_->disableTimer();
+    service_queue_->release();
+    break;
+  case QueueingState::None:
+    break;
+  }
+  queueing_state_ = QueueingState::None;
+}
+
+void HttpTestServerDecoderFilter::serve(const nighthawk::server::ResponseOptions& options) {
+  samplers_ = config_->staticSamplers(options);
+  if (samplers_ == nullptr) {
+    request_samplers_ = std::make_unique<ResponseSamplers>(options);
+    samplers_ = request_samplers_.get();
+  }
+  if (!options.has_queueing_server()) {
+    sendReply(options);
+    return;
+  }
+  service_queue_ = config_->serviceQueue(options.queueing_server());
+  waiter_ = std::make_shared<ServiceQueue::Waiter>(
+      decoder_callbacks_->dispatcher(), [this, &options]() { startService(options); });
+  switch (service_queue_->acquire(waiter_)) {
+  case ServiceQueue::Admission::Granted:
+    startService(options);
+    break;
+  case ServiceQueue::Admission::Queued:
+    queueing_state_ = QueueingState::Waiting;
+    break;
+  case ServiceQueue::Admission::Rejected:
+    reject(options);
+    break;
+  }
+}
+
+void HttpTestServerDecoderFilter::startService(const nighthawk::server::ResponseOptions& options) {
+  queueing_state_ = QueueingState::Serving;
+  service_timer_ = decoder_callbacks_->dispatcher().createTimer([this, &options]() {
+    // Replying may end the stream, and destroy the filter, so the slot is freed first.
+    queueing_state_ = QueueingState::None;
+    service_queue_->release();
+    sendReply(options);
+  });
+  service_timer_->enableHRTimer(std::chrono::microseconds(
+      samplers_->service_time_microseconds->sample(random_generator_.random())));
+}
+
+void HttpTestServerDecoderFilter::reject(const nighthawk::server::ResponseOptions& options) {
+  if (options.queueing_server().rejection_policy() == nighthawk::server::QueueingServer::RESET) {
+    decoder_callbacks_->resetStream();
+    return;
+  }
+  decoder_callbacks_->sendLocalReply(Envoy::Http::Code::ServiceUnavailable, "", nullptr,
+                                     absl::nullopt, "queueing_server_queue_full");
+}
 
 void HttpTestServerDecoderFilter::sendReply(const nighthawk::server::ResponseOptions& options) {
-  std::string response_body(options.response_body_size(), 'a');
-  if (request_headers_dump_.has_value()) {
-    response_body += *request_headers_dump_;
+  if (samplers_->cpu_work_microseconds.has_value()) {
+    cpu_time_ = CpuWork::get().burn(std::chrono::microseconds(
+        samplers_->cpu_work_microseconds->sample(random_generator_.random())));
+  }
+  if (samplers_->cache_emulation.has_value()) {
+    sendCacheEmulatingReply(options);
+    return;
+  }
+  uint64_t body_size = options.response_body_size();
+  if (samplers_->response_body_size.has_value()) {
+    body_size = samplers_->response_body_size->sample(random_generator_.random());
+  }
+  Envoy::Http::ResponseHeaderMapPtr response_headers = Envoy::Http::ResponseHeaderMapImpl::create();
+  response_headers->setStatus(200);
+  encodeReply(std::move(response_headers), body_size, options, "");
+}
+
+void HttpTestServerDecoderFilter::sendCacheEmulatingReply(
+    const nighthawk::server::ResponseOptions& options) {
+  const CacheEmulation::Content content =
+      samplers_->cache_emulation->lookup(request_headers_->getPathValue());
+  const bool not_modified = CacheEmulation::isNotModified(*request_headers_, content);
+  Envoy::Http::ResponseHeaderMapPtr response_headers = Envoy::Http::ResponseHeaderMapImpl::create();
+  response_headers->setStatus(not_modified ? 304 : 200);
+  CacheEmulation::addResponseHeaders(*response_headers, content);
+  encodeReply(std::move(response_headers),
+              not_modified ? absl::nullopt : absl::make_optional(content.body_size), options,
+              "cache_emulation");
+}
+
+void HttpTestServerDecoderFilter::encodeReply(Envoy::Http::ResponseHeaderMapPtr response_headers,
+                                              absl::optional<uint64_t> body_size,
+                                              const nighthawk::server::ResponseOptions& options,
+                                              absl::string_view details) {
+  Envoy::Buffer::OwnedImpl body;
+  if (body_size.has_value()) {
+    if (*body_size > 0) {
+      auto* fragment = new Envoy::Buffer::BufferFragmentImpl(
+          staticResponseContent().data(), *body_size,
+          [](const void*, size_t, const Envoy::Buffer::BufferFragmentImpl* frag) { delete frag; });
+      body.addBufferFragment(*fragment);
+    }
+    config_->stats().response_body_size_.recordValue(*body_size);
+    if (request_headers_dump_.has_value()) {
+      body.add(*request_headers_dump_);
+    }
+    response_headers->setContentLength(body.length());
+    if (body.length() > 0) {
+      response_headers->setReferenceContentType(Envoy::Http::Headers::get().ContentTypeValues.Text);
+    }
+  }
+  applyResponseHeaders(*response_headers, options);
+  const bool headers_only = body.length() == 0;
+  decoder_callbacks_->encodeHeaders(std::move(response_headers), headers_only, details);
+  if (!headers_only) {
+    decoder_callbacks_->encodeData(body, true);
+  }
+}
+
+void HttpTestServerDecoderFilter::applyResponseHeaders(
+    Envoy::Http::ResponseHeaderMap& response_headers,
+    const nighthawk::server::ResponseOptions& options) const {
+  if (cpu_time_.has_value()) {
+    response_headers.setCopy(TestServer::HeaderNames::get().CpuTime,
+                             absl::StrCat(cpu_time_->count()));
   }
-  decoder_callbacks_->sendLocalReply(
-      static_cast<Envoy::Http::Code>(200), response_body,
-      [options](Envoy::Http::ResponseHeaderMap& direct_response_headers) {
-        Configuration::applyConfigToResponseHeaders(direct_response_headers, options);
-      },
-      absl::nullopt, "");
+  Configuration::applyConfigToResponseHeaders(response_headers, options);
 }
 
 Envoy::Http::FilterHeadersStatus
 HttpTestServerDecoderFilter::decodeHeaders(Envoy::Http::RequestHeaderMap& headers,
                                            bool end_stream) {
+  request_headers_ = &headers;
   effective_config_ = config_->computeEffectiveConfiguration(headers);
   if (end_stream) {
     if (!config_->validateOrSendError(effective_config_, *decoder_callbacks_)) {
@@ -46,7 +233,7 @@ HttpTestServerDecoderFilter::decodeHeaders(Envoy::Http::RequestHeaderMap& header
         headers_dump << "\nRequest Headers:\n" << headers;
         request_headers_dump_ = headers_dump.str();
       }
-      sendReply(*effective_config_.value());
+      serve(*effective_config_.value());
     }
   }
   return Envoy::Http::FilterHeadersStatus::StopIteration;
@@ -56,7 +243,7 @@ Envoy::Http::FilterDataStatus HttpTestServerDecoderFilter::decodeData(Envoy::Buf
                                                                       bool end_stream) {
   if (end_stream) {
     if (!config_->validateOrSendError(effective_config_, *decoder_callbacks_)) {
-      sendReply(*effective_config_.value());
+      serve(*effective_config_.value());
     }
   }
   return Envoy::Http::FilterDataStatus::StopIterationNoBuffer;
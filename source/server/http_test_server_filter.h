@@ -1,20 +1,95 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <string>
 
 #include "envoy/server/filter_config.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "external/envoy/source/common/common/random_generator.h"
 
 #include "api/server/response_options.pb.h"
 
+#include "source/server/cache_emulation.h"
+#include "source/server/distribution_sampler.h"
 #include "source/server/http_filter_config_base.h"
+#include "source/server/service_queue.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Nighthawk {
 namespace Server {
 
-// Basically this is left in as a placeholder for further configuration.
+#define ALL_TEST_SERVER_STATS(HISTOGRAM) HISTOGRAM(response_body_size, Bytes)
+
+struct TestServerStats {
+  ALL_TEST_SERVER_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * The samplers of the distributions a set of response options draws from per request. Building
+ * them walks the histograms, so they are built once per set of options rather than per request.
+ */
+struct ResponseSamplers {
+  /**
+   * @param options the response options. Must have passed validation, and outlive the samplers.
+   */
+  explicit ResponseSamplers(const nighthawk::server::ResponseOptions& options);
+
+  absl::optional<DistributionSampler> service_time_microseconds;
+  absl::optional<DistributionSampler> cpu_work_microseconds;
+  absl::optional<DistributionSampler> response_body_size;
+  absl::optional<CacheEmulation> cache_emulation;
+};
+
+/**
+ * Filter configuration container class for the test server extension. Instances of this class will
+ * be shared across instances of HttpTestServerDecoderFilter, and hold the service queues which the
+ * filters on all workers compete for.
+ */
 class HttpTestServerDecoderFilterConfig : public FilterConfigurationBase {
 public:
-  HttpTestServerDecoderFilterConfig(const nighthawk::server::ResponseOptions& proto_config);
+  /**
+   * @param proto_config the static configuration of the filter.
+   * @param scope the scope to create statistics in.
+   * @param stats_prefix the prefix of the statistics names, e.g.
+   * test-server.queueing_server.rq_rejected: 1
+   */
+  HttpTestServerDecoderFilterConfig(const nighthawk::server::ResponseOptions& proto_config,
+                                    Envoy::Stats::Scope& scope, const std::string& stats_prefix);
+
+  /**
+   * Gets the service queue for a queueing server configuration. Configurations with the same slots
+   * and max_queue_length share a queue. Safe to use concurrently.
+   *
+   * @param queueing_server the configuration.
+   * @return ServiceQueueSharedPtr the queue, created on first use.
+   */
+  ServiceQueueSharedPtr serviceQueue(const nighthawk::server::QueueingServer& queueing_server);
+
+  /**
+   * @return TestServerStats& the statistics of the filters sharing this configuration.
+   */
+  TestServerStats& stats() { return stats_; }
+
+  /**
+   * @param options an effective configuration.
+   * @return const ResponseSamplers* the samplers of the configuration when it is a static one,
+   * built when this was constructed. nullptr when it came from request headers.
+   */
+  const ResponseSamplers* staticSamplers(const nighthawk::server::ResponseOptions& options) const;
+
+private:
+  TestServerStats stats_;
+  // Keyed by the static configurations, which the base class keeps alive.
+  absl::flat_hash_map<const nighthawk::server::ResponseOptions*, std::unique_ptr<ResponseSamplers>>
+      static_samplers_;
+  QueueingServerStats queueing_server_stats_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::pair<uint32_t, uint32_t>, ServiceQueueSharedPtr>
+      service_queues_ ABSL_GUARDED_BY(mutex_);
 };
 
 using HttpTestServerDecoderFilterConfigSharedPtr =
@@ -34,11 +109,40 @@ public:
   void setDecoderFilterCallbacks(Envoy::Http::StreamDecoderFilterCallbacks&) override;
 
 private:
+  // Where the request is in its stay at a queueing server.
+  enum class QueueingState { None, Waiting, Serving };
+
+  // Replies right away, or once the request has been served by a queueing server.
+  void serve(const nighthawk::server::ResponseOptions& options);
+  // Occupies the slot the request holds for its service time.
+  void startService(const nighthawk::server::ResponseOptions& options);
+  void reject(const nighthawk::server::ResponseOptions& options);
   void sendReply(const nighthawk::server::ResponseOptions& options);
+  // Replies as an origin of cacheable content would. See CacheEmulation in response_options.proto.
+  void sendCacheEmulatingReply(const nighthawk::server::ResponseOptions& options);
+  // Sends the response, with a body of the size served from shared memory, if it has a body.
+  void encodeReply(Envoy::Http::ResponseHeaderMapPtr response_headers,
+                   absl::optional<uint64_t> body_size,
+                   const nighthawk::server::ResponseOptions& options, absl::string_view details);
+  // Adds the headers the options ask for, and the header reporting the CPU time spent, if any.
+  void applyResponseHeaders(Envoy::Http::ResponseHeaderMap& response_headers,
+                            const nighthawk::server::ResponseOptions& options) const;
   const HttpTestServerDecoderFilterConfigSharedPtr config_;
   absl::StatusOr<EffectiveFilterConfigurationPtr> effective_config_;
   Envoy::Http::StreamDecoderFilterCallbacks* decoder_callbacks_;
+  const Envoy::Http::RequestHeaderMap* request_headers_{nullptr};
   absl::optional<std::string> request_headers_dump_;
+  Envoy::Random::RandomGeneratorImpl random_generator_;
+  // The CPU time spent on the work the options asked for, if they asked for any.
+  absl::optional<std::chrono::nanoseconds> cpu_time_;
+  // The samplers for the effective configuration. Those of a configuration from request headers
+  // are owned by request_samplers_.
+  const ResponseSamplers* samplers_{nullptr};
+  std::unique_ptr<ResponseSamplers> request_samplers_;
+  ServiceQueueSharedPtr service_queue_;
+  ServiceQueue::WaiterSharedPtr waiter_;
+  Envoy::Event::TimerPtr service_timer_;
+  QueueingState queueing_state_{QueueingState::None};
 };
 
 } // namespace Server
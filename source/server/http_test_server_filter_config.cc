@@ -8,6 +8,7 @@
 #include "api/server/response_options.pb.validate.h"
 
 #include "source/server/configuration.h"
+#include "source/server/cpu_work.h"
 #include "source/server/http_test_server_filter.h"
 
 namespace Nighthawk {
@@ -18,14 +19,15 @@ class HttpTestServerDecoderFilterConfig
     : public Envoy::Server::Configuration::NamedHttpFilterConfigFactory {
 public:
   Envoy::Http::FilterFactoryCb
-  createFilterFactoryFromProto(const Envoy::Protobuf::Message& proto_config, const std::string&,
+  createFilterFactoryFromProto(const Envoy::Protobuf::Message& proto_config,
+                               const std::string& stats_prefix,
                                Envoy::Server::Configuration::FactoryContext& context) override {
     auto& validation_visitor = Envoy::ProtobufMessage::getStrictValidationVisitor();
     const nighthawk::server::ResponseOptions& response_options =
         Envoy::MessageUtil::downcastAndValidate<const nighthawk::server::ResponseOptions&>(
             proto_config, validation_visitor);
     validateResponseOptions(response_options);
-    return createFilter(response_options, context);
+    return createFilter(response_options, stats_prefix, context);
   }
 
   Envoy::ProtobufTypes::MessagePtr createEmptyConfigProto() override {
@@ -36,10 +38,13 @@ public:
 
 private:
   Envoy::Http::FilterFactoryCb createFilter(const nighthawk::server::ResponseOptions& proto_config,
-                                            Envoy::Server::Configuration::FactoryContext&) {
+                                            const std::string& stats_prefix,
+                                            Envoy::Server::Configuration::FactoryContext& context) {
+    // Calibrates the CPU work ahead of the first request, which would otherwise pay for it.
+    CpuWork::get();
     Nighthawk::Server::HttpTestServerDecoderFilterConfigSharedPtr config =
         std::make_shared<Nighthawk::Server::HttpTestServerDecoderFilterConfig>(
-            Nighthawk::Server::HttpTestServerDecoderFilterConfig(proto_config));
+            proto_config, context.scope(), stats_prefix);
 
     return [config](Envoy::Http::FilterChainFactoryCallbacks& callbacks) -> void {
       auto* filter = new Nighthawk::Server::HttpTestServerDecoderFilter(config);
@@ -0,0 +1,75 @@
+#include "source/server/service_queue.h"
+
+#include <chrono>
+
+namespace Nighthawk {
+namespace Server {
+
+ServiceQueue::Waiter::Waiter(Envoy::Event::Dispatcher& dispatcher,
+                             std::function<void()> on_granted)
+    : dispatcher_(dispatcher), on_granted_(std::move(on_granted)),
+      enqueued_at_(dispatcher.timeSource().monotonicTime()) {}
+
+ServiceQueue::ServiceQueue(uint32_t slots, uint32_t max_queue_length, QueueingServerStats& stats)
+    : slots_(slots), max_queue_length_(max_queue_length), stats_(stats) {}
+
+ServiceQueue::Admission ServiceQueue::acquire(const WaiterSharedPtr& waiter) {
+  absl::MutexLock lock(&mutex_);
+  if (busy_slots_ < slots_) {
+    busy_slots_++;
+    stats_.busy_slots_.inc();
+    return Admission::Granted;
+  }
+  if (queue_.size() >= max_queue_length_) {
+    stats_.rq_rejected_.inc();
+    return Admission::Rejected;
+  }
+  waiter->position_ = queue_.insert(queue_.end(), waiter);
+  waiter->queued_ = true;
+  stats_.rq_queued_.inc();
+  stats_.queue_depth_.inc();
+  return Admission::Queued;
+}
+
+void ServiceQueue::cancel(const WaiterSharedPtr& waiter) {
+  waiter->cancelled_ = true;
+  absl::MutexLock lock(&mutex_);
+  if (waiter->queued_) {
+    queue_.erase(waiter->position_);
+    waiter->queued_ = false;
+    stats_.queue_depth_.dec();
+  }
+  // Otherwise the slot is on its way to the request, and the posted callback passes it on.
+}
+
+void ServiceQueue::release() {
+  WaiterSharedPtr next;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (queue_.empty()) {
+      busy_slots_--;
+      stats_.busy_slots_.dec();
+      return;
+    }
+    next = std::move(queue_.front());
+    queue_.pop_front();
+    next->queued_ = false;
+    stats_.queue_depth_.dec();
+  }
+  // The stream of the request may go away while this is pending, so the callback keeps the queue
+  // alive rather than relying on the stream to.
+  next->dispatcher_.post([self = shared_from_this(), next]() {
+    if (next->cancelled_) {
+      self->release();
+      return;
+    }
+    self->stats_.queue_wait_.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                             next->dispatcher_.timeSource().monotonicTime() -
+                                             next->enqueued_at_)
+                                             .count());
+    next->on_granted_();
+  });
+}
+
+} // namespace Server
+} // namespace Nighthawk
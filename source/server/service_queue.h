@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Nighthawk {
+namespace Server {
+
+#define ALL_QUEUEING_SERVER_STATS(COUNTER, GAUGE, HISTOGRAM)                                       \
+  COUNTER(rq_queued)                                                                               \
+  COUNTER(rq_rejected)                                                                             \
+  GAUGE(busy_slots, Accumulate)                                                                    \
+  GAUGE(queue_depth, Accumulate)                                                                   \
+  HISTOGRAM(queue_wait, Microseconds)
+
+struct QueueingServerStats {
+  ALL_QUEUEING_SERVER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                            GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * A fixed number of service slots, and a bounded queue of requests waiting for one, shared by all
+ * workers. See QueueingServer in response_options.proto. Waiting requests are parked: when a slot
+ * frees up, the first waiting request gets it, by a callback posted to the dispatcher of its
+ * worker. The slot stays busy during the handoff, so a request which arrives meanwhile can't take
+ * it.
+ */
+class ServiceQueue : public std::enable_shared_from_this<ServiceQueue> {
+public:
+  /**
+   * The outcome of asking for a slot.
+   */
+  enum class Admission {
+    // The request holds a slot.
+    Granted,
+    // The request waits for a slot.
+    Queued,
+    // The queue is full.
+    Rejected
+  };
+
+  /**
+   * A request waiting for a slot.
+   */
+  class Waiter {
+  public:
+    Waiter(Envoy::Event::Dispatcher& dispatcher, std::function<void()> on_granted);
+
+  private:
+    friend class ServiceQueue;
+    Envoy::Event::Dispatcher& dispatcher_;
+    const std::function<void()> on_granted_;
+    const Envoy::MonotonicTime enqueued_at_;
+    // Guarded by the mutex of the queue.
+    bool queued_{false};
+    std::list<std::shared_ptr<Waiter>>::iterator position_;
+    // Only accessed on the thread of the dispatcher.
+    bool cancelled_{false};
+  };
+
+  using WaiterSharedPtr = std::shared_ptr<Waiter>;
+
+  /**
+   * @param slots the number of requests served concurrently.
+   * @param max_queue_length the number of requests which may wait for a slot.
+   * @param stats the stats to update. Must outlive the queue.
+   */
+  ServiceQueue(uint32_t slots, uint32_t max_queue_length, QueueingServerStats& stats);
+
+  /**
+   * Takes a free slot, or else queues for one, or else gives up.
+   *
+   * @param waiter the request. When it gets queued, its on_granted callback runs on its dispatcher
+   * once it holds a slot, unless it gets cancelled first. Not called when a slot is granted right
+   * away.
+   * @return Admission the outcome.
+   */
+  Admission acquire(const WaiterSharedPtr& waiter);
+
+  /**
+   * Stops a queued request from waiting. Must be called on the thread of its dispatcher. When a
+   * slot was already handed to the request, it is passed on instead.
+   *
+   * @param waiter the request, which must have been queued by acquire().
+   */
+  void cancel(const WaiterSharedPtr& waiter);
+
+  /**
+   * Frees a slot, handing it to the first waiting request, if any.
+   */
+  void release();
+
+private:
+  const uint32_t slots_;
+  const uint32_t max_queue_length_;
+  QueueingServerStats& stats_;
+  absl::Mutex mutex_;
+  uint32_t busy_slots_ ABSL_GUARDED_BY(mutex_){0};
+  std::list<WaiterSharedPtr> queue_ ABSL_GUARDED_BY(mutex_);
+};
+
+using ServiceQueueSharedPtr = std::shared_ptr<ServiceQueue>;
+
+} // namespace Server
+} // namespace Nighthawk
@@ -13,6 +13,7 @@ namespace TestServer {
 class HeaderNameValues {
 public:
   const Envoy::Http::LowerCaseString TestServerConfig{"x-nighthawk-test-server-config"};
+  const Envoy::Http::LowerCaseString CpuTime{"x-nighthawk-test-server-cpu-time-ns"};
 };
 
 using HeaderNames = Envoy::ConstSingleton<HeaderNameValues>;
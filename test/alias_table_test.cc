@@ -0,0 +1,52 @@
+#include <random>
+#include <vector>
+
+#include "nighthawk/common/exception.h"
+
+#include "source/common/alias_table.h"
+
+#include "gtest/gtest.h"
+
+using namespace testing;
+
+namespace Nighthawk {
+
+class AliasTableTest : public Test {};
+
+TEST_F(AliasTableTest, ProbabilitiesAreNormalizedWeights) {
+  AliasTable alias_table(std::vector<double>{80, 15, 5});
+  ASSERT_EQ(3, alias_table.size());
+  EXPECT_DOUBLE_EQ(0.80, alias_table.probability(0));
+  EXPECT_DOUBLE_EQ(0.15, alias_table.probability(1));
+  EXPECT_DOUBLE_EQ(0.05, alias_table.probability(2));
+}
+
+TEST_F(AliasTableTest, SamplesFollowWeights) {
+  AliasTable alias_table(std::vector<double>{80, 15, 0, 5});
+  std::mt19937_64 generator(1234);
+  std::vector<uint64_t> counts(alias_table.size());
+  const uint64_t kSamples = 100000;
+  for (uint64_t i = 0; i < kSamples; i++) {
+    counts[alias_table.sample(generator)]++;
+  }
+  EXPECT_NEAR(0.80, 1.0 * counts[0] / kSamples, 0.01);
+  EXPECT_NEAR(0.15, 1.0 * counts[1] / kSamples, 0.01);
+  EXPECT_EQ(0, counts[2]);
+  EXPECT_NEAR(0.05, 1.0 * counts[3] / kSamples, 0.01);
+}
+
+TEST_F(AliasTableTest, SingleEntryIsAlwaysSampled) {
+  AliasTable alias_table(std::vector<double>{3});
+  std::mt19937_64 generator(1234);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(0, alias_table.sample(generator));
+  }
+}
+
+TEST_F(AliasTableTest, BadWeightsThrow) {
+  EXPECT_THROW(AliasTable(std::vector<double>{}), NighthawkException);
+  EXPECT_THROW(AliasTable(std::vector<double>{0, 0}), NighthawkException);
+  EXPECT_THROW(AliasTable(std::vector<double>{1, -1, 2}), NighthawkException);
+}
+
+} // namespace Nighthawk
@@ -21,6 +21,7 @@
 
 #include "gtest/gtest.h"
 
+using namespace std::chrono_literals;
 using namespace testing;
 
 namespace Nighthawk {
@@ -143,7 +144,7 @@ public:
     };
 
     for (uint64_t i = 0; i < amount; i++) {
-      if (client_->tryStartRequest(f)) {
+      if (client_->tryStartRequest(f, time_system_.monotonicTime())) {
         inflight_response_count++;
       }
     }
@@ -152,7 +153,7 @@ public:
         client_setup_parameters.max_pending_requests + client_setup_parameters.max_connection_limit;
     // If amount_of_request >= max_in_flight_allowed, we are not able to add more request.
     if (amount >= max_in_flight_allowed) {
-      EXPECT_FALSE(client_->tryStartRequest(f));
+      EXPECT_FALSE(client_->tryStartRequest(f, time_system_.monotonicTime()));
     }
 
     dispatcher_->run(Envoy::Event::Dispatcher::RunType::Block);
@@ -421,6 +422,192 @@ TEST_F(BenchmarkClientHttpTest, RequestGeneratorProvidingDifferentPathsSendsRequ
   EXPECT_EQ(2, getCounter("http_2xx"));
 }
 
+TEST_F(BenchmarkClientHttpTest, RequestClassesGetTrackedSeparately) {
+  for (const std::string& request_class_name : {"small", "large"}) {
+    statistic_.request_class_statistics.push_back(std::make_unique<Client::RequestClassStatistic>(
+        store_, request_class_name, std::make_unique<StreamingStatistic>(),
+        std::make_unique<StreamingStatistic>()));
+  }
+  uint32_t request_class = 0;
+  RequestGenerator request_generator = [this, &request_class]() {
+    // Yield three requests of the first class for every request of the second one.
+    return std::make_unique<RequestImpl>(default_header_map_, request_class++ % 4 == 3 ? 1 : 0);
+  };
+  setupBenchmarkClient(request_generator);
+  client_->setShouldMeasureLatencies(true);
+  auto client_setup_parameters = ClientSetupParameters(0, 8, 8, request_generator);
+  verifyBenchmarkClientProcessesExpectedInflightRequests(client_setup_parameters);
+  StatisticPtrMap statistics = client_->statistics();
+  EXPECT_EQ(8, statistics["benchmark_http_client.request_to_response"]->count());
+  EXPECT_EQ(6, statistics["benchmark_http_client.class_small.request_to_response"]->count());
+  EXPECT_EQ(2, statistics["benchmark_http_client.class_large.request_to_response"]->count());
+  EXPECT_EQ(6, statistics["benchmark_http_client.class_small.response_body_size"]->count());
+  EXPECT_DOUBLE_EQ(97,
+                   statistics["benchmark_http_client.class_large.response_body_size"]->mean());
+  EXPECT_EQ(8, getCounter("http_2xx"));
+  EXPECT_EQ(6, store_.counterFromString("benchmark.class.small.http_2xx").value());
+  EXPECT_EQ(2, store_.counterFromString("benchmark.class.large.http_2xx").value());
+}
+
+TEST_F(BenchmarkClientHttpTest, RequestTimeoutAbandonsStuckRequest) {
+  statistic_.request_timeout_statistic = std::make_unique<StreamingStatistic>();
+  setupBenchmarkClient(getDefaultRequestGenerator());
+  client_->setRequestTimeout(10ms);
+  client_->setShouldMeasureLatencies(true);
+  EXPECT_EQ(1, client_->statistics().count("benchmark_http_client.request_to_timeout"));
+  Envoy::Http::StreamCallbacks* stream_callbacks = nullptr;
+  EXPECT_CALL(pool_, newStream(_, _, _))
+      .WillOnce([this, &stream_callbacks](
+                    Envoy::Http::ResponseDecoder& decoder,
+                    Envoy::Http::ConnectionPool::Callbacks& callbacks,
+                    const Envoy::Http::ConnectionPool::Instance::StreamOptions&)
+                    -> Envoy::Http::ConnectionPool::Cancellable* {
+        stream_callbacks = dynamic_cast<Envoy::Http::StreamCallbacks*>(&decoder);
+        NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+        callbacks.onPoolReady(stream_encoder_, Envoy::Upstream::HostDescriptionConstSharedPtr{},
+                              stream_info, {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+        // No response will ever arrive.
+        return nullptr;
+      });
+  EXPECT_CALL(stream_encoder_.stream_, resetStream(Envoy::Http::StreamResetReason::LocalReset))
+      .WillOnce([&stream_callbacks](Envoy::Http::StreamResetReason reason) {
+        stream_callbacks->onResetStream(reason, "");
+      });
+  bool succeeded = true;
+  EXPECT_TRUE(client_->tryStartRequest(
+      [this, &succeeded](bool, bool success) {
+        succeeded = success;
+        dispatcher_->exit();
+      },
+      time_system_.monotonicTime()));
+  dispatcher_->run(Envoy::Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_FALSE(succeeded);
+  EXPECT_EQ(1, getCounter("request_timeouts"));
+  EXPECT_EQ(0, getCounter("stream_resets"));
+  const Statistic* request_timeout_statistic =
+      client_->statistics()["benchmark_http_client.request_to_timeout"];
+  ASSERT_EQ(1, request_timeout_statistic->count());
+  EXPECT_GE(request_timeout_statistic->max(), 10'000'000);
+}
+
+TEST_F(BenchmarkClientHttpTest, FailedAttemptIsRetriedWithinBudget) {
+  statistic_.first_attempt_statistic = std::make_unique<StreamingStatistic>();
+  statistic_.final_response_statistic = std::make_unique<StreamingStatistic>();
+  setupBenchmarkClient(getDefaultRequestGenerator());
+  Client::RequestAttemptConfig attempt_config;
+  attempt_config.max_retries = 1;
+  attempt_config.retry_budget_percent = 100;
+  client_->setRequestAttemptConfig(attempt_config);
+  client_->setShouldMeasureLatencies(true);
+  EXPECT_CALL(pool_, newStream(_, _, _))
+      .WillOnce([](Envoy::Http::ResponseDecoder&, Envoy::Http::ConnectionPool::Callbacks& callbacks,
+                   const Envoy::Http::ConnectionPool::Instance::StreamOptions&)
+                    -> Envoy::Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason::Overflow, "",
+                                Envoy::Upstream::HostDescriptionConstSharedPtr{});
+        return nullptr;
+      })
+      .WillOnce([this](Envoy::Http::ResponseDecoder& decoder,
+                       Envoy::Http::ConnectionPool::Callbacks& callbacks,
+                       const Envoy::Http::ConnectionPool::Instance::StreamOptions&)
+                    -> Envoy::Http::ConnectionPool::Cancellable* {
+        NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+        callbacks.onPoolReady(stream_encoder_, Envoy::Upstream::HostDescriptionConstSharedPtr{},
+                              stream_info, {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+        decoder.decodeHeaders(Envoy::Http::ResponseHeaderMapPtr{
+                                  new Envoy::Http::TestResponseHeaderMapImpl{{":status", "200"}}},
+                              true);
+        return nullptr;
+      });
+  uint32_t completions = 0;
+  bool succeeded = false;
+  EXPECT_TRUE(client_->tryStartRequest(
+      [&completions, &succeeded](bool, bool success) {
+        completions++;
+        succeeded = success;
+      },
+      time_system_.monotonicTime()));
+  EXPECT_EQ(1, completions);
+  EXPECT_TRUE(succeeded);
+  EXPECT_EQ(1, getCounter("attempted_requests"));
+  EXPECT_EQ(1, getCounter("retried_attempts"));
+  EXPECT_EQ(1, getCounter("retried_requests"));
+  EXPECT_EQ(1, getCounter("pool_overflow"));
+  EXPECT_EQ(1, getCounter("http_2xx"));
+  // Only the final response counts, as the first attempt failed.
+  EXPECT_EQ(0, client_->statistics()["benchmark_http_client.first_attempt_to_response"]->count());
+  EXPECT_EQ(1, client_->statistics()["benchmark_http_client.request_to_final_response"]->count());
+}
+
+TEST_F(BenchmarkClientHttpTest, RetryBudgetLimitsRetries) {
+  setupBenchmarkClient(getDefaultRequestGenerator());
+  Client::RequestAttemptConfig attempt_config;
+  attempt_config.max_retries = 3;
+  // Allows a retry for every other request.
+  attempt_config.retry_budget_percent = 50;
+  client_->setRequestAttemptConfig(attempt_config);
+  EXPECT_CALL(pool_, newStream(_, _, _))
+      .WillRepeatedly([](Envoy::Http::ResponseDecoder&,
+                         Envoy::Http::ConnectionPool::Callbacks& callbacks,
+                         const Envoy::Http::ConnectionPool::Instance::StreamOptions&)
+                          -> Envoy::Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason::Overflow, "",
+                                Envoy::Upstream::HostDescriptionConstSharedPtr{});
+        return nullptr;
+      });
+  uint32_t failures = 0;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(client_->tryStartRequest(
+        [&failures](bool, bool success) {
+          EXPECT_FALSE(success);
+          failures++;
+        },
+        time_system_.monotonicTime()));
+  }
+  EXPECT_EQ(4, failures);
+  EXPECT_EQ(4, getCounter("attempted_requests"));
+  EXPECT_EQ(2, getCounter("retried_attempts"));
+  // Each retry went to a different request, as the budget only allowed one at a time.
+  EXPECT_EQ(2, getCounter("retried_requests"));
+  EXPECT_EQ(6, getCounter("pool_overflow"));
+  EXPECT_GT(getCounter("retry_budget_exhausted"), 0);
+}
+
+TEST_F(BenchmarkClientHttpTest, SourceAddressOnlyAdvancesWhenRequestIsDispatched) {
+  bool have_request = false;
+  setupBenchmarkClient([this, &have_request]() -> RequestPtr {
+    if (!have_request) {
+      return nullptr;
+    }
+    return std::make_unique<RequestImpl>(default_header_map_);
+  });
+  client_->setSourceAddressClusters({"a", "b"});
+  std::string last_cluster;
+  EXPECT_CALL(cluster_manager(), getThreadLocalCluster(_))
+      .WillRepeatedly([this, &last_cluster](absl::string_view cluster_name) {
+        last_cluster = std::string(cluster_name);
+        return &thread_local_cluster_;
+      });
+  std::vector<std::string> dispatched_to;
+  EXPECT_CALL(pool_, newStream(_, _, _))
+      .WillRepeatedly([&last_cluster, &dispatched_to](
+                          Envoy::Http::ResponseDecoder&,
+                          Envoy::Http::ConnectionPool::Callbacks& callbacks,
+                          const Envoy::Http::ConnectionPool::Instance::StreamOptions&)
+                          -> Envoy::Http::ConnectionPool::Cancellable* {
+        dispatched_to.push_back(last_cluster);
+        callbacks.onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason::Overflow, "",
+                                Envoy::Upstream::HostDescriptionConstSharedPtr{});
+        return nullptr;
+      });
+  // Nothing to send, so the first source address stays up next.
+  EXPECT_FALSE(client_->tryStartRequest([](bool, bool) {}, time_system_.monotonicTime()));
+  have_request = true;
+  EXPECT_TRUE(client_->tryStartRequest([](bool, bool) {}, time_system_.monotonicTime()));
+  EXPECT_TRUE(client_->tryStartRequest([](bool, bool) {}, time_system_.monotonicTime()));
+  EXPECT_THAT(dispatched_to, ElementsAre("a", "b"));
+}
+
 TEST_F(BenchmarkClientHttpTest, DrainTimeoutFires) {
   RequestGenerator default_request_generator = getDefaultRequestGenerator();
   setupBenchmarkClient(default_request_generator);
@@ -439,7 +626,7 @@ TEST_F(BenchmarkClientHttpTest, DrainTimeoutFires) {
   EXPECT_CALL(pool_, hasActiveConnections()).WillOnce([]() -> bool { return true; });
   EXPECT_CALL(pool_, addIdleCallback(_));
   // We don't expect the callback that we pass here to fire.
-  client_->tryStartRequest([](bool, bool) { EXPECT_TRUE(false); });
+  client_->tryStartRequest([](bool, bool) { EXPECT_TRUE(false); }, time_system_.monotonicTime());
   // To get past this, the drain timeout within the benchmark client must execute.
   dispatcher_->run(Envoy::Event::Dispatcher::RunType::Block);
   EXPECT_EQ(0, getCounter("http_2xx"));
@@ -67,7 +67,7 @@ public:
     return map;
   }
 
-  bool CheckThreadChanged(const CompletionCallback&) {
+  bool CheckThreadChanged(const CompletionCallback&, Envoy::MonotonicTime) {
     EXPECT_NE(thread_id_, std::this_thread::get_id());
     return false;
   }
@@ -106,7 +106,7 @@ TEST_F(ClientWorkerTest, BasicTest) {
   {
     InSequence dummy;
     EXPECT_CALL(*benchmark_client_, setShouldMeasureLatencies(false));
-    EXPECT_CALL(*benchmark_client_, tryStartRequest(_))
+    EXPECT_CALL(*benchmark_client_, tryStartRequest(_, _))
         .WillOnce(Invoke(this, &ClientWorkerTest::CheckThreadChanged));
     EXPECT_CALL(*benchmark_client_, setShouldMeasureLatencies(true));
     EXPECT_CALL(*sequencer_, start);
@@ -118,10 +118,36 @@ TEST_F(ClientWorkerTest, BasicTest) {
   auto worker = std::make_unique<ClientWorkerImpl>(
       *api_, tls_, cluster_manager_ptr_, benchmark_client_factory_, termination_predicate_factory_,
       sequencer_factory_, request_generator_factory_, store_, worker_number,
-      time_system_.monotonicTime(), http_tracer_, ClientWorkerImpl::HardCodedWarmupStyle::ON);
-
+      time_system_.monotonicTime(), http_tracer_, ClientWorkerImpl::HardCodedWarmupStyle::ON,
+      false, {}, {"10.0.0.1"});
+
+  // The worker snapshots its typed counter block when it completes. The counters of the clusters
+  // bound to its source addresses add to the totals.
+  store_.counterFromString(fmt::format("cluster.{}.benchmark.http_2xx", worker_number)).add(3);
+  store_.counterFromString(fmt::format("cluster.{}.upstream_cx_total", worker_number)).add(1);
+  store_
+      .counterFromString(
+          fmt::format("cluster.{}.source.10_0_0_1.upstream_cx_total", worker_number))
+      .add(2);
+  // Likewise for the connections left open.
+  store_
+      .gaugeFromString(fmt::format("cluster.{}.upstream_cx_active", worker_number),
+                       Envoy::Stats::Gauge::ImportMode::Accumulate)
+      .set(1);
+  store_
+      .gaugeFromString(fmt::format("cluster.{}.source.10_0_0_1.upstream_cx_active", worker_number),
+                       Envoy::Stats::Gauge::ImportMode::Accumulate)
+      .set(1);
   worker->start();
   worker->waitForCompletion();
+  EXPECT_EQ(3, worker->counterValues()[static_cast<size_t>(WorkerCounter::BenchmarkHttp2xx)]);
+  EXPECT_EQ(0, worker->counterValues()[static_cast<size_t>(WorkerCounter::BenchmarkHttp5xx)]);
+  EXPECT_EQ(3, worker->counterValues()[static_cast<size_t>(WorkerCounter::UpstreamCxTotal)]);
+  EXPECT_EQ(2, worker->openConnections());
+  // The block holds the counters of the worker's own scope, which the process skips when it looks
+  // for counters outside of the blocks.
+  EXPECT_EQ(&store_.counterFromString(fmt::format("cluster.{}.upstream_cx_total", worker_number)),
+            worker->counterBlock()[static_cast<size_t>(WorkerCounter::UpstreamCxTotal)]);
 
   EXPECT_CALL(*benchmark_client_, statistics()).WillOnce(Return(createStatisticPtrMap()));
   EXPECT_CALL(*sequencer_, statistics()).WillOnce(Return(createStatisticPtrMap()));
@@ -131,5 +157,44 @@ TEST_F(ClientWorkerTest, BasicTest) {
   worker->shutdown();
 }
 
+TEST_F(ClientWorkerTest, ReportsTheMixOfRequestClasses) {
+  EXPECT_CALL(*benchmark_client_, setShouldMeasureLatencies(_)).Times(2);
+  EXPECT_CALL(*sequencer_, start);
+  EXPECT_CALL(*sequencer_, waitForCompletion);
+  EXPECT_CALL(*benchmark_client_, terminate());
+  EXPECT_CALL(*request_generator_, requestClassNames())
+      .WillRepeatedly(Return(std::vector<std::string>{"0", "1"}));
+  EXPECT_CALL(*request_generator_, requestClassMix())
+      .WillOnce(Return(std::vector<RequestClassMix>{{70, 0.75}, {30, 0.25}}));
+  auto worker = std::make_unique<ClientWorkerImpl>(
+      *api_, tls_, cluster_manager_ptr_, benchmark_client_factory_, termination_predicate_factory_,
+      sequencer_factory_, request_generator_factory_, store_, 1, time_system_.monotonicTime(),
+      http_tracer_, ClientWorkerImpl::HardCodedWarmupStyle::OFF, false, {});
+  worker->start();
+  worker->waitForCompletion();
+  EXPECT_EQ(70, store_.counterFromString("cluster.1.benchmark.class.0.requests").value());
+  EXPECT_EQ(75, store_.counterFromString("cluster.1.benchmark.class.0.target_requests").value());
+  EXPECT_EQ(30, store_.counterFromString("cluster.1.benchmark.class.1.requests").value());
+  EXPECT_EQ(25, store_.counterFromString("cluster.1.benchmark.class.1.target_requests").value());
+  worker->shutdown();
+}
+
+TEST(WorkerCounterValuesTest, MergesByIndexAndConvertsToNames) {
+  WorkerCounterValues worker_0{};
+  WorkerCounterValues worker_1{};
+  worker_0[static_cast<size_t>(WorkerCounter::BenchmarkHttp2xx)] = 5;
+  worker_1[static_cast<size_t>(WorkerCounter::BenchmarkHttp2xx)] = 7;
+  worker_1[static_cast<size_t>(WorkerCounter::UpstreamCxTotal)] = 1;
+
+  WorkerCounterValues merged{};
+  mergeWorkerCounterValues(merged, worker_0);
+  mergeWorkerCounterValues(merged, worker_1);
+
+  const std::map<std::string, uint64_t> counters = workerCounterValuesToMap(merged);
+  EXPECT_EQ(2, counters.size());
+  EXPECT_EQ(12, counters.at("benchmark.http_2xx"));
+  EXPECT_EQ(1, counters.at("upstream_cx_total"));
+}
+
 } // namespace Client
 } // namespace Nighthawk
@@ -0,0 +1,211 @@
+#include "test/common/sequencer_simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
+
+#include "source/common/rate_limiter_impl.h"
+#include "source/common/sequencer_impl.h"
+#include "source/common/termination_predicate_impl.h"
+
+#include "absl/strings/str_format.h"
+
+namespace Nighthawk {
+namespace {
+
+// Orders the event heap so that the earliest event, and among those the first scheduled, is on top.
+template <class Event> bool laterEvent(const Event& a, const Event& b) {
+  return a.time != b.time ? a.time > b.time : a.sequence > b.sequence;
+}
+
+std::string formatNanoseconds(uint64_t nanoseconds) {
+  return absl::StrFormat("%.3fus", nanoseconds / 1000.0);
+}
+
+} // namespace
+
+Envoy::SystemTime SimulatedTimeSource::systemTime() {
+  return Envoy::SystemTime(std::chrono::duration_cast<Envoy::SystemTime::duration>(elapsed_));
+}
+
+Envoy::MonotonicTime SimulatedTimeSource::monotonicTime() {
+  return Envoy::MonotonicTime(elapsed_);
+}
+
+void SimulatedTimeSource::advanceTo(Envoy::MonotonicTime time) {
+  elapsed_ = std::max(elapsed_, std::chrono::nanoseconds(time.time_since_epoch()));
+}
+
+void SimulatedTimeSource::advance(std::chrono::nanoseconds duration) { elapsed_ += duration; }
+
+SimulatedDispatcher::SimulatedDispatcher(SimulatedTimeSource& time_source)
+    : time_source_(time_source) {}
+
+Envoy::Event::TimerPtr SimulatedDispatcher::createTimer(Envoy::Event::TimerCb cb) {
+  return std::make_unique<SimulatedTimer>(*this, std::move(cb));
+}
+
+void SimulatedDispatcher::run(RunType) {
+  exit_requested_ = false;
+  while (!exit_requested_ && !events_.empty()) {
+    std::pop_heap(events_.begin(), events_.end(), laterEvent<Event>);
+    Event event = std::move(events_.back());
+    events_.pop_back();
+    time_source_.advanceTo(event.time);
+    events_processed_++;
+    event.callback();
+  }
+}
+
+void SimulatedDispatcher::exit() { exit_requested_ = true; }
+
+void SimulatedDispatcher::schedule(Envoy::MonotonicTime time, std::function<void()> callback) {
+  events_.push_back({time, next_sequence_++, std::move(callback)});
+  std::push_heap(events_.begin(), events_.end(), laterEvent<Event>);
+}
+
+void SimulatedDispatcher::enableTimer(const std::shared_ptr<TimerState>& state,
+                                      std::chrono::nanoseconds duration) {
+  // Scheduling the event assigns it the sequence it will be identified by.
+  state->sequence = next_sequence_;
+  state->enabled = true;
+  schedule(time_source_.monotonicTime() + duration, [state, sequence = state->sequence]() {
+    if (state->enabled && state->sequence == sequence) {
+      state->enabled = false;
+      state->callback();
+    }
+  });
+}
+
+SimulatedDispatcher::SimulatedTimer::SimulatedTimer(SimulatedDispatcher& dispatcher,
+                                                    Envoy::Event::TimerCb cb)
+    : dispatcher_(dispatcher), state_(std::make_shared<TimerState>()) {
+  state_->callback = std::move(cb);
+}
+
+SimulatedDispatcher::SimulatedTimer::~SimulatedTimer() { disableTimer(); }
+
+void SimulatedDispatcher::SimulatedTimer::disableTimer() { state_->enabled = false; }
+
+void SimulatedDispatcher::SimulatedTimer::enableTimer(std::chrono::milliseconds duration,
+                                                      const Envoy::ScopeTrackedObject*) {
+  dispatcher_.enableTimer(state_, duration);
+}
+
+void SimulatedDispatcher::SimulatedTimer::enableHRTimer(std::chrono::microseconds duration,
+                                                        const Envoy::ScopeTrackedObject*) {
+  dispatcher_.enableTimer(state_, duration);
+}
+
+bool SimulatedDispatcher::SimulatedTimer::enabled() { return state_->enabled; }
+
+SimulatedPlatformUtil::SimulatedPlatformUtil(SimulatedTimeSource& time_source,
+                                             std::chrono::nanoseconds yield_duration,
+                                             std::chrono::nanoseconds sleep_overshoot)
+    : time_source_(time_source), yield_duration_(yield_duration),
+      sleep_overshoot_(sleep_overshoot) {}
+
+void SimulatedPlatformUtil::yieldCurrentThread() const { time_source_.advance(yield_duration_); }
+
+void SimulatedPlatformUtil::sleep(std::chrono::microseconds duration) const {
+  time_source_.advance(duration + sleep_overshoot_);
+}
+
+LatencyModel constantLatency(std::chrono::nanoseconds latency) {
+  return [latency](uint64_t) { return latency; };
+}
+
+LatencyModel exponentialLatency(std::chrono::nanoseconds mean, uint64_t seed) {
+  auto generator = std::make_shared<std::mt19937_64>(seed);
+  return [generator, mean](uint64_t) {
+    // Inverse transform sampling rather than std::exponential_distribution, whose output differs
+    // between standard library implementations.
+    const double uniform = ((*generator)() >> 11) * 0x1.0p-53;
+    return std::chrono::nanoseconds(
+        static_cast<int64_t>(-std::log1p(-uniform) * static_cast<double>(mean.count())));
+  };
+}
+
+double SequencerSimulationResult::achievedRate() const {
+  return simulated_duration.count() == 0
+             ? 0
+             : initiated_requests / std::chrono::duration<double>(simulated_duration).count();
+}
+
+std::string SequencerSimulationResult::toString() const {
+  return absl::StrFormat(
+      "intended %d requests, initiated %d, completed %d, %d early.\n"
+      "achieved %.1f Hz over %s of simulated time in %d events.\n"
+      "schedule lag: mean %s, p50 %s, p99 %s, p99.99 %s, max %s.",
+      intended_requests, initiated_requests, completed_requests, early_requests, achievedRate(),
+      formatNanoseconds(simulated_duration.count()), events,
+      formatNanoseconds(static_cast<uint64_t>(schedule_lag->mean())),
+      formatNanoseconds(schedule_lag->percentile(50)),
+      formatNanoseconds(schedule_lag->percentile(99)),
+      formatNanoseconds(schedule_lag->percentile(99.99)), formatNanoseconds(schedule_lag->max()));
+}
+
+SequencerSimulationResult runSequencerSimulation(const SequencerSimulationConfig& config) {
+  SimulatedTimeSource time_source;
+  SimulatedDispatcher dispatcher(time_source);
+  SimulatedPlatformUtil platform_util(time_source, config.yield_duration, config.sleep_overshoot);
+  Envoy::Stats::IsolatedStoreImpl store;
+  SequencerSimulationResult result;
+  result.schedule_lag = std::make_unique<HdrStatistic>();
+  const Frequency frequency(config.requests_per_second);
+  result.intended_requests = static_cast<uint64_t>(std::floor(
+      std::chrono::duration<double>(config.duration).count() * frequency.value() + 0.5));
+
+  const Envoy::MonotonicTime start = time_source.monotonicTime();
+  const double interval_ns =
+      std::chrono::duration<double, std::nano>(frequency.interval()).count();
+  uint64_t in_flight = 0;
+  SequencerTarget target = [&](OperationCallback callback, Envoy::MonotonicTime) {
+    if (config.max_in_flight > 0 && in_flight >= config.max_in_flight) {
+      return false;
+    }
+    const Envoy::MonotonicTime now = time_source.monotonicTime();
+    const uint64_t request_number = result.initiated_requests++;
+    const Envoy::MonotonicTime due =
+        start + std::chrono::nanoseconds(
+                    static_cast<int64_t>(std::llround((request_number + 0.5) * interval_ns)));
+    if (now < due) {
+      result.early_requests++;
+      result.schedule_lag->addValue(0);
+    } else {
+      result.schedule_lag->addValue((now - due).count());
+    }
+    in_flight++;
+    dispatcher.schedule(now + config.latency_model(request_number),
+                        [&in_flight, &result, callback]() {
+                          in_flight--;
+                          result.completed_requests++;
+                          callback(true, true);
+                        });
+    return true;
+  };
+
+  RateLimiterPtr rate_limiter =
+      config.rate_limiter_factory
+          ? config.rate_limiter_factory(time_source, frequency)
+          : std::make_unique<LinearRateLimiter>(time_source, frequency);
+  SequencerImpl sequencer(
+      platform_util, dispatcher, time_source, std::move(rate_limiter), target,
+      std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>(),
+      config.idle_strategy,
+      std::make_unique<DurationTerminationPredicateImpl>(
+          time_source, std::chrono::duration_cast<std::chrono::microseconds>(config.duration),
+          start),
+      store);
+  sequencer.start();
+  sequencer.waitForCompletion();
+  result.simulated_duration = time_source.monotonicTime() - start;
+  // Let the requests which are still in flight complete, like a worker does when it tears down.
+  dispatcher.run(Envoy::Event::Dispatcher::RunType::Block);
+  result.events = dispatcher.eventsProcessed();
+  return result;
+}
+
+} // namespace Nighthawk
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/timer.h"
+
+#include "nighthawk/common/platform_util.h"
+#include "nighthawk/common/rate_limiter.h"
+
+#include "external/envoy/test/mocks/event/mocks.h"
+
+#include "source/common/frequency.h"
+#include "source/common/statistic_impl.h"
+
+#include "api/client/options.pb.h"
+
+namespace Nighthawk {
+
+/**
+ * Time source which only moves when told to, starting from the epoch. Simulated time is decoupled
+ * from the wall clock, so a simulation of seconds of load takes as long as processing its events
+ * does.
+ */
+class SimulatedTimeSource : public Envoy::TimeSource {
+public:
+  Envoy::SystemTime systemTime() override;
+  Envoy::MonotonicTime monotonicTime() override;
+
+  /**
+   * Moves time forward. Time never moves backwards, so moving to a time in the past is a no-op.
+   *
+   * @param time the time to move to.
+   */
+  void advanceTo(Envoy::MonotonicTime time);
+  /**
+   * @param duration how far to move time forward.
+   */
+  void advance(std::chrono::nanoseconds duration);
+
+private:
+  std::chrono::nanoseconds elapsed_{0};
+};
+
+/**
+ * Dispatcher which runs timers and scheduled callbacks as discrete events in simulated time.
+ * Events run in the order of their due time, and in the order they were scheduled when they are
+ * due at the same time, so that runs are deterministic. Running an event first moves time to its
+ * due time. Events which became overdue, because time was moved forward outside of the event loop,
+ * run as soon as possible, like a late wakeup would. Only the parts of the dispatcher the sequencer
+ * uses are simulated; everything else is left to the mock.
+ */
+class SimulatedDispatcher : public Envoy::Event::MockDispatcher {
+public:
+  SimulatedDispatcher(SimulatedTimeSource& time_source);
+
+  Envoy::Event::TimerPtr createTimer(Envoy::Event::TimerCb cb) override;
+  void run(RunType type) override;
+  void exit() override;
+  void updateApproximateMonotonicTime() override {}
+
+  /**
+   * Schedules a callback to run at a point in simulated time.
+   *
+   * @param time when to run the callback.
+   * @param callback the callback to run.
+   */
+  void schedule(Envoy::MonotonicTime time, std::function<void()> callback);
+
+  /**
+   * @return uint64_t the number of events which ran so far.
+   */
+  uint64_t eventsProcessed() const { return events_processed_; }
+
+private:
+  struct Event {
+    Envoy::MonotonicTime time;
+    uint64_t sequence;
+    std::function<void()> callback;
+  };
+  struct TimerState {
+    Envoy::Event::TimerCb callback;
+    bool enabled{false};
+    // Identifies the event which fires the timer. Events of earlier enablements are ignored.
+    uint64_t sequence{0};
+  };
+  class SimulatedTimer : public Envoy::Event::Timer {
+  public:
+    SimulatedTimer(SimulatedDispatcher& dispatcher, Envoy::Event::TimerCb cb);
+    ~SimulatedTimer() override;
+    void disableTimer() override;
+    void enableTimer(std::chrono::milliseconds duration,
+                     const Envoy::ScopeTrackedObject* object = nullptr) override;
+    void enableHRTimer(std::chrono::microseconds duration,
+                       const Envoy::ScopeTrackedObject* object = nullptr) override;
+    bool enabled() override;
+
+  private:
+    SimulatedDispatcher& dispatcher_;
+    // Shared with the pending event, which may outlive the timer.
+    std::shared_ptr<TimerState> state_;
+  };
+
+  void enableTimer(const std::shared_ptr<TimerState>& state, std::chrono::nanoseconds duration);
+
+  SimulatedTimeSource& time_source_;
+  // A min-heap on (time, sequence).
+  std::vector<Event> events_;
+  uint64_t next_sequence_{0};
+  uint64_t events_processed_{0};
+  bool exit_requested_{false};
+};
+
+/**
+ * Platform utilities which cost simulated time instead of wall clock time, so that the cost of the
+ * sequencer idle strategies shows in a simulation.
+ */
+class SimulatedPlatformUtil : public PlatformUtil {
+public:
+  /**
+   * @param time_source the simulated time source to advance.
+   * @param yield_duration how long yielding the thread takes.
+   * @param sleep_overshoot how much longer than requested sleeping takes.
+   */
+  SimulatedPlatformUtil(SimulatedTimeSource& time_source, std::chrono::nanoseconds yield_duration,
+                        std::chrono::nanoseconds sleep_overshoot);
+
+  void yieldCurrentThread() const override;
+  void sleep(std::chrono::microseconds duration) const override;
+
+private:
+  SimulatedTimeSource& time_source_;
+  const std::chrono::nanoseconds yield_duration_;
+  const std::chrono::nanoseconds sleep_overshoot_;
+};
+
+/**
+ * Returns how long the upstream takes to respond to the request with the given (zero-based) number.
+ */
+using LatencyModel = std::function<std::chrono::nanoseconds(uint64_t request_number)>;
+
+/**
+ * Creates the rate limiter under evaluation.
+ */
+using RateLimiterFactory =
+    std::function<RateLimiterPtr(Envoy::TimeSource& time_source, Frequency frequency)>;
+
+/**
+ * @param latency the latency of every request.
+ * @return LatencyModel a model of an upstream with a fixed latency.
+ */
+LatencyModel constantLatency(std::chrono::nanoseconds latency);
+
+/**
+ * @param mean the mean latency.
+ * @param seed seeds the random number generator, so that runs with the same seed are identical.
+ * @return LatencyModel a model of an upstream with exponentially distributed latencies.
+ */
+LatencyModel exponentialLatency(std::chrono::nanoseconds mean, uint64_t seed);
+
+struct SequencerSimulationConfig {
+  uint64_t requests_per_second{1000};
+  // How long the duration termination predicate lets the sequencer run.
+  std::chrono::nanoseconds duration{std::chrono::seconds(1)};
+  nighthawk::client::SequencerIdleStrategy::SequencerIdleStrategyOptions idle_strategy{
+      nighthawk::client::SequencerIdleStrategy::SPIN};
+  // The maximum number of requests the upstream accepts concurrently, like a connection pool
+  // would. Zero means no limit, which is an open-loop test.
+  uint64_t max_in_flight{0};
+  LatencyModel latency_model{constantLatency(std::chrono::microseconds(100))};
+  // Defaults to a LinearRateLimiter at requests_per_second.
+  RateLimiterFactory rate_limiter_factory;
+  std::chrono::nanoseconds yield_duration{std::chrono::microseconds(1)};
+  std::chrono::nanoseconds sleep_overshoot{0};
+};
+
+/**
+ * How faithfully a simulated run followed the intended schedule. The intended schedule is the one
+ * the LinearRateLimiter follows: request i is due at (i + 0.5) / requests_per_second after the
+ * start. Rate limiters which deliberately deviate from it, like the ramping or distribution
+ * sampling ones, are best compared on the achieved rate.
+ */
+struct SequencerSimulationResult {
+  // The number of requests the intended schedule holds within the duration.
+  uint64_t intended_requests{0};
+  uint64_t initiated_requests{0};
+  // Includes requests which were still in flight when the sequencer stopped, and completed while
+  // draining.
+  uint64_t completed_requests{0};
+  // Requests which started before they were due. They count as a lag of zero.
+  uint64_t early_requests{0};
+  uint64_t events{0};
+  // How long the sequencer ran for in simulated time.
+  std::chrono::nanoseconds simulated_duration{0};
+  // How late requests started compared to the intended schedule, in nanoseconds.
+  std::unique_ptr<HdrStatistic> schedule_lag;
+
+  /**
+   * @return double the achieved request rate in Hz.
+   */
+  double achievedRate() const;
+  /**
+   * @return std::string a human readable report of the run.
+   */
+  std::string toString() const;
+};
+
+/**
+ * Drives a SequencerImpl, with the configured rate limiter and a DurationTerminationPredicateImpl,
+ * against a simulated upstream in simulated time. Runs are deterministic: the same configuration
+ * always yields the same result.
+ *
+ * @param config describes the run.
+ * @return SequencerSimulationResult how the run went.
+ */
+SequencerSimulationResult runSequencerSimulation(const SequencerSimulationConfig& config);
+
+} // namespace Nighthawk
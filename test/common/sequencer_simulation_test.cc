@@ -0,0 +1,171 @@
+#include <chrono>
+
+#include "source/common/rate_limiter_impl.h"
+
+#include "test/common/sequencer_simulation.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+namespace Nighthawk {
+namespace {
+
+SequencerSimulationConfig
+oneMillionRequestsPerSecond(nighthawk::client::SequencerIdleStrategy::SequencerIdleStrategyOptions
+                                idle_strategy) {
+  SequencerSimulationConfig config;
+  config.requests_per_second = 1000000;
+  config.duration = 100ms;
+  config.idle_strategy = idle_strategy;
+  config.latency_model = constantLatency(50us);
+  return config;
+}
+
+TEST(SimulatedTimeSource, OnlyMovesForward) {
+  SimulatedTimeSource time_source;
+  const Envoy::MonotonicTime start = time_source.monotonicTime();
+  EXPECT_EQ(time_source.monotonicTime(), start);
+  time_source.advance(10us);
+  EXPECT_EQ(time_source.monotonicTime() - start, 10us);
+  time_source.advanceTo(start + 5us);
+  EXPECT_EQ(time_source.monotonicTime() - start, 10us);
+  time_source.advanceTo(start + 20us);
+  EXPECT_EQ(time_source.monotonicTime() - start, 20us);
+  EXPECT_EQ(time_source.systemTime().time_since_epoch(), 20us);
+}
+
+TEST(SimulatedDispatcher, RunsEventsInOrderOfTimeThenScheduling) {
+  SimulatedTimeSource time_source;
+  SimulatedDispatcher dispatcher(time_source);
+  const Envoy::MonotonicTime start = time_source.monotonicTime();
+  std::vector<int> order;
+  dispatcher.schedule(start + 2us, [&order]() { order.push_back(3); });
+  dispatcher.schedule(start + 1us, [&order]() { order.push_back(1); });
+  dispatcher.schedule(start + 1us, [&order]() { order.push_back(2); });
+  dispatcher.run(Envoy::Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(order, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(time_source.monotonicTime() - start, 2us);
+  EXPECT_EQ(dispatcher.eventsProcessed(), 3);
+}
+
+TEST(SimulatedDispatcher, TimersOnlyFireForTheirLastEnablement) {
+  SimulatedTimeSource time_source;
+  SimulatedDispatcher dispatcher(time_source);
+  int fired = 0;
+  Envoy::Event::TimerPtr timer = dispatcher.createTimer([&fired]() { fired++; });
+  timer->enableHRTimer(10us);
+  timer->enableHRTimer(20us);
+  EXPECT_TRUE(timer->enabled());
+  dispatcher.run(Envoy::Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(fired, 1);
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(time_source.monotonicTime().time_since_epoch(), 20us);
+
+  timer->enableTimer(1ms);
+  timer->disableTimer();
+  Envoy::Event::TimerPtr destroyed = dispatcher.createTimer([&fired]() { fired++; });
+  destroyed->enableTimer(1ms);
+  destroyed.reset();
+  dispatcher.run(Envoy::Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(SequencerSimulation, RunsAreDeterministic) {
+  SequencerSimulationConfig config;
+  config.requests_per_second = 50000;
+  config.max_in_flight = 8;
+  // The latency model draws from a generator of its own, so each run gets a fresh one.
+  config.latency_model = exponentialLatency(200us, 42);
+  const SequencerSimulationResult first = runSequencerSimulation(config);
+  config.latency_model = exponentialLatency(200us, 42);
+  const SequencerSimulationResult second = runSequencerSimulation(config);
+  EXPECT_EQ(first.toString(), second.toString());
+  EXPECT_GT(first.initiated_requests, 0);
+}
+
+TEST(SequencerSimulation, SpinningKeepsTheScheduleWhileIdle) {
+  SequencerSimulationConfig config;
+  config.requests_per_second = 10000;
+  config.duration = 100ms;
+  config.latency_model = constantLatency(50us);
+  const SequencerSimulationResult result = runSequencerSimulation(config);
+  SCOPED_TRACE(result.toString());
+  EXPECT_EQ(result.intended_requests, 1000);
+  EXPECT_NEAR(result.initiated_requests, result.intended_requests, 1);
+  EXPECT_EQ(result.completed_requests, result.initiated_requests);
+  EXPECT_EQ(result.early_requests, 0);
+  // Every request completes before the next one is due, so the sequencer spins in between, and
+  // wakes up every yield.
+  EXPECT_LE(result.schedule_lag->max(), 1000);
+}
+
+TEST(SequencerSimulation, SpinningStopsWhileRequestsAreInFlight) {
+  const SequencerSimulationResult result = runSequencerSimulation(
+      oneMillionRequestsPerSecond(nighthawk::client::SequencerIdleStrategy::SPIN));
+  SCOPED_TRACE(result.toString());
+  EXPECT_EQ(result.intended_requests, 100000);
+  EXPECT_NEAR(result.initiated_requests, result.intended_requests, 25);
+  EXPECT_EQ(result.completed_requests, result.initiated_requests);
+  // There are always requests in flight at this rate, so the sequencer never considers itself
+  // idle, and falls back to the periodic timer and completions to wake it up.
+  EXPECT_LE(result.schedule_lag->max(), 25000);
+  EXPECT_GT(result.schedule_lag->mean(), 1000);
+}
+
+TEST(SequencerSimulation, PollingLagsByUpToTheTimerResolution) {
+  const SequencerSimulationResult result = runSequencerSimulation(
+      oneMillionRequestsPerSecond(nighthawk::client::SequencerIdleStrategy::POLL));
+  SCOPED_TRACE(result.toString());
+  EXPECT_NEAR(result.initiated_requests, result.intended_requests, 25);
+  EXPECT_LE(result.schedule_lag->max(), 25000);
+  EXPECT_GT(result.schedule_lag->mean(), 1000);
+}
+
+TEST(SequencerSimulation, SleepingLagsByTheSleepDurationAndOvershoot) {
+  SequencerSimulationConfig config =
+      oneMillionRequestsPerSecond(nighthawk::client::SequencerIdleStrategy::SLEEP);
+  const SequencerSimulationResult result = runSequencerSimulation(config);
+  config.sleep_overshoot = 50us;
+  const SequencerSimulationResult overshooting = runSequencerSimulation(config);
+  SCOPED_TRACE(result.toString());
+  SCOPED_TRACE(overshooting.toString());
+  EXPECT_LE(result.schedule_lag->max(), 50000);
+  EXPECT_LE(overshooting.schedule_lag->max(), 100000);
+  EXPECT_GT(overshooting.schedule_lag->mean(), result.schedule_lag->mean());
+}
+
+TEST(SequencerSimulation, LimitedUpstreamCapsTheAchievedRate) {
+  SequencerSimulationConfig config;
+  config.requests_per_second = 100000;
+  config.max_in_flight = 10;
+  config.latency_model = constantLatency(1ms);
+  const SequencerSimulationResult result = runSequencerSimulation(config);
+  SCOPED_TRACE(result.toString());
+  // Ten requests in flight that each take a millisecond allow for 10k requests per second.
+  EXPECT_NEAR(result.achievedRate(), 10000, 100);
+  EXPECT_LT(result.initiated_requests, result.intended_requests);
+  EXPECT_EQ(result.completed_requests, result.initiated_requests);
+}
+
+TEST(SequencerSimulation, ComparesRateLimiters) {
+  SequencerSimulationConfig config;
+  config.requests_per_second = 10000;
+  config.duration = 100ms;
+  const SequencerSimulationResult linear = runSequencerSimulation(config);
+  config.rate_limiter_factory = [](Envoy::TimeSource& time_source, Frequency frequency) {
+    return std::make_unique<BurstingRateLimiter>(
+        std::make_unique<LinearRateLimiter>(time_source, frequency), 10);
+  };
+  const SequencerSimulationResult bursting = runSequencerSimulation(config);
+  SCOPED_TRACE(linear.toString());
+  SCOPED_TRACE(bursting.toString());
+  EXPECT_EQ(bursting.intended_requests, linear.intended_requests);
+  EXPECT_NEAR(bursting.initiated_requests, linear.initiated_requests, 10);
+  // The first request of each burst waits for the nine that follow it.
+  EXPECT_GE(bursting.schedule_lag->max(), 900000);
+  EXPECT_LE(linear.schedule_lag->max(), 1000);
+}
+
+} // namespace
+} // namespace Nighthawk
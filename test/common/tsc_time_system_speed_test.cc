@@ -0,0 +1,40 @@
+// Compares the cost of a timestamp taken from the TSC time system against one taken from the
+// monotonic clock, to help judge whether --tsc-clock is worthwhile on a machine.
+
+#include <memory>
+
+#include "external/envoy/source/common/event/real_time_system.h"
+
+#include "source/common/tsc_time_system.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_TscMonotonicTime(benchmark::State& state) {
+  std::unique_ptr<TscTimeSystem> time_system = TscTimeSystem::create();
+  if (time_system == nullptr) {
+    state.SkipWithError("The TSC is unavailable or unreliable on this machine.");
+    return;
+  }
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(time_system->monotonicTime());
+  }
+  state.counters["ns_per_tick"] = time_system->nanosecondsPerTick();
+  state.counters["reliable"] = time_system->reliable();
+}
+BENCHMARK(BM_TscMonotonicTime);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_RealMonotonicTime(benchmark::State& state) {
+  Envoy::Event::RealTimeSystem time_system; // NO_CHECK_FORMAT(real_time)
+  for (auto _ : state) {                    // NOLINT
+    benchmark::DoNotOptimize(time_system.monotonicTime());
+  }
+}
+BENCHMARK(BM_RealMonotonicTime);
+
+} // namespace
+} // namespace Nighthawk
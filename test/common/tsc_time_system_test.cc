@@ -0,0 +1,84 @@
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "source/common/tsc_time_system.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+// The tests below only compare timestamps taken far enough apart that calibration inaccuracies
+// can't reorder them, so they don't depend on the load of the machine.
+class TscTimeSystemTest : public testing::Test {
+public:
+  void SetUp() override {
+    time_system_ = TscTimeSystem::create();
+    if (time_system_ == nullptr) {
+      GTEST_SKIP() << "The TSC is unavailable or unreliable on this machine.";
+    }
+  }
+
+  std::unique_ptr<TscTimeSystem> time_system_;
+};
+
+TEST_F(TscTimeSystemTest, CalibratesToAPlausibleRate) {
+  // Anything between 100 MHz and 10 GHz.
+  EXPECT_GT(time_system_->nanosecondsPerTick(), 0.1);
+  EXPECT_LT(time_system_->nanosecondsPerTick(), 10);
+  EXPECT_TRUE(time_system_->reliable());
+}
+
+TEST_F(TscTimeSystemTest, NeverGoesBackwards) {
+  Envoy::MonotonicTime last = time_system_->monotonicTime();
+  // Long enough to span a couple of drift checks.
+  const Envoy::MonotonicTime end = last + 3 * TscTimeSystem::DriftCheckInterval;
+  while (last < end) {
+    const Envoy::MonotonicTime now = time_system_->monotonicTime();
+    ASSERT_GE(now, last);
+    last = now;
+  }
+  EXPECT_TRUE(time_system_->reliable());
+}
+
+TEST_F(TscTimeSystemTest, AdvancesAcrossSleeps) {
+  const Envoy::MonotonicTime start = time_system_->monotonicTime();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  // Sleeping takes at least as long as requested.
+  EXPECT_GT(time_system_->monotonicTime(), start + std::chrono::milliseconds(10));
+}
+
+TEST_F(TscTimeSystemTest, OrdersTimestampsAcrossThreads) {
+  const Envoy::MonotonicTime before = time_system_->monotonicTime();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  Envoy::MonotonicTime on_thread;
+  std::thread thread([this, &on_thread]() { on_thread = time_system_->monotonicTime(); });
+  thread.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const Envoy::MonotonicTime after = time_system_->monotonicTime();
+  EXPECT_LT(before, on_thread);
+  EXPECT_LT(on_thread, after);
+}
+
+TEST_F(TscTimeSystemTest, StaysReliableOnThreadsWhichRarelyReadTheTime) {
+  time_system_->monotonicTime();
+  std::this_thread::sleep_for(5 * TscTimeSystem::DriftCheckInterval);
+  time_system_->monotonicTime();
+  EXPECT_TRUE(time_system_->reliable());
+}
+
+TEST_F(TscTimeSystemTest, ReanchorsAfterLongPauses) {
+  time_system_->monotonicTime();
+  std::this_thread::sleep_for((TscTimeSystem::MaxDriftCheckIntervals + 2) *
+                              TscTimeSystem::DriftCheckInterval);
+  const Envoy::MonotonicTime after_pause = time_system_->monotonicTime();
+  EXPECT_TRUE(time_system_->reliable());
+  // The pause re-anchored the thread, so the drift checks that follow start from scratch.
+  std::this_thread::sleep_for(2 * TscTimeSystem::DriftCheckInterval);
+  EXPECT_GT(time_system_->monotonicTime(), after_pause);
+  EXPECT_TRUE(time_system_->reliable());
+}
+
+} // namespace
+} // namespace Nighthawk
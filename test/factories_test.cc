@@ -40,6 +40,13 @@ TEST_F(FactoriesTest, CreateBenchmarkClient) {
   EXPECT_CALL(options_, maxPendingRequests());
   EXPECT_CALL(options_, maxActiveRequests());
   EXPECT_CALL(options_, maxRequestsPerConnection());
+  EXPECT_CALL(options_, requestTimeout());
+  EXPECT_CALL(options_, hedgeDelayPercentile());
+  EXPECT_CALL(options_, maxRetries());
+  EXPECT_CALL(options_, retryBudgetPercent());
+  EXPECT_CALL(options_, socketTimestamping());
+  EXPECT_CALL(options_, requestEventLog());
+  EXPECT_CALL(options_, slowestRequests());
   EXPECT_CALL(options_, openLoop());
   EXPECT_CALL(options_, responseHeaderWithLatencyInput());
   auto cmd = std::make_unique<nighthawk::client::CommandLineOptions>();
@@ -192,9 +199,8 @@ public:
     EXPECT_CALL(dispatcher_, createTimer_(_)).Times(2);
     EXPECT_CALL(options_, jitterUniform()).WillOnce(Return(1ns));
     Envoy::Event::SimulatedTimeSystem time_system;
-    const SequencerTarget dummy_sequencer_target = [](const CompletionCallback&) -> bool {
-      return true;
-    };
+    const SequencerTarget dummy_sequencer_target =
+        [](const CompletionCallback&, Envoy::MonotonicTime) -> bool { return true; };
     auto sequencer = factory.create(api_->timeSource(), dispatcher_, dummy_sequencer_target,
                                     std::make_unique<MockTerminationPredicate>(), stats_store_,
                                     time_system.monotonicTime() + 10ms);
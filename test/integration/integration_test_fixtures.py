@@ -3,10 +3,12 @@
 import json
 import logging
 import os
+import random
 import requests
 import socket
 import subprocess
 import sys
+import tempfile
 import threading
 import time
 import pytest
@@ -338,6 +340,39 @@ class MultiServerHttpIntegrationTestBase(IntegrationTestBase):
     return super(MultiServerHttpIntegrationTestBase, self).getAllTestServerRootUris(False)
 
 
+class UdsHttpIntegrationTestBase(IntegrationTestBase):
+  """Base for plain http tests against a Nighthawk test server listening on a unix domain socket.
+
+  The admin interface of the test server keeps listening on an address of the ip version under test.
+
+  Attributes:
+    server_uds_path: String, path of the unix domain socket the test server listens on. Starts
+      with '@' for abstract sockets.
+  """
+
+  def __init__(self, request, server_config_uds, abstract):
+    """Initialize the UdsHttpIntegrationTestBase instance.
+
+    Args:
+      request: The pytest `request` test fixture used to determine information
+        about the currently executing test case.
+      server_config_uds: path to a server configuration which listens on $server_uds_path.
+      abstract: Boolean, use a socket in the abstract namespace instead of one on the file system.
+    """
+    super(UdsHttpIntegrationTestBase, self).__init__(request, server_config_uds)
+    if abstract:
+      self.server_uds_path = "@nighthawk-test-server-%d" % random.randint(1, 1024 * 1024 * 1024)
+    else:
+      # Socket paths are limited to about a hundred characters, so we don't put them in the
+      # (deeply nested) output directory.
+      self.server_uds_path = os.path.join(tempfile.mkdtemp(), "nighthawk-test-server.sock")
+    self.parameters["server_uds_path"] = self.server_uds_path
+
+  def getTestServerRootUri(self):
+    """See base class."""
+    return "unix://%s:/" % self.server_uds_path
+
+
 class HttpsIntegrationTestBase(IntegrationTestBase):
   """Base for https tests against the Nighthawk test server."""
 
@@ -421,6 +456,42 @@ def http_test_server_fixture(request, server_config, caplog):
   f.tearDown(caplog)
 
 
+@pytest.fixture()
+def server_config_uds():
+  """Fixture which yields the path to a server configuration listening on a unix domain socket.
+
+  Yields:
+      String: Path to the server configuration.
+  """
+  yield "nighthawk/test/integration/configurations/nighthawk_http_origin_uds.yaml"
+
+
+@pytest.fixture(params=determineIpVersionsFromEnvironment())
+def uds_http_test_server_fixture(request, server_config_uds, caplog):
+  """Fixture for setting up a test environment with a server listening on a unix domain socket.
+
+  Yields:
+      UdsHttpIntegrationTestBase: A fully set up instance. Tear down will happen automatically.
+  """
+  f = UdsHttpIntegrationTestBase(request, server_config_uds, abstract=False)
+  f.setUp()
+  yield f
+  f.tearDown(caplog)
+
+
+@pytest.fixture(params=determineIpVersionsFromEnvironment())
+def abstract_uds_http_test_server_fixture(request, server_config_uds, caplog):
+  """Fixture for setting up a test environment with a server listening on an abstract socket.
+
+  Yields:
+      UdsHttpIntegrationTestBase: A fully set up instance. Tear down will happen automatically.
+  """
+  f = UdsHttpIntegrationTestBase(request, server_config_uds, abstract=True)
+  f.setUp()
+  yield f
+  f.tearDown(caplog)
+
+
 @pytest.fixture(params=determineIpVersionsFromEnvironment())
 def https_test_server_fixture(request, server_config, caplog):
   """Fixture for setting up a test environment with the stock https server configuration.
@@ -234,8 +234,12 @@ class TestServerBase(object):
     try:
       listeners = self.fetchJsonFromAdminInterface("/listeners?format=json")
       # Right now we assume there's only a single listener
-      self.server_port = listeners["listener_statuses"][0]["local_address"]["socket_address"][
-          "port_value"]
+      local_address = listeners["listener_statuses"][0]["local_address"]
+      # Unix domain socket listeners don't have a port.
+      if "pipe" in local_address:
+        self.server_port = 0
+      else:
+        self.server_port = local_address["socket_address"]["port_value"]
       return True
     except requests.exceptions.ConnectionError:
       return False
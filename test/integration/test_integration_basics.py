@@ -12,9 +12,10 @@ from threading import Thread
 
 from test.integration.common import IpVersion
 from test.integration.integration_test_fixtures import (
-    http_test_server_fixture, https_test_server_fixture, https_test_server_fixture,
-    multi_http_test_server_fixture, multi_https_test_server_fixture, quic_test_server_fixture,
-    server_config, server_config_quic)
+    abstract_uds_http_test_server_fixture, http_test_server_fixture, https_test_server_fixture,
+    https_test_server_fixture, multi_http_test_server_fixture, multi_https_test_server_fixture,
+    quic_test_server_fixture, server_config, server_config_quic, server_config_uds,
+    uds_http_test_server_fixture)
 from test.integration import asserts
 from test.integration import utility
 
@@ -70,6 +71,34 @@ def test_http_h1(http_test_server_fixture):
   asserts.assertGreaterEqual(len(counters), 12)
 
 
+def _run_unix_domain_socket_test(fixture, protocol_args):
+  parsed_json, _ = fixture.runNighthawkClient([
+      fixture.getTestServerRootUri(), "--duration", "100", "--connections", "2",
+      "--termination-predicate", "benchmark.http_2xx:24"
+  ] + protocol_args)
+  counters = fixture.getNighthawkCounterMapFromJson(parsed_json)
+  asserts.assertCounterEqual(counters, "benchmark.http_2xx", 25)
+  asserts.assertCounterEqual(counters, "upstream_rq_total", 25)
+  asserts.assertCounterBetweenInclusive(counters, "upstream_cx_total", 1, 2)
+  asserts.assertCounterGreaterEqual(counters, "upstream_cx_tx_bytes_total", 500)
+  asserts.assertCounterGreaterEqual(counters, "upstream_cx_rx_bytes_total", 500)
+  global_histograms = fixture.getNighthawkGlobalHistogramsbyIdFromJson(parsed_json)
+  asserts.assertEqual(int(global_histograms["benchmark_http_client.request_to_response"]["count"]),
+                      25)
+
+
+@pytest.mark.skipif(utility.isSanitizerRun(), reason="Unstable and very slow in sanitizer runs")
+def test_http_h1_unix_domain_socket(uds_http_test_server_fixture):
+  """Test http1 against a test server listening on a unix domain socket."""
+  _run_unix_domain_socket_test(uds_http_test_server_fixture, [])
+
+
+@pytest.mark.skipif(utility.isSanitizerRun(), reason="Unstable and very slow in sanitizer runs")
+def test_http_h2_abstract_unix_domain_socket(abstract_uds_http_test_server_fixture):
+  """Test http2 against a test server listening on a socket in the abstract namespace."""
+  _run_unix_domain_socket_test(abstract_uds_http_test_server_fixture, ["--protocol", "http2"])
+
+
 def _mini_stress_test(fixture, args):
   # run a test with more rps then we can handle, and a very small client-side queue.
   # we should observe both lots of successfull requests as well as time spend in blocking mode.,
@@ -210,6 +239,14 @@ def test_http_concurrency(http_test_server_fixture):
   # upstream_cx > # of backend connections for H1 as new connections will spawn if the existing clients
   # cannot keep up with the RPS.
   asserts.assertCounterGreaterEqual(counters, "upstream_cx_http1_total", 4)
+  # Counters outside of the typed worker counter blocks are reported per worker as well.
+  worker_results = [x for x in parsed_json["results"] if x["name"] != "global"]
+  assert (len(worker_results) == 4)
+  for worker_result in worker_results:
+    worker_counters = {
+        counter["name"]: int(counter["value"]) for counter in worker_result["counters"]
+    }
+    asserts.assertCounterEqual(worker_counters, "default.total_match_count", 1)
 
 
 @pytest.mark.parametrize('server_config',
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "external/envoy/source/common/event/real_time_system.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+#include "source/client/memory_usage_sampler.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+using namespace std::chrono_literals;
+
+class MemoryUsageSamplerTest : public testing::Test {
+public:
+  Envoy::Event::RealTimeSystem time_system_;
+};
+
+TEST_F(MemoryUsageSamplerTest, SamplesAtThePhaseBoundaries) {
+  MemoryUsageSampler sampler(time_system_, 2, 0s);
+  sampler.sample(nighthawk::client::MemorySample::WORKERS_STARTING);
+  sampler.onPhaseStarted();
+  sampler.onPhaseStarted();
+  sampler.onPhaseCompleted();
+  sampler.onPhaseCompleted();
+  const std::vector<nighthawk::client::MemorySample> samples = sampler.stop();
+  ASSERT_EQ(3, samples.size());
+  EXPECT_EQ(nighthawk::client::MemorySample::WORKERS_STARTING, samples[0].trigger());
+  EXPECT_EQ(0, Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(samples[0].offset()));
+  EXPECT_EQ(nighthawk::client::MemorySample::MAIN_PHASE_STARTED, samples[1].trigger());
+  EXPECT_EQ(nighthawk::client::MemorySample::MAIN_PHASE_COMPLETED, samples[2].trigger());
+  EXPECT_LE(Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(samples[1].offset()),
+            Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(samples[2].offset()));
+}
+
+TEST_F(MemoryUsageSamplerTest, SamplesAtTheInterval) {
+  MemoryUsageSampler sampler(time_system_, 1, 5ms);
+  sampler.onPhaseStarted();
+  std::this_thread::sleep_for(50ms);
+  sampler.onPhaseCompleted();
+  const std::vector<nighthawk::client::MemorySample> samples = sampler.stop();
+  ASSERT_GE(samples.size(), 3);
+  EXPECT_EQ(nighthawk::client::MemorySample::MAIN_PHASE_STARTED, samples.front().trigger());
+  EXPECT_EQ(nighthawk::client::MemorySample::INTERVAL, samples[1].trigger());
+  EXPECT_EQ(nighthawk::client::MemorySample::MAIN_PHASE_COMPLETED, samples.back().trigger());
+}
+
+TEST_F(MemoryUsageSamplerTest, StopWithoutPhases) {
+  MemoryUsageSampler sampler(time_system_, 1, 5ms);
+  EXPECT_TRUE(sampler.stop().empty());
+  // Phases which start after stopping aren't sampled.
+  sampler.onPhaseStarted();
+  sampler.onPhaseCompleted();
+  EXPECT_TRUE(sampler.stop().empty());
+}
+
+TEST_F(MemoryUsageSamplerTest, CurrentMemoryUsage) {
+  const nighthawk::client::MemorySample sample = MemoryUsageSampler::currentMemoryUsage();
+  if (sample.resident_set_size_bytes() == 0) {
+    GTEST_SKIP() << "The resident set size can't be determined on this platform.";
+  }
+  EXPECT_GE(sample.peak_resident_set_size_bytes(), sample.resident_set_size_bytes());
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
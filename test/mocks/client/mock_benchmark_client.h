@@ -14,9 +14,12 @@ public:
   MOCK_METHOD(void, terminate, (), (override));
   MOCK_METHOD(void, setShouldMeasureLatencies, (bool), (override));
   MOCK_METHOD(StatisticPtrMap, statistics, (), (const, override));
-  MOCK_METHOD(bool, tryStartRequest, (Client::CompletionCallback), (override));
+  MOCK_METHOD(bool, tryStartRequest, (Client::CompletionCallback, Envoy::MonotonicTime),
+              (override));
   MOCK_METHOD(Envoy::Stats::Scope&, scope, (), (const, override));
   MOCK_METHOD(bool, shouldMeasureLatencies, (), (const, override));
+  MOCK_METHOD(std::vector<nighthawk::client::SlowRequest>, slowestRequests, (),
+              (const, override));
   MOCK_METHOD(const Envoy::Http::RequestHeaderMap&, requestHeaders, (), (const));
 };
 
@@ -33,6 +33,23 @@ public:
               (const, override));
   MOCK_METHOD(absl::optional<envoy::config::core::v3::BindConfig>&, upstreamBindConfig, (),
               (const, override));
+  MOCK_METHOD(std::vector<std::string>, sourceAddresses, (), (const, override));
+  MOCK_METHOD(bool, lowMemoryConnections, (), (const, override));
+  MOCK_METHOD(bool, reportMemoryUsage, (), (const, override));
+  MOCK_METHOD(bool, socketTimestamping, (), (const, override));
+  MOCK_METHOD(bool, tscClock, (), (const, override));
+  MOCK_METHOD(bool, calibrateOverhead, (), (const, override));
+  MOCK_METHOD(bool, overheadAdjustedPercentiles, (), (const, override));
+  MOCK_METHOD(std::string, requestEventLog, (), (const, override));
+  MOCK_METHOD(uint32_t, requestEventLogCapacity, (), (const, override));
+  MOCK_METHOD(uint32_t, slowestRequests, (), (const, override));
+  MOCK_METHOD(std::vector<std::string>, slowestRequestsHeaders, (), (const, override));
+  MOCK_METHOD(bool, perfCounters, (), (const, override));
+  MOCK_METHOD(std::string, cpuProfile, (), (const, override));
+  MOCK_METHOD(std::string, heapProfile, (), (const, override));
+  MOCK_METHOD(std::chrono::nanoseconds, profileDelay, (), (const, override));
+  MOCK_METHOD(std::chrono::nanoseconds, profileDuration, (), (const, override));
+  MOCK_METHOD(std::chrono::nanoseconds, memorySampleInterval, (), (const, override));
   MOCK_METHOD(absl::optional<envoy::config::core::v3::TransportSocket>&, transportSocket, (),
               (const, override));
   MOCK_METHOD(uint32_t, maxPendingRequests, (), (const, override));
@@ -52,6 +69,10 @@ public:
   MOCK_METHOD(TerminationPredicateMap, failurePredicates, (), (const, override));
   MOCK_METHOD(bool, openLoop, (), (const, override));
   MOCK_METHOD(std::chrono::nanoseconds, jitterUniform, (), (const, override));
+  MOCK_METHOD(std::chrono::nanoseconds, requestTimeout, (), (const, override));
+  MOCK_METHOD(double, hedgeDelayPercentile, (), (const, override));
+  MOCK_METHOD(uint32_t, maxRetries, (), (const, override));
+  MOCK_METHOD(double, retryBudgetPercent, (), (const, override));
   MOCK_METHOD(std::string, nighthawkService, (), (const, override));
   MOCK_METHOD(bool, h2UseMultipleConnections, (), (const));
   MOCK_METHOD(std::vector<nighthawk::client::MultiTarget::Endpoint>, multiTargetEndpoints, (),
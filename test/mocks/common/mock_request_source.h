@@ -12,6 +12,8 @@ public:
   MOCK_METHOD(RequestGenerator, get, (), (override));
   MOCK_METHOD(void, initOnThread, (), (override));
   MOCK_METHOD(void, destroyOnThread, (), (override));
+  MOCK_METHOD(std::vector<std::string>, requestClassNames, (), (const, override));
+  MOCK_METHOD(std::vector<RequestClassMix>, requestClassMix, (), (const, override));
 };
 
 } // namespace Nighthawk
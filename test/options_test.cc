@@ -192,13 +192,15 @@ TEST_F(OptionsImplTest, AlmostAll) {
       "{} --rps 4 --connections 5 --duration 6 --timeout 7 --h2 "
       "--concurrency 8 --verbosity error --output-format yaml --prefetch-connections "
       "--burst-size 13 --address-family v6 --request-method POST --request-body-size 1234 "
-      "--upstream-bind-config {} "
+      "--upstream-bind-config {} --source-address 10.0.0.0/31 --source-address 10.0.0.4 "
+      "--low-memory-connections --report-memory-usage --tsc-clock "
       "--transport-socket {} "
       "--request-header f1:b1 --request-header f2:b2 --request-header f3:b3:b4 "
       "--max-pending-requests 10 "
       "--max-active-requests 11 --max-requests-per-connection 12 --sequencer-idle-strategy sleep "
       "--termination-predicate t1:1 --termination-predicate t2:2 --failure-predicate f1:1 "
-      "--failure-predicate f2:2 --jitter-uniform .00001s "
+      "--failure-predicate f2:2 --jitter-uniform .00001s --request-timeout .5s "
+      "--hedge-delay-percentile 95 --max-retries 2 --retry-budget-percent 10 "
       "--max-concurrent-streams 42 "
       "--experimental-h1-connection-reuse-strategy lru --label label1 --label label2 {} "
       "--simple-warmup --stats-sinks {} --stats-sinks {} --stats-flush-interval 10 "
@@ -227,6 +229,11 @@ TEST_F(OptionsImplTest, AlmostAll) {
   const std::vector<std::string> expected_headers = {"f1:b1", "f2:b2", "f3:b3:b4"};
   EXPECT_EQ(expected_headers, options->requestHeaders());
   EXPECT_EQ(1234, options->requestBodySize());
+  const std::vector<std::string> expected_source_addresses{"10.0.0.0/31", "10.0.0.4"};
+  EXPECT_EQ(expected_source_addresses, options->sourceAddresses());
+  EXPECT_TRUE(options->lowMemoryConnections());
+  EXPECT_TRUE(options->reportMemoryUsage());
+  EXPECT_TRUE(options->tscClock());
   EXPECT_EQ(
       "name: \"envoy.transport_sockets.tls\"\n"
       "typed_config {\n"
@@ -250,6 +257,10 @@ TEST_F(OptionsImplTest, AlmostAll) {
   EXPECT_EQ(1, options->failurePredicates()["f1"]);
   EXPECT_EQ(2, options->failurePredicates()["f2"]);
   EXPECT_EQ(10us, options->jitterUniform());
+  EXPECT_EQ(500ms, options->requestTimeout());
+  EXPECT_DOUBLE_EQ(95, options->hedgeDelayPercentile());
+  EXPECT_EQ(2, options->maxRetries());
+  EXPECT_DOUBLE_EQ(10, options->retryBudgetPercent());
   EXPECT_EQ(42, options->maxConcurrentStreams());
   EXPECT_EQ(nighthawk::client::H1ConnectionReuseStrategy::LRU,
             options->h1ConnectionReuseStrategy());
@@ -321,10 +332,18 @@ TEST_F(OptionsImplTest, AlmostAll) {
   EXPECT_EQ(1, cmd->mutable_failure_predicates()->erase("f1"));
   EXPECT_EQ(1, cmd->mutable_termination_predicates()->erase("t1"));
   EXPECT_EQ(cmd->jitter_uniform().nanos(), options->jitterUniform().count());
+  EXPECT_EQ(cmd->request_timeout().nanos(), options->requestTimeout().count());
+  EXPECT_DOUBLE_EQ(cmd->hedge_delay_percentile().value(), options->hedgeDelayPercentile());
+  EXPECT_EQ(cmd->max_retries().value(), options->maxRetries());
+  EXPECT_DOUBLE_EQ(cmd->retry_budget_percent().value(), options->retryBudgetPercent());
   EXPECT_EQ(cmd->max_concurrent_streams().value(), options->maxConcurrentStreams());
   EXPECT_EQ(cmd->experimental_h1_connection_reuse_strategy().value(),
             options->h1ConnectionReuseStrategy());
   EXPECT_THAT(cmd->labels(), ElementsAreArray(expected_labels));
+  EXPECT_THAT(cmd->source_addresses(), ElementsAreArray(expected_source_addresses));
+  EXPECT_EQ(cmd->low_memory_connections().value(), options->lowMemoryConnections());
+  EXPECT_EQ(cmd->report_memory_usage().value(), options->reportMemoryUsage());
+  EXPECT_EQ(cmd->tsc_clock().value(), options->tscClock());
   EXPECT_EQ(cmd->simple_warmup().value(), options->simpleWarmup());
   EXPECT_EQ(10, cmd->stats_flush_interval().value());
   ASSERT_EQ(cmd->stats_sinks_size(), options->statsSinks().size());
@@ -733,6 +752,212 @@ TEST_F(OptionsImplTest, UsesHttp3WhenProtocolShortFormFlagIsSet) {
   EXPECT_EQ(Envoy::Http::Protocol::Http3, converted_option->protocol());
 }
 
+TEST_F(OptionsImplTest, UnixDomainSocketTargetsRejectHttp3) {
+  EXPECT_NO_THROW(TestUtility::createOptionsImpl(
+      fmt::format("{} --protocol http2 unix:///tmp/sock:/foo", client_name_)));
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --protocol http3 unix:///tmp/sock:/foo", client_name_)),
+                          MalformedArgvException, "HTTP/3 can't be used with a unix domain socket");
+}
+
+TEST_F(OptionsImplTest, SourceAddressesAreValidated) {
+  EXPECT_NO_THROW(TestUtility::createOptionsImpl(fmt::format(
+      "{} --source-address ::1 --source-address fd00::/120 {}", client_name_, good_test_uri_)));
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --source-address 10.0.0.300 {}", client_name_, good_test_uri_)),
+                          MalformedArgvException, "Invalid source address '10.0.0.300'");
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --source-address 10.0.0.0/33 {}", client_name_, good_test_uri_)),
+                          MalformedArgvException, "Invalid prefix length");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --source-address 10.0.0.1 --source-address ::1 {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "same address family");
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --source-address 10.0.0.0/8 {}", client_name_, good_test_uri_)),
+                          MalformedArgvException, "more than the supported maximum");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --source-address 10.0.0.1 unix:///tmp/sock:/foo", client_name_)),
+      MalformedArgvException, "--source-address can't be used with a unix domain socket");
+}
+
+TEST_F(OptionsImplTest, SocketTimestamping) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --socket-timestamping {}", client_name_, good_test_uri_));
+  EXPECT_TRUE(options->socketTimestamping());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_TRUE(cmd->socket_timestamping().value());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_TRUE(options_from_proto.socketTimestamping());
+  EXPECT_FALSE(TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_))
+                   ->socketTimestamping());
+}
+
+TEST_F(OptionsImplTest, SocketTimestampingIsValidated) {
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --socket-timestamping --h2 {}", client_name_, good_test_uri_)),
+                          MalformedArgvException, "only supported for HTTP/1");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --socket-timestamping https://127.0.0.1/", client_name_)),
+      MalformedArgvException, "requires a plaintext http target URI");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --socket-timestamping unix:///tmp/sock:/foo", client_name_)),
+      MalformedArgvException, "requires a plaintext http target URI");
+}
+
+TEST_F(OptionsImplTest, CalibrateOverhead) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --calibrate-overhead {}", client_name_, good_test_uri_));
+  EXPECT_TRUE(options->calibrateOverhead());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_TRUE(cmd->calibrate_overhead().value());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_TRUE(options_from_proto.calibrateOverhead());
+  EXPECT_FALSE(TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_))
+                   ->calibrateOverhead());
+}
+
+TEST_F(OptionsImplTest, OverheadAdjustedPercentiles) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(fmt::format(
+      "{} --calibrate-overhead --overhead-adjusted-percentiles {}", client_name_, good_test_uri_));
+  EXPECT_TRUE(options->overheadAdjustedPercentiles());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_TRUE(cmd->overhead_adjusted_percentiles().value());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_TRUE(options_from_proto.overheadAdjustedPercentiles());
+  EXPECT_FALSE(TestUtility::createOptionsImpl(
+                   fmt::format("{} --calibrate-overhead {}", client_name_, good_test_uri_))
+                   ->overheadAdjustedPercentiles());
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format("{} --overhead-adjusted-percentiles {}",
+                                                 client_name_, good_test_uri_)),
+      MalformedArgvException, "requires --calibrate-overhead");
+}
+
+TEST_F(OptionsImplTest, CalibrateOverheadIsValidated) {
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --calibrate-overhead --h2 {}", client_name_, good_test_uri_)),
+                          MalformedArgvException, "only supported for HTTP/1");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --calibrate-overhead https://127.0.0.1/", client_name_)),
+      MalformedArgvException, "requires a plaintext http target URI");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --calibrate-overhead --multi-target-endpoint 127.0.0.1:80 --multi-target-path /",
+          client_name_)),
+      MalformedArgvException, "requires a target URI");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --calibrate-overhead --nighthawk-service grpc://127.0.0.1:8443 {}",
+                      client_name_, good_test_uri_)),
+      MalformedArgvException, "can't be used with --nighthawk-service");
+}
+
+TEST_F(OptionsImplTest, RequestEventLog) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --request-event-log /tmp/events --request-event-log-capacity 1024 {}",
+                  client_name_, good_test_uri_));
+  EXPECT_EQ("/tmp/events", options->requestEventLog());
+  EXPECT_EQ(1024, options->requestEventLogCapacity());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_EQ("/tmp/events", cmd->request_event_log().value());
+  EXPECT_EQ(1024, cmd->request_event_log_capacity().value());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_EQ("/tmp/events", options_from_proto.requestEventLog());
+  EXPECT_EQ(1024, options_from_proto.requestEventLogCapacity());
+  options = TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_));
+  EXPECT_EQ("", options->requestEventLog());
+  EXPECT_EQ(1048576, options->requestEventLogCapacity());
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --request-event-log-capacity 0 {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "Proto constraint validation failed");
+}
+
+TEST_F(OptionsImplTest, SlowestRequests) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --slowest-requests 5 --slowest-requests-header x-request-id "
+                  "--slowest-requests-header server {}",
+                  client_name_, good_test_uri_));
+  const std::vector<std::string> expected_headers{"x-request-id", "server"};
+  EXPECT_EQ(5, options->slowestRequests());
+  EXPECT_EQ(expected_headers, options->slowestRequestsHeaders());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_EQ(5, cmd->slowest_requests().value());
+  EXPECT_THAT(cmd->slowest_requests_headers(), ElementsAreArray(expected_headers));
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_EQ(5, options_from_proto.slowestRequests());
+  EXPECT_EQ(expected_headers, options_from_proto.slowestRequestsHeaders());
+  EXPECT_EQ(0, TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_))
+                   ->slowestRequests());
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format("{} --slowest-requests-header server {}",
+                                                 client_name_, good_test_uri_)),
+      MalformedArgvException, "requires --slowest-requests");
+}
+
+TEST_F(OptionsImplTest, PerfCounters) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --perf-counters {}", client_name_, good_test_uri_));
+  EXPECT_TRUE(options->perfCounters());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_TRUE(cmd->perf_counters().value());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_TRUE(options_from_proto.perfCounters());
+  EXPECT_FALSE(TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_))
+                   ->perfCounters());
+}
+
+TEST_F(OptionsImplTest, ProfileOptions) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --cpu-profile /tmp/cpu.prof --heap-profile /tmp/heap --profile-delay 5s "
+                  "--profile-duration 1.5s {}",
+                  client_name_, good_test_uri_));
+  EXPECT_EQ("/tmp/cpu.prof", options->cpuProfile());
+  EXPECT_EQ("/tmp/heap", options->heapProfile());
+  EXPECT_EQ(5s, options->profileDelay());
+  EXPECT_EQ(1500ms, options->profileDuration());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_EQ("/tmp/cpu.prof", cmd->cpu_profile().value());
+  EXPECT_EQ(5, cmd->profile_delay().seconds());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_EQ("/tmp/cpu.prof", options_from_proto.cpuProfile());
+  EXPECT_EQ("/tmp/heap", options_from_proto.heapProfile());
+  EXPECT_EQ(5s, options_from_proto.profileDelay());
+  EXPECT_EQ(1500ms, options_from_proto.profileDuration());
+
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --profile-delay 5s {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "require --cpu-profile or --heap-profile");
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(
+                              fmt::format("{} --cpu-profile /tmp/cpu.prof --profile-delay 5 {}",
+                                          client_name_, good_test_uri_)),
+                          MalformedArgvException, "Invalid value for --profile-delay");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --heap-profile /tmp/heap --profile-duration -1s {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "--profile-duration is out of range");
+}
+
+TEST_F(OptionsImplTest, MemorySampleInterval) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(fmt::format(
+      "{} --report-memory-usage --memory-sample-interval 1s {}", client_name_, good_test_uri_));
+  EXPECT_EQ(1s, options->memorySampleInterval());
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_EQ(1, cmd->memory_sample_interval().seconds());
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_EQ(1s, options_from_proto.memorySampleInterval());
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --memory-sample-interval 1s {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "--memory-sample-interval requires --report-memory-usage");
+}
+
 TEST_F(OptionsImplTest, FailsForInvalidProtocolFlagValues) {
   EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(
                               fmt::format("{} --protocol 0 {}", client_name_, good_test_uri_)),
@@ -825,6 +1050,36 @@ TEST_F(OptionsImplTest, JitterValueRangeTest) {
       fmt::format("{} --jitter-uniform 100s {}", client_name_, good_test_uri_)));
 }
 
+TEST_F(OptionsImplTest, RequestTimeoutValueRangeTest) {
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format("{} --request-timeout a {}",
+                                                                     client_name_, good_test_uri_)),
+                          MalformedArgvException, "Invalid value for --request-timeout");
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --request-timeout -1s {}", client_name_, good_test_uri_)),
+                          MalformedArgvException, "--request-timeout is out of range");
+  EXPECT_EQ(0ns, TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_))
+                     ->requestTimeout());
+  EXPECT_EQ(2s, TestUtility::createOptionsImpl(
+                    fmt::format("{} --request-timeout 2s {}", client_name_, good_test_uri_))
+                    ->requestTimeout());
+}
+
+TEST_F(OptionsImplTest, HedgeAndRetryValueRangeTest) {
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --hedge-delay-percentile 100 {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "Proto constraint validation failed");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --retry-budget-percent 101 {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "Proto constraint validation failed");
+  std::unique_ptr<OptionsImpl> options =
+      TestUtility::createOptionsImpl(fmt::format("{} {}", client_name_, good_test_uri_));
+  EXPECT_DOUBLE_EQ(0, options->hedgeDelayPercentile());
+  EXPECT_EQ(0, options->maxRetries());
+  EXPECT_DOUBLE_EQ(20, options->retryBudgetPercent());
+}
+
 // Test a relatively large uint value to see if we can get reasonable range
 // when we specced a uint32_t
 // See https://github.com/envoyproxy/nighthawk/pull/88/files#r299572672
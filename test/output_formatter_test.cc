@@ -105,6 +105,128 @@ TEST_F(OutputCollectorTest, CliFormatter) {
                         "test/test_data/output_formatter.txt.gold");
 }
 
+TEST_F(OutputCollectorTest, CliFormatterShowsOverheadAdjustedPercentiles) {
+  StatisticPtr latency_statistic = std::make_unique<HdrStatistic>();
+  for (const uint64_t value : {40000, 50000, 60000, 70000}) {
+    latency_statistic->addValue(value);
+  }
+  latency_statistic->setId("foo_latency");
+  std::vector<StatisticPtr> calibration_statistics;
+  calibration_statistics.push_back(std::move(latency_statistic));
+  collector_->addResult("calibration", calibration_statistics,
+                        {{"calibration.worker_throughput_ceiling_rps", 50000}}, 1s, absl::nullopt);
+  nighthawk::client::Output output_proto = collector_->toProto();
+  output_proto.mutable_options()->mutable_overhead_adjusted_percentiles()->set_value(true);
+  ConsoleOutputFormatterImpl formatter;
+  const std::string output = *(formatter.formatProto(output_proto));
+  EXPECT_THAT(output, HasSubstr("  Percentile  Count       Value          Adjusted (estimate)\n"));
+  // The median of the baseline, 50us, is subtracted.
+  EXPECT_THAT(output, HasSubstr("  0.5         2           0s 000ms 190us 0s 000ms 140us\n"));
+  EXPECT_THAT(output, HasSubstr("  0.75        3           0s 000ms 200us 0s 000ms 150us\n"));
+  // Statistics which aren't in the baseline aren't adjusted.
+  EXPECT_THAT(output, HasSubstr("  0.5         2           15             \n"));
+  EXPECT_THAT(output,
+              HasSubstr("Throughput ceiling of a single client worker: 50000 requests per second"));
+}
+
+TEST_F(OutputCollectorTest, CliFormatterShowsComparisonWithCalibration) {
+  collector_->addResult("calibration", {},
+                        {{"calibration.worker_throughput_ceiling_rps", 50000},
+                         {"calibration.benchmark_workers", 4},
+                         {"calibration.adjusted_request_to_response_p50_ns", 250000},
+                         {"calibration.adjusted_request_to_response_p99_ns", 0}},
+                        1s, absl::nullopt);
+  ConsoleOutputFormatterImpl formatter;
+  const std::string output = *(formatter.formatProto(collector_->toProto()));
+  EXPECT_THAT(output, HasSubstr("Request latency above the calibration baseline at p50: 0s 000ms "
+                                "250us\n"));
+  EXPECT_THAT(output, HasSubstr("Request latency above the calibration baseline at p99: 0s 000ms "
+                                "000us\n"));
+  EXPECT_THAT(output, HasSubstr("The calibration baseline paces requests like a single one of the "
+                                "4 workers of the benchmark, without contention between workers."));
+}
+
+TEST_F(OutputCollectorTest, CliFormatterOnlyShowsOverheadAdjustedPercentilesOnRequest) {
+  StatisticPtr latency_statistic = std::make_unique<HdrStatistic>();
+  latency_statistic->addValue(50000);
+  latency_statistic->setId("foo_latency");
+  std::vector<StatisticPtr> calibration_statistics;
+  calibration_statistics.push_back(std::move(latency_statistic));
+  collector_->addResult("calibration", calibration_statistics,
+                        {{"calibration.worker_throughput_ceiling_rps", 50000}}, 1s, absl::nullopt);
+  ConsoleOutputFormatterImpl formatter;
+  const std::string output = *(formatter.formatProto(collector_->toProto()));
+  EXPECT_THAT(output, Not(HasSubstr("Adjusted")));
+  EXPECT_THAT(output, HasSubstr("  0.5         2           0s 000ms 190us \n"));
+  EXPECT_THAT(output,
+              HasSubstr("Throughput ceiling of a single client worker: 50000 requests per second"));
+}
+
+TEST_F(OutputCollectorTest, CliFormatterShowsSlowestRequests) {
+  nighthawk::client::SlowRequest slow_request;
+  *slow_request.mutable_latency() = Envoy::Protobuf::util::TimeUtil::MillisecondsToDuration(25);
+  *slow_request.mutable_pool_wait() = Envoy::Protobuf::util::TimeUtil::MicrosecondsToDuration(10);
+  *slow_request.mutable_time_to_first_byte() =
+      Envoy::Protobuf::util::TimeUtil::MillisecondsToDuration(20);
+  slow_request.set_method("GET");
+  slow_request.set_authority("example.com");
+  slow_request.set_path("/slow");
+  slow_request.set_response_code(200);
+  slow_request.set_worker(1);
+  slow_request.set_connection_id(7);
+  slow_request.set_upstream_host("127.0.0.1:80");
+  envoy::config::core::v3::HeaderValue* header = slow_request.add_response_headers();
+  header->set_key("server");
+  header->set_value("envoy");
+  collector_->setSlowestRequests({slow_request});
+  ConsoleOutputFormatterImpl formatter;
+  const std::string output = *(formatter.formatProto(collector_->toProto()));
+  EXPECT_THAT(output, HasSubstr("Slowest requests\n  0s 025ms 000us | GET example.com/slow | "
+                                "status 200 | worker 1 | connection 7 127.0.0.1:80\n"));
+  EXPECT_THAT(output, HasSubstr("    waited for a connection: 0s 000ms 010us | first byte after: "
+                                "0s 020ms 000us\n"));
+  EXPECT_THAT(output, HasSubstr("    response header server: envoy\n"));
+}
+
+TEST_F(OutputCollectorTest, CliFormatterShowsProfiles) {
+  nighthawk::client::Profile profile;
+  profile.set_type(nighthawk::client::Profile::CPU);
+  profile.set_path("/tmp/nighthawk.prof");
+  *profile.mutable_offset() = Envoy::Protobuf::util::TimeUtil::SecondsToDuration(5);
+  *profile.mutable_duration() = Envoy::Protobuf::util::TimeUtil::SecondsToDuration(2);
+  collector_->setProfiles({profile});
+  ConsoleOutputFormatterImpl formatter;
+  const std::string output = *(formatter.formatProto(collector_->toProto()));
+  EXPECT_THAT(output, HasSubstr("Profiles\n  CPU profile /tmp/nighthawk.prof | started 5s 000ms "
+                                "000us into the main phase | ran for 2s 000ms 000us\n"));
+}
+
+TEST_F(OutputCollectorTest, CliFormatterShowsMemorySamples) {
+  nighthawk::client::MemorySample sample;
+  sample.set_trigger(nighthawk::client::MemorySample::MAIN_PHASE_COMPLETED);
+  *sample.mutable_offset() = Envoy::Protobuf::util::TimeUtil::SecondsToDuration(3);
+  sample.set_resident_set_size_bytes(64 * 1024 * 1024);
+  sample.set_peak_resident_set_size_bytes(80 * 1024 * 1024);
+  sample.set_allocated_bytes(30 * 1024 * 1024);
+  sample.set_heap_size_bytes(50 * 1024 * 1024);
+  sample.set_page_heap_free_bytes(6 * 1024 * 1024);
+  sample.set_page_heap_unmapped_bytes(10 * 1024 * 1024);
+  sample.set_thread_cache_bytes(2 * 1024 * 1024);
+  nighthawk::client::MemorySample sample_without_allocator_statistics;
+  sample_without_allocator_statistics.set_trigger(
+      nighthawk::client::MemorySample::WORKERS_STARTING);
+  sample_without_allocator_statistics.set_resident_set_size_bytes(32 * 1024 * 1024);
+  sample_without_allocator_statistics.set_peak_resident_set_size_bytes(32 * 1024 * 1024);
+  collector_->setMemorySamples({sample_without_allocator_statistics, sample});
+  ConsoleOutputFormatterImpl formatter;
+  const std::string output = *(formatter.formatProto(collector_->toProto()));
+  EXPECT_THAT(output, HasSubstr("Memory usage\n  workers starting     | 0s 000ms 000us | resident "
+                                "32.0 MiB | peak resident 32.0 MiB\n  main phase completed "));
+  EXPECT_THAT(output, HasSubstr("| 3s 000ms 000us | resident 64.0 MiB | peak resident 80.0 MiB\n"
+                                "    allocated 30.0 MiB | heap 50.0 MiB | fragmentation 25.0% | "
+                                "page heap free 6.0 MiB | thread caches 2.0 MiB\n"));
+}
+
 TEST_F(OutputCollectorTest, JsonFormatter) {
   JsonOutputFormatterImpl formatter;
   EXPECT_EQ((formatter.formatProto(collector_->toProto())).ok(), true);
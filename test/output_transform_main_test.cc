@@ -8,6 +8,7 @@
 
 #include "source/client/output_formatter_impl.h"
 #include "source/client/output_transform_main.h"
+#include "source/client/request_event_log.h"
 
 #include "absl/strings/match.h"
 #include "gtest/gtest.h"
@@ -71,5 +72,39 @@ TEST_F(OutputTransformMainTest, HappyFlowForAllOutputFormats) {
   }
 }
 
+TEST_F(OutputTransformMainTest, OutputFormatAndRequestEventLogAreExclusive) {
+  std::vector<const char*> argv = {"foo", "--output-format", "human", "--request-event-log",
+                                   "/dev/null"};
+  EXPECT_THROW(OutputTransformMain(argv.size(), argv.data(), stream_), std::exception);
+}
+
+TEST_F(OutputTransformMainTest, BadRequestEventLog) {
+  const std::string path = Envoy::TestEnvironment::temporaryPath("not_a_request_event_log");
+  Envoy::TestEnvironment::writeStringToFileForTest(path, "foo bar blah", true);
+  std::vector<const char*> argv = {"foo", "--request-event-log", path.c_str()};
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
+TEST_F(OutputTransformMainTest, HappyFlowForAllRequestEventLogFormats) {
+  const std::string path = Envoy::TestEnvironment::temporaryPath("request_event_log");
+  {
+    RequestEventLog log(path, 4, 0);
+    RequestEventRecord record{};
+    record.request_id = log.nextRequestId();
+    record.start_ns = 1000;
+    record.last_byte_ns = 2000;
+    record.status = 200;
+    record.outcome = RequestOutcome::Success;
+    log.append(record);
+  }
+  for (const char* format : {"summary", "csv"}) {
+    std::vector<const char*> argv = {"foo", "--request-event-log", path.c_str(),
+                                     "--request-event-log-format", format};
+    OutputTransformMain main(argv.size(), argv.data(), stream_);
+    EXPECT_EQ(main.run(), 0);
+  }
+}
+
 } // namespace Client
 } // namespace Nighthawk
@@ -0,0 +1,110 @@
+#include <google/protobuf/util/time_util.h>
+
+#include <map>
+#include <string>
+
+#include "source/client/overhead_calibration.h"
+
+#include "test/client/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+TEST(OverheadCalibrationTest, RetainsHowRequestsAreIssued) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      "nighthawk_client --calibrate-overhead --rps 100 --connections 7 --concurrency 2 "
+      "--duration 30 --request-method POST --request-body-size 10 --request-header foo:bar "
+      "--report-memory-usage --source-address 10.0.0.1 http://example.com:81/path");
+  OptionsPtr calibration_options =
+      OverheadCalibration::createCalibrationOptions(*options, 1234, false);
+  EXPECT_EQ("http://127.0.0.1:1234/", calibration_options->uri().value());
+  EXPECT_EQ(nighthawk::client::AddressFamily::V4, calibration_options->addressFamily());
+  EXPECT_EQ(OverheadCalibration::RunDuration, calibration_options->duration());
+  EXPECT_EQ(100, calibration_options->requestsPerSecond());
+  EXPECT_EQ(7, calibration_options->connections());
+  // The responder serves on a single thread.
+  EXPECT_EQ("1", calibration_options->concurrency());
+  EXPECT_EQ(envoy::config::core::v3::RequestMethod::POST, calibration_options->requestMethod());
+  EXPECT_EQ(10, calibration_options->requestBodySize());
+  EXPECT_EQ(std::vector<std::string>{"foo:bar"}, calibration_options->requestHeaders());
+  EXPECT_TRUE(calibration_options->sourceAddresses().empty());
+  EXPECT_FALSE(calibration_options->reportMemoryUsage());
+  EXPECT_FALSE(calibration_options->calibrateOverhead());
+}
+
+TEST(OverheadCalibrationTest, OnlyTargetsTheResponder) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      "nighthawk_client --multi-target-endpoint 10.0.0.1:80 --multi-target-endpoint 10.0.0.2:80 "
+      "--multi-target-path /path --multi-target-use-https --label foo");
+  OptionsPtr calibration_options =
+      OverheadCalibration::createCalibrationOptions(*options, 1234, false);
+  EXPECT_EQ("http://127.0.0.1:1234/", calibration_options->uri().value());
+  EXPECT_TRUE(calibration_options->multiTargetEndpoints().empty());
+  EXPECT_TRUE(calibration_options->multiTargetPath().empty());
+  EXPECT_FALSE(calibration_options->multiTargetUseHttps());
+  EXPECT_TRUE(calibration_options->labels().empty());
+}
+
+TEST(OverheadCalibrationTest, SaturatesInClosedLoop) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      "nighthawk_client --calibrate-overhead --open-loop --rps 100 http://127.0.0.1/");
+  OptionsPtr calibration_options =
+      OverheadCalibration::createCalibrationOptions(*options, 1234, true);
+  EXPECT_EQ(1000000, calibration_options->requestsPerSecond());
+  EXPECT_FALSE(calibration_options->openLoop());
+}
+
+// Adds a request latency statistic with the given median and 99th percentile to the result.
+void addRequestLatency(nighthawk::client::Result& result, int64_t median_ns, int64_t p99_ns) {
+  nighthawk::client::Statistic* statistic = result.add_statistics();
+  statistic->set_id("benchmark_http_client.request_to_response");
+  for (const auto& [percentile, value] :
+       {std::make_pair(.5, median_ns), std::make_pair(.99, p99_ns)}) {
+    nighthawk::client::Percentile* reported = statistic->add_percentiles();
+    reported->set_percentile(percentile);
+    *reported->mutable_duration() = Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(value);
+  }
+}
+
+std::map<std::string, uint64_t> counterMap(const nighthawk::client::Result& result) {
+  std::map<std::string, uint64_t> counters;
+  for (const nighthawk::client::Counter& counter : result.counters()) {
+    counters[counter.name()] = counter.value();
+  }
+  return counters;
+}
+
+TEST(OverheadCalibrationTest, ComparesWithBenchmark) {
+  nighthawk::client::Output output;
+  for (const std::string name : {"worker_0", "worker_1", "worker_2", "global"}) {
+    output.add_results()->set_name(name);
+  }
+  addRequestLatency(*output.mutable_results(3), 300000, 900000);
+  nighthawk::client::Result baseline;
+  addRequestLatency(baseline, 50000, 1000000);
+  OverheadCalibration::compareWithBenchmark(output, baseline);
+  const std::map<std::string, uint64_t> counters = counterMap(baseline);
+  EXPECT_EQ(3, counters.at(std::string(OverheadCalibration::BenchmarkWorkersCounter)));
+  EXPECT_EQ(250000, counters.at(std::string(OverheadCalibration::AdjustedMedianCounter)));
+  // The baseline can exceed the benchmark, most likely in the tail.
+  EXPECT_EQ(0, counters.at(std::string(OverheadCalibration::AdjustedP99Counter)));
+}
+
+TEST(OverheadCalibrationTest, ComparesWithSingleWorkerBenchmarkWithoutLatency) {
+  nighthawk::client::Output output;
+  output.add_results()->set_name("global");
+  nighthawk::client::Result baseline;
+  addRequestLatency(baseline, 50000, 1000000);
+  OverheadCalibration::compareWithBenchmark(output, baseline);
+  const std::map<std::string, uint64_t> counters = counterMap(baseline);
+  EXPECT_EQ(1, counters.at(std::string(OverheadCalibration::BenchmarkWorkersCounter)));
+  EXPECT_EQ(0, counters.count(std::string(OverheadCalibration::AdjustedMedianCounter)));
+  EXPECT_EQ(0, counters.count(std::string(OverheadCalibration::AdjustedP99Counter)));
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
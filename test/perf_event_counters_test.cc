@@ -0,0 +1,48 @@
+#include <map>
+#include <string>
+
+#include "source/common/perf_event_counters.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+TEST(PerfEventCountersTest, CountsTheCallingThread) {
+  PerfEventCounters counters;
+  if (!counters.available()) {
+    GTEST_SKIP() << "Perf events are not available in this environment.";
+  }
+  counters.start();
+  volatile uint64_t sum = 0;
+  for (uint64_t i = 0; i < 10000000; i++) {
+    sum = sum + i;
+  }
+  counters.stop();
+  const std::map<std::string, uint64_t> values = counters.values();
+  ASSERT_EQ(1, values.count("perf.task_clock_ns"));
+  EXPECT_GT(values.at("perf.task_clock_ns"), 0);
+  // Stopped counters don't count.
+  for (uint64_t i = 0; i < 10000000; i++) {
+    sum = sum + i;
+  }
+  EXPECT_EQ(values.at("perf.task_clock_ns"), counters.values().at("perf.task_clock_ns"));
+}
+
+TEST(PerfEventCountersTest, AddPerRequestCounters) {
+  std::map<std::string, uint64_t> counters{{"perf.instructions", 50000},
+                                           {"perf.context_switches", 3},
+                                           {"perf.page_faults", 10}};
+  PerfEventCounters::addPerRequestCounters(counters, 100);
+  EXPECT_EQ(500, counters.at("perf.instructions_per_request"));
+  EXPECT_EQ(30, counters.at("perf.context_switches_per_1k_requests"));
+  // Ratios of counters which weren't collected are left out.
+  EXPECT_EQ(0, counters.count("perf.cycles_per_request"));
+  EXPECT_EQ(5, counters.size());
+  // Without requests there are no ratios.
+  PerfEventCounters::addPerRequestCounters(counters, 0);
+  EXPECT_EQ(5, counters.size());
+}
+
+} // namespace
+} // namespace Nighthawk
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "external/envoy/source/common/event/real_time_system.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+#include "source/client/phase_profiler.h"
+
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+using namespace std::chrono_literals;
+
+// Records how the profilers get driven instead of running them.
+class FakePhaseProfiler : public PhaseProfiler {
+public:
+  using PhaseProfiler::PhaseProfiler;
+
+  bool heap_profiler_available_{true};
+  std::vector<std::string> started_;
+  absl::Notification cpu_profiler_stopped_;
+
+protected:
+  bool startCpuProfiler(const std::string& path) override {
+    started_.push_back(path);
+    return true;
+  }
+  void stopCpuProfiler() override { cpu_profiler_stopped_.Notify(); }
+  bool startHeapProfiler(const std::string& path_prefix) override {
+    if (heap_profiler_available_) {
+      started_.push_back(path_prefix);
+    }
+    return heap_profiler_available_;
+  }
+  void stopHeapProfiler() override {}
+};
+
+class PhaseProfilerTest : public testing::Test {
+public:
+  Envoy::Event::RealTimeSystem time_system_;
+};
+
+TEST_F(PhaseProfilerTest, ProfilesUntilTheLastPhaseCompletes) {
+  FakePhaseProfiler profiler(time_system_, 2, "/tmp/cpu.prof", "/tmp/heap", 0s, 0s);
+  profiler.onPhaseStarted();
+  profiler.onPhaseStarted();
+  profiler.onPhaseCompleted();
+  EXPECT_FALSE(
+      profiler.cpu_profiler_stopped_.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  profiler.onPhaseCompleted();
+  EXPECT_TRUE(profiler.cpu_profiler_stopped_.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  const std::vector<nighthawk::client::Profile> profiles = profiler.stop();
+  const std::vector<std::string> expected_started{"/tmp/cpu.prof", "/tmp/heap"};
+  EXPECT_EQ(expected_started, profiler.started_);
+  ASSERT_EQ(2, profiles.size());
+  EXPECT_EQ(nighthawk::client::Profile::CPU, profiles[0].type());
+  EXPECT_EQ("/tmp/cpu.prof", profiles[0].path());
+  EXPECT_EQ(nighthawk::client::Profile::HEAP, profiles[1].type());
+  EXPECT_EQ("/tmp/heap", profiles[1].path());
+}
+
+TEST_F(PhaseProfilerTest, StopsAfterTheDuration) {
+  FakePhaseProfiler profiler(time_system_, 1, "/tmp/cpu.prof", "", 10ms, 20ms);
+  profiler.onPhaseStarted();
+  EXPECT_TRUE(profiler.cpu_profiler_stopped_.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  profiler.onPhaseCompleted();
+  const std::vector<nighthawk::client::Profile> profiles = profiler.stop();
+  ASSERT_EQ(1, profiles.size());
+  EXPECT_GE(Envoy::Protobuf::util::TimeUtil::DurationToMilliseconds(profiles[0].offset()), 10);
+  EXPECT_GE(Envoy::Protobuf::util::TimeUtil::DurationToMilliseconds(profiles[0].duration()), 20);
+}
+
+TEST_F(PhaseProfilerTest, NothingIsProfiledWhenThePhaseCompletesWithinTheDelay) {
+  FakePhaseProfiler profiler(time_system_, 1, "/tmp/cpu.prof", "", 1h, 0s);
+  profiler.onPhaseStarted();
+  profiler.onPhaseCompleted();
+  EXPECT_TRUE(profiler.stop().empty());
+  EXPECT_TRUE(profiler.started_.empty());
+}
+
+TEST_F(PhaseProfilerTest, UnavailableProfilersAreLeftOut) {
+  FakePhaseProfiler profiler(time_system_, 1, "/tmp/cpu.prof", "/tmp/heap", 0s, 0s);
+  profiler.heap_profiler_available_ = false;
+  profiler.onPhaseStarted();
+  profiler.onPhaseCompleted();
+  const std::vector<nighthawk::client::Profile> profiles = profiler.stop();
+  ASSERT_EQ(1, profiles.size());
+  EXPECT_EQ(nighthawk::client::Profile::CPU, profiles[0].type());
+}
+
+TEST_F(PhaseProfilerTest, StopWithoutPhases) {
+  FakePhaseProfiler profiler(time_system_, 1, "/tmp/cpu.prof", "", 0s, 0s);
+  EXPECT_TRUE(profiler.stop().empty());
+  // Phases which start after stopping aren't profiled.
+  profiler.onPhaseStarted();
+  EXPECT_TRUE(profiler.stop().empty());
+  EXPECT_TRUE(profiler.started_.empty());
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
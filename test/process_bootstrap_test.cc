@@ -29,8 +29,10 @@ namespace Nighthawk {
 namespace {
 
 using ::envoy::config::bootstrap::v3::Bootstrap;
+using ::envoy::config::cluster::v3::Cluster;
 using ::Envoy::StatusHelpers::StatusIs;
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::Invoke;
 using ::testing::NiceMock;
 using ::testing::Return;
@@ -153,6 +155,86 @@ TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH1) {
   Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
 }
 
+TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForUnixDomainSocket) {
+  // Unix domain socket paths are not resolved through dns.
+  EXPECT_CALL(mock_dns_resolver_factory_, createDnsResolver(_, _, _))
+      .WillOnce(Return(mock_resolver_));
+  EXPECT_CALL(*mock_resolver_, resolve(_, _, _)).Times(0);
+
+  std::unique_ptr<Client::OptionsImpl> options =
+      Client::TestUtility::createOptionsImpl("nighthawk_client unix://@sidecar:/foo");
+
+  absl::StatusOr<Bootstrap> expected_bootstrap = parseBootstrapFromText(R"pb(
+    static_resources {
+      clusters {
+        name: "0"
+        type: STATIC
+        connect_timeout {
+          seconds: 30
+        }
+        circuit_breakers {
+          thresholds {
+            max_connections {
+              value: 100
+            }
+            max_pending_requests {
+              value: 1
+            }
+            max_requests {
+              value: 100
+            }
+            max_retries {
+            }
+          }
+        }
+        load_assignment {
+          cluster_name: "0"
+          endpoints {
+            lb_endpoints {
+              endpoint {
+                address {
+                  pipe {
+                    path: "@sidecar"
+                  }
+                }
+              }
+            }
+          }
+        }
+        typed_extension_protocol_options {
+          key: "envoy.extensions.upstreams.http.v3.HttpProtocolOptions"
+          value {
+            [type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions] {
+              common_http_protocol_options {
+                max_requests_per_connection {
+                  value: 4294937295
+                }
+              }
+              explicit_http_config {
+                http_protocol_options {
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    stats_flush_interval {
+      seconds: 5
+    }
+  )pb");
+  ASSERT_THAT(expected_bootstrap, StatusIs(absl::StatusCode::kOk));
+
+  NiceMock<Envoy::Api::MockApi> api;
+  absl::StatusOr<Bootstrap> bootstrap =
+      createBootstrapConfiguration(mock_dispatcher_, api, *options, mock_dns_resolver_factory_,
+                                   typed_dns_resolver_config_, number_of_workers_);
+  ASSERT_THAT(bootstrap, StatusIs(absl::StatusCode::kOk));
+  EXPECT_THAT(*bootstrap, EqualsProto(*expected_bootstrap));
+
+  Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
+}
+
 TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH1RespectingPortInUri) {
   setupUriResolutionExpectations();
 
@@ -412,6 +494,92 @@ TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH1WithTls) {
   Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
 }
 
+TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH1WithSocketTimestamping) {
+  setupUriResolutionExpectations();
+
+  std::unique_ptr<Client::OptionsImpl> options = Client::TestUtility::createOptionsImpl(
+      "nighthawk_client --socket-timestamping http://www.example.org");
+
+  absl::StatusOr<Bootstrap> expected_bootstrap = parseBootstrapFromText(R"pb(
+    static_resources {
+      clusters {
+        name: "0"
+        type: STATIC
+        connect_timeout {
+          seconds: 30
+        }
+        circuit_breakers {
+          thresholds {
+            max_connections {
+              value: 100
+            }
+            max_pending_requests {
+              value: 1
+            }
+            max_requests {
+              value: 100
+            }
+            max_retries {
+            }
+          }
+        }
+        transport_socket {
+          name: "nighthawk.transport_sockets.socket_timestamping"
+          typed_config {
+            [type.googleapis.com/nighthawk.client.SocketTimestampingConfig] {
+            }
+          }
+        }
+        load_assignment {
+          cluster_name: "0"
+          endpoints {
+            lb_endpoints {
+              endpoint {
+                address {
+                  socket_address {
+                    address: "127.0.0.1"
+                    port_value: 80
+                  }
+                }
+              }
+            }
+          }
+        }
+        typed_extension_protocol_options {
+          key: "envoy.extensions.upstreams.http.v3.HttpProtocolOptions"
+          value {
+            [type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions] {
+              common_http_protocol_options {
+                max_requests_per_connection {
+                  value: 4294937295
+                }
+              }
+              explicit_http_config {
+                http_protocol_options {
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    stats_flush_interval {
+      seconds: 5
+    }
+  )pb");
+  ASSERT_THAT(expected_bootstrap, StatusIs(absl::StatusCode::kOk));
+
+  NiceMock<Envoy::Api::MockApi> api;
+  absl::StatusOr<Bootstrap> bootstrap =
+      createBootstrapConfiguration(mock_dispatcher_, api, *options, mock_dns_resolver_factory_,
+                                   typed_dns_resolver_config_, number_of_workers_);
+  ASSERT_THAT(bootstrap, StatusIs(absl::StatusCode::kOk));
+  EXPECT_THAT(*bootstrap, EqualsProto(*expected_bootstrap));
+
+  // Ensure the generated bootstrap is valid.
+  Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
+}
+
 TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH1AndMultipleWorkers) {
   setupUriResolutionExpectations();
 
@@ -626,6 +794,99 @@ TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH2) {
   Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
 }
 
+TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH2WithLowMemoryConnections) {
+  setupUriResolutionExpectations();
+
+  std::unique_ptr<Client::OptionsImpl> options = Client::TestUtility::createOptionsImpl(
+      "nighthawk_client --h2 --low-memory-connections http://www.example.org");
+
+  absl::StatusOr<Bootstrap> expected_bootstrap = parseBootstrapFromText(R"pb(
+    static_resources {
+      clusters {
+        name: "0"
+        type: STATIC
+        per_connection_buffer_limit_bytes {
+          value: 32768
+        }
+        connect_timeout {
+          seconds: 30
+        }
+        circuit_breakers {
+          thresholds {
+            max_connections {
+              value: 100
+            }
+            max_pending_requests {
+              value: 1
+            }
+            max_requests {
+              value: 100
+            }
+            max_retries {
+            }
+          }
+        }
+        load_assignment {
+          cluster_name: "0"
+          endpoints {
+            lb_endpoints {
+              endpoint {
+                address {
+                  socket_address {
+                    address: "127.0.0.1"
+                    port_value: 80
+                  }
+                }
+              }
+            }
+          }
+        }
+        typed_extension_protocol_options {
+          key: "envoy.extensions.upstreams.http.v3.HttpProtocolOptions"
+          value {
+            [type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions] {
+              common_http_protocol_options {
+                max_requests_per_connection {
+                  value: 4294937295
+                }
+              }
+              explicit_http_config {
+                http2_protocol_options {
+                  max_concurrent_streams {
+                    value: 2147483647
+                  }
+                  hpack_table_size {
+                  }
+                  initial_stream_window_size {
+                    value: 65535
+                  }
+                  initial_connection_window_size {
+                    value: 65535
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    stats_flush_interval {
+      seconds: 5
+    }
+  )pb");
+  ASSERT_THAT(expected_bootstrap, StatusIs(absl::StatusCode::kOk));
+
+  NiceMock<Envoy::Api::MockApi> api;
+  absl::StatusOr<Bootstrap> bootstrap =
+      createBootstrapConfiguration(mock_dispatcher_, api, *options, mock_dns_resolver_factory_,
+                                   typed_dns_resolver_config_, number_of_workers_);
+  ASSERT_THAT(bootstrap, StatusIs(absl::StatusCode::kOk));
+  EXPECT_THAT(*bootstrap, EqualsProto(*expected_bootstrap));
+
+  // Ensure the generated bootstrap is valid.
+  Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
+}
+
 TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapForH2WithTls) {
   setupUriResolutionExpectations();
 
@@ -1643,6 +1904,243 @@ TEST_F(CreateBootstrapConfigurationTest, CreatesBootstrapWithCustomUpstreamBindC
   Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
 }
 
+TEST_F(CreateBootstrapConfigurationTest, CreatesClustersPerSourceAddress) {
+  setupUriResolutionExpectations();
+
+  // The connections of the worker are split over its source addresses. The first source address
+  // cluster gets the connection that remains.
+  std::unique_ptr<Client::OptionsImpl> options = Client::TestUtility::createOptionsImpl(
+      "nighthawk_client --connections 3 --source-address 10.0.0.1 --source-address 10.0.0.2 "
+      "http://www.example.org");
+
+  absl::StatusOr<Bootstrap> expected_bootstrap = parseBootstrapFromText(R"pb(
+    static_resources {
+      clusters {
+        name: "0"
+        type: STATIC
+        connect_timeout {
+          seconds: 30
+        }
+        circuit_breakers {
+          thresholds {
+            max_connections {
+              value: 3
+            }
+            max_pending_requests {
+              value: 1
+            }
+            max_requests {
+              value: 100
+            }
+            max_retries {
+            }
+          }
+        }
+        load_assignment {
+          cluster_name: "0"
+          endpoints {
+            lb_endpoints {
+              endpoint {
+                address {
+                  socket_address {
+                    address: "127.0.0.1"
+                    port_value: 80
+                  }
+                }
+              }
+            }
+          }
+        }
+        typed_extension_protocol_options {
+          key: "envoy.extensions.upstreams.http.v3.HttpProtocolOptions"
+          value {
+            [type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions] {
+              common_http_protocol_options {
+                max_requests_per_connection {
+                  value: 4294937295
+                }
+              }
+              explicit_http_config {
+                http_protocol_options {
+                }
+              }
+            }
+          }
+        }
+      }
+      clusters {
+        name: "0.source_0"
+        alt_stat_name: "0.source.10_0_0_1"
+        type: STATIC
+        connect_timeout {
+          seconds: 30
+        }
+        circuit_breakers {
+          thresholds {
+            max_connections {
+              value: 2
+            }
+            max_pending_requests {
+              value: 1
+            }
+            max_requests {
+              value: 100
+            }
+            max_retries {
+            }
+          }
+        }
+        load_assignment {
+          cluster_name: "0.source_0"
+          endpoints {
+            lb_endpoints {
+              endpoint {
+                address {
+                  socket_address {
+                    address: "127.0.0.1"
+                    port_value: 80
+                  }
+                }
+              }
+            }
+          }
+        }
+        typed_extension_protocol_options {
+          key: "envoy.extensions.upstreams.http.v3.HttpProtocolOptions"
+          value {
+            [type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions] {
+              common_http_protocol_options {
+                max_requests_per_connection {
+                  value: 4294937295
+                }
+              }
+              explicit_http_config {
+                http_protocol_options {
+                }
+              }
+            }
+          }
+        }
+        upstream_bind_config {
+          source_address {
+            address: "10.0.0.1"
+            port_value: 0
+          }
+        }
+      }
+      clusters {
+        name: "0.source_1"
+        alt_stat_name: "0.source.10_0_0_2"
+        type: STATIC
+        connect_timeout {
+          seconds: 30
+        }
+        circuit_breakers {
+          thresholds {
+            max_connections {
+              value: 1
+            }
+            max_pending_requests {
+              value: 1
+            }
+            max_requests {
+              value: 100
+            }
+            max_retries {
+            }
+          }
+        }
+        load_assignment {
+          cluster_name: "0.source_1"
+          endpoints {
+            lb_endpoints {
+              endpoint {
+                address {
+                  socket_address {
+                    address: "127.0.0.1"
+                    port_value: 80
+                  }
+                }
+              }
+            }
+          }
+        }
+        typed_extension_protocol_options {
+          key: "envoy.extensions.upstreams.http.v3.HttpProtocolOptions"
+          value {
+            [type.googleapis.com/envoy.extensions.upstreams.http.v3.HttpProtocolOptions] {
+              common_http_protocol_options {
+                max_requests_per_connection {
+                  value: 4294937295
+                }
+              }
+              explicit_http_config {
+                http_protocol_options {
+                }
+              }
+            }
+          }
+        }
+        upstream_bind_config {
+          source_address {
+            address: "10.0.0.2"
+            port_value: 0
+          }
+        }
+      }
+    }
+    stats_flush_interval {
+      seconds: 5
+    }
+  )pb");
+  ASSERT_THAT(expected_bootstrap, StatusIs(absl::StatusCode::kOk));
+
+  NiceMock<Envoy::Api::MockApi> api;
+  absl::StatusOr<Bootstrap> bootstrap =
+      createBootstrapConfiguration(mock_dispatcher_, api, *options, mock_dns_resolver_factory_,
+                                   typed_dns_resolver_config_, number_of_workers_);
+  ASSERT_THAT(bootstrap, StatusIs(absl::StatusCode::kOk));
+  EXPECT_THAT(*bootstrap, EqualsProto(*expected_bootstrap));
+
+  // Ensure the generated bootstrap is valid.
+  Envoy::MessageUtil::validate(*bootstrap, Envoy::ProtobufMessage::getStrictValidationVisitor());
+}
+
+TEST_F(CreateBootstrapConfigurationTest, PartitionsSourceAddressesOverWorkers) {
+  setupUriResolutionExpectations();
+
+  std::unique_ptr<Client::OptionsImpl> options = Client::TestUtility::createOptionsImpl(
+      "nighthawk_client --source-address 10.0.0.0/31 --source-address 10.0.0.2 "
+      "http://www.example.org");
+
+  NiceMock<Envoy::Api::MockApi> api;
+  absl::StatusOr<Bootstrap> bootstrap =
+      createBootstrapConfiguration(mock_dispatcher_, api, *options, mock_dns_resolver_factory_,
+                                   typed_dns_resolver_config_, /*number_of_workers=*/2);
+  ASSERT_THAT(bootstrap, StatusIs(absl::StatusCode::kOk));
+  std::vector<std::string> cluster_names;
+  std::vector<std::string> source_addresses;
+  for (const Cluster& cluster : bootstrap->static_resources().clusters()) {
+    cluster_names.push_back(cluster.name());
+    source_addresses.push_back(cluster.upstream_bind_config().source_address().address());
+  }
+  EXPECT_THAT(cluster_names, ElementsAre("0", "0.source_0", "0.source_1", "1", "1.source_0"));
+  EXPECT_THAT(source_addresses, ElementsAre("", "10.0.0.0", "10.0.0.2", "", "10.0.0.1"));
+}
+
+TEST_F(CreateBootstrapConfigurationTest, RejectsMoreSourceAddressesThanConnections) {
+  setupUriResolutionExpectations();
+
+  std::unique_ptr<Client::OptionsImpl> options = Client::TestUtility::createOptionsImpl(
+      "nighthawk_client --connections 2 --source-address 10.0.0.0/30 http://www.example.org");
+
+  NiceMock<Envoy::Api::MockApi> api;
+  absl::StatusOr<Bootstrap> bootstrap =
+      createBootstrapConfiguration(mock_dispatcher_, api, *options, mock_dns_resolver_factory_,
+                                   typed_dns_resolver_config_, /*number_of_workers=*/1);
+  EXPECT_THAT(bootstrap, StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(CreateBootstrapConfigurationTest, DeterminesSniFromRequestHeader) {
   setupUriResolutionExpectations();
 
@@ -0,0 +1,114 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "nighthawk/common/exception.h"
+
+#include "external/envoy/test/test_common/environment.h"
+
+#include "source/client/request_event_log.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+RequestEventRecord recordAt(uint64_t request_id, int64_t start_ns, int64_t duration_ns) {
+  RequestEventRecord record{};
+  record.request_id = request_id;
+  record.connection_id = 7;
+  record.intended_start_ns = start_ns - 1000;
+  record.start_ns = start_ns;
+  record.connect_ns = start_ns + 2000;
+  record.first_byte_ns = start_ns + duration_ns - 500;
+  record.last_byte_ns = start_ns + duration_ns;
+  record.status = 200;
+  record.response_bytes = 10;
+  record.outcome = RequestOutcome::Success;
+  return record;
+}
+
+class RequestEventLogTest : public testing::Test {
+public:
+  const std::string path_{Envoy::TestEnvironment::temporaryPath("request_event_log")};
+};
+
+TEST_F(RequestEventLogTest, RoundTrip) {
+  {
+    RequestEventLog log(path_, 16, 3);
+    for (int i = 0; i < 5; i++) {
+      log.append(recordAt(log.nextRequestId(), 1000000 * (i + 1), 10000));
+    }
+  }
+  absl::StatusOr<std::vector<RequestEventRecord>> records = RequestEventLog::read(path_);
+  ASSERT_TRUE(records.ok()) << records.status();
+  ASSERT_EQ(5, records->size());
+  for (uint64_t i = 0; i < 5; i++) {
+    EXPECT_EQ(i, (*records)[i].request_id);
+    EXPECT_EQ(1000000 * static_cast<int64_t>(i + 1), (*records)[i].start_ns);
+  }
+  // The unused capacity gets truncated away.
+  std::ifstream stream(path_, std::ios_base::binary | std::ios_base::ate);
+  EXPECT_EQ(RequestEventLog::HeaderSize + 5 * sizeof(RequestEventRecord), stream.tellg());
+}
+
+TEST_F(RequestEventLogTest, WrapsAroundRetainingTheMostRecentRecords) {
+  {
+    RequestEventLog log(path_, 4, 0);
+    for (int i = 0; i < 10; i++) {
+      log.append(recordAt(log.nextRequestId(), 1000000 * (i + 1), 10000));
+    }
+  }
+  absl::StatusOr<std::vector<RequestEventRecord>> records = RequestEventLog::read(path_);
+  ASSERT_TRUE(records.ok()) << records.status();
+  ASSERT_EQ(4, records->size());
+  for (uint64_t i = 0; i < 4; i++) {
+    EXPECT_EQ(6 + i, (*records)[i].request_id);
+  }
+}
+
+TEST_F(RequestEventLogTest, RejectsZeroCapacity) {
+  EXPECT_THROW(RequestEventLog(path_, 0, 0), NighthawkException);
+}
+
+TEST_F(RequestEventLogTest, ReadRejectsOtherFiles) {
+  EXPECT_EQ(absl::StatusCode::kNotFound,
+            RequestEventLog::read(path_ + ".does_not_exist").status().code());
+  std::ofstream(path_) << std::string(RequestEventLog::HeaderSize, 'x');
+  EXPECT_EQ(absl::StatusCode::kInvalidArgument, RequestEventLog::read(path_).status().code());
+}
+
+TEST_F(RequestEventLogTest, FormatCsv) {
+  std::vector<RequestEventRecord> records{recordAt(1, 5000, 10000)};
+  records[0].request_class = 2;
+  EXPECT_EQ("request_id,request_class,connection_id,intended_start_ns,start_ns,connect_ns,"
+            "first_byte_ns,last_byte_ns,status,response_bytes,outcome\n"
+            "1,2,7,4000,5000,7000,14500,15000,200,10,success\n",
+            RequestEventLog::formatCsv(records));
+}
+
+TEST_F(RequestEventLogTest, FormatSummary) {
+  std::vector<RequestEventRecord> records;
+  for (int i = 0; i < 10; i++) {
+    records.push_back(recordAt(i, 1000000 * (i + 1), 10000 * (i + 1)));
+  }
+  RequestEventRecord reset{};
+  reset.request_id = 10;
+  reset.outcome = RequestOutcome::StreamReset;
+  records.push_back(reset);
+  const std::string summary = RequestEventLog::formatSummary(records, 2);
+  EXPECT_NE(std::string::npos, summary.find("11 requests\n"));
+  EXPECT_NE(std::string::npos, summary.find("  success: 10\n"));
+  EXPECT_NE(std::string::npos, summary.find("  stream_reset: 1\n"));
+  EXPECT_NE(std::string::npos, summary.find("p90     90.000\n"));
+  // Only the two slowest requests get listed, slowest first.
+  const std::string slowest = summary.substr(summary.find("Slowest"));
+  EXPECT_NE(std::string::npos, slowest.find("100.000\n"));
+  EXPECT_LT(slowest.find("100.000\n"), slowest.find("90.000\n"));
+  EXPECT_EQ(std::string::npos, slowest.find("80.000\n"));
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
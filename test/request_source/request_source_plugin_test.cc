@@ -7,6 +7,7 @@
 #include "external/envoy/test/test_common/utility.h"
 
 #include "source/request_source/request_options_list_plugin_impl.h"
+#include "source/request_source/session_plugin_impl.h"
 
 #include "test/request_source/stub_plugin_impl.h"
 #include "test/test_common/environment.h"
@@ -19,6 +20,7 @@ namespace Nighthawk {
 namespace {
 using nighthawk::request_source::FileBasedOptionsListRequestSourceConfig;
 using nighthawk::request_source::InLineOptionsListRequestSourceConfig;
+using nighthawk::request_source::SessionRequestSourceConfig;
 using nighthawk::request_source::StubPluginConfig;
 using ::testing::NiceMock;
 using ::testing::Test;
@@ -57,6 +59,25 @@ public:
   Envoy::Stats::MockIsolatedStatsStore stats_store_;
   Envoy::Api::ApiPtr api_;
 };
+
+class SessionRequestSourcePluginTest : public Test {
+public:
+  SessionRequestSourcePluginTest() : api_(Envoy::Api::createApiForTest(stats_store_)) {}
+  RequestSourcePtr createPlugin(const std::string& config_yaml) {
+    SessionRequestSourceConfig config;
+    Envoy::TestUtility::loadFromYaml(config_yaml, config);
+    Envoy::ProtobufWkt::Any config_any;
+    config_any.PackFrom(config);
+    auto& config_factory =
+        Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+            "nighthawk.session-request-source-plugin");
+    Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+    header->setPath("/");
+    return config_factory.createRequestSourcePlugin(config_any, *api_, std::move(header));
+  }
+  Envoy::Stats::MockIsolatedStatsStore stats_store_;
+  Envoy::Api::ApiPtr api_;
+};
 TEST_F(StubRequestSourcePluginTest, CreateEmptyConfigProtoCreatesCorrectType) {
   auto& config_factory =
       Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
@@ -392,6 +413,120 @@ TEST_F(InLineRequestSourcePluginTest,
   EXPECT_EQ(header3->getPathValue(), "/a");
 }
 
+TEST_F(InLineRequestSourcePluginTest,
+       CreateRequestSourcePluginGetsRequestGeneratorThatClassifiesRequestsByOptionsIndex) {
+  Envoy::MessageUtil util;
+  nighthawk::client::RequestOptionsList options_list;
+  util.loadFromFile(/*file to load*/ Nighthawk::TestEnvironment::runfilesPath(
+                        "test/request_source/test_data/test-config-ab.yaml"),
+                    /*out parameter*/ options_list,
+                    /*validation visitor*/ Envoy::ProtobufMessage::getStrictValidationVisitor(),
+                    /*Api*/ *api_);
+  nighthawk::request_source::InLineOptionsListRequestSourceConfig config =
+      MakeInLinePluginConfig(options_list, /*num_requests*/ 3);
+  Envoy::ProtobufWkt::Any config_any;
+  config_any.PackFrom(config);
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+          "nighthawk.in-line-options-list-request-source-plugin");
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  RequestSourcePtr plugin =
+      config_factory.createRequestSourcePlugin(config_any, *api_, std::move(header));
+  plugin->initOnThread();
+  EXPECT_THAT(plugin->requestClassNames(), ::testing::ElementsAre("0", "1"));
+  Nighthawk::RequestGenerator generator = plugin->get();
+  Nighthawk::RequestPtr request1 = generator();
+  Nighthawk::RequestPtr request2 = generator();
+  Nighthawk::RequestPtr request3 = generator();
+  ASSERT_NE(request1, nullptr);
+  ASSERT_NE(request2, nullptr);
+  ASSERT_NE(request3, nullptr);
+  EXPECT_EQ(request1->requestClass(), 0);
+  EXPECT_EQ(request2->requestClass(), 1);
+  EXPECT_EQ(request3->requestClass(), 0);
+  // Without weights there is no mix to aim for.
+  EXPECT_TRUE(plugin->requestClassMix().empty());
+}
+
+TEST_F(InLineRequestSourcePluginTest,
+       CreateRequestSourcePluginWithWeightsGetsRequestGeneratorThatFollowsWeights) {
+  nighthawk::client::RequestOptionsList options_list;
+  for (const uint32_t weight : {3, 1, 0}) {
+    nighthawk::client::RequestOptions* request_options = options_list.add_options();
+    request_options->mutable_weight()->set_value(weight);
+  }
+  nighthawk::request_source::InLineOptionsListRequestSourceConfig config =
+      MakeInLinePluginConfig(options_list, /*num_requests*/ 0);
+  Envoy::ProtobufWkt::Any config_any;
+  config_any.PackFrom(config);
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+          "nighthawk.in-line-options-list-request-source-plugin");
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  RequestSourcePtr plugin =
+      config_factory.createRequestSourcePlugin(config_any, *api_, std::move(header));
+  plugin->initOnThread();
+  Nighthawk::RequestGenerator generator = plugin->get();
+  std::vector<uint32_t> counts(3);
+  const uint32_t kRequests = 10000;
+  for (uint32_t i = 0; i < kRequests; i++) {
+    Nighthawk::RequestPtr request = generator();
+    ASSERT_NE(request, nullptr);
+    ASSERT_LT(request->requestClass(), counts.size());
+    counts[request->requestClass()]++;
+  }
+  EXPECT_NEAR(0.75, 1.0 * counts[0] / kRequests, 0.03);
+  EXPECT_NEAR(0.25, 1.0 * counts[1] / kRequests, 0.03);
+  EXPECT_EQ(0, counts[2]);
+  const std::vector<RequestClassMix> mix = plugin->requestClassMix();
+  ASSERT_EQ(3, mix.size());
+  for (size_t i = 0; i < mix.size(); i++) {
+    EXPECT_EQ(counts[i], mix[i].yielded);
+  }
+  EXPECT_DOUBLE_EQ(0.75, mix[0].target_share);
+  EXPECT_DOUBLE_EQ(0.25, mix[1].target_share);
+  EXPECT_DOUBLE_EQ(0, mix[2].target_share);
+  plugin->destroyOnThread();
+}
+
+TEST_F(InLineRequestSourcePluginTest, CreateRequestSourcePluginWithOnlyZeroWeightsThrowsAnError) {
+  nighthawk::client::RequestOptionsList options_list;
+  options_list.add_options()->mutable_weight()->set_value(0);
+  nighthawk::request_source::InLineOptionsListRequestSourceConfig config =
+      MakeInLinePluginConfig(options_list, /*num_requests*/ 0);
+  Envoy::ProtobufWkt::Any config_any;
+  config_any.PackFrom(config);
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+          "nighthawk.in-line-options-list-request-source-plugin");
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  EXPECT_THROW_WITH_REGEX(
+      config_factory.createRequestSourcePlugin(config_any, *api_, std::move(header)),
+      Envoy::EnvoyException, "none of its entries has a positive weight");
+}
+
+TEST_F(InLineRequestSourcePluginTest,
+       CreateRequestSourcePluginWithSingleOptionsEntryDoesNotClassifyRequests) {
+  Envoy::MessageUtil util;
+  nighthawk::client::RequestOptionsList options_list;
+  util.loadFromFile(/*file to load*/ Nighthawk::TestEnvironment::runfilesPath(
+                        "test/request_source/test_data/test-config-c.yaml"),
+                    /*out parameter*/ options_list,
+                    /*validation visitor*/ Envoy::ProtobufMessage::getStrictValidationVisitor(),
+                    /*Api*/ *api_);
+  nighthawk::request_source::InLineOptionsListRequestSourceConfig config =
+      MakeInLinePluginConfig(options_list, /*num_requests*/ 1);
+  Envoy::ProtobufWkt::Any config_any;
+  config_any.PackFrom(config);
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+          "nighthawk.in-line-options-list-request-source-plugin");
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  RequestSourcePtr plugin =
+      config_factory.createRequestSourcePlugin(config_any, *api_, std::move(header));
+  EXPECT_TRUE(plugin->requestClassNames().empty());
+}
+
 TEST_F(
     InLineRequestSourcePluginTest,
     CreateRequestSourcePluginMultipleTimesWithDifferentConfigsCreatesDifferentWorkingRequestsSources) {
@@ -459,5 +594,96 @@ TEST_F(
   EXPECT_EQ(request_c_3, nullptr);
 }
 
+TEST_F(SessionRequestSourcePluginTest, CreateRequestSourcePluginCreatesCorrectPluginType) {
+  RequestSourcePtr plugin = createPlugin(R"EOF(
+steps:
+  - request_options: {}
+)EOF");
+  EXPECT_NE(dynamic_cast<SessionRequestSource*>(plugin.get()), nullptr);
+}
+
+TEST_F(SessionRequestSourcePluginTest, SessionsProceedOnResponsesAndUseExtractedValues) {
+  RequestSourcePtr plugin = createPlugin(R"EOF(
+steps:
+  - name: list
+    request_options:
+      request_headers:
+        - { header: { key: ":path", value: "/items" } }
+    extractions:
+      - { variable: "id", response_body: { after: "\"id\":\"", until: "\"" } }
+      - { variable: "cookie", response_header: "set-cookie" }
+  - name: item
+    request_options:
+      request_method: POST
+      request_headers:
+        - { header: { key: ":path", value: "/items/{{id}}" } }
+        - { header: { key: "cookie", value: "{{cookie}}" } }
+)EOF");
+  EXPECT_THAT(plugin->requestClassNames(), ::testing::ElementsAre("list", "item"));
+  plugin->initOnThread();
+  Nighthawk::RequestGenerator generator = plugin->get();
+  Nighthawk::RequestPtr list_request = generator();
+  ASSERT_NE(list_request, nullptr);
+  EXPECT_EQ(list_request->requestClass(), 0);
+  EXPECT_EQ(list_request->header()->getPathValue(), "/items");
+  // The only session is waiting for its response.
+  EXPECT_EQ(generator(), nullptr);
+
+  ResponseObserverSharedPtr observer = list_request->responseObserver();
+  ASSERT_NE(observer, nullptr);
+  EXPECT_GT(observer->maxResponseBodyBytes(), 0);
+  Envoy::Http::TestResponseHeaderMapImpl response_headers{{":status", "200"},
+                                                          {"set-cookie", "session=abc"}};
+  observer->onResponse(true, &response_headers, R"({"items":[{"id":"42"},{"id":"43"}]})");
+
+  Nighthawk::RequestPtr item_request = generator();
+  ASSERT_NE(item_request, nullptr);
+  EXPECT_EQ(item_request->requestClass(), 1);
+  EXPECT_EQ(item_request->header()->getPathValue(), "/items/42");
+  EXPECT_EQ(item_request->header()->getMethodValue(), "POST");
+  EXPECT_EQ(item_request->header()
+                ->get(Envoy::Http::LowerCaseString("cookie"))[0]
+                ->value()
+                .getStringView(),
+            "session=abc");
+  // The last step doesn't extract anything from the response body.
+  EXPECT_EQ(item_request->responseObserver()->maxResponseBodyBytes(), 0);
+  item_request->responseObserver()->onResponse(true, &response_headers, "");
+
+  // The session starts over after its last step.
+  Nighthawk::RequestPtr next_request = generator();
+  ASSERT_NE(next_request, nullptr);
+  EXPECT_EQ(next_request->requestClass(), 0);
+}
+
+TEST_F(SessionRequestSourcePluginTest, SessionsStartOverWhenAStepFails) {
+  RequestSourcePtr plugin = createPlugin(R"EOF(
+concurrent_sessions: 2
+steps:
+  - request_options: {}
+    extractions:
+      - { variable: "token", response_header: "x-token" }
+  - request_options:
+      request_headers:
+        - { header: { key: "x-token", value: "{{token}}" } }
+)EOF");
+  Nighthawk::RequestGenerator generator = plugin->get();
+  Nighthawk::RequestPtr request1 = generator();
+  Nighthawk::RequestPtr request2 = generator();
+  ASSERT_NE(request1, nullptr);
+  ASSERT_NE(request2, nullptr);
+  EXPECT_EQ(generator(), nullptr);
+  // The first response lacks the header to extract, the second request failed altogether.
+  Envoy::Http::TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  request1->responseObserver()->onResponse(true, &response_headers, "");
+  request2->responseObserver()->onResponse(false, nullptr, "");
+  Nighthawk::RequestPtr request3 = generator();
+  Nighthawk::RequestPtr request4 = generator();
+  ASSERT_NE(request3, nullptr);
+  ASSERT_NE(request4, nullptr);
+  EXPECT_EQ(request3->requestClass(), 0);
+  EXPECT_EQ(request4->requestClass(), 0);
+}
+
 } // namespace
 } // namespace Nighthawk
@@ -1,5 +1,7 @@
 #include <chrono>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "nighthawk/common/exception.h"
 #include "nighthawk/common/platform_util.h"
@@ -29,12 +31,12 @@ class FakeSequencerTarget {
 public:
   virtual ~FakeSequencerTarget() = default;
   // A fake method that matches the sequencer target signature.
-  virtual bool callback(OperationCallback) PURE;
+  virtual bool callback(OperationCallback, Envoy::MonotonicTime) PURE;
 };
 
 class MockSequencerTarget : public FakeSequencerTarget {
 public:
-  MOCK_METHOD(bool, callback, (OperationCallback), (override));
+  MOCK_METHOD(bool, callback, (OperationCallback, Envoy::MonotonicTime), (override));
 };
 
 class SequencerTestBase : public testing::Test {
@@ -43,9 +45,10 @@ public:
       : dispatcher_(std::make_unique<Envoy::Event::MockDispatcher>()), frequency_(10_Hz),
         interval_(std::chrono::duration_cast<std::chrono::milliseconds>(frequency_.interval())),
         sequencer_target_(
-            std::bind(&SequencerTestBase::callback_test, this, std::placeholders::_1)) {}
+            std::bind(&SequencerTestBase::callback_test, this, std::placeholders::_1,
+                      std::placeholders::_2)) {}
 
-  bool callback_test(const OperationCallback& f) {
+  bool callback_test(const OperationCallback& f, Envoy::MonotonicTime) {
     callback_test_count_++;
     f(true, true);
     return true;
@@ -163,7 +166,8 @@ private:
 // Basic rate limiter interaction test.
 TEST_F(SequencerTestWithTimerEmulation, RateLimiterInteraction) {
   SequencerTarget callback =
-      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1,
+                std::placeholders::_2);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
                           std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
@@ -175,7 +179,7 @@ TEST_F(SequencerTestWithTimerEmulation, RateLimiterInteraction) {
       .WillOnce(Return(true))
       .WillRepeatedly(Return(false));
   EXPECT_CALL(rate_limiter_unsafe_ref_, elapsed()).Times(2);
-  EXPECT_CALL(*target(), callback(_)).Times(2).WillOnce(Return(true)).WillOnce(Return(true));
+  EXPECT_CALL(*target(), callback(_, _)).Times(2).WillOnce(Return(true)).WillOnce(Return(true));
   expectDispatcherRun();
   EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
   sequencer.start();
@@ -185,7 +189,8 @@ TEST_F(SequencerTestWithTimerEmulation, RateLimiterInteraction) {
 // Saturated rate limiter interaction test.
 TEST_F(SequencerTestWithTimerEmulation, RateLimiterSaturatedTargetInteraction) {
   SequencerTarget callback =
-      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1,
+                std::placeholders::_2);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
                           std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
@@ -198,7 +203,7 @@ TEST_F(SequencerTestWithTimerEmulation, RateLimiterSaturatedTargetInteraction) {
       .WillRepeatedly(Return(false));
   EXPECT_CALL(rate_limiter_unsafe_ref_, elapsed()).Times(2);
 
-  EXPECT_CALL(*target(), callback(_)).Times(2).WillOnce(Return(true)).WillOnce(Return(false));
+  EXPECT_CALL(*target(), callback(_, _)).Times(2).WillOnce(Return(true)).WillOnce(Return(false));
 
   // The sequencer should call RateLimiter::releaseOne() when the target returns false.
   EXPECT_CALL(rate_limiter_unsafe_ref_, releaseOne());
@@ -218,12 +223,14 @@ public:
     expectDispatcherRun();
   }
 
-  bool timeout_test(const std::function<void(bool, bool)>& /* f */) {
+  bool timeout_test(const std::function<void(bool, bool)>& /* f */, Envoy::MonotonicTime) {
     callback_test_count_++;
     // We don't call f(); which will cause the sequencer to think there is in-flight work.
     return true;
   }
-  bool saturated_test(const std::function<void(bool, bool)>& /* f */) { return false; }
+  bool saturated_test(const std::function<void(bool, bool)>& /* f */, Envoy::MonotonicTime) {
+    return false;
+  }
 
   std::unique_ptr<LinearRateLimiter> rate_limiter_;
 
@@ -267,7 +274,8 @@ TEST_F(SequencerIntegrationTest, IdleStrategySleep) {
 // not being able to start any requests, for example due to misconfiguration or system conditions.
 TEST_F(SequencerIntegrationTest, AlwaysSaturatedTargetTest) {
   SequencerTarget callback =
-      std::bind(&SequencerIntegrationTest::saturated_test, this, std::placeholders::_1);
+      std::bind(&SequencerIntegrationTest::saturated_test, this, std::placeholders::_1,
+                std::placeholders::_2);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
                           std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
@@ -280,12 +288,48 @@ TEST_F(SequencerIntegrationTest, AlwaysSaturatedTargetTest) {
   EXPECT_EQ(1, sequencer.blockedStatistic().count());
 }
 
+// An operation which the target refused is due since the first refusal, rather than since the
+// target accepted it.
+TEST_F(SequencerIntegrationTest, PassesTheTimeARefusedOperationWasDue) {
+  std::vector<Envoy::MonotonicTime> refusals;
+  // The times each started operation was due, and was started.
+  std::vector<std::pair<Envoy::MonotonicTime, Envoy::MonotonicTime>> starts;
+  SequencerTarget callback = [this, &refusals, &starts](const OperationCallback& f,
+                                                        Envoy::MonotonicTime due) {
+    const Envoy::MonotonicTime now = time_system_.monotonicTime();
+    if (refusals.size() < 3) {
+      refusals.push_back(now);
+      return false;
+    }
+    starts.emplace_back(due, now);
+    f(true, true);
+    return true;
+  };
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
+                          std::move(termination_predicate_), store_);
+  EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
+  sequencer.start();
+  sequencer.waitForCompletion();
+
+  ASSERT_EQ(3, refusals.size());
+  ASSERT_EQ(test_number_of_intervals_, starts.size());
+  EXPECT_EQ(refusals[0], starts[0].first);
+  EXPECT_LT(starts[0].first, starts[0].second);
+  for (size_t i = 1; i < starts.size(); i++) {
+    EXPECT_EQ(starts[i].first, starts[i].second);
+  }
+  EXPECT_EQ(1, sequencer.blockedStatistic().count());
+}
+
 // (SequencerIntegrationTest::timeout_test()) will never call back, effectively simulated a
 // stalled benchmark client. Implicitly we test that we get past sequencer.waitForCompletion()
 // timely, and don't hang.
 TEST_F(SequencerIntegrationTest, CallbacksDoNotInfluenceTestDuration) {
   SequencerTarget callback =
-      std::bind(&SequencerIntegrationTest::timeout_test, this, std::placeholders::_1);
+      std::bind(&SequencerIntegrationTest::timeout_test, this, std::placeholders::_1,
+                std::placeholders::_2);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
                           std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
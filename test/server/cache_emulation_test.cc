@@ -0,0 +1,102 @@
+#include <set>
+
+#include "external/envoy/test/test_common/utility.h"
+
+#include "api/server/response_options.pb.h"
+
+#include "source/server/cache_emulation.h"
+
+#include "absl/strings/str_cat.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Server {
+namespace {
+
+using ::Envoy::Http::TestRequestHeaderMapImpl;
+using ::Envoy::Http::TestResponseHeaderMapImpl;
+
+nighthawk::server::CacheEmulation makeConfig() {
+  nighthawk::server::CacheEmulation config;
+  config.mutable_body_size()->mutable_uniform()->set_min(100);
+  config.mutable_body_size()->mutable_uniform()->set_max(10000);
+  config.mutable_max_age_seconds()->mutable_uniform()->set_min(60);
+  config.mutable_max_age_seconds()->mutable_uniform()->set_max(3600);
+  return config;
+}
+
+TEST(CacheEmulationTest, LookupIsDeterministicPerPath) {
+  const CacheEmulation cache_emulation(makeConfig());
+  const CacheEmulation::Content first = cache_emulation.lookup("/object/1");
+  const CacheEmulation::Content again = CacheEmulation(makeConfig()).lookup("/object/1");
+  EXPECT_EQ(first.body_size, again.body_size);
+  EXPECT_EQ(first.max_age_seconds, again.max_age_seconds);
+  EXPECT_EQ(first.etag, again.etag);
+  EXPECT_EQ(first.last_modified, again.last_modified);
+  EXPECT_NE(first.etag, cache_emulation.lookup("/object/2").etag);
+}
+
+TEST(CacheEmulationTest, LookupDrawsFromTheConfiguredDistributions) {
+  const CacheEmulation cache_emulation(makeConfig());
+  std::set<uint64_t> body_sizes;
+  for (int i = 0; i < 100; i++) {
+    const CacheEmulation::Content content = cache_emulation.lookup(absl::StrCat("/object/", i));
+    EXPECT_GE(content.body_size, 100);
+    EXPECT_LE(content.body_size, 10000);
+    EXPECT_GE(content.max_age_seconds, 60);
+    EXPECT_LE(content.max_age_seconds, 3600);
+    EXPECT_EQ(content.etag.size(), 18);
+    body_sizes.insert(content.body_size);
+  }
+  EXPECT_GT(body_sizes.size(), 90);
+}
+
+// The content which the conditional request tests request.
+CacheEmulation::Content testContent() {
+  return {10, 300, "\"abc\"", absl::FromUnixSeconds(1000)};
+}
+
+bool isNotModified(const TestRequestHeaderMapImpl& request_headers) {
+  return CacheEmulation::isNotModified(request_headers, testContent());
+}
+
+TEST(CacheEmulationTest, AddsCacheHeaders) {
+  TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  CacheEmulation::addResponseHeaders(response_headers, testContent());
+  EXPECT_TRUE(Envoy::TestUtility::headerMapEqualIgnoreOrder(
+      response_headers,
+      TestResponseHeaderMapImpl{{":status", "200"},
+                                {"etag", "\"abc\""},
+                                {"last-modified", "Thu, 01 Jan 1970 00:16:40 GMT"},
+                                {"cache-control", "public, max-age=300"}}));
+}
+
+TEST(CacheEmulationTest, MatchesIfNoneMatch) {
+  EXPECT_FALSE(isNotModified(TestRequestHeaderMapImpl{}));
+  EXPECT_TRUE(isNotModified(TestRequestHeaderMapImpl{{"if-none-match", "\"abc\""}}));
+  EXPECT_TRUE(isNotModified(TestRequestHeaderMapImpl{{"if-none-match", "W/\"abc\""}}));
+  EXPECT_TRUE(isNotModified(TestRequestHeaderMapImpl{{"if-none-match", "\"xyz\", \"abc\""}}));
+  EXPECT_TRUE(isNotModified(TestRequestHeaderMapImpl{{"if-none-match", "*"}}));
+  EXPECT_FALSE(isNotModified(TestRequestHeaderMapImpl{{"if-none-match", "\"xyz\""}}));
+}
+
+TEST(CacheEmulationTest, MatchesIfModifiedSince) {
+  const std::string last_modified = CacheEmulation::formatHttpDate(testContent().last_modified);
+  const std::string earlier = CacheEmulation::formatHttpDate(absl::FromUnixSeconds(999));
+  const std::string later = CacheEmulation::formatHttpDate(absl::FromUnixSeconds(2000));
+  EXPECT_TRUE(isNotModified(TestRequestHeaderMapImpl{{"if-modified-since", last_modified}}));
+  EXPECT_TRUE(isNotModified(TestRequestHeaderMapImpl{{"if-modified-since", later}}));
+  EXPECT_FALSE(isNotModified(TestRequestHeaderMapImpl{{"if-modified-since", earlier}}));
+  EXPECT_FALSE(isNotModified(TestRequestHeaderMapImpl{{"if-modified-since", "yesterday"}}));
+}
+
+TEST(CacheEmulationTest, IfNoneMatchTakesPrecedenceOverIfModifiedSince) {
+  const std::string later = CacheEmulation::formatHttpDate(absl::FromUnixSeconds(2000));
+  EXPECT_FALSE(isNotModified(
+      TestRequestHeaderMapImpl{{"if-none-match", "\"xyz\""}, {"if-modified-since", later}}));
+}
+
+} // namespace
+} // namespace Server
+} // namespace Nighthawk
@@ -1,6 +1,7 @@
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/core/v3/base.pb.h"
 
+#include "external/envoy/test/test_common/environment.h"
 #include "external/envoy/test/test_common/utility.h"
 
 #include "api/server/response_options.pb.validate.h"
@@ -229,6 +230,209 @@ TEST(ValidateResponseOptions, ThrowsWhenBothEnvoyApiV2AndV3ResponseHeadersAreSet
   EXPECT_THROW(validateResponseOptions(configuration), Envoy::EnvoyException);
 }
 
+TEST(ValidateResponseOptions, DoesNotThrowOnValidCacheEmulation) {
+  nighthawk::server::ResponseOptions configuration;
+  nighthawk::server::CacheEmulation* cache_emulation = configuration.mutable_cache_emulation();
+  cache_emulation->mutable_body_size()->set_constant(4194304);
+  cache_emulation->mutable_max_age_seconds()->mutable_uniform()->set_max(60);
+  EXPECT_NO_THROW(validateResponseOptions(configuration));
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenCacheEmulationBodySizeIsTooLarge) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.mutable_cache_emulation()->mutable_body_size()->mutable_uniform()->set_max(4194305);
+  configuration.mutable_cache_emulation()->mutable_max_age_seconds()->set_constant(60);
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "body_size distribution: values may not exceed 4194304");
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenUniformMinExceedsMax) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.mutable_cache_emulation()->mutable_body_size()->set_constant(10);
+  nighthawk::server::Distribution::Uniform* max_age =
+      configuration.mutable_cache_emulation()->mutable_max_age_seconds()->mutable_uniform();
+  max_age->set_min(2);
+  max_age->set_max(1);
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "max_age_seconds distribution: min 2 exceeds max 1");
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenCpuWorkIsTooLarge) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.mutable_cpu_work_microseconds()->set_constant(10000001);
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "cpu_work_microseconds distribution: values may not exceed 10000000");
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenServiceTimeIsTooLong) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.mutable_queueing_server()->set_slots(1);
+  configuration.mutable_queueing_server()->mutable_service_time_microseconds()->set_constant(
+      60000001);
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "service_time_microseconds distribution: values may not exceed 60000000");
+}
+
+TEST(MergeJsonConfig, FailsOnQueueingServerWithoutSlots) {
+  nighthawk::server::ResponseOptions configuration;
+  std::string error_message;
+  EXPECT_FALSE(mergeJsonConfig(
+      R"({queueing_server: {slots: 0, service_time_microseconds: {constant: 1}}})", configuration,
+      error_message));
+  EXPECT_THAT(error_message, testing::HasSubstr("slots"));
+}
+
+TEST(ApplyPathProfile, MergesTheProfileIntoTheOptions) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.set_response_body_size(10);
+  configuration.set_echo_request_headers(true);
+  nighthawk::server::PathProfile* path_profile = configuration.add_path_profiles();
+  path_profile->set_prefix("/large");
+  path_profile->mutable_response_options()->set_response_body_size(1000);
+  const nighthawk::server::ResponseOptions profile_configuration =
+      applyPathProfile(configuration, *path_profile);
+  EXPECT_EQ(profile_configuration.response_body_size(), 1000);
+  EXPECT_TRUE(profile_configuration.echo_request_headers());
+  EXPECT_EQ(profile_configuration.path_profiles_size(), 0);
+}
+
+TEST(ValidateResponseOptions, ThrowsOnNestedPathProfiles) {
+  nighthawk::server::ResponseOptions configuration;
+  nighthawk::server::PathProfile* path_profile = configuration.add_path_profiles();
+  path_profile->set_prefix("/a");
+  path_profile->mutable_response_options()->add_path_profiles()->set_prefix("/a/b");
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "path profiles may not have path profiles of their own");
+}
+
+TEST(ValidateResponseOptions, ThrowsOnDuplicatePathProfiles) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.add_path_profiles()->set_path("/a");
+  configuration.add_path_profiles()->set_prefix("/a");
+  EXPECT_NO_THROW(validateResponseOptions(configuration));
+  configuration.add_path_profiles()->set_prefix("/a");
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "duplicate path profile for '/a'");
+}
+
+TEST(ValidateResponseOptions, ValidatesPathProfilesMergedIntoTheOptions) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.add_response_headers();
+  nighthawk::server::PathProfile* path_profile = configuration.add_path_profiles();
+  path_profile->set_prefix("/");
+  path_profile->mutable_response_options()->add_v3_response_headers();
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "cannot specify both response_headers and v3_response_headers");
+}
+
+TEST(MergeJsonConfig, FailsOnPathProfiles) {
+  nighthawk::server::ResponseOptions configuration;
+  std::string error_message;
+  EXPECT_FALSE(mergeJsonConfig(
+      R"({path_profiles: [{prefix: "/", response_options: {response_body_size: 1}}]})",
+      configuration, error_message));
+  EXPECT_THAT(error_message,
+              testing::HasSubstr("path_profiles can only be set in static configuration"));
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenResponseBodySizeDistributionIsTooLarge) {
+  nighthawk::server::ResponseOptions configuration;
+  configuration.mutable_response_body_size_distribution()->mutable_uniform()->set_max(4194305);
+  EXPECT_THROW_WITH_REGEX(
+      validateResponseOptions(configuration), Envoy::EnvoyException,
+      "response_body_size_distribution distribution: values may not exceed 4194304");
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenHistogramBucketMinExceedsMax) {
+  nighthawk::server::ResponseOptions configuration;
+  nighthawk::server::Distribution::Histogram::Bucket* bucket =
+      configuration.mutable_response_body_size_distribution()->mutable_histogram()->add_buckets();
+  bucket->set_min(2);
+  bucket->set_max(1);
+  bucket->set_weight(1);
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "bucket min 2 exceeds max 1");
+}
+
+TEST(ValidateResponseOptions, ThrowsWhenHistogramWeightsOverflow) {
+  nighthawk::server::ResponseOptions configuration;
+  nighthawk::server::Distribution::Histogram* histogram =
+      configuration.mutable_response_body_size_distribution()->mutable_histogram();
+  histogram->add_buckets()->set_weight(UINT64_MAX);
+  histogram->add_buckets()->set_weight(1);
+  EXPECT_THROW_WITH_REGEX(validateResponseOptions(configuration), Envoy::EnvoyException,
+                          "the bucket weights add up to more than");
+}
+
+TEST(LoadHistogramFile, ReadsBuckets) {
+  const std::string path = Envoy::TestEnvironment::temporaryPath("histogram");
+  Envoy::TestEnvironment::writeStringToFileForTest(path,
+                                                   "# sizes\n"
+                                                   "100 200 3\n"
+                                                   "\n"
+                                                   "  1000\t5  \n",
+                                                   true);
+  const nighthawk::server::Distribution::Histogram histogram = loadHistogramFile(path);
+  ASSERT_EQ(histogram.buckets_size(), 2);
+  EXPECT_EQ(histogram.buckets(0).min(), 100);
+  EXPECT_EQ(histogram.buckets(0).max(), 200);
+  EXPECT_EQ(histogram.buckets(0).weight(), 3);
+  EXPECT_EQ(histogram.buckets(1).min(), 1000);
+  EXPECT_EQ(histogram.buckets(1).max(), 1000);
+  EXPECT_EQ(histogram.buckets(1).weight(), 5);
+}
+
+TEST(LoadHistogramFile, ThrowsOnBadFiles) {
+  EXPECT_THROW_WITH_REGEX(loadHistogramFile("/does/not/exist"), Envoy::EnvoyException,
+                          "unable to open histogram file");
+  const std::string path = Envoy::TestEnvironment::temporaryPath("bad_histogram");
+  Envoy::TestEnvironment::writeStringToFileForTest(path, "1 2 3 4\n", true);
+  EXPECT_THROW_WITH_REGEX(loadHistogramFile(path), Envoy::EnvoyException, "line 1");
+  Envoy::TestEnvironment::writeStringToFileForTest(path, "1 0\n", true);
+  EXPECT_THROW_WITH_REGEX(loadHistogramFile(path), Envoy::EnvoyException, "positive weight");
+  Envoy::TestEnvironment::writeStringToFileForTest(path, "# nothing\n", true);
+  EXPECT_THROW_WITH_REGEX(loadHistogramFile(path), Envoy::EnvoyException, "has no buckets");
+}
+
+TEST(ReadHistogramFiles, ReplacesFilesByHistograms) {
+  const std::string path = Envoy::TestEnvironment::temporaryPath("profile_histogram");
+  Envoy::TestEnvironment::writeStringToFileForTest(path, "10 1\n", true);
+  nighthawk::server::ResponseOptions configuration;
+  configuration.mutable_response_body_size_distribution()->set_histogram_file(path);
+  nighthawk::server::PathProfile* path_profile = configuration.add_path_profiles();
+  path_profile->set_prefix("/");
+  path_profile->mutable_response_options()->mutable_cpu_work_microseconds()->set_histogram_file(
+      path);
+  EXPECT_NO_THROW(validateResponseOptions(configuration));
+  readHistogramFiles(configuration);
+  EXPECT_EQ(configuration.response_body_size_distribution().histogram().buckets(0).min(), 10);
+  EXPECT_EQ(configuration.path_profiles(0)
+                .response_options()
+                .cpu_work_microseconds()
+                .histogram()
+                .buckets(0)
+                .min(),
+            10);
+}
+
+TEST(MergeJsonConfig, FailsOnHistogramFiles) {
+  nighthawk::server::ResponseOptions configuration;
+  std::string error_message;
+  EXPECT_FALSE(mergeJsonConfig(R"({response_body_size_distribution: {histogram_file: "/x"}})",
+                               configuration, error_message));
+  EXPECT_THAT(error_message,
+              testing::HasSubstr("histogram files can only be named in static configuration"));
+}
+
+TEST(MergeJsonConfig, FailsOnInvalidCacheEmulation) {
+  nighthawk::server::ResponseOptions configuration;
+  std::string error_message;
+  EXPECT_FALSE(mergeJsonConfig(
+      R"({cache_emulation: {body_size: {constant: 5000000}, max_age_seconds: {constant: 1}}})",
+      configuration, error_message));
+  EXPECT_THAT(error_message, testing::HasSubstr("values may not exceed 4194304"));
+}
+
 } // namespace
 } // namespace Configuration
 } // namespace Server
@@ -0,0 +1,31 @@
+#include <chrono>
+
+#include "source/server/cpu_work.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+namespace Nighthawk {
+namespace Server {
+namespace {
+
+TEST(CpuWorkTest, CalibratesToAPositiveSpeed) {
+  EXPECT_GT(CpuWork::get().iterationsPerMicrosecond(), 0);
+}
+
+TEST(CpuWorkTest, BurnsAboutTheRequestedCpuTime) {
+  const std::chrono::nanoseconds start = CpuWork::threadCpuTime();
+  const std::chrono::nanoseconds spent = CpuWork::get().burn(10ms);
+  EXPECT_GE(CpuWork::threadCpuTime() - start, spent);
+  // Calibration keeps the fastest round, so the work only takes longer than requested when the
+  // thread gets interrupted. A generous upper bound keeps this from flaking on loaded machines.
+  EXPECT_GE(spent, 5ms);
+  EXPECT_LE(spent, 100ms);
+}
+
+TEST(CpuWorkTest, BurnsNothingForNoWork) { EXPECT_LT(CpuWork::get().burn(0us), 1ms); }
+
+} // namespace
+} // namespace Server
+} // namespace Nighthawk
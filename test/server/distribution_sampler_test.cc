@@ -0,0 +1,125 @@
+#include <vector>
+
+#include "api/server/response_options.pb.h"
+
+#include "source/server/distribution_sampler.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Server {
+namespace {
+
+TEST(DistributionSamplerTest, ConstantAlwaysYieldsTheConstant) {
+  nighthawk::server::Distribution distribution;
+  distribution.set_constant(42);
+  const DistributionSampler sampler(distribution);
+  EXPECT_EQ(sampler.min(), 42);
+  EXPECT_EQ(sampler.max(), 42);
+  EXPECT_EQ(sampler.sample(0), 42);
+  EXPECT_EQ(sampler.sample(12345), 42);
+  EXPECT_EQ(sampler.sample(UINT64_MAX), 42);
+}
+
+TEST(DistributionSamplerTest, UniformCoversTheRange) {
+  nighthawk::server::Distribution distribution;
+  distribution.mutable_uniform()->set_min(10);
+  distribution.mutable_uniform()->set_max(19);
+  const DistributionSampler sampler(distribution);
+  EXPECT_EQ(sampler.min(), 10);
+  EXPECT_EQ(sampler.max(), 19);
+  EXPECT_EQ(sampler.sample(0), 10);
+  EXPECT_EQ(sampler.sample(UINT64_MAX), 19);
+  EXPECT_EQ(sampler.sample(UINT64_MAX / 2), 14);
+  std::vector<uint64_t> counts(10, 0);
+  const uint64_t steps = 1000;
+  for (uint64_t i = 0; i < steps; i++) {
+    const uint64_t value = sampler.sample(i * (UINT64_MAX / steps));
+    ASSERT_GE(value, 10);
+    ASSERT_LE(value, 19);
+    counts[value - 10]++;
+  }
+  for (const uint64_t count : counts) {
+    EXPECT_NEAR(count, steps / 10, 1);
+  }
+}
+
+TEST(DistributionSamplerTest, UniformOverAllValuesYieldsTheRandomValue) {
+  nighthawk::server::Distribution distribution;
+  distribution.mutable_uniform()->set_max(UINT64_MAX);
+  const DistributionSampler sampler(distribution);
+  EXPECT_EQ(sampler.sample(0), 0);
+  EXPECT_EQ(sampler.sample(12345), 12345);
+  EXPECT_EQ(sampler.sample(UINT64_MAX), UINT64_MAX);
+}
+
+TEST(DistributionSamplerTest, HistogramPicksBucketsInProportionToTheirWeights) {
+  nighthawk::server::Distribution distribution;
+  nighthawk::server::Distribution::Histogram::Bucket* bucket =
+      distribution.mutable_histogram()->add_buckets();
+  bucket->set_min(10);
+  bucket->set_max(10);
+  bucket->set_weight(3);
+  bucket = distribution.mutable_histogram()->add_buckets();
+  bucket->set_min(1000);
+  bucket->set_max(1999);
+  bucket->set_weight(1);
+  const DistributionSampler sampler(distribution);
+  EXPECT_EQ(sampler.min(), 10);
+  EXPECT_EQ(sampler.max(), 1999);
+  EXPECT_EQ(sampler.sample(0), 10);
+  EXPECT_EQ(sampler.sample(UINT64_MAX), 1999);
+  uint64_t small = 0;
+  const uint64_t steps = 1000;
+  for (uint64_t i = 0; i < steps; i++) {
+    const uint64_t value = sampler.sample(i * (UINT64_MAX / steps));
+    if (value == 10) {
+      small++;
+    } else {
+      ASSERT_GE(value, 1000);
+      ASSERT_LE(value, 1999);
+    }
+  }
+  EXPECT_NEAR(small, steps * 3 / 4, 1);
+}
+
+TEST(DistributionSamplerTest, HistogramNeverPicksBucketsWithoutWeight) {
+  nighthawk::server::Distribution distribution;
+  for (const uint64_t value : {1, 2, 3, 4}) {
+    nighthawk::server::Distribution::Histogram::Bucket* bucket =
+        distribution.mutable_histogram()->add_buckets();
+    bucket->set_min(value);
+    bucket->set_max(value);
+    bucket->set_weight(value % 2);
+  }
+  const DistributionSampler sampler(distribution);
+  EXPECT_EQ(sampler.sample(0), 1);
+  EXPECT_EQ(sampler.sample(UINT64_MAX), 3);
+  const uint64_t steps = 1000;
+  for (uint64_t i = 0; i < steps; i++) {
+    const uint64_t value = sampler.sample(i * (UINT64_MAX / steps));
+    ASSERT_TRUE(value == 1 || value == 3) << value;
+  }
+}
+
+TEST(DistributionSamplerTest, HistogramSpreadsValuesOverTheBucket) {
+  nighthawk::server::Distribution distribution;
+  nighthawk::server::Distribution::Histogram::Bucket* bucket =
+      distribution.mutable_histogram()->add_buckets();
+  bucket->set_min(0);
+  bucket->set_max(9);
+  bucket->set_weight(3);
+  const DistributionSampler sampler(distribution);
+  std::vector<uint64_t> counts(10, 0);
+  const uint64_t steps = 1000;
+  for (uint64_t i = 0; i < steps; i++) {
+    counts[sampler.sample(i * (UINT64_MAX / steps))]++;
+  }
+  for (const uint64_t count : counts) {
+    EXPECT_NEAR(count, steps / 10, 2);
+  }
+}
+
+} // namespace
+} // namespace Server
+} // namespace Nighthawk
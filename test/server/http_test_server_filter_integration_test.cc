@@ -1,3 +1,5 @@
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
+
 #include "api/server/response_options.pb.h"
 #include "api/server/response_options.pb.validate.h"
 
@@ -6,6 +8,9 @@
 
 #include "test/server/http_filter_integration_test_base.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
 #include "gtest/gtest.h"
 
 namespace Nighthawk {
@@ -28,6 +33,22 @@ constexpr absl::string_view kNoConfigProto = R"EOF(
 name: test-server
 )EOF";
 
+constexpr absl::string_view kCacheEmulationProto = R"EOF(
+name: test-server
+typed_config:
+  "@type": type.googleapis.com/nighthawk.server.ResponseOptions
+  cache_emulation:
+    body_size: { uniform: { min: 1, max: 1000 } }
+    max_age_seconds: { constant: 300 }
+)EOF";
+
+// Returns the value of the first response header with the name, or an empty string if absent.
+std::string getResponseHeader(const Envoy::IntegrationStreamDecoder& response,
+                              absl::string_view name) {
+  const auto header = response.headers().get(Envoy::Http::LowerCaseString(std::string(name)));
+  return header.empty() ? "" : std::string(header[0]->value().getStringView());
+}
+
 class HttpTestServerIntegrationTest : public HttpFilterIntegrationTestBase,
                                       public TestWithParam<Envoy::Network::Address::IpVersion> {
 public:
@@ -246,6 +267,161 @@ TEST_P(HttpTestServerIntegrationTest, TestNoStaticConfigHeaderConfig) {
   EXPECT_EQ("", response->body());
 }
 
+TEST_P(HttpTestServerIntegrationTest, CacheEmulationServesTheSameContentPerPath) {
+  initializeFilterConfiguration(kCacheEmulationProto);
+  setRequestHeader(Envoy::Http::LowerCaseString(":path"), "/object/1");
+  Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+  const std::string body = response->body();
+  EXPECT_GE(body.size(), 1);
+  EXPECT_LE(body.size(), 1000);
+  EXPECT_EQ(std::string(body.size(), 'a'), body);
+  EXPECT_EQ("public, max-age=300", getResponseHeader(*response, "cache-control"));
+  EXPECT_NE("", getResponseHeader(*response, "last-modified"));
+  const std::string etag = getResponseHeader(*response, "etag");
+  EXPECT_NE("", etag);
+
+  response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+  EXPECT_EQ(body, response->body());
+  EXPECT_EQ(etag, getResponseHeader(*response, "etag"));
+}
+
+TEST_P(HttpTestServerIntegrationTest, CacheEmulationAnswersMatchingConditionalRequestsWith304) {
+  initializeFilterConfiguration(kCacheEmulationProto);
+  setRequestHeader(Envoy::Http::LowerCaseString(":path"), "/object/1");
+  Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  const std::string etag = getResponseHeader(*response, "etag");
+
+  setRequestHeader(Envoy::Http::LowerCaseString("if-none-match"), etag);
+  response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("304", response->headers().Status()->value().getStringView());
+  EXPECT_EQ("", response->body());
+  EXPECT_EQ(etag, getResponseHeader(*response, "etag"));
+
+  // The entity tag of one path doesn't match the content of another.
+  setRequestHeader(Envoy::Http::LowerCaseString(":path"), "/object/2");
+  response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+}
+
+TEST_P(HttpTestServerIntegrationTest, CacheEmulationViaRequestLevelConfiguration) {
+  initializeFilterConfiguration(kNoConfigProto);
+  setRequestLevelConfiguration(
+      "{cache_emulation: {body_size: {constant: 10}, max_age_seconds: {constant: 1}}}");
+  Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+  EXPECT_EQ(std::string(10, 'a'), response->body());
+  EXPECT_EQ("public, max-age=1", getResponseHeader(*response, "cache-control"));
+}
+
+TEST_P(HttpTestServerIntegrationTest, ReportsTheCpuTimeSpentOnCpuWork) {
+  initializeFilterConfiguration(kNoConfigProto);
+  setRequestLevelConfiguration("{cpu_work_microseconds: {constant: 2000}, response_body_size: 10}");
+  Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+  EXPECT_EQ(std::string(10, 'a'), response->body());
+  uint64_t cpu_time_ns;
+  ASSERT_TRUE(absl::SimpleAtoi(
+      getResponseHeader(*response, "x-nighthawk-test-server-cpu-time-ns"), &cpu_time_ns));
+  // Calibration is a best effort, and the header can't be checked for precision here.
+  EXPECT_GT(cpu_time_ns, 0);
+}
+
+TEST_P(HttpTestServerIntegrationTest, OmitsTheCpuTimeWithoutCpuWork) {
+  initializeFilterConfiguration(kNoConfigProto);
+  Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("", getResponseHeader(*response, "x-nighthawk-test-server-cpu-time-ns"));
+}
+
+TEST_P(HttpTestServerIntegrationTest, QueueingServerRepliesOnceServed) {
+  initializeFilterConfiguration(kNoConfigProto);
+  setRequestLevelConfiguration("{queueing_server: {slots: 1, service_time_microseconds: {constant: "
+                               "1000}}, response_body_size: 10}");
+  // The second request only gets served if the first one freed the slot.
+  for (int i = 0; i < 2; i++) {
+    Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+    ASSERT_TRUE(response->waitForEndStream());
+    ASSERT_TRUE(response->complete());
+    EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+    EXPECT_EQ(std::string(10, 'a'), response->body());
+  }
+}
+
+TEST_P(HttpTestServerIntegrationTest, PathProfilesVaryTheResponseByPath) {
+  initializeFilterConfiguration(R"EOF(
+name: test-server
+typed_config:
+  "@type": type.googleapis.com/nighthawk.server.ResponseOptions
+  response_body_size: 1
+  path_profiles:
+  - prefix: /api/
+    response_options: { response_body_size: 10 }
+  - prefix: /api/large/
+    response_options: { response_body_size: 100 }
+  - path: /api/large/exception
+    response_options: { response_body_size: 20 }
+)EOF");
+  const std::vector<std::pair<std::string, size_t>> expectations = {
+      {"/", 1},
+      {"/api/", 10},
+      {"/api/small", 10},
+      {"/api/large/object", 100},
+      {"/api/large/exception", 20},
+      {"/api/large/exception?query", 20},
+      {"/api/large/exception/more", 100}};
+  for (const auto& expectation : expectations) {
+    SCOPED_TRACE(expectation.first);
+    setRequestHeader(Envoy::Http::LowerCaseString(":path"), expectation.first);
+    Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+    ASSERT_TRUE(response->waitForEndStream());
+    ASSERT_TRUE(response->complete());
+    EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+    EXPECT_EQ(expectation.second, response->body().size());
+  }
+
+  // Request-level configuration is merged into the matching profile.
+  setRequestLevelConfiguration("{echo_request_headers: true}");
+  setRequestHeader(Envoy::Http::LowerCaseString(":path"), "/api/small");
+  Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_THAT(response->body(), HasSubstr(std::string(10, 'a') + "\nRequest Headers:"));
+}
+
+TEST_P(HttpTestServerIntegrationTest, DrawsResponseBodySizesFromTheDistribution) {
+  initializeFilterConfiguration(kNoConfigProto);
+  setRequestLevelConfiguration("{response_body_size: 5, response_body_size_distribution: "
+                               "{histogram: {buckets: [{min: 100, max: 199, weight: 1}, "
+                               "{min: 1000, max: 1000, weight: 1}]}}}");
+  for (int i = 0; i < 10; i++) {
+    Envoy::IntegrationStreamDecoderPtr response = getResponse(ResponseOrigin::EXTENSION);
+    ASSERT_TRUE(response->waitForEndStream());
+    ASSERT_TRUE(response->complete());
+    EXPECT_EQ("200", response->headers().Status()->value().getStringView());
+    const std::string body = response->body();
+    EXPECT_EQ(std::string(body.size(), 'a'), body);
+    EXPECT_TRUE((body.size() >= 100 && body.size() <= 199) || body.size() == 1000) << body.size();
+    EXPECT_EQ(absl::StrCat(body.size()), response->headers().getContentLengthValue());
+  }
+}
+
 // Here we test config-level merging as well as its application at the response-header level.
 TEST(HttpTestServerDecoderFilterTest, HeaderMerge) {
   nighthawk::server::ResponseOptions initial_options;
@@ -254,8 +430,9 @@ TEST(HttpTestServerDecoderFilterTest, HeaderMerge) {
   response_header->mutable_header()->set_value("bar1");
   response_header->mutable_append();
 
+  Envoy::Stats::IsolatedStoreImpl store;
   Server::HttpTestServerDecoderFilterConfigSharedPtr config =
-      std::make_shared<Server::HttpTestServerDecoderFilterConfig>(initial_options);
+      std::make_shared<Server::HttpTestServerDecoderFilterConfig>(initial_options, store, "");
   Server::HttpTestServerDecoderFilter f(config);
 
   Envoy::Http::TestRequestHeaderMapImpl request_headers{
@@ -0,0 +1,117 @@
+#include <vector>
+
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
+#include "external/envoy/test/mocks/event/mocks.h"
+
+#include "source/server/service_queue.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Server {
+namespace {
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::SaveArg;
+
+class ServiceQueueTest : public testing::Test {
+protected:
+  // Makes a waiter which records its number in granted_ when it gets a slot.
+  ServiceQueue::WaiterSharedPtr makeWaiter(int number) {
+    return std::make_shared<ServiceQueue::Waiter>(dispatcher_,
+                                                  [this, number]() { granted_.push_back(number); });
+  }
+
+  // Frees a slot, and returns the callback which hands it to the next waiter.
+  Envoy::Event::PostCb releaseAndCapturePost(ServiceQueue& queue) {
+    Envoy::Event::PostCb callback;
+    EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&callback));
+    queue.release();
+    return callback;
+  }
+
+  Envoy::Stats::IsolatedStoreImpl store_;
+  QueueingServerStats stats_{ALL_QUEUEING_SERVER_STATS(
+      POOL_COUNTER(store_), POOL_GAUGE(store_), POOL_HISTOGRAM(store_))};
+  NiceMock<Envoy::Event::MockDispatcher> dispatcher_;
+  std::vector<int> granted_;
+};
+
+TEST_F(ServiceQueueTest, GrantsFreeSlotsThenQueuesThenRejects) {
+  auto queue = std::make_shared<ServiceQueue>(2, 1, stats_);
+  EXPECT_EQ(queue->acquire(makeWaiter(1)), ServiceQueue::Admission::Granted);
+  EXPECT_EQ(queue->acquire(makeWaiter(2)), ServiceQueue::Admission::Granted);
+  EXPECT_EQ(queue->acquire(makeWaiter(3)), ServiceQueue::Admission::Queued);
+  EXPECT_EQ(queue->acquire(makeWaiter(4)), ServiceQueue::Admission::Rejected);
+  EXPECT_EQ(stats_.busy_slots_.value(), 2);
+  EXPECT_EQ(stats_.queue_depth_.value(), 1);
+  EXPECT_EQ(stats_.rq_queued_.value(), 1);
+  EXPECT_EQ(stats_.rq_rejected_.value(), 1);
+  EXPECT_TRUE(granted_.empty());
+}
+
+TEST_F(ServiceQueueTest, WithoutAQueueRejectsWhenAllSlotsAreBusy) {
+  auto queue = std::make_shared<ServiceQueue>(1, 0, stats_);
+  EXPECT_EQ(queue->acquire(makeWaiter(1)), ServiceQueue::Admission::Granted);
+  EXPECT_EQ(queue->acquire(makeWaiter(2)), ServiceQueue::Admission::Rejected);
+}
+
+TEST_F(ServiceQueueTest, ReleaseHandsTheSlotToWaitersInArrivalOrder) {
+  auto queue = std::make_shared<ServiceQueue>(1, 2, stats_);
+  EXPECT_EQ(queue->acquire(makeWaiter(1)), ServiceQueue::Admission::Granted);
+  EXPECT_EQ(queue->acquire(makeWaiter(2)), ServiceQueue::Admission::Queued);
+  EXPECT_EQ(queue->acquire(makeWaiter(3)), ServiceQueue::Admission::Queued);
+
+  Envoy::Event::PostCb handoff = releaseAndCapturePost(*queue);
+  // The slot stays busy during the handoff.
+  EXPECT_EQ(queue->acquire(makeWaiter(4)), ServiceQueue::Admission::Queued);
+  EXPECT_EQ(stats_.busy_slots_.value(), 1);
+  handoff();
+  EXPECT_EQ(granted_, std::vector<int>({2}));
+
+  releaseAndCapturePost(*queue)();
+  releaseAndCapturePost(*queue)();
+  EXPECT_EQ(granted_, std::vector<int>({2, 3, 4}));
+  EXPECT_EQ(stats_.queue_depth_.value(), 0);
+
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  queue->release();
+  EXPECT_EQ(stats_.busy_slots_.value(), 0);
+}
+
+TEST_F(ServiceQueueTest, CancelledWaitersLeaveTheQueue) {
+  auto queue = std::make_shared<ServiceQueue>(1, 1, stats_);
+  EXPECT_EQ(queue->acquire(makeWaiter(1)), ServiceQueue::Admission::Granted);
+  ServiceQueue::WaiterSharedPtr waiter = makeWaiter(2);
+  EXPECT_EQ(queue->acquire(waiter), ServiceQueue::Admission::Queued);
+  queue->cancel(waiter);
+  EXPECT_EQ(stats_.queue_depth_.value(), 0);
+  // The queue has room again.
+  EXPECT_EQ(queue->acquire(makeWaiter(3)), ServiceQueue::Admission::Queued);
+  releaseAndCapturePost(*queue)();
+  EXPECT_EQ(granted_, std::vector<int>({3}));
+}
+
+TEST_F(ServiceQueueTest, SlotsHandedToCancelledWaitersArePassedOn) {
+  auto queue = std::make_shared<ServiceQueue>(1, 2, stats_);
+  EXPECT_EQ(queue->acquire(makeWaiter(1)), ServiceQueue::Admission::Granted);
+  ServiceQueue::WaiterSharedPtr waiter = makeWaiter(2);
+  EXPECT_EQ(queue->acquire(waiter), ServiceQueue::Admission::Queued);
+  EXPECT_EQ(queue->acquire(makeWaiter(3)), ServiceQueue::Admission::Queued);
+
+  Envoy::Event::PostCb handoff = releaseAndCapturePost(*queue);
+  queue->cancel(waiter);
+  Envoy::Event::PostCb next_handoff;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&next_handoff));
+  handoff();
+  EXPECT_TRUE(granted_.empty());
+  next_handoff();
+  EXPECT_EQ(granted_, std::vector<int>({3}));
+  EXPECT_EQ(stats_.busy_slots_.value(), 1);
+}
+
+} // namespace
+} // namespace Server
+} // namespace Nighthawk
@@ -0,0 +1,94 @@
+#include <google/protobuf/util/time_util.h>
+
+#include <vector>
+
+#include "source/client/slowest_request_tracker.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+nighthawk::client::SlowRequest requestWithPath(absl::string_view path) {
+  nighthawk::client::SlowRequest request;
+  request.set_path(std::string(path));
+  return request;
+}
+
+int64_t latencyNs(const nighthawk::client::SlowRequest& request) {
+  return google::protobuf::util::TimeUtil::DurationToNanoseconds(request.latency());
+}
+
+TEST(SlowestRequestTrackerTest, RetainsTheSlowestRequests) {
+  SlowestRequestTracker tracker(3, 2, {});
+  for (const uint64_t latency_ns : {50, 10, 70, 30, 90, 20, 60}) {
+    if (tracker.qualifies(latency_ns)) {
+      tracker.add(latency_ns, requestWithPath(absl::StrCat("/", latency_ns)));
+    }
+  }
+  const std::vector<nighthawk::client::SlowRequest> slowest = tracker.slowestRequests();
+  ASSERT_EQ(3, slowest.size());
+  EXPECT_EQ(90, latencyNs(slowest[0]));
+  EXPECT_EQ("/90", slowest[0].path());
+  EXPECT_EQ(70, latencyNs(slowest[1]));
+  EXPECT_EQ(60, latencyNs(slowest[2]));
+  EXPECT_EQ(2, slowest[0].worker());
+}
+
+TEST(SlowestRequestTrackerTest, OnlyQualifiesRequestsSlowerThanTheThreshold) {
+  SlowestRequestTracker tracker(2, 0, {});
+  EXPECT_TRUE(tracker.qualifies(0));
+  tracker.add(20, requestWithPath("/a"));
+  tracker.add(40, requestWithPath("/b"));
+  // The fastest retained request is the threshold.
+  EXPECT_FALSE(tracker.qualifies(10));
+  EXPECT_FALSE(tracker.qualifies(20));
+  EXPECT_TRUE(tracker.qualifies(21));
+  // Requests that don't qualify are ignored.
+  tracker.add(5, requestWithPath("/c"));
+  EXPECT_EQ(2, tracker.slowestRequests().size());
+  EXPECT_EQ(20, latencyNs(tracker.slowestRequests()[1]));
+}
+
+TEST(SlowestRequestTrackerTest, ZeroCapacityQualifiesNothing) {
+  SlowestRequestTracker tracker(0, 0, {});
+  EXPECT_FALSE(tracker.qualifies(1000));
+  tracker.add(1000, requestWithPath("/"));
+  EXPECT_TRUE(tracker.slowestRequests().empty());
+}
+
+TEST(SlowestRequestTrackerTest, HeaderNamesAreLowerCased) {
+  SlowestRequestTracker tracker(1, 0, {"X-Request-Id", "server"});
+  ASSERT_EQ(2, tracker.headerNames().size());
+  EXPECT_EQ("x-request-id", tracker.headerNames()[0].get());
+  EXPECT_EQ("server", tracker.headerNames()[1].get());
+}
+
+TEST(SlowestRequestTrackerTest, MergeKeepsTheSlowestAcrossWorkers) {
+  SlowestRequestTracker worker_0(2, 0, {});
+  SlowestRequestTracker worker_1(2, 1, {});
+  worker_0.add(10, requestWithPath("/"));
+  worker_0.add(40, requestWithPath("/"));
+  worker_1.add(30, requestWithPath("/"));
+  worker_1.add(20, requestWithPath("/"));
+  std::vector<nighthawk::client::SlowRequest> requests = worker_0.slowestRequests();
+  for (nighthawk::client::SlowRequest& request : worker_1.slowestRequests()) {
+    requests.push_back(std::move(request));
+  }
+  const std::vector<nighthawk::client::SlowRequest> merged =
+      SlowestRequestTracker::merge(std::move(requests), 3);
+  ASSERT_EQ(3, merged.size());
+  EXPECT_EQ(40, latencyNs(merged[0]));
+  EXPECT_EQ(0, merged[0].worker());
+  EXPECT_EQ(30, latencyNs(merged[1]));
+  EXPECT_EQ(1, merged[1].worker());
+  EXPECT_EQ(20, latencyNs(merged[2]));
+  // Merging fewer requests than the capacity retains all of them.
+  EXPECT_EQ(3, SlowestRequestTracker::merge(merged, 5).size());
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,110 @@
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "external/envoy/source/common/buffer/buffer_impl.h"
+#include "external/envoy/source/common/network/io_socket_handle_impl.h"
+#include "external/envoy/test/mocks/network/mocks.h"
+
+#include "source/client/socket_timestamping_transport_socket.h"
+
+#include "gtest/gtest.h"
+
+using namespace testing;
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+// Sets up a connected pair of loopback TCP sockets. The client side is handed to the transport
+// socket under test, the server side is driven directly.
+class SocketTimestampingTransportSocketTest : public Test {
+public:
+  SocketTimestampingTransportSocketTest() {
+    listener_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_length = sizeof(address);
+    EXPECT_EQ(0, bind(listener_fd_, reinterpret_cast<sockaddr*>(&address), address_length));
+    EXPECT_EQ(0, listen(listener_fd_, 1));
+    EXPECT_EQ(0,
+              getsockname(listener_fd_, reinterpret_cast<sockaddr*>(&address), &address_length));
+    const int client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_EQ(0, connect(client_fd, reinterpret_cast<sockaddr*>(&address), address_length));
+    server_fd_ = accept(listener_fd_, nullptr, nullptr);
+    io_handle_ = std::make_unique<Envoy::Network::IoSocketHandleImpl>(client_fd);
+    ON_CALL(callbacks_, ioHandle()).WillByDefault(ReturnRef(*io_handle_));
+  }
+
+  ~SocketTimestampingTransportSocketTest() override {
+    close(server_fd_);
+    close(listener_fd_);
+  }
+
+  // Echoes what the client sent, and waits until the echo can be read by the client.
+  void echo() {
+    char data[1024];
+    const ssize_t length = read(server_fd_, data, sizeof(data));
+    ASSERT_GT(length, 0);
+    ASSERT_EQ(length, write(server_fd_, data, length));
+    pollfd client_poll{io_handle_->fdDoNotUse(), POLLIN, 0};
+    ASSERT_EQ(1, poll(&client_poll, 1, 5000));
+  }
+
+  int listener_fd_{-1};
+  int server_fd_{-1};
+  std::unique_ptr<Envoy::Network::IoSocketHandleImpl> io_handle_;
+  NiceMock<Envoy::Network::MockTransportSocketCallbacks> callbacks_;
+};
+
+TEST_F(SocketTimestampingTransportSocketTest, ReportsWireTimestampsPerExchange) {
+  SocketTimestampingTransportSocket transport_socket;
+  transport_socket.setTransportSocketCallbacks(callbacks_);
+  transport_socket.onConnected();
+  const std::string request = "GET / HTTP/1.1\r\nhost: foo\r\n\r\n";
+  for (int i = 0; i < 3; i++) {
+    Envoy::Buffer::OwnedImpl request_buffer(request);
+    EXPECT_EQ(request.size(), transport_socket.doWrite(request_buffer, false).bytes_processed_);
+    echo();
+    Envoy::Buffer::OwnedImpl response_buffer;
+    const Envoy::Network::IoResult result = transport_socket.doRead(response_buffer);
+    EXPECT_EQ(Envoy::Network::PostIoAction::KeepOpen, result.action_);
+    EXPECT_EQ(request.size(), result.bytes_processed_);
+    EXPECT_EQ(request, response_buffer.toString());
+    const absl::optional<WireTimestamps>& exchange = transport_socket.currentExchange();
+    ASSERT_TRUE(exchange.has_value());
+    EXPECT_GE(exchange->wireLatency().count(), 0);
+    // The stream decoders of the connection see the same timestamps.
+    const Envoy::StreamInfo::FilterState& filter_state =
+        *callbacks_.connection_.stream_info_.filterState();
+    const auto* published =
+        filter_state.getDataReadOnly<ConnectionWireTimestamps>(ConnectionWireTimestamps::key());
+    ASSERT_NE(nullptr, published);
+    ASSERT_TRUE(published->currentExchange().has_value());
+    EXPECT_EQ(exchange->wireLatency(), published->currentExchange()->wireLatency());
+  }
+}
+
+TEST_F(SocketTimestampingTransportSocketTest, ReportsEndOfStream) {
+  SocketTimestampingTransportSocket transport_socket;
+  transport_socket.setTransportSocketCallbacks(callbacks_);
+  transport_socket.onConnected();
+  shutdown(server_fd_, SHUT_WR);
+  pollfd client_poll{io_handle_->fdDoNotUse(), POLLIN, 0};
+  ASSERT_EQ(1, poll(&client_poll, 1, 5000));
+  Envoy::Buffer::OwnedImpl buffer;
+  const Envoy::Network::IoResult result = transport_socket.doRead(buffer);
+  EXPECT_TRUE(result.end_stream_read_);
+  EXPECT_EQ(0, result.bytes_processed_);
+  // Nothing was exchanged, so there are no timestamps to report.
+  EXPECT_FALSE(transport_socket.currentExchange().has_value());
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+
+#include "nighthawk/common/exception.h"
+
+#include "external/envoy/test/test_common/utility.h"
+
+#include "source/client/source_address_utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using namespace testing;
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+TEST(SourceAddressUtilityTest, ExpandsAddressesAndRanges) {
+  EXPECT_THAT(SourceAddressUtility::expandSourceAddresses({"10.0.0.9", "192.168.1.5/30"}),
+              ElementsAre("10.0.0.9", "192.168.1.4", "192.168.1.5", "192.168.1.6", "192.168.1.7"));
+  EXPECT_THAT(SourceAddressUtility::expandSourceAddresses({"10.0.0.255/31", "10.0.1.0/32"}),
+              ElementsAre("10.0.0.254", "10.0.0.255", "10.0.1.0"));
+  EXPECT_THAT(SourceAddressUtility::expandSourceAddresses({"fd00::ff/127", "::1"}),
+              ElementsAre("fd00::fe", "fd00::ff", "::1"));
+  EXPECT_TRUE(SourceAddressUtility::expandSourceAddresses({}).empty());
+  EXPECT_EQ(SourceAddressUtility::MaxSourceAddresses,
+            SourceAddressUtility::expandSourceAddresses({"10.1.0.0/16"}).size());
+}
+
+TEST(SourceAddressUtilityTest, RejectsBadSpecifications) {
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"foo"}), NighthawkException,
+                          "Invalid source address 'foo'");
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"10.0.0.0/x"}),
+                          NighthawkException, "Invalid prefix length");
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"fd00::/129"}),
+                          NighthawkException, "Invalid prefix length");
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"::1", "10.0.0.1"}),
+                          NighthawkException, "same address family");
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"10.0.0.0/30", "10.0.0.2"}),
+                          NighthawkException, "'10.0.0.2' is specified more than once");
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"10.1.0.0/16", "10.2.0.1"}),
+                          NighthawkException, "more than the supported maximum");
+  EXPECT_THROW_WITH_REGEX(SourceAddressUtility::expandSourceAddresses({"fd00::/64"}),
+                          NighthawkException, "more than the supported maximum");
+}
+
+TEST(SourceAddressUtilityTest, PartitionsAddressesOverWorkers) {
+  const std::vector<std::string> addresses{"a", "b", "c", "d", "e"};
+  EXPECT_THAT(SourceAddressUtility::sourceAddressesForWorker(addresses, 0, 2),
+              ElementsAre("a", "c", "e"));
+  EXPECT_THAT(SourceAddressUtility::sourceAddressesForWorker(addresses, 1, 2),
+              ElementsAre("b", "d"));
+  EXPECT_THAT(SourceAddressUtility::sourceAddressesForWorker(addresses, 0, 1),
+              ElementsAreArray(addresses));
+  // With fewer addresses than workers, the workers share them.
+  EXPECT_THAT(SourceAddressUtility::sourceAddressesForWorker(addresses, 6, 8), ElementsAre("b"));
+  EXPECT_TRUE(SourceAddressUtility::sourceAddressesForWorker({}, 0, 1).empty());
+}
+
+TEST(SourceAddressUtilityTest, NamesClustersAndStats) {
+  EXPECT_EQ("3.source_7", SourceAddressUtility::clusterName(3, 7));
+  EXPECT_EQ("3.source.10_0_0_1", SourceAddressUtility::statName(3, "10.0.0.1"));
+  EXPECT_EQ("0.source.fd00__1", SourceAddressUtility::statName(0, "fd00::1"));
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
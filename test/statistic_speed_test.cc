@@ -0,0 +1,93 @@
+// Compares merging HdrStatistic instances and extracting a set of percentiles from them against
+// the per-value and per-percentile paths of the HdrHistogram library. BM_HdrAdd is how combine()
+// used to merge, BM_HdrStatisticCombine is how it merges histograms of the same layout now.
+
+#include <random>
+#include <vector>
+
+#include "source/common/statistic_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+const std::vector<double> ReportedPercentiles{0, 10, 50, 75, 90, 95, 99, 99.9, 99.99, 100};
+
+template <class T> void addSamples(T add, uint64_t count) {
+  std::mt19937_64 mt(1243);
+  std::lognormal_distribution<double> dist(13, 1);
+  for (uint64_t i = 0; i < count; i++) {
+    add(static_cast<uint64_t>(dist(mt)));
+  }
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_HdrAdd(benchmark::State& state) {
+  std::vector<hdr_histogram*> histograms(2);
+  for (hdr_histogram*& histogram : histograms) {
+    hdr_init(1, 1000L * 1000 * 1000 * 60, 4, &histogram);
+    addSamples([histogram](uint64_t value) { hdr_record_value(histogram, value); },
+               state.range(0));
+  }
+  for (auto _ : state) { // NOLINT
+    hdr_histogram* combined;
+    hdr_init(1, 1000L * 1000 * 1000 * 60, 4, &combined);
+    hdr_add(combined, histograms[0]);
+    hdr_add(combined, histograms[1]);
+    benchmark::DoNotOptimize(combined->total_count);
+    hdr_close(combined);
+  }
+  for (hdr_histogram* histogram : histograms) {
+    hdr_close(histogram);
+  }
+}
+BENCHMARK(BM_HdrAdd)->Arg(1000)->Arg(1000000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_HdrStatisticCombine(benchmark::State& state) {
+  HdrStatistic a;
+  HdrStatistic b;
+  addSamples([&a](uint64_t value) { a.addValue(value); }, state.range(0));
+  addSamples([&b](uint64_t value) { b.addValue(value); }, state.range(0));
+  for (auto _ : state) { // NOLINT
+    StatisticPtr combined = a.combine(b);
+    benchmark::DoNotOptimize(combined->count());
+  }
+}
+BENCHMARK(BM_HdrStatisticCombine)->Arg(1000)->Arg(1000000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_HdrStatisticPercentileEach(benchmark::State& state) {
+  HdrStatistic statistic;
+  addSamples([&statistic](uint64_t value) { statistic.addValue(value); }, state.range(0));
+  for (auto _ : state) { // NOLINT
+    for (const double percentile : ReportedPercentiles) {
+      benchmark::DoNotOptimize(statistic.percentile(percentile));
+    }
+  }
+}
+BENCHMARK(BM_HdrStatisticPercentileEach)->Arg(1000)->Arg(1000000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_HdrStatisticPercentiles(benchmark::State& state) {
+  HdrStatistic statistic;
+  addSamples([&statistic](uint64_t value) { statistic.addValue(value); }, state.range(0));
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(statistic.percentiles(ReportedPercentiles));
+  }
+}
+BENCHMARK(BM_HdrStatisticPercentiles)->Arg(1000)->Arg(1000000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_HdrStatisticToProto(benchmark::State& state) {
+  HdrStatistic statistic;
+  addSamples([&statistic](uint64_t value) { statistic.addValue(value); }, state.range(0));
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(statistic.toProto(Statistic::SerializationDomain::DURATION));
+  }
+}
+BENCHMARK(BM_HdrStatisticToProto)->Arg(1000)->Arg(1000000);
+
+} // namespace
+} // namespace Nighthawk
@@ -268,8 +268,27 @@ TYPED_TEST(TypedStatisticTest, IdFieldWorks) {
   EXPECT_EQ(id, statistic.id());
 }
 
+TYPED_TEST(TypedStatisticTest, MemoryUsageBytes) {
+  TypeParam statistic;
+  const uint64_t empty = statistic.memoryUsageBytes();
+  EXPECT_GE(empty, sizeof(StatisticImpl));
+  for (int i = 1; i < 10000; i++) {
+    statistic.addValue(i);
+  }
+  EXPECT_GE(statistic.memoryUsageBytes(), empty);
+}
+
 class StatisticTest : public Test {};
 
+TEST(StatisticTest, InMemoryStatisticMemoryUsageGrowsWithTheSamples) {
+  InMemoryStatistic statistic;
+  const uint64_t empty = statistic.memoryUsageBytes();
+  for (int i = 1; i < 10000; i++) {
+    statistic.addValue(i);
+  }
+  EXPECT_GE(statistic.memoryUsageBytes(), empty + 9999 * sizeof(int64_t));
+}
+
 // Note that we explicitly subject SimpleStatistic to the large
 // values below, and see a 0 stdev returned.
 TEST(StatisticTest, SimpleStatisticProtoOutputLargeValues) {
@@ -354,6 +373,35 @@ TEST(StatisticTest, HdrStatisticPercentilesProto) {
       << golden_json;
 }
 
+TEST(StatisticTest, HdrStatisticPercentilesProtoMatchesLibraryIterator) {
+  HdrStatistic statistic;
+  hdr_histogram* histogram;
+  ASSERT_EQ(0, hdr_init(1, 1000L * 1000 * 1000 * 60, statistic.significantDigits(), &histogram));
+  std::mt19937_64 mt(1243);
+  std::lognormal_distribution<double> dist(13, 1);
+  for (int i = 0; i < 10000; i++) {
+    const uint64_t value = static_cast<uint64_t>(dist(mt));
+    statistic.addValue(value);
+    hdr_record_value(histogram, value);
+  }
+
+  const nighthawk::client::Statistic proto = statistic.toProto(Statistic::SerializationDomain::RAW);
+  hdr_iter iter;
+  hdr_iter_percentile_init(&iter, histogram, 5);
+  int i = 0;
+  while (hdr_iter_next(&iter)) {
+    ASSERT_LT(i, proto.percentiles_size());
+    EXPECT_DOUBLE_EQ(iter.specifics.percentiles.percentile / 100.0,
+                     proto.percentiles(i).percentile());
+    EXPECT_EQ(static_cast<uint64_t>(iter.cumulative_count), proto.percentiles(i).count());
+    EXPECT_EQ(static_cast<uint64_t>(iter.highest_equivalent_value),
+              proto.percentiles(i).raw_value());
+    i++;
+  }
+  EXPECT_EQ(i, proto.percentiles_size());
+  hdr_close(histogram);
+}
+
 TEST(StatisticTest, CircllhistStatisticPercentilesProto) {
   nighthawk::client::Statistic parsed_json_proto;
   CircllhistStatistic statistic;
@@ -398,6 +446,60 @@ TEST(StatisticTest, HdrStatisticOutOfRange) {
   EXPECT_EQ(0, a.count());
 }
 
+TEST(StatisticTest, HdrStatisticPercentileAndReset) {
+  HdrStatistic a;
+  EXPECT_EQ(0, a.percentile(50));
+  for (uint64_t i = 1; i <= 100; i++) {
+    a.addValue(i * 1000);
+  }
+  EXPECT_NEAR(50000, a.percentile(50), 10);
+  EXPECT_NEAR(95000, a.percentile(95), 10);
+  a.reset();
+  EXPECT_EQ(0, a.count());
+  EXPECT_EQ(0, a.percentile(95));
+}
+
+TEST(StatisticTest, HdrStatisticCombineAddsUpCounts) {
+  HdrStatistic a;
+  HdrStatistic b;
+  HdrStatistic all;
+  std::mt19937_64 mt(1243);
+  std::lognormal_distribution<double> dist(13, 1);
+  for (int i = 0; i < 10000; i++) {
+    const uint64_t value = static_cast<uint64_t>(dist(mt));
+    (i % 3 == 0 ? a : b).addValue(value);
+    all.addValue(value);
+  }
+  const StatisticPtr combined = a.combine(b);
+  EXPECT_EQ(all.count(), combined->count());
+  EXPECT_EQ(all.min(), combined->min());
+  EXPECT_EQ(all.max(), combined->max());
+  EXPECT_DOUBLE_EQ(all.mean(), combined->mean());
+  EXPECT_DOUBLE_EQ(all.pstdev(), combined->pstdev());
+  const auto& combined_hdr = dynamic_cast<const HdrStatistic&>(*combined);
+  for (const double percentile : {0.0, 1.0, 50.0, 90.0, 99.0, 99.99, 100.0}) {
+    EXPECT_EQ(all.percentile(percentile), combined_hdr.percentile(percentile));
+  }
+}
+
+TEST(StatisticTest, HdrStatisticPercentiles) {
+  HdrStatistic a;
+  EXPECT_EQ(std::vector<uint64_t>({0, 0}), a.percentiles({50, 99}));
+  std::mt19937_64 mt(1243);
+  std::lognormal_distribution<double> dist(13, 1);
+  for (int i = 0; i < 10000; i++) {
+    a.addValue(static_cast<uint64_t>(dist(mt)));
+  }
+  // The percentiles come back in the requested order.
+  const std::vector<double> requested{50, 99.9, 10, 100, 90, 75, 50};
+  const std::vector<uint64_t> values = a.percentiles(requested);
+  ASSERT_EQ(requested.size(), values.size());
+  for (size_t i = 0; i < requested.size(); i++) {
+    EXPECT_EQ(a.percentile(requested[i]), values[i]) << requested[i];
+  }
+  EXPECT_TRUE(a.percentiles({}).empty());
+}
+
 TEST(StatisticTest, NullStatistic) {
   NullStatistic stat;
   EXPECT_EQ(0, stat.count());
@@ -438,10 +540,7 @@ TYPED_TEST(SinkableStatisticTest, EmptySinkableStatistic) {
   EXPECT_TRUE(std::isnan(stat.pstdev()));
   EXPECT_EQ(stat.min(), UINT64_MAX);
   EXPECT_EQ(stat.max(), 0);
-  EXPECT_EQ(Envoy::Stats::Histogram::Unit::Unspecified, stat.unit());
-  EXPECT_FALSE(stat.used());
-  EXPECT_EQ("", stat.name());
-  EXPECT_EQ("", stat.tagExtractedName());
+  EXPECT_EQ(nullptr, stat.sinkHistogram());
   EXPECT_EQ(absl::nullopt, stat.worker_id());
 }
 
@@ -452,10 +551,14 @@ TYPED_TEST(SinkableStatisticTest, SimpleSinkableStatistic) {
   const uint64_t sample_value = 123;
   const std::string stat_name = "stat_name";
 
-  EXPECT_CALL(mock_store, deliverHistogramToSinks(_, sample_value)).Times(2);
-  stat.recordValue(sample_value);
+  // Samples go to the sinks through the histogram of the scope, which exists once the id is set.
   stat.addValue(sample_value);
   stat.setId(stat_name);
+  ASSERT_NE(nullptr, stat.sinkHistogram());
+  EXPECT_EQ(stat_name, stat.sinkHistogram()->name());
+  EXPECT_EQ(Envoy::Stats::Histogram::Unit::Unspecified, stat.sinkHistogram()->unit());
+  EXPECT_CALL(mock_store, deliverHistogramToSinks(_, sample_value));
+  stat.addValue(sample_value);
 
   EXPECT_EQ(2, stat.count());
   Helper::expectNear(123.0, stat.mean(), stat.significantDigits());
@@ -463,10 +566,7 @@ TYPED_TEST(SinkableStatisticTest, SimpleSinkableStatistic) {
   EXPECT_DOUBLE_EQ(0, stat.pstdev());
   EXPECT_EQ(123, stat.min());
   EXPECT_EQ(123, stat.max());
-  EXPECT_EQ(Envoy::Stats::Histogram::Unit::Unspecified, stat.unit());
-  EXPECT_TRUE(stat.used());
-  EXPECT_EQ(stat_name, stat.name());
-  EXPECT_EQ("0.stat_name", stat.tagExtractedName());
+  EXPECT_EQ(stat_name, stat.id());
   EXPECT_TRUE(stat.worker_id().has_value());
   EXPECT_EQ(worker_id, stat.worker_id().value());
 }
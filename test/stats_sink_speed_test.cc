@@ -0,0 +1,65 @@
+// Compares the cost of recording the latency of a request into a sinkable statistic with stats
+// sinks configured against none, on a thread local store set up like the one of the client.
+
+#include <memory>
+#include <vector>
+
+#include "envoy/stats/sink.h"
+
+#include "external/envoy/source/common/stats/allocator_impl.h"
+#include "external/envoy/source/common/stats/symbol_table.h"
+#include "external/envoy/source/common/stats/thread_local_store.h"
+#include "external/envoy/source/common/thread_local/thread_local_impl.h"
+#include "external/envoy/test/test_common/utility.h"
+
+#include "source/common/statistic_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+// Counts what it gets handed, like the cheapest sink would.
+class CountingStatsSink : public Envoy::Stats::Sink {
+public:
+  void flush(Envoy::Stats::MetricSnapshot&) override { flushes_++; }
+  void onHistogramComplete(const Envoy::Stats::Histogram&, uint64_t) override { samples_++; }
+
+  uint64_t flushes_{0};
+  uint64_t samples_{0};
+};
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_SinkableStatisticAddValue(benchmark::State& state) {
+  Envoy::Stats::SymbolTableImpl symbol_table;
+  Envoy::Stats::AllocatorImpl allocator(symbol_table);
+  Envoy::Stats::ThreadLocalStoreImpl store(allocator);
+  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest();
+  Envoy::Event::DispatcherPtr dispatcher = api->allocateDispatcher("benchmark");
+  Envoy::ThreadLocal::InstanceImpl tls;
+  tls.registerThread(*dispatcher, true);
+  store.initializeThreading(*dispatcher, tls);
+  std::vector<std::unique_ptr<CountingStatsSink>> sinks;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    sinks.push_back(std::make_unique<CountingStatsSink>());
+    store.addSink(*sinks.back());
+  }
+  Envoy::Stats::ScopeSharedPtr scope = store.createScope("cluster.0.");
+  SinkableHdrStatistic statistic(*scope, 0);
+  statistic.setId("benchmark_http_client.latency_2xx");
+
+  uint64_t latency = 1000;
+  for (auto _ : state) { // NOLINT
+    statistic.addValue(latency);
+    latency = latency * 7 % 1000003;
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  store.shutdownThreading();
+  tls.shutdownGlobalThreading();
+  tls.shutdownThread();
+}
+BENCHMARK(BM_SinkableStatisticAddValue)->Arg(0)->Arg(1)->Arg(4);
+
+} // namespace
+} // namespace Nighthawk
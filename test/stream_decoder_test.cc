@@ -7,6 +7,7 @@
 #include "external/envoy/source/common/stats/isolated_store_impl.h"
 #include "external/envoy/test/mocks/http/mocks.h"
 #include "external/envoy/test/mocks/stream_info/mocks.h"
+#include "external/envoy/test/test_common/environment.h"
 
 #include "source/client/stream_decoder.h"
 #include "source/common/statistic_impl.h"
@@ -40,6 +41,8 @@ public:
   void exportLatency(const uint32_t, const uint64_t) override {
     stream_decoder_export_latency_callbacks_++;
   }
+  void onRequestTimeout(const uint64_t) override { request_timeouts_++; }
+  void onRequestCancelled() override { cancelled_requests_++; }
 
   Envoy::Event::TestRealTimeSystem time_system_;
   Envoy::Stats::IsolatedStoreImpl store_;
@@ -54,6 +57,8 @@ public:
   uint64_t stream_decoder_completion_callbacks_{0};
   uint64_t pool_failures_{0};
   uint64_t stream_decoder_export_latency_callbacks_{0};
+  uint64_t request_timeouts_{0};
+  uint64_t cancelled_requests_{0};
   Envoy::Random::RandomGeneratorImpl random_generator_;
   Envoy::Tracing::HttpTracerSharedPtr http_tracer_;
   Envoy::Http::ResponseHeaderMapPtr test_header_;
@@ -90,6 +95,70 @@ TEST_F(StreamDecoderTest, HeaderWithBodyTest) {
   EXPECT_EQ(1, stream_decoder_completion_callbacks_);
 }
 
+TEST_F(StreamDecoderTest, RequestClassStatisticIsUpdated) {
+  RequestClassStatistic request_class_statistic(store_, "foo",
+                                                std::make_unique<StreamingStatistic>(),
+                                                std::make_unique<StreamingStatistic>());
+  EXPECT_EQ(request_class_statistic.response_statistic->id(),
+            "benchmark_http_client.class_foo.request_to_response");
+  EXPECT_EQ(request_class_statistic.response_body_size_statistic->id(),
+            "benchmark_http_client.class_foo.response_body_size");
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
+      response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
+      request_headers_, true, 0, random_generator_, http_tracer_, "");
+  decoder->setRequestClassStatistic(&request_class_statistic);
+  Envoy::Http::MockRequestEncoder stream_encoder;
+  EXPECT_CALL(stream_encoder, getStream());
+  Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  EXPECT_CALL(stream_encoder, encodeHeaders(_, true));
+  decoder->onPoolReady(stream_encoder, ptr, stream_info,
+                       {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+  decoder->decodeHeaders(std::move(test_header_), false);
+  Envoy::Buffer::OwnedImpl buf(std::string(3, 'a'));
+  decoder->decodeData(buf, true);
+  EXPECT_EQ(1, request_class_statistic.response_statistic->count());
+  EXPECT_EQ(1, request_class_statistic.response_body_size_statistic->count());
+  EXPECT_EQ(3, request_class_statistic.response_body_size_statistic->max());
+  EXPECT_EQ(1, request_class_statistic.counters.http_2xx_.value());
+  EXPECT_EQ(1, store_.counterFromString("benchmark.class.foo.http_2xx").value());
+  EXPECT_EQ(0, request_class_statistic.counters.stream_resets_.value());
+}
+
+TEST_F(StreamDecoderTest, ResponseObserverGetsBoundedBodyPrefix) {
+  class TestResponseObserver : public ResponseObserver {
+  public:
+    uint32_t maxResponseBodyBytes() const override { return 4; }
+    void onResponse(bool success, const Envoy::Http::ResponseHeaderMap* headers,
+                    absl::string_view body) override {
+      responses++;
+      last_success = success;
+      last_had_headers = headers != nullptr;
+      last_body = std::string(body);
+    }
+    int responses{0};
+    bool last_success{};
+    bool last_had_headers{};
+    std::string last_body;
+  };
+  auto observer = std::make_shared<TestResponseObserver>();
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
+      response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
+      request_headers_, false, 0, random_generator_, http_tracer_, "");
+  decoder->setResponseObserver(observer);
+  decoder->decodeHeaders(std::move(test_header_), false);
+  Envoy::Buffer::OwnedImpl buf1("abc");
+  decoder->decodeData(buf1, false);
+  Envoy::Buffer::OwnedImpl buf2("def");
+  decoder->decodeData(buf2, true);
+  EXPECT_EQ(1, observer->responses);
+  EXPECT_TRUE(observer->last_success);
+  EXPECT_TRUE(observer->last_had_headers);
+  EXPECT_EQ("abcd", observer->last_body);
+}
+
 TEST_F(StreamDecoderTest, TrailerTest) {
   bool is_complete = false;
   auto decoder = new StreamDecoder(
@@ -164,6 +233,77 @@ TEST_F(StreamDecoderTest, LatencyIsMeasured) {
   EXPECT_EQ(1, stream_decoder_export_latency_callbacks_);
 }
 
+TEST_F(StreamDecoderTest, RequestEventIsLogged) {
+  const std::string path = Envoy::TestEnvironment::temporaryPath("stream_decoder_events");
+  {
+    RequestEventLog request_event_log(path, 8, 0);
+    auto decoder = new StreamDecoder(
+        *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_,
+        latency_statistic_, response_header_size_statistic_, response_body_size_statistic_,
+        origin_latency_statistic_, request_headers_, false, 0, random_generator_, http_tracer_, "");
+    const Envoy::MonotonicTime intended_start = time_system_.monotonicTime() - 1ms;
+    decoder->setRequestEventLog(&request_event_log, request_event_log.nextRequestId(), 3,
+                                intended_start);
+    Envoy::Http::MockRequestEncoder stream_encoder;
+    EXPECT_CALL(stream_encoder, getStream());
+    EXPECT_CALL(stream_encoder, encodeHeaders(_, true));
+    Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+    NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+    stream_info.downstream_connection_info_provider_->setConnectionID(42);
+    decoder->onPoolReady(stream_encoder, ptr, stream_info,
+                         {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+    decoder->decodeHeaders(std::move(test_header_), false);
+    Envoy::Buffer::OwnedImpl buf(std::string(5, 'a'));
+    decoder->decodeData(buf, true);
+  }
+  const absl::StatusOr<std::vector<RequestEventRecord>> records = RequestEventLog::read(path);
+  ASSERT_TRUE(records.ok());
+  ASSERT_EQ(1, records->size());
+  const RequestEventRecord& record = (*records)[0];
+  EXPECT_EQ(0, record.request_id);
+  EXPECT_EQ(3, record.request_class);
+  EXPECT_EQ(42, record.connection_id);
+  EXPECT_EQ(200, record.status);
+  EXPECT_EQ(5, record.response_bytes);
+  EXPECT_EQ(RequestOutcome::Success, record.outcome);
+  EXPECT_LT(record.intended_start_ns, record.start_ns);
+  EXPECT_LE(record.start_ns, record.connect_ns);
+  EXPECT_LE(record.connect_ns, record.first_byte_ns);
+  EXPECT_LE(record.first_byte_ns, record.last_byte_ns);
+}
+
+TEST_F(StreamDecoderTest, SlowRequestIsCaptured) {
+  SlowestRequestTracker tracker(1, 4, {"server", ":method"});
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
+      response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
+      request_headers_, true, 0, random_generator_, http_tracer_, "");
+  decoder->setSlowestRequestTracker(&tracker);
+  Envoy::Http::MockRequestEncoder stream_encoder;
+  EXPECT_CALL(stream_encoder, getStream());
+  EXPECT_CALL(stream_encoder, encodeHeaders(_, true));
+  Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  stream_info.downstream_connection_info_provider_->setConnectionID(42);
+  decoder->onPoolReady(stream_encoder, ptr, stream_info,
+                       {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+  test_header_->addCopy(Envoy::Http::LowerCaseString("server"), "envoy");
+  decoder->decodeHeaders(std::move(test_header_), true);
+  const std::vector<nighthawk::client::SlowRequest> slowest = tracker.slowestRequests();
+  ASSERT_EQ(1, slowest.size());
+  EXPECT_EQ("GET", slowest[0].method());
+  EXPECT_EQ("/foo", slowest[0].path());
+  EXPECT_EQ(200, slowest[0].response_code());
+  EXPECT_EQ(42, slowest[0].connection_id());
+  EXPECT_EQ(4, slowest[0].worker());
+  ASSERT_EQ(1, slowest[0].request_headers_size());
+  EXPECT_EQ(":method", slowest[0].request_headers(0).key());
+  EXPECT_EQ("GET", slowest[0].request_headers(0).value());
+  ASSERT_EQ(1, slowest[0].response_headers_size());
+  EXPECT_EQ("server", slowest[0].response_headers(0).key());
+  EXPECT_EQ("envoy", slowest[0].response_headers(0).value());
+}
+
 TEST_F(StreamDecoderTest, StreamResetTest) {
   bool is_complete = false;
   auto decoder = new StreamDecoder(
@@ -191,6 +331,104 @@ TEST_F(StreamDecoderTest, PoolFailureTest) {
   EXPECT_EQ(1, pool_failures_);
 }
 
+TEST_F(StreamDecoderTest, TimeoutResetsActiveStream) {
+  bool is_complete = false;
+  RequestClassStatistic request_class_statistic(store_, "foo",
+                                                std::make_unique<StreamingStatistic>(),
+                                                std::make_unique<StreamingStatistic>());
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [&is_complete](bool, bool) { is_complete = true; },
+      connect_statistic_, latency_statistic_, response_header_size_statistic_,
+      response_body_size_statistic_, origin_latency_statistic_, request_headers_, true, 0,
+      random_generator_, http_tracer_, "");
+  decoder->setRequestClassStatistic(&request_class_statistic);
+  NiceMock<Envoy::Http::MockRequestEncoder> stream_encoder;
+  Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  EXPECT_CALL(stream_encoder, encodeHeaders(_, true));
+  decoder->onPoolReady(stream_encoder, ptr, stream_info,
+                       {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+  EXPECT_CALL(stream_encoder.stream_, resetStream(Envoy::Http::StreamResetReason::LocalReset))
+      .WillOnce(Invoke([decoder](Envoy::Http::StreamResetReason reason) {
+        decoder->onResetStream(reason, "");
+      }));
+  decoder->onExpired();
+  EXPECT_TRUE(is_complete);
+  EXPECT_EQ(1, request_timeouts_);
+  // Timeouts are not reported as regular completions, so they don't count as stream resets.
+  EXPECT_EQ(0, stream_decoder_completion_callbacks_);
+  EXPECT_EQ(0, latency_statistic_.count());
+  EXPECT_EQ(1, request_class_statistic.counters.request_timeouts_.value());
+  EXPECT_EQ(0, request_class_statistic.counters.stream_resets_.value());
+}
+
+TEST_F(StreamDecoderTest, TimeoutCancelsPendingRequest) {
+  class MockCancellable : public Envoy::Http::ConnectionPool::Cancellable {
+  public:
+    MOCK_METHOD(void, cancel, (Envoy::ConnectionPool::CancelPolicy), (override));
+  };
+  bool is_complete = false;
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [&is_complete](bool, bool) { is_complete = true; },
+      connect_statistic_, latency_statistic_, response_header_size_statistic_,
+      response_body_size_statistic_, origin_latency_statistic_, request_headers_, true, 0,
+      random_generator_, http_tracer_, "");
+  MockCancellable pool_request;
+  decoder->setPoolRequest(&pool_request);
+  EXPECT_CALL(pool_request, cancel(Envoy::ConnectionPool::CancelPolicy::Default));
+  decoder->onExpired();
+  EXPECT_TRUE(is_complete);
+  EXPECT_EQ(1, request_timeouts_);
+  EXPECT_EQ(0, stream_decoder_completion_callbacks_);
+  EXPECT_EQ(0, pool_failures_);
+}
+
+TEST_F(StreamDecoderTest, CancelResetsActiveStream) {
+  bool is_complete = false;
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [&is_complete](bool, bool) { is_complete = true; },
+      connect_statistic_, latency_statistic_, response_header_size_statistic_,
+      response_body_size_statistic_, origin_latency_statistic_, request_headers_, true, 0,
+      random_generator_, http_tracer_, "");
+  NiceMock<Envoy::Http::MockRequestEncoder> stream_encoder;
+  Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  EXPECT_CALL(stream_encoder, encodeHeaders(_, true));
+  decoder->onPoolReady(stream_encoder, ptr, stream_info,
+                       {} /*absl::optional<Envoy::Http::Protocol> protocol*/);
+  EXPECT_CALL(stream_encoder.stream_, resetStream(Envoy::Http::StreamResetReason::LocalReset))
+      .WillOnce(Invoke([decoder](Envoy::Http::StreamResetReason reason) {
+        decoder->onResetStream(reason, "");
+      }));
+  decoder->cancel();
+  EXPECT_TRUE(is_complete);
+  EXPECT_EQ(1, cancelled_requests_);
+  // Cancellations are neither reported as regular completions, nor as timeouts.
+  EXPECT_EQ(0, stream_decoder_completion_callbacks_);
+  EXPECT_EQ(0, request_timeouts_);
+}
+
+TEST_F(StreamDecoderTest, CancelCancelsPendingRequest) {
+  class MockCancellable : public Envoy::Http::ConnectionPool::Cancellable {
+  public:
+    MOCK_METHOD(void, cancel, (Envoy::ConnectionPool::CancelPolicy), (override));
+  };
+  bool is_complete = false;
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [&is_complete](bool, bool) { is_complete = true; },
+      connect_statistic_, latency_statistic_, response_header_size_statistic_,
+      response_body_size_statistic_, origin_latency_statistic_, request_headers_, true, 0,
+      random_generator_, http_tracer_, "");
+  MockCancellable pool_request;
+  decoder->setPoolRequest(&pool_request);
+  EXPECT_CALL(pool_request, cancel(Envoy::ConnectionPool::CancelPolicy::Default));
+  decoder->cancel();
+  EXPECT_TRUE(is_complete);
+  EXPECT_EQ(1, cancelled_requests_);
+  EXPECT_EQ(0, request_timeouts_);
+  EXPECT_EQ(0, pool_failures_);
+}
+
 TEST_F(StreamDecoderTest, StreamResetReasonToResponseFlag) {
   ASSERT_EQ(StreamDecoder::streamResetReasonToResponseFlag(
                 Envoy::Http::StreamResetReason::ConnectionFailure),
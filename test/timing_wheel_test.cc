@@ -0,0 +1,178 @@
+#include <chrono>
+#include <vector>
+
+#include "external/envoy/test/mocks/event/mocks.h"
+#include "external/envoy/test/test_common/simulated_time_system.h"
+
+#include "source/common/timing_wheel.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace Nighthawk {
+namespace {
+
+// Entry that records the times at which it expired.
+class RecordingEntry : public TimingWheelEntry {
+public:
+  explicit RecordingEntry(Envoy::TimeSource& time_source) : time_source_(time_source) {}
+  void onExpired() override { expirations.push_back(time_source_.monotonicTime()); }
+
+  std::vector<Envoy::MonotonicTime> expirations;
+
+private:
+  Envoy::TimeSource& time_source_;
+};
+
+class TimingWheelTest : public Test {
+public:
+  TimingWheelTest() : timer_(new NiceMock<Envoy::Event::MockTimer>(&dispatcher_)) {}
+
+  // Advances the simulated time, and fires the tick timer when it is armed.
+  void advance(std::chrono::nanoseconds duration) {
+    time_system_.advanceTimeWait(duration);
+    if (timer_->enabled()) {
+      timer_->invokeCallback();
+    }
+  }
+
+  Envoy::Event::SimulatedTimeSystem time_system_;
+  NiceMock<Envoy::Event::MockDispatcher> dispatcher_;
+  NiceMock<Envoy::Event::MockTimer>* timer_; // not owned
+};
+
+TEST_F(TimingWheelTest, EntriesExpireAfterTimeoutButNotBefore) {
+  TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+  EXPECT_EQ(10ms, wheel.tick());
+  RecordingEntry entry(time_system_);
+  const Envoy::MonotonicTime start = time_system_.monotonicTime();
+  EXPECT_FALSE(timer_->enabled());
+  wheel.schedule(entry);
+  EXPECT_TRUE(entry.scheduled());
+  EXPECT_TRUE(timer_->enabled());
+  for (int i = 0; i < 9; i++) {
+    advance(10ms);
+  }
+  EXPECT_TRUE(entry.expirations.empty());
+  advance(10ms);
+  ASSERT_EQ(1, entry.expirations.size());
+  EXPECT_EQ(100ms, entry.expirations[0] - start);
+  EXPECT_FALSE(entry.scheduled());
+  EXPECT_EQ(0, wheel.size());
+  // Nothing is scheduled, so the wheel should stop ticking.
+  EXPECT_FALSE(timer_->enabled());
+}
+
+TEST_F(TimingWheelTest, UnscheduledEntriesDoNotExpire) {
+  TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+  RecordingEntry entry(time_system_);
+  RecordingEntry other_entry(time_system_);
+  wheel.schedule(entry);
+  wheel.schedule(other_entry);
+  EXPECT_EQ(2, wheel.size());
+  entry.unschedule();
+  EXPECT_EQ(1, wheel.size());
+  advance(150ms);
+  EXPECT_TRUE(entry.expirations.empty());
+  EXPECT_EQ(1, other_entry.expirations.size());
+}
+
+TEST_F(TimingWheelTest, DeadlinesAreRoundedUpToTicks) {
+  TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+  RecordingEntry first_entry(time_system_);
+  wheel.schedule(first_entry);
+  // Schedule halfway through a tick, so the deadline falls halfway through a later tick.
+  time_system_.advanceTimeWait(5ms);
+  RecordingEntry entry(time_system_);
+  const Envoy::MonotonicTime start = time_system_.monotonicTime();
+  wheel.schedule(entry);
+  while (entry.expirations.empty()) {
+    advance(1ms);
+  }
+  EXPECT_GE(entry.expirations[0] - start, 100ms);
+  EXPECT_LE(entry.expirations[0] - start, 100ms + wheel.tick());
+}
+
+TEST_F(TimingWheelTest, CatchesUpAfterEventLoopStall) {
+  TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+  RecordingEntry early_entry(time_system_);
+  RecordingEntry late_entry(time_system_);
+  wheel.schedule(early_entry);
+  // Stall for longer than a full revolution of the wheel, without the timer firing. Only the entry
+  // which is due should expire, even though the late entry occupies a slot the wheel passes over.
+  time_system_.advanceTimeWait(30ms);
+  wheel.schedule(late_entry);
+  time_system_.advanceTimeWait(95ms);
+  timer_->invokeCallback();
+  EXPECT_EQ(1, early_entry.expirations.size());
+  EXPECT_TRUE(late_entry.expirations.empty());
+  advance(5ms);
+  EXPECT_EQ(1, late_entry.expirations.size());
+}
+
+TEST_F(TimingWheelTest, EntriesMayBeScheduledWithShorterDelays) {
+  TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+  RecordingEntry short_entry(time_system_);
+  RecordingEntry capped_entry(time_system_);
+  RecordingEntry immediate_entry(time_system_);
+  const Envoy::MonotonicTime start = time_system_.monotonicTime();
+  wheel.schedule(short_entry, 30ms);
+  wheel.schedule(capped_entry, 1s);
+  wheel.schedule(immediate_entry, 0ms);
+  advance(10ms);
+  ASSERT_EQ(1, immediate_entry.expirations.size());
+  EXPECT_EQ(10ms, immediate_entry.expirations[0] - start);
+  advance(20ms);
+  ASSERT_EQ(1, short_entry.expirations.size());
+  EXPECT_EQ(30ms, short_entry.expirations[0] - start);
+  for (int i = 0; i < 7; i++) {
+    advance(10ms);
+  }
+  ASSERT_EQ(1, capped_entry.expirations.size());
+  EXPECT_EQ(100ms, capped_entry.expirations[0] - start);
+}
+
+TEST_F(TimingWheelTest, ExpiryCallbacksMayRescheduleAndUnschedule) {
+  TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+  RecordingEntry victim(time_system_);
+  // Entry that unschedules another expiring entry, and reschedules itself.
+  class ReschedulingEntry : public RecordingEntry {
+  public:
+    ReschedulingEntry(Envoy::TimeSource& time_source, TimingWheel& wheel, TimingWheelEntry& victim)
+        : RecordingEntry(time_source), wheel_(wheel), victim_(victim) {}
+    void onExpired() override {
+      RecordingEntry::onExpired();
+      victim_.unschedule();
+      wheel_.schedule(*this);
+    }
+
+  private:
+    TimingWheel& wheel_;
+    TimingWheelEntry& victim_;
+  };
+  ReschedulingEntry entry(time_system_, wheel, victim);
+  wheel.schedule(entry);
+  wheel.schedule(victim);
+  advance(100ms);
+  EXPECT_EQ(1, entry.expirations.size());
+  EXPECT_TRUE(victim.expirations.empty());
+  EXPECT_TRUE(entry.scheduled());
+  EXPECT_TRUE(timer_->enabled());
+  advance(100ms);
+  EXPECT_EQ(2, entry.expirations.size());
+}
+
+TEST_F(TimingWheelTest, EntriesMayOutliveTheWheel) {
+  RecordingEntry entry(time_system_);
+  {
+    TimingWheel wheel(dispatcher_, time_system_, 100ms, 10);
+    wheel.schedule(entry);
+  }
+  EXPECT_FALSE(entry.scheduled());
+  entry.unschedule();
+}
+
+} // namespace
+} // namespace Nighthawk
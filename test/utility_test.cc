@@ -1,4 +1,5 @@
 #include <string>
+#include <vector>
 
 #include "external/envoy/source/common/network/dns_resolver/dns_factory_util.h"
 #include "external/envoy/source/common/network/utility.h"
@@ -76,6 +77,35 @@ TEST_F(UtilityTest, Ipv6Address) {
   EXPECT_EQ(80, u2.port());
 }
 
+TEST_F(UtilityTest, UnixDomainSocket) {
+  checkUriParsing("unix:///tmp/sock", "localhost", "localhost", 0, "unix", "/");
+  checkUriParsing("UNIX:///tmp/sock:/foo/bar", "localhost", "localhost", 0, "unix", "/foo/bar");
+  checkUriParsing("unix://@abstract:/foo", "localhost", "localhost", 0, "unix", "/foo");
+  EXPECT_THROW(UriImpl("unix://"), UriException);
+  EXPECT_THROW(UriImpl("unix://@"), UriException);
+  EXPECT_THROW(UriImpl("unix://relative/sock"), UriException);
+}
+
+TEST_F(UtilityTest, UnixDomainSocketResolvesToPipe) {
+  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest();
+  auto dispatcher = api->allocateDispatcher("test_thread");
+  envoy::config::core::v3::TypedExtensionConfig typed_dns_resolver_config;
+  Envoy::Network::DnsResolverFactory& dns_resolver_factory =
+      Envoy::Network::createDefaultDnsResolverFactory(typed_dns_resolver_config);
+  Envoy::Network::DnsResolverSharedPtr dns_resolver =
+      dns_resolver_factory.createDnsResolver(*dispatcher, *api, typed_dns_resolver_config);
+  // The address family doesn't apply to unix domain sockets.
+  UriImpl uri("unix:///tmp/sock:/foo");
+  Envoy::Network::Address::InstanceConstSharedPtr address =
+      uri.resolve(*dispatcher, *dns_resolver, Envoy::Network::DnsLookupFamily::V6Only);
+  EXPECT_EQ(Envoy::Network::Address::Type::Pipe, address->type());
+  EXPECT_EQ("/tmp/sock", address->asString());
+  UriImpl abstract_uri("unix://@abstract");
+  EXPECT_EQ("@abstract",
+            abstract_uri.resolve(*dispatcher, *dns_resolver, Envoy::Network::DnsLookupFamily::Auto)
+                ->asString());
+}
+
 TEST_F(UtilityTest, FindPortSeparator) {
   EXPECT_EQ(absl::string_view::npos, Utility::findPortSeparator("127.0.0.1"));
   EXPECT_EQ(5, Utility::findPortSeparator("[::1]:80"));
@@ -188,6 +218,30 @@ TEST_F(UtilityTest, MapCountersFromStore) {
   EXPECT_EQ(counters.begin()->second, 2);
 }
 
+TEST_F(UtilityTest, ResidentSetSizeGrowsWhenMemoryIsTouched) {
+  const absl::optional<uint64_t> before = Utility::residentSetSizeBytes();
+  if (!before.has_value()) {
+    GTEST_SKIP() << "The resident set size can't be determined on this platform.";
+  }
+  EXPECT_GT(before.value(), 0);
+  // Touch every page of a large allocation, so it becomes resident.
+  constexpr size_t kSize = 64 * 1024 * 1024;
+  std::vector<char> memory(kSize, 1);
+  const absl::optional<uint64_t> after = Utility::residentSetSizeBytes();
+  ASSERT_TRUE(after.has_value());
+  EXPECT_GE(after.value(), before.value() + kSize / 2);
+  EXPECT_EQ(1, memory[kSize - 1]);
+}
+
+TEST_F(UtilityTest, PeakResidentSetSizeIsAtLeastTheResidentSetSize) {
+  const absl::optional<uint64_t> current = Utility::residentSetSizeBytes();
+  const absl::optional<uint64_t> peak = Utility::peakResidentSetSizeBytes();
+  if (!peak.has_value() || !current.has_value()) {
+    GTEST_SKIP() << "The resident set size can't be determined on this platform.";
+  }
+  EXPECT_GE(peak.value(), current.value());
+}
+
 TEST_F(UtilityTest, MultipleSemicolons) {
   EXPECT_THROW(UriImpl("HTTP://HTTP://a:111"), UriException);
 }
@@ -0,0 +1,79 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "source/client/zero_work_responder.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+constexpr absl::string_view kResponse = "HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n";
+
+class ZeroWorkResponderTest : public testing::Test {
+public:
+  ZeroWorkResponderTest() {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(responder_.port());
+    EXPECT_EQ(0, connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+  }
+
+  ~ZeroWorkResponderTest() override { close(fd_); }
+
+  void send(absl::string_view data) {
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), write(fd_, data.data(), data.size()));
+  }
+
+  // Reads until the expected number of bytes arrived, or the connection got closed.
+  std::string receive(size_t size) {
+    std::string received;
+    char buffer[1024];
+    while (received.size() < size) {
+      const ssize_t rc = read(fd_, buffer, sizeof(buffer));
+      if (rc <= 0) {
+        break;
+      }
+      received.append(buffer, rc);
+    }
+    return received;
+  }
+
+  ZeroWorkResponder responder_;
+  int fd_{-1};
+};
+
+TEST_F(ZeroWorkResponderTest, RespondsToPipelinedRequests) {
+  send("GET / HTTP/1.1\r\nhost: foo\r\n\r\nGET /bar HTTP/1.1\r\nhost: foo\r\n\r\n");
+  EXPECT_EQ(absl::StrCat(kResponse, kResponse), receive(2 * kResponse.size()));
+}
+
+TEST_F(ZeroWorkResponderTest, SkipsRequestBodies) {
+  // The body looks like a request, which must not be answered.
+  const std::string body = "GET / HTTP/1.1\r\n\r\n";
+  send(absl::StrCat("POST / HTTP/1.1\r\nhost: foo\r\nContent-Length: ", body.size(), "\r\n\r\n"));
+  send(body);
+  send("GET / HTTP/1.1\r\nhost: foo\r\n\r\n");
+  EXPECT_EQ(absl::StrCat(kResponse, kResponse), receive(2 * kResponse.size()));
+  // Nothing else is pending.
+  shutdown(fd_, SHUT_WR);
+  EXPECT_EQ("", receive(1));
+}
+
+TEST_F(ZeroWorkResponderTest, RespondsToRequestsSplitOverWrites) {
+  send("GET / HTTP/1.1\r\nhost: f");
+  send("oo\r\n\r");
+  send("\n");
+  EXPECT_EQ(std::string(kResponse), receive(kResponse.size()));
+}
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk